@@ -0,0 +1,163 @@
+#include "AspectAdapter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace vcam {
+
+namespace {
+
+// Preto BGRA opaco (B=0, G=0, R=0, A=255) como palavra little-endian
+const uint32_t kOpaqueBlackBGRA = 0xFF000000u;
+
+inline int evenSize(double value, int limit) {
+    int size = (int)std::lround(value) & ~1;
+    return std::min(std::max(size, 2), limit);
+}
+
+inline int evenOffset(double value) {
+    return std::max((int)std::floor(value), 0) & ~1;
+}
+
+AspectLayout computeLayout(const CropRect &source, int width, int height,
+                           AspectMode mode, const NormalizedRect &roi) {
+    AspectLayout layout;
+    layout.crop = source;
+    layout.content = { 0, 0, width, height };
+
+    if (mode == AspectMode::Stretch || source.width < 2 || source.height < 2) {
+        return layout;
+    }
+
+    double srcAspect = (double)source.width / source.height;
+    double dstAspect = (double)width / height;
+
+    if (mode == AspectMode::Fit) {
+        int contentWidth = width;
+        int contentHeight = height;
+        if (srcAspect > dstAspect) {
+            contentHeight = evenSize(width / srcAspect, height);
+        } else {
+            contentWidth = evenSize(height * srcAspect, width);
+        }
+        layout.content.x = evenOffset((width - contentWidth) / 2.0);
+        layout.content.y = evenOffset((height - contentHeight) / 2.0);
+        layout.content.width = contentWidth;
+        layout.content.height = contentHeight;
+        return layout;
+    }
+
+    // Fill: maior janela na proporção da saída que cabe na origem
+    double fillWidth = srcAspect > dstAspect ? source.height * dstAspect : source.width;
+
+    // Menor janela nessa proporção que contém a região de interesse
+    double roiWidth = std::min(std::max(roi.width, 0.0f), 1.0f) * source.width;
+    double roiHeight = std::min(std::max(roi.height, 0.0f), 1.0f) * source.height;
+    double windowWidth = std::max(roiWidth, roiHeight * dstAspect);
+    if (windowWidth <= 0 || windowWidth > fillWidth) {
+        windowWidth = fillWidth;
+    }
+    double windowHeight = windowWidth / dstAspect;
+
+    int cropWidth = evenSize(windowWidth, source.width);
+    int cropHeight = evenSize(windowHeight, source.height);
+
+    // Centraliza na região de interesse sem sair da origem
+    double centerX = source.x + (roi.x + roi.width / 2.0) * source.width;
+    double centerY = source.y + (roi.y + roi.height / 2.0) * source.height;
+    double left = std::min(std::max(centerX - cropWidth / 2.0, (double)source.x), (double)(source.x + source.width - cropWidth));
+    double top = std::min(std::max(centerY - cropHeight / 2.0, (double)source.y), (double)(source.y + source.height - cropHeight));
+
+    layout.crop.x = evenOffset(left);
+    layout.crop.y = evenOffset(top);
+    layout.crop.width = cropWidth;
+    layout.crop.height = cropHeight;
+    return layout;
+}
+
+void fillBGRA(uint8_t *row, int pixels) {
+    if (pixels > 0) {
+        std::fill_n((uint32_t *)row, pixels, kOpaqueBlackBGRA);
+    }
+}
+
+} // namespace
+
+// --- AspectAdapter ---
+
+AspectAdapter::AspectAdapter()
+    : _valid(false), _source(), _width(0), _height(0), _mode(AspectMode::Stretch),
+      _regionOfInterest(), _layout(), _recomputeCount(0) {
+}
+
+const AspectLayout &AspectAdapter::layout(const CropRect &source, int width, int height,
+                                          AspectMode mode, const NormalizedRect &regionOfInterest) {
+    bool same = _valid &&
+                source.x == _source.x && source.y == _source.y &&
+                source.width == _source.width && source.height == _source.height &&
+                width == _width && height == _height &&
+                mode == _mode && regionOfInterest == _regionOfInterest;
+    if (same) {
+        return _layout;
+    }
+
+    _layout = computeLayout(source, width, height, mode, regionOfInterest);
+    _source = source;
+    _width = width;
+    _height = height;
+    _mode = mode;
+    _regionOfInterest = regionOfInterest;
+    _valid = true;
+    _recomputeCount++;
+    return _layout;
+}
+
+// --- Faixas ---
+
+void FillNV12Bars(const NV12Planes &dst, int width, int height, const CropRect &content, YUVRange range) {
+    const uint8_t black = range == YUVRange::Full ? 0 : 16;
+    const int right = content.x + content.width;
+
+    for (int y = 0; y < height; y++) {
+        uint8_t *row = dst.y + (size_t)y * dst.strideY;
+        if (y < content.y || y >= content.y + content.height) {
+            memset(row, black, width);
+        } else {
+            memset(row, black, content.x);
+            memset(row + right, black, width - right);
+        }
+    }
+
+    // Crominância neutra (128) nas duas componentes: UV intercalado vira um memset simples
+    const int chromaWidth = ((width + 1) / 2) * 2;
+    const int chromaLeft = content.x;
+    const int chromaRight = ((right + 1) / 2) * 2;
+    const int chromaTop = content.y / 2;
+    const int chromaBottom = (content.y + content.height + 1) / 2;
+
+    for (int y = 0; y < (height + 1) / 2; y++) {
+        uint8_t *row = dst.uv + (size_t)y * dst.strideUV;
+        if (y < chromaTop || y >= chromaBottom) {
+            memset(row, 128, chromaWidth);
+        } else {
+            memset(row, 128, chromaLeft);
+            memset(row + chromaRight, 128, chromaWidth - chromaRight);
+        }
+    }
+}
+
+void FillBGRABars(const BGRAPlane &dst, int width, int height, const CropRect &content) {
+    const int right = content.x + content.width;
+
+    for (int y = 0; y < height; y++) {
+        uint8_t *row = dst.data + (size_t)y * dst.stride;
+        if (y < content.y || y >= content.y + content.height) {
+            fillBGRA(row, width);
+        } else {
+            fillBGRA(row, content.x);
+            fillBGRA(row + (size_t)right * 4, width - right);
+        }
+    }
+}
+
+} // namespace vcam
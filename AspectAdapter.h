@@ -0,0 +1,83 @@
+#ifndef ASPECTADAPTER_H
+#define ASPECTADAPTER_H
+
+#include "FrameScaler.h"
+
+namespace vcam {
+
+/**
+ * Como encaixar a origem numa saída de outra proporção.
+ */
+enum class AspectMode {
+    Stretch,  // distorce para ocupar a saída inteira
+    Fill,     // recorta a origem na proporção da saída (centro ou região de interesse)
+    Fit       // encaixa a origem inteira com faixas pretas
+};
+
+/**
+ * Retângulo normalizado (0-1) relativo ao recorte da origem.
+ */
+struct NormalizedRect {
+    float x;
+    float y;
+    float width;
+    float height;
+
+    bool operator==(const NormalizedRect &other) const {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+};
+
+/**
+ * Resultado da adaptação: o que ler da origem e onde escrever na saída.
+ */
+struct AspectLayout {
+    CropRect crop;     // região da origem, em pixels de luma
+    CropRect content;  // região da saída que recebe a imagem; o resto são faixas
+
+    bool hasBars(int width, int height) const {
+        return content.x != 0 || content.y != 0 || content.width != width || content.height != height;
+    }
+};
+
+/**
+ * AspectAdapter
+ *
+ * Calcula recorte e área útil para cada geometria (recorte da origem,
+ * tamanho da saída, modo e região de interesse) e guarda o resultado:
+ * o cálculo só é refeito quando algum desses parâmetros muda.
+ * Coordenadas são pares para manter a crominância 4:2:0 alinhada.
+ * Não é thread-safe: use uma instância por thread.
+ */
+class AspectAdapter {
+public:
+    AspectAdapter();
+
+    const AspectLayout &layout(const CropRect &source, int width, int height,
+                               AspectMode mode, const NormalizedRect &regionOfInterest);
+
+    // Quantas vezes o layout foi recalculado
+    uint64_t recomputeCount() const {
+        return _recomputeCount;
+    }
+
+private:
+    bool _valid;
+    CropRect _source;
+    int _width;
+    int _height;
+    AspectMode _mode;
+    NormalizedRect _regionOfInterest;
+    AspectLayout _layout;
+    uint64_t _recomputeCount;
+};
+
+/**
+ * Preenche com preto tudo que está fora de `content` (memset por linha).
+ */
+void FillNV12Bars(const NV12Planes &dst, int width, int height, const CropRect &content, YUVRange range);
+void FillBGRABars(const BGRAPlane &dst, int width, int height, const CropRect &content);
+
+} // namespace vcam
+
+#endif /* ASPECTADAPTER_H */
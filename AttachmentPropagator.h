@@ -0,0 +1,76 @@
+#ifndef ATTACHMENTPROPAGATOR_H
+#define ATTACHMENTPROPAGATOR_H
+
+#include <CoreMedia/CoreMedia.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "CFHandle.h"
+
+namespace vcam {
+
+/**
+ * Contadores e custo da propagação.
+ */
+struct AttachmentPropagatorStats {
+    uint64_t frames;       // buffers substitutos processados
+    uint64_t attachments;  // attachments copiados
+    uint64_t scans;        // cópias do dicionário de attachments (única alocação da propagação)
+    uint64_t resolves;     // vezes que o conjunto de chaves mudou (primeiro frame incluído)
+    uint64_t keys;         // chaves propagáveis distintas vistas na sessão
+    uint64_t totalNs;      // tempo gasto em propagate()
+};
+
+/**
+ * AttachmentPropagator
+ *
+ * Copia para o buffer substituto os attachments propagáveis do buffer
+ * original da câmera (EXIF, MetadataDictionary, matriz intrínseca...), que
+ * apps leem direto do CMSampleBuffer.
+ *
+ * As chaves propagáveis ficam em cache por sessão. Em regime cada frame lê
+ * só essas chaves (CMGetAttachment, sem cópia) para um dicionário mutável
+ * reaproveitado e aplica tudo com um CMSetAttachments: nenhuma alocação por
+ * frame. O dicionário completo (CMCopyDictionaryOfAttachments) só é copiado
+ * no primeiro frame e a cada kRescanInterval frames, para que chaves que
+ * aparecem depois ou em outra saída da câmera também entrem no cache.
+ *
+ * Thread-safe: o cache e o dicionário reaproveitado são protegidos por mutex.
+ */
+class AttachmentPropagator {
+public:
+    AttachmentPropagator();
+
+    /**
+     * Copia os attachments de `original` para `substitute`.
+     * @return Número de attachments copiados
+     */
+    size_t propagate(CMSampleBufferRef original, CMSampleBufferRef substitute);
+
+    /** Esquece as chaves; a próxima chamada resolve de novo (nova sessão/câmera). */
+    void reset();
+
+    AttachmentPropagatorStats stats() const;
+
+    /** Frames entre duas cópias completas do dicionário (~1 s a 30 fps). */
+    static const uint64_t kRescanInterval = 30;
+
+private:
+    /** Acrescenta ao cache as chaves novas de `attachments`. Chamar com _mutex. */
+    void resolveKeys(CFDictionaryRef attachments);
+
+    mutable std::mutex _mutex;
+    CFHandle<CFMutableSetRef> _keys;
+    CFHandle<CFMutableDictionaryRef> _scratch;  // attachments do frame atual, reaproveitado
+    uint64_t _framesSinceScan;                  // protegido por _mutex
+
+    std::atomic<uint64_t> _frames;
+    std::atomic<uint64_t> _attachments;
+    std::atomic<uint64_t> _scans;
+    std::atomic<uint64_t> _resolves;
+    std::atomic<uint64_t> _totalNs;
+};
+
+} // namespace vcam
+
+#endif /* ATTACHMENTPROPAGATOR_H */
@@ -0,0 +1,124 @@
+#import <Foundation/Foundation.h>
+#include "AttachmentPropagator.h"
+#include <chrono>
+
+namespace vcam {
+
+namespace {
+
+struct KeyScan {
+    CFSetRef known;
+    bool changed;
+};
+
+void findNewKey(const void *key, const void *value, void *context) {
+    (void)value;
+    auto *scan = static_cast<KeyScan *>(context);
+    if (!scan->changed && !CFSetContainsValue(scan->known, key)) {
+        scan->changed = true;
+    }
+}
+
+void addKey(const void *key, const void *value, void *context) {
+    (void)value;
+    CFSetAddValue((CFMutableSetRef)context, key);
+}
+
+struct KeyCopy {
+    CMSampleBufferRef original;
+    CFMutableDictionaryRef attachments;
+};
+
+// Regra Get: CMGetAttachment não retém nem copia
+void copyKnownKey(const void *key, void *context) {
+    auto *copy = static_cast<KeyCopy *>(context);
+    CMAttachmentMode mode = 0;
+    CFTypeRef value = CMGetAttachment(copy->original, (CFStringRef)key, &mode);
+    if (value && mode == kCMAttachmentMode_ShouldPropagate) {
+        CFDictionarySetValue(copy->attachments, key, value);
+    }
+}
+
+} // namespace
+
+AttachmentPropagator::AttachmentPropagator()
+    : _framesSinceScan(0), _frames(0), _attachments(0), _scans(0), _resolves(0), _totalNs(0) {
+    _keys = CFHandle<CFMutableSetRef>::adopt(CFSetCreateMutable(kCFAllocatorDefault, 0, &kCFTypeSetCallBacks));
+    _scratch = CFHandle<CFMutableDictionaryRef>::adopt(CFDictionaryCreateMutable(
+        kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks));
+}
+
+void AttachmentPropagator::resolveKeys(CFDictionaryRef attachments) {
+    KeyScan scan = { _keys.get(), false };
+    CFDictionaryApplyFunction(attachments, findNewKey, &scan);
+    if (!scan.changed) {
+        return;
+    }
+    CFIndex before = CFSetGetCount(_keys.get());
+    CFDictionaryApplyFunction(attachments, addKey, _keys.get());
+    _resolves.fetch_add(1, std::memory_order_relaxed);
+    NSLog(@"[AttachmentPropagator] %ld chaves propagáveis no buffer da câmera (%ld novas)",
+          (long)CFSetGetCount(_keys.get()), (long)(CFSetGetCount(_keys.get()) - before));
+}
+
+size_t AttachmentPropagator::propagate(CMSampleBufferRef original, CMSampleBufferRef substitute) {
+    if (!original || !substitute) {
+        return 0;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    size_t copied = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_framesSinceScan == 0) {
+            // Cópia completa: o dicionário já vem filtrado pelo modo de propagação
+            CFHandle<CFDictionaryRef> attachments = CFHandle<CFDictionaryRef>::adopt(
+                CMCopyDictionaryOfAttachments(kCFAllocatorDefault, original, kCMAttachmentMode_ShouldPropagate));
+            _scans.fetch_add(1, std::memory_order_relaxed);
+            if (attachments) {
+                CMSetAttachments(substitute, attachments.get(), kCMAttachmentMode_ShouldPropagate);
+                copied = (size_t)CFDictionaryGetCount(attachments.get());
+                resolveKeys(attachments.get());
+            }
+        } else {
+            KeyCopy copy = { original, _scratch.get() };
+            CFSetApplyFunction(_keys.get(), copyKnownKey, &copy);
+            copied = (size_t)CFDictionaryGetCount(_scratch.get());
+            if (copied > 0) {
+                CMSetAttachments(substitute, _scratch.get(), kCMAttachmentMode_ShouldPropagate);
+            }
+            // Não segura os valores do frame até o próximo
+            CFDictionaryRemoveAllValues(_scratch.get());
+        }
+        _framesSinceScan = (_framesSinceScan + 1) % kRescanInterval;
+    }
+
+    uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    _frames.fetch_add(1, std::memory_order_relaxed);
+    _attachments.fetch_add(copied, std::memory_order_relaxed);
+    _totalNs.fetch_add(elapsed, std::memory_order_relaxed);
+    return copied;
+}
+
+void AttachmentPropagator::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    CFSetRemoveAllValues(_keys.get());
+    _framesSinceScan = 0;
+}
+
+AttachmentPropagatorStats AttachmentPropagator::stats() const {
+    AttachmentPropagatorStats stats;
+    stats.frames = _frames.load(std::memory_order_relaxed);
+    stats.attachments = _attachments.load(std::memory_order_relaxed);
+    stats.scans = _scans.load(std::memory_order_relaxed);
+    stats.resolves = _resolves.load(std::memory_order_relaxed);
+    stats.totalNs = _totalNs.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        stats.keys = (uint64_t)CFSetGetCount(_keys.get());
+    }
+    return stats;
+}
+
+} // namespace vcam
@@ -0,0 +1,78 @@
+#ifndef CFHANDLE_H
+#define CFHANDLE_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <utility>
+
+namespace vcam {
+
+/**
+ * CFHandle
+ *
+ * Referência RAII para objetos CoreFoundation (CMSampleBufferRef,
+ * CVPixelBufferRef...). Cópia faz CFRetain, destruição faz CFRelease,
+ * ambos thread-safe, o que permite usá-lo como payload do FrameSlot.
+ */
+template <typename Ref>
+class CFHandle {
+public:
+    CFHandle() : _ref(NULL) {}
+
+    /** Assume a posse de uma referência já retida (regra "Create"/"Copy"). */
+    static CFHandle adopt(Ref ref) {
+        CFHandle handle;
+        handle._ref = ref;
+        return handle;
+    }
+
+    /** Retém uma referência obtida pela regra "Get". */
+    static CFHandle retain(Ref ref) {
+        if (ref) {
+            CFRetain(ref);
+        }
+        return adopt(ref);
+    }
+
+    CFHandle(const CFHandle &other) : _ref(other._ref) {
+        if (_ref) {
+            CFRetain(_ref);
+        }
+    }
+
+    CFHandle(CFHandle &&other) : _ref(other._ref) {
+        other._ref = NULL;
+    }
+
+    CFHandle &operator=(CFHandle other) {
+        std::swap(_ref, other._ref);
+        return *this;
+    }
+
+    ~CFHandle() {
+        if (_ref) {
+            CFRelease(_ref);
+        }
+    }
+
+    Ref get() const {
+        return _ref;
+    }
+
+    /** Transfere a posse para o chamador, que deve chamar CFRelease. */
+    Ref release() {
+        Ref ref = _ref;
+        _ref = NULL;
+        return ref;
+    }
+
+    explicit operator bool() const {
+        return _ref != NULL;
+    }
+
+private:
+    Ref _ref;
+};
+
+} // namespace vcam
+
+#endif /* CFHANDLE_H */
@@ -0,0 +1,33 @@
+#ifndef CVPIXELBUFFERPOOLBACKEND_H
+#define CVPIXELBUFFERPOOLBACKEND_H
+
+#include <CoreVideo/CoreVideo.h>
+#include "PixelBufferPool.h"
+
+namespace vcam {
+
+/**
+ * Backend do PixelBufferPool apoiado em um CVPixelBufferPool por bucket.
+ * Os buffers são IOSurface e voltam ao pool do CoreVideo quando o último
+ * consumidor os libera. O limite de buffers vivos usa
+ * kCVPixelBufferPoolAllocationThresholdKey.
+ */
+class CVPixelBufferPoolBackend : public PoolBackend {
+public:
+    void *createBucket(const PoolKey &key, size_t maxBuffers) override;
+    void *acquire(void *bucket) override;
+    void destroyBucket(void *bucket) override;
+};
+
+/** Alinhamento de bytes por linha usado nos buffers convertidos. */
+static const int kPooledBufferStrideAlignment = 64;
+
+/**
+ * Obtém um pixel buffer do pool (o chamador deve chamar CVPixelBufferRelease).
+ * @return NULL se o formato não é suportado ou o bucket está no limite
+ */
+CVPixelBufferRef CreatePooledPixelBuffer(PixelBufferPool &pool, OSType pixelFormat, int width, int height);
+
+} // namespace vcam
+
+#endif /* CVPIXELBUFFERPOOLBACKEND_H */
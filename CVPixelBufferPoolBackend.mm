@@ -0,0 +1,71 @@
+#import <Foundation/Foundation.h>
+#include "CVPixelBufferPoolBackend.h"
+
+namespace vcam {
+
+struct CVPoolBucket {
+    CVPixelBufferPoolRef pool;
+    CFDictionaryRef auxAttributes;
+};
+
+void *CVPixelBufferPoolBackend::createBucket(const PoolKey &key, size_t maxBuffers) {
+    NSDictionary *poolAttributes = @{
+        (id)kCVPixelBufferPoolMinimumBufferCountKey: @2
+    };
+    NSDictionary *bufferAttributes = @{
+        (id)kCVPixelBufferPixelFormatTypeKey: @(key.pixelFormat),
+        (id)kCVPixelBufferWidthKey: @(key.width),
+        (id)kCVPixelBufferHeightKey: @(key.height),
+        (id)kCVPixelBufferBytesPerRowAlignmentKey: @(key.strideAlignment),
+        (id)kCVPixelBufferIOSurfacePropertiesKey: @{}
+    };
+
+    CVPixelBufferPoolRef pool = NULL;
+    CVReturn status = CVPixelBufferPoolCreate(kCFAllocatorDefault,
+                                              (__bridge CFDictionaryRef)poolAttributes,
+                                              (__bridge CFDictionaryRef)bufferAttributes,
+                                              &pool);
+    if (status != kCVReturnSuccess) {
+        NSLog(@"[PixelBufferPool] Erro ao criar CVPixelBufferPool %dx%d: %d", key.width, key.height, status);
+        return nullptr;
+    }
+
+    CVPoolBucket *bucket = new CVPoolBucket;
+    bucket->pool = pool;
+    bucket->auxAttributes = (CFDictionaryRef)CFBridgingRetain(@{
+        (id)kCVPixelBufferPoolAllocationThresholdKey: @(maxBuffers)
+    });
+
+    NSLog(@"[PixelBufferPool] Bucket criado: %c%c%c%c %dx%d",
+          (char)(key.pixelFormat >> 24), (char)(key.pixelFormat >> 16),
+          (char)(key.pixelFormat >> 8), (char)key.pixelFormat, key.width, key.height);
+    return bucket;
+}
+
+void *CVPixelBufferPoolBackend::acquire(void *bucket) {
+    CVPoolBucket *storage = static_cast<CVPoolBucket *>(bucket);
+
+    CVPixelBufferRef pixelBuffer = NULL;
+    CVReturn status = CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(kCFAllocatorDefault, storage->pool,
+                                                                          storage->auxAttributes, &pixelBuffer);
+    if (status != kCVReturnSuccess) {
+        // kCVReturnWouldExceedAllocationThreshold: todos os buffers estão em uso
+        return nullptr;
+    }
+    return pixelBuffer;
+}
+
+void CVPixelBufferPoolBackend::destroyBucket(void *bucket) {
+    CVPoolBucket *storage = static_cast<CVPoolBucket *>(bucket);
+    CVPixelBufferPoolFlush(storage->pool, kCVPixelBufferPoolFlushExcessBuffers);
+    CVPixelBufferPoolRelease(storage->pool);
+    CFRelease(storage->auxAttributes);
+    delete storage;
+}
+
+CVPixelBufferRef CreatePooledPixelBuffer(PixelBufferPool &pool, OSType pixelFormat, int width, int height) {
+    PoolKey key = { pixelFormat, width, height, kPooledBufferStrideAlignment };
+    return static_cast<CVPixelBufferRef>(pool.acquire(key));
+}
+
+} // namespace vcam
@@ -0,0 +1,155 @@
+#include "CadenceMatcher.h"
+
+#include <cmath>
+
+namespace vcam {
+
+namespace {
+
+// Média circular da fase: peso de cada frame novo
+const double kPhaseWeight = 1.0 / 16;
+// Frames vistos antes de confiar na fase
+const int kMinPhaseSamples = 8;
+// Concentração mínima das fases (1 = todas iguais, 0 = espalhadas); jitter
+// uniforme de meio período ainda dá ~0,64
+const double kMinPhaseCoherence = 0.5;
+
+} // namespace
+
+CadenceMatcher::CadenceMatcher(int64_t maxRepeatNs)
+    : _maxRepeatNs(maxRepeatNs) {
+    reset();
+}
+
+void CadenceMatcher::reset() {
+    _lastFrameId = 0;
+    _lastFreshNs = 0;
+    _stalled = false;
+    _hasCallback = false;
+    _lastCallbackNs = 0;
+    _intervalNs = 0;
+    _lastSeenId = 0;
+    _streamIntervalNs = 0;
+    _phaseX = 0;
+    _phaseY = 0;
+    _phaseSamples = 0;
+    _holdNs = 0;
+    _stats = CadenceStats();
+}
+
+void CadenceMatcher::trackInterval(int64_t callbackNs) {
+    if (_hasCallback) {
+        int64_t delta = callbackNs - _lastCallbackNs;
+        if (delta > 0) {
+            // Média móvel (1/8) para absorver o jitter de entrega
+            _intervalNs = _intervalNs == 0 ? delta : _intervalNs + (delta - _intervalNs) / 8;
+        }
+    }
+    _hasCallback = true;
+    _lastCallbackNs = callbackNs;
+}
+
+// Uma amostra por frame novo: idade na primeira chamada que o vê, módulo o
+// menor dos dois intervalos (com o stream mais rápido, as publicações entre
+// duas chamadas repetem a fase a cada intervalo do stream)
+void CadenceMatcher::trackPhase(const CadenceFrame &latest, const CadenceFrame &previous, int64_t callbackNs) {
+    if (latest.id == _lastSeenId || latest.publishedNs == 0) {
+        return;
+    }
+    _lastSeenId = latest.id;
+
+    if (previous.id != 0 && previous.publishedNs != 0 && latest.publishedNs > previous.publishedNs) {
+        int64_t delta = latest.publishedNs - previous.publishedNs;
+        _streamIntervalNs = _streamIntervalNs == 0 ? delta : _streamIntervalNs + (delta - _streamIntervalNs) / 8;
+    }
+
+    int64_t period = _intervalNs;
+    if (_streamIntervalNs > 0 && (period == 0 || _streamIntervalNs < period)) {
+        period = _streamIntervalNs;
+    }
+    if (period <= 0) {
+        return;
+    }
+
+    int64_t age = ((callbackNs - latest.publishedNs) % period + period) % period;
+    double angle = 2.0 * M_PI * (double)age / (double)period;
+    if (_phaseSamples == 0) {
+        _phaseX = std::cos(angle);
+        _phaseY = std::sin(angle);
+    } else {
+        _phaseX += (std::cos(angle) - _phaseX) * kPhaseWeight;
+        _phaseY += (std::sin(angle) - _phaseY) * kPhaseWeight;
+    }
+    _phaseSamples++;
+
+    if (_phaseSamples < kMinPhaseSamples || std::hypot(_phaseX, _phaseY) < kMinPhaseCoherence) {
+        _holdNs = 0;
+        return;
+    }
+
+    // Fronteira a meio período do centro das publicações
+    double boundary = std::atan2(_phaseY, _phaseX) / (2.0 * M_PI) + 0.5;
+    boundary -= std::floor(boundary);
+    _holdNs = (int64_t)(boundary * (double)period);
+}
+
+CadenceDecision CadenceMatcher::deliver(uint64_t frameId, int64_t callbackNs) {
+    if (_lastFrameId != 0 && frameId > _lastFrameId + 1) {
+        _stats.droppedFrames += frameId - _lastFrameId - 1;
+    }
+    _lastFrameId = frameId;
+    _lastFreshNs = callbackNs;
+    _stalled = false;
+    _stats.delivered++;
+    return CadenceDecision::Deliver;
+}
+
+CadenceDecision CadenceMatcher::decide(const CadenceFrame &latest, const CadenceFrame &previous, int64_t callbackNs) {
+    trackInterval(callbackNs);
+
+    if (latest.id == 0) {
+        _stats.droppedCallbacks++;
+        return CadenceDecision::Drop;
+    }
+
+    // Id menor que o entregue: stream reiniciado, nada foi pulado e a fase é outra
+    if (latest.id < _lastFrameId) {
+        _lastFrameId = 0;
+        _lastSeenId = 0;
+        _streamIntervalNs = 0;
+        _phaseSamples = 0;
+        _holdNs = 0;
+    }
+    trackPhase(latest, previous, callbackNs);
+
+    if (latest.id != _lastFrameId) {
+        bool ready = _holdNs == 0 || _lastFrameId == 0 || latest.publishedNs == 0 ||
+                     callbackNs - latest.publishedNs >= _holdNs;
+        if (ready) {
+            return deliver(latest.id, callbackNs);
+        }
+        // Publicado depois da fronteira: o anterior ainda não entregue sai agora
+        if (previous.id > _lastFrameId && previous.id < latest.id) {
+            return deliver(previous.id, callbackNs);
+        }
+        // Segura o novo uma chamada; o chamador repete o anterior, que ele ainda tem
+        if (previous.id == _lastFrameId) {
+            _stalled = false;
+            _stats.held++;
+            _stats.repeated++;
+            return CadenceDecision::Repeat;
+        }
+        return deliver(latest.id, callbackNs);
+    }
+
+    // Stream parado: descartar deixaria o app sem frames (e devolver o buffer
+    // da câmera mostraria a câmera real), então o último frame segue repetido
+    _stalled = callbackNs - _lastFreshNs > _maxRepeatNs;
+    if (_stalled) {
+        _stats.stalledCallbacks++;
+    }
+    _stats.repeated++;
+    return CadenceDecision::Repeat;
+}
+
+} // namespace vcam
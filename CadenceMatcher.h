@@ -0,0 +1,134 @@
+#ifndef CADENCEMATCHER_H
+#define CADENCEMATCHER_H
+
+#include <cstdint>
+
+namespace vcam {
+
+/**
+ * O que fazer com uma chamada da câmera.
+ */
+enum class CadenceDecision {
+    Deliver,  // frame novo do stream
+    Repeat,   // stream mais lento que a câmera ou parado: reentrega o último frame
+    Drop      // nada para entregar (sem frame ainda)
+};
+
+/**
+ * Frame publicado visto numa chamada da câmera.
+ */
+struct CadenceFrame {
+    uint64_t id;          // 0 = nenhum
+    int64_t publishedNs;  // instante da publicação no relógio do host; 0 = desconhecido
+};
+
+/**
+ * Contadores da sessão.
+ */
+struct CadenceStats {
+    uint64_t delivered;
+    uint64_t repeated;
+    uint64_t held;              // repetições por segurar um frame publicado colado à chamada
+    uint64_t droppedFrames;     // frames do stream substituídos antes de qualquer chamada da câmera
+    uint64_t droppedCallbacks;  // chamadas da câmera sem frame entregue
+    uint64_t stalledCallbacks;  // repetições com o stream parado há mais de maxRepeatNs
+};
+
+/**
+ * CadenceMatcher
+ *
+ * Casa a cadência do stream WebRTC com a da câmera nativa usando os ids dos
+ * frames publicados: a cada chamada da câmera decide entre entregar o frame
+ * novo, repetir o anterior (stream mais lento) ou não entregar nada. Frames
+ * do stream que chegam mais rápido que a câmera são contados como descartados.
+ * Com o stream parado o último frame continua sendo repetido: o app nunca
+ * fica sem frames enquanto a substituição está ativa.
+ * Os PTS entregues seguem os da câmera, que já são uniformes; o matcher
+ * estima o intervalo entre chamadas para preencher a duração.
+ *
+ * Com taxas iguais (ou múltiplas) e as publicações caindo perto das chamadas,
+ * o jitter faria um frame ora chegar antes, ora depois da chamada: repetição
+ * seguida de descarte. Com os instantes de publicação o matcher estima a fase
+ * das publicações em relação às chamadas e põe a fronteira de decisão meio
+ * período longe dela: um frame publicado depois da fronteira é segurado uma
+ * chamada (repete o anterior) e entregue na seguinte, junto com o anterior
+ * publicado, que o chamador também informa. Sem fase definida (taxas sem
+ * relação, jitter do tamanho do período) entrega sempre o mais recente.
+ *
+ * Não é thread-safe.
+ */
+class CadenceMatcher {
+public:
+    /**
+     * @param maxRepeatNs Tempo repetindo o mesmo frame a partir do qual o stream é considerado parado
+     */
+    explicit CadenceMatcher(int64_t maxRepeatNs = 500000000LL);
+
+    /**
+     * @param latest Frame mais recente publicado
+     * @param previous Frame publicado antes dele (id 0 se não há)
+     * @param callbackNs PTS da chamada da câmera, em ns, no relógio do host
+     * @return Deliver/Repeat referem-se a frameId(): `latest` ou `previous`
+     */
+    CadenceDecision decide(const CadenceFrame &latest, const CadenceFrame &previous, int64_t callbackNs);
+
+    /** Sem instantes de publicação: entrega sempre o mais recente. */
+    CadenceDecision decide(uint64_t frameId, int64_t callbackNs) {
+        return decide(CadenceFrame{ frameId, 0 }, CadenceFrame{ 0, 0 }, callbackNs);
+    }
+
+    /** Frame a entregar ou repetir segundo a última decisão. */
+    uint64_t frameId() const {
+        return _lastFrameId;
+    }
+
+    void reset();
+
+    /** Intervalo estimado entre chamadas da câmera, em ns (0 enquanto desconhecido). */
+    int64_t cameraIntervalNs() const {
+        return _intervalNs;
+    }
+
+    /** Idade mínima, em ns, de um frame para ser entregue (0 = sem fase definida). */
+    int64_t holdNs() const {
+        return _holdNs;
+    }
+
+    CadenceStats stats() const {
+        return _stats;
+    }
+
+    /** O último frame está sendo repetido há mais de maxRepeatNs. */
+    bool stalled() const {
+        return _stalled;
+    }
+
+private:
+    void trackInterval(int64_t callbackNs);
+    void trackPhase(const CadenceFrame &latest, const CadenceFrame &previous, int64_t callbackNs);
+    CadenceDecision deliver(uint64_t frameId, int64_t callbackNs);
+
+    const int64_t _maxRepeatNs;
+
+    uint64_t _lastFrameId;
+    int64_t _lastFreshNs;  // chamada em que o último frame novo foi entregue
+    bool _stalled;
+
+    bool _hasCallback;
+    int64_t _lastCallbackNs;
+    int64_t _intervalNs;
+
+    // Fase das publicações: média circular da idade do frame novo módulo o período
+    uint64_t _lastSeenId;
+    int64_t _streamIntervalNs;
+    double _phaseX;
+    double _phaseY;
+    int _phaseSamples;
+    int64_t _holdNs;
+
+    CadenceStats _stats;
+};
+
+} // namespace vcam
+
+#endif /* CADENCEMATCHER_H */
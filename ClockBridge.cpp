@@ -0,0 +1,121 @@
+#include "ClockBridge.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vcam {
+
+namespace {
+
+// Abaixo disso a inclinação estimada é ruído: assume relógios na mesma taxa
+const size_t kMinSamplesForSlope = 8;
+
+// Deriva máxima aceita entre os relógios (±0,5%)
+const double kMaxDrift = 0.005;
+
+// Passo mínimo entre PTS consecutivos, se a chegada permitir
+const int64_t kMinStepNs = 1000000;
+
+} // namespace
+
+ClockBridge::ClockBridge(size_t windowSize, int64_t discontinuityNs)
+    : _windowSize(std::max<size_t>(windowSize, 2)), _discontinuityNs(discontinuityNs),
+      _next(0), _slope(1.0), _intercept(0), _originStreamNs(0),
+      _hasLast(false), _lastStreamNs(0), _lastPtsNs(0), _discontinuities(0) {
+    _samples.reserve(_windowSize);
+}
+
+void ClockBridge::reset() {
+    _samples.clear();
+    _next = 0;
+    _slope = 1.0;
+    _intercept = 0;
+    _hasLast = false;
+}
+
+void ClockBridge::fit() {
+    const size_t n = _samples.size();
+
+    double meanX = 0;
+    double meanY = 0;
+    for (const Sample &sample : _samples) {
+        meanX += (double)(sample.streamNs - _originStreamNs);
+        meanY += (double)sample.hostNs;
+    }
+    meanX /= n;
+    meanY /= n;
+
+    double slope = 1.0;
+    if (n >= kMinSamplesForSlope) {
+        double sxx = 0;
+        double sxy = 0;
+        for (const Sample &sample : _samples) {
+            double dx = (double)(sample.streamNs - _originStreamNs) - meanX;
+            sxx += dx * dx;
+            sxy += dx * ((double)sample.hostNs - meanY);
+        }
+        if (sxx > 0) {
+            slope = std::min(std::max(sxy / sxx, 1.0 - kMaxDrift), 1.0 + kMaxDrift);
+        }
+    }
+
+    // Reta pela média e depois baixada até o menor atraso da janela
+    double intercept = meanY - slope * meanX;
+    double minResidual = 0;
+    bool first = true;
+    for (const Sample &sample : _samples) {
+        double residual = (double)sample.hostNs - (intercept + slope * (double)(sample.streamNs - _originStreamNs));
+        if (first || residual < minResidual) {
+            minResidual = residual;
+            first = false;
+        }
+    }
+
+    _slope = slope;
+    _intercept = intercept + minResidual;
+}
+
+MappedTime ClockBridge::map(int64_t streamNs, int64_t hostNs) {
+    // Stream reiniciado ou com salto: descarta a janela, mas mantém a monotonicidade da saída
+    if (!_samples.empty()) {
+        int64_t delta = streamNs - _lastStreamNs;
+        if (delta <= 0 || delta > _discontinuityNs) {
+            _samples.clear();
+            _next = 0;
+            _discontinuities++;
+        }
+    }
+
+    if (_samples.empty()) {
+        _originStreamNs = streamNs;
+    }
+
+    Sample sample = { streamNs, hostNs };
+    if (_samples.size() < _windowSize) {
+        _samples.push_back(sample);
+    } else {
+        _samples[_next] = sample;
+        _next = (_next + 1) % _windowSize;
+    }
+    _lastStreamNs = streamNs;
+
+    fit();
+
+    int64_t pts = (int64_t)std::llround(_intercept + _slope * (double)(streamNs - _originStreamNs));
+    pts = std::min(pts, hostNs);
+    if (_hasLast) {
+        // Em rajadas (chegadas a menos de kMinStepNs do último PTS) o passo
+        // encolhe até a chegada, para o PTS não passar dela
+        int64_t step = std::min(kMinStepNs, std::max<int64_t>(hostNs - _lastPtsNs, 1));
+        pts = std::max(pts, _lastPtsNs + step);
+    }
+
+    MappedTime mapped;
+    mapped.ptsNs = pts;
+    mapped.durationNs = _hasLast ? pts - _lastPtsNs : 0;
+
+    _hasLast = true;
+    _lastPtsNs = pts;
+    return mapped;
+}
+
+} // namespace vcam
@@ -0,0 +1,81 @@
+#ifndef CLOCKBRIDGE_H
+#define CLOCKBRIDGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+/**
+ * Tempo mapeado para o relógio do host.
+ */
+struct MappedTime {
+    int64_t ptsNs;
+    int64_t durationNs;  // 0 no primeiro frame após um reset
+};
+
+/**
+ * ClockBridge
+ *
+ * Converte timestamps do stream WebRTC (RTCVideoFrame.timeStampNs) para o
+ * relógio do host usado pela sessão de captura. Uma regressão linear sobre
+ * os últimos pares (stream, chegada no host) estima deriva e offset; a reta
+ * é baixada até o menor atraso observado na janela, para que nenhum PTS
+ * fique no futuro em relação à chegada. O resultado é monotônico e sem o
+ * jitter de rede dos instantes de chegada.
+ *
+ * Não é thread-safe: deve ser alimentado por uma única thread (a de conversão do renderer).
+ */
+class ClockBridge {
+public:
+    /**
+     * @param windowSize Pares usados na regressão
+     * @param discontinuityNs Saltos do stream maiores que isso (ou para trás) reiniciam o mapeamento
+     */
+    explicit ClockBridge(size_t windowSize = 120, int64_t discontinuityNs = 2000000000LL);
+
+    /**
+     * Registra o par e devolve o PTS/duração no relógio do host.
+     */
+    MappedTime map(int64_t streamNs, int64_t hostNs);
+
+    void reset();
+
+    /** Deriva estimada do relógio do stream em relação ao host, em ppm. */
+    double driftPpm() const {
+        return (_slope - 1.0) * 1e6;
+    }
+
+    /** Quantas vezes o mapeamento foi reiniciado por descontinuidade. */
+    uint64_t discontinuityCount() const {
+        return _discontinuities;
+    }
+
+private:
+    struct Sample {
+        int64_t streamNs;
+        int64_t hostNs;
+    };
+
+    void fit();
+
+    const size_t _windowSize;
+    const int64_t _discontinuityNs;
+
+    std::vector<Sample> _samples;  // buffer circular
+    size_t _next;
+
+    double _slope;
+    double _intercept;  // host = intercept + slope * (stream - origem)
+    int64_t _originStreamNs;
+
+    bool _hasLast;
+    int64_t _lastStreamNs;
+    int64_t _lastPtsNs;
+    uint64_t _discontinuities;
+};
+
+} // namespace vcam
+
+#endif /* CLOCKBRIDGE_H */
@@ -0,0 +1,301 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace vcam {
+
+/**
+ * DropOldestQueue
+ *
+ * Fila limitada sem locks com um produtor e um consumidor. Cheia, o push
+ * descarta o item mais antigo em vez de bloquear ou crescer: para vídeo ao
+ * vivo o frame novo sempre vale mais que o atrasado.
+ *
+ * Para descartar, o produtor consome a cabeça como um segundo consumidor;
+ * por isso as células seguem o esquema de sequência por célula (Vyukov),
+ * que mantém a célula reservada até o consumidor terminar de movê-la.
+ */
+template <typename T>
+class DropOldestQueue {
+public:
+    /** @param capacity Arredondada para a próxima potência de dois (mínimo 2) */
+    explicit DropOldestQueue(size_t capacity) : _enqueuePos(0), _dequeuePos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    DropOldestQueue(const DropOldestQueue &) = delete;
+    DropOldestQueue &operator=(const DropOldestQueue &) = delete;
+
+    /**
+     * Enfileira; só o produtor chama.
+     * @return true se um item antigo foi descartado para abrir espaço
+     */
+    bool push(T value) {
+        bool evicted = false;
+        while (!tryEnqueue(value)) {
+            // Descarta no máximo um; se o consumidor ainda está movendo a célula, espera ele terminar
+            T oldest;
+            if (!evicted && pop(oldest)) {
+                evicted = true;
+                continue;
+            }
+            std::this_thread::yield();
+        }
+        return evicted;
+    }
+
+    /** Desenfileira o item mais antigo. @return false se vazia */
+    bool pop(T &out) {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = _cells[pos & _mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.value = T();
+                    cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t depth() const {
+        size_t enqueued = _enqueuePos.load(std::memory_order_seq_cst);
+        size_t dequeued = _dequeuePos.load(std::memory_order_seq_cst);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t capacity() const {
+        return _mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    bool tryEnqueue(T &value) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell &cell = _cells[pos & _mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != pos) {
+            return false;
+        }
+        cell.value = std::move(value);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        _enqueuePos.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _enqueuePos;
+    alignas(64) std::atomic<size_t> _dequeuePos;
+};
+
+/**
+ * Contadores e tempos por estágio do pipeline.
+ */
+struct FramePipelineStats {
+    uint64_t submitted;
+    uint64_t processed;
+    uint64_t dropped;       // descartados na fila (drop-oldest)
+    uint64_t maxDepth;      // maior profundidade observada
+    uint64_t queueNsTotal;  // espera na fila
+    uint64_t queueNsMax;
+    uint64_t workNsTotal;   // estágio do worker (conversão + publicação)
+    uint64_t workNsMax;
+};
+
+/**
+ * FramePipeline
+ *
+ * Tira o trabalho pesado da thread que entrega os frames: o produtor
+ * (callback do renderer) só enfileira numa DropOldestQueue e um worker
+ * dedicado executa o estágio de conversão/publicação. A fila limitada com
+ * descarte do mais antigo garante memória constante se o worker atrasar.
+ *
+ * submit() deve ser chamado por uma única thread. threadSetup roda no início
+ * do worker (ex.: ajustar QoS no iOS).
+ */
+template <typename T>
+class FramePipeline {
+public:
+    typedef std::function<void(T &)> Worker;
+
+    FramePipeline(size_t capacity, Worker worker, std::function<void()> threadSetup = nullptr)
+        : _queue(capacity), _worker(std::move(worker)), _threadSetup(std::move(threadSetup)),
+          _running(false), _sleeping(false) {
+        resetStats();
+    }
+
+    ~FramePipeline() {
+        stop();
+    }
+
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    void start() {
+        if (_running.exchange(true)) {
+            return;
+        }
+        _thread = std::thread([this] { run(); });
+    }
+
+    /** Para o worker; itens ainda na fila são descartados. */
+    void stop() {
+        if (!_running.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _wake.notify_one();
+        }
+        _thread.join();
+
+        Entry entry;
+        while (_queue.pop(entry)) {
+        }
+    }
+
+    void submit(T item) {
+        Entry entry = { std::move(item), nowNs() };
+        if (_queue.push(std::move(entry))) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        _submitted.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t depth = _queue.depth();
+        uint64_t maxDepth = _maxDepth.load(std::memory_order_relaxed);
+        while (depth > maxDepth && !_maxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {
+        }
+
+        // Só paga o mutex se o worker está dormindo
+        if (_sleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _wake.notify_one();
+        }
+    }
+
+    size_t depth() const {
+        return _queue.depth();
+    }
+
+    FramePipelineStats stats() const {
+        FramePipelineStats stats;
+        stats.submitted = _submitted.load(std::memory_order_relaxed);
+        stats.processed = _processed.load(std::memory_order_relaxed);
+        stats.dropped = _dropped.load(std::memory_order_relaxed);
+        stats.maxDepth = _maxDepth.load(std::memory_order_relaxed);
+        stats.queueNsTotal = _queueNsTotal.load(std::memory_order_relaxed);
+        stats.queueNsMax = _queueNsMax.load(std::memory_order_relaxed);
+        stats.workNsTotal = _workNsTotal.load(std::memory_order_relaxed);
+        stats.workNsMax = _workNsMax.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void resetStats() {
+        _submitted = 0;
+        _processed = 0;
+        _dropped = 0;
+        _maxDepth = 0;
+        _queueNsTotal = 0;
+        _queueNsMax = 0;
+        _workNsTotal = 0;
+        _workNsMax = 0;
+    }
+
+private:
+    struct Entry {
+        T item;
+        uint64_t enqueuedNs;
+    };
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Só o worker escreve os máximos
+    static void record(std::atomic<uint64_t> &total, std::atomic<uint64_t> &max, uint64_t value) {
+        total.fetch_add(value, std::memory_order_relaxed);
+        if (value > max.load(std::memory_order_relaxed)) {
+            max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void run() {
+        if (_threadSetup) {
+            _threadSetup();
+        }
+
+        while (_running.load(std::memory_order_relaxed)) {
+            Entry entry;
+            if (!_queue.pop(entry)) {
+                std::unique_lock<std::mutex> lock(_wakeMutex);
+                _sleeping.store(true, std::memory_order_seq_cst);
+                _wake.wait(lock, [this] {
+                    return !_running.load(std::memory_order_relaxed) || _queue.depth() > 0;
+                });
+                _sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            uint64_t start = nowNs();
+            record(_queueNsTotal, _queueNsMax, start - entry.enqueuedNs);
+            _worker(entry.item);
+            record(_workNsTotal, _workNsMax, nowNs() - start);
+            _processed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    DropOldestQueue<Entry> _queue;
+    Worker _worker;
+    std::function<void()> _threadSetup;
+
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<bool> _sleeping;
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+
+    std::atomic<uint64_t> _submitted;
+    std::atomic<uint64_t> _processed;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<uint64_t> _maxDepth;
+    std::atomic<uint64_t> _queueNsTotal;
+    std::atomic<uint64_t> _queueNsMax;
+    std::atomic<uint64_t> _workNsTotal;
+    std::atomic<uint64_t> _workNsMax;
+};
+
+} // namespace vcam
+
+#endif /* FRAMEPIPELINE_H */
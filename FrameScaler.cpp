@@ -0,0 +1,625 @@
+#include "FrameScaler.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VCAM_SCALE_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define VCAM_SCALE_SSE2 1
+#endif
+
+namespace vcam {
+
+namespace {
+
+// Pesos em ponto fixo Q14
+const int kWeightBits = 14;
+const int kWeightOne = 1 << kWeightBits;
+const int kWeightRounding = 1 << (kWeightBits - 1);
+
+inline uint8_t clampToByte(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+double lanczos3(double x) {
+    x = std::fabs(x);
+    if (x < 1e-8) {
+        return 1.0;
+    }
+    if (x >= 3.0) {
+        return 0.0;
+    }
+    double pix = M_PI * x;
+    return 3.0 * std::sin(pix) * std::sin(pix / 3.0) / (pix * pix);
+}
+
+// --- Filtro vertical ---
+
+void verticalScalarFrom(const uint8_t *const *rows, const int16_t *weights, int taps,
+                        uint8_t *out, int start, int width) {
+    for (int x = start; x < width; x++) {
+        int sum = kWeightRounding;
+        for (int k = 0; k < taps; k++) {
+            sum += weights[k] * rows[k][x];
+        }
+        out[x] = clampToByte(sum >> kWeightBits);
+    }
+}
+
+#if VCAM_SCALE_NEON
+
+void verticalFilter(const uint8_t *const *rows, const int16_t *weights, int taps, uint8_t *out, int width) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int32x4_t accLo = vdupq_n_s32(0);
+        int32x4_t accHi = vdupq_n_s32(0);
+        for (int k = 0; k < taps; k++) {
+            int16x8_t pixels = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + x)));
+            accLo = vmlal_n_s16(accLo, vget_low_s16(pixels), weights[k]);
+            accHi = vmlal_n_s16(accHi, vget_high_s16(pixels), weights[k]);
+        }
+        uint16x8_t result = vcombine_u16(vqrshrun_n_s32(accLo, kWeightBits), vqrshrun_n_s32(accHi, kWeightBits));
+        vst1_u8(out + x, vqmovn_u16(result));
+    }
+    verticalScalarFrom(rows, weights, taps, out, x, width);
+}
+
+#elif VCAM_SCALE_SSE2
+
+void verticalFilter(const uint8_t *const *rows, const int16_t *weights, int taps, uint8_t *out, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(kWeightRounding);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i accLo = rounding;
+        __m128i accHi = rounding;
+
+        // Taps em pares: _mm_madd_epi16 soma a*wa + b*wb em 32 bits
+        for (int k = 0; k < taps; k += 2) {
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(rows[k] + x)), zero);
+            __m128i b = zero;
+            int16_t wb = 0;
+            if (k + 1 < taps) {
+                b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(rows[k + 1] + x)), zero);
+                wb = weights[k + 1];
+            }
+            __m128i w = _mm_set1_epi32((int)(((uint32_t)(uint16_t)wb << 16) | (uint16_t)weights[k]));
+            accLo = _mm_add_epi32(accLo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            accHi = _mm_add_epi32(accHi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+
+        __m128i packed = _mm_packs_epi32(_mm_srai_epi32(accLo, kWeightBits), _mm_srai_epi32(accHi, kWeightBits));
+        _mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(packed, packed));
+    }
+    verticalScalarFrom(rows, weights, taps, out, x, width);
+}
+
+#else
+
+void verticalFilter(const uint8_t *const *rows, const int16_t *weights, int taps, uint8_t *out, int width) {
+    verticalScalarFrom(rows, weights, taps, out, 0, width);
+}
+
+#endif
+
+// --- Filtro horizontal ---
+
+// `channels` = 2 para UV intercalado; cada canal vai para o seu destino
+void horizontalFilter(const int *indices, const int16_t *weights, int taps, int dstSize,
+                      const uint8_t *src, int channels, uint8_t *const *outs) {
+    if (taps == 1) {
+        for (int i = 0; i < dstSize; i++) {
+            const uint8_t *pixel = src + indices[i] * channels;
+            for (int c = 0; c < channels; c++) {
+                outs[c][i] = pixel[c];
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < dstSize; i++) {
+        const int *ix = indices + i * taps;
+        const int16_t *w = weights + i * taps;
+        for (int c = 0; c < channels; c++) {
+            int sum = kWeightRounding;
+            for (int k = 0; k < taps; k++) {
+                sum += w[k] * src[ix[k] * channels + c];
+            }
+            outs[c][i] = clampToByte(sum >> kWeightBits);
+        }
+    }
+}
+
+// Janelas contíguas: a amostra i lê `window` pixels a partir de starts[i]
+void windowScalarFrom(const int *starts, const int16_t *weights, int window, int dstSize,
+                      const uint8_t *src, int channels, uint8_t *const *outs, int start) {
+    for (int i = start; i < dstSize; i++) {
+        const uint8_t *p = src + (size_t)starts[i] * channels;
+        const int16_t *w = weights + (size_t)i * window;
+        for (int c = 0; c < channels; c++) {
+            int sum = kWeightRounding;
+            for (int k = 0; k < window; k++) {
+                sum += w[k] * p[k * channels + c];
+            }
+            outs[c][i] = clampToByte(sum >> kWeightBits);
+        }
+    }
+}
+
+#if VCAM_SCALE_NEON
+
+// Produto de uma janela com os pesos; 4 somas parciais em 32 bits
+inline int32x4_t dotWindow(const uint8_t *p, const int16_t *w, int window) {
+    int32x4_t acc = vdupq_n_s32(0);
+    int k = 0;
+    for (; k + 8 <= window; k += 8) {
+        int16x8_t pixels = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p + k)));
+        int16x8_t wk = vld1q_s16(w + k);
+        acc = vmlal_s16(acc, vget_low_s16(pixels), vget_low_s16(wk));
+        acc = vmlal_s16(acc, vget_high_s16(pixels), vget_high_s16(wk));
+    }
+    if (k < window) {
+        // Últimos 4 taps: carga de 4 bytes, sem ler além da janela
+        uint32_t bits;
+        std::memcpy(&bits, p + k, 4);
+        int16x8_t pixels = vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bits))));
+        acc = vmlal_s16(acc, vget_low_s16(pixels), vld1_s16(w + k));
+    }
+    return acc;
+}
+
+// UV intercalado: mesmos pesos para U e V
+inline void dotWindowUV(const uint8_t *p, const int16_t *w, int window, int32x4_t &accU, int32x4_t &accV) {
+    accU = vdupq_n_s32(0);
+    accV = vdupq_n_s32(0);
+    int k = 0;
+    for (; k + 8 <= window; k += 8) {
+        uint8x8x2_t pixels = vld2_u8(p + 2 * k);
+        int16x8_t u = vreinterpretq_s16_u16(vmovl_u8(pixels.val[0]));
+        int16x8_t v = vreinterpretq_s16_u16(vmovl_u8(pixels.val[1]));
+        int16x8_t wk = vld1q_s16(w + k);
+        accU = vmlal_s16(accU, vget_low_s16(u), vget_low_s16(wk));
+        accU = vmlal_s16(accU, vget_high_s16(u), vget_high_s16(wk));
+        accV = vmlal_s16(accV, vget_low_s16(v), vget_low_s16(wk));
+        accV = vmlal_s16(accV, vget_high_s16(v), vget_high_s16(wk));
+    }
+    if (k < window) {
+        uint8x8_t raw = vld1_u8(p + 2 * k);
+        uint8x8x2_t split = vuzp_u8(raw, raw);
+        int16x4_t wk = vld1_s16(w + k);
+        accU = vmlal_s16(accU, vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(split.val[0]))), wk);
+        accV = vmlal_s16(accV, vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(split.val[1]))), wk);
+    }
+}
+
+// Soma horizontal de 4 acumuladores: [Σa0, Σa1, Σa2, Σa3]
+inline int32x4_t reduce4(int32x4_t a0, int32x4_t a1, int32x4_t a2, int32x4_t a3) {
+    int32x2_t s01 = vpadd_s32(vpadd_s32(vget_low_s32(a0), vget_high_s32(a0)),
+                              vpadd_s32(vget_low_s32(a1), vget_high_s32(a1)));
+    int32x2_t s23 = vpadd_s32(vpadd_s32(vget_low_s32(a2), vget_high_s32(a2)),
+                              vpadd_s32(vget_low_s32(a3), vget_high_s32(a3)));
+    return vcombine_s32(s01, s23);
+}
+
+inline void store4(int32x4_t sums, uint8_t *out) {
+    uint16x4_t narrow = vqrshrun_n_s32(sums, kWeightBits);
+    uint32_t bits = vget_lane_u32(vreinterpret_u32_u8(vqmovn_u16(vcombine_u16(narrow, narrow))), 0);
+    std::memcpy(out, &bits, 4);
+}
+
+#elif VCAM_SCALE_SSE2
+
+inline __m128i dotWindow(const uint8_t *p, const int16_t *w, int window) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    int k = 0;
+    for (; k + 8 <= window; k += 8) {
+        __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + k)), zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(pixels, _mm_loadu_si128((const __m128i *)(w + k))));
+    }
+    if (k < window) {
+        // Últimos 4 taps: carga de 4 bytes, sem ler além da janela
+        int32_t bits;
+        std::memcpy(&bits, p + k, 4);
+        __m128i pixels = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(pixels, _mm_loadl_epi64((const __m128i *)(w + k))));
+    }
+    return acc;
+}
+
+// UV intercalado: U nos bytes pares, V nos ímpares de cada palavra de 16 bits
+inline void dotWindowUV(const uint8_t *p, const int16_t *w, int window, __m128i &accU, __m128i &accV) {
+    const __m128i lowBytes = _mm_set1_epi16(0xFF);
+    accU = _mm_setzero_si128();
+    accV = _mm_setzero_si128();
+    int k = 0;
+    for (; k + 8 <= window; k += 8) {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(p + 2 * k));
+        __m128i wk = _mm_loadu_si128((const __m128i *)(w + k));
+        accU = _mm_add_epi32(accU, _mm_madd_epi16(_mm_and_si128(pixels, lowBytes), wk));
+        accV = _mm_add_epi32(accV, _mm_madd_epi16(_mm_srli_epi16(pixels, 8), wk));
+    }
+    if (k < window) {
+        __m128i pixels = _mm_loadl_epi64((const __m128i *)(p + 2 * k));
+        __m128i wk = _mm_loadl_epi64((const __m128i *)(w + k));
+        accU = _mm_add_epi32(accU, _mm_madd_epi16(_mm_and_si128(pixels, lowBytes), wk));
+        accV = _mm_add_epi32(accV, _mm_madd_epi16(_mm_srli_epi16(pixels, 8), wk));
+    }
+}
+
+// Soma horizontal de 4 acumuladores: [Σa0, Σa1, Σa2, Σa3]
+inline __m128i reduce4(__m128i a0, __m128i a1, __m128i a2, __m128i a3) {
+    __m128i t01 = _mm_add_epi32(_mm_unpacklo_epi32(a0, a1), _mm_unpackhi_epi32(a0, a1));
+    __m128i t23 = _mm_add_epi32(_mm_unpacklo_epi32(a2, a3), _mm_unpackhi_epi32(a2, a3));
+    return _mm_add_epi32(_mm_unpacklo_epi64(t01, t23), _mm_unpackhi_epi64(t01, t23));
+}
+
+inline void store4(__m128i sums, uint8_t *out) {
+    __m128i shifted = _mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(kWeightRounding)), kWeightBits);
+    __m128i packed = _mm_packs_epi32(shifted, shifted);
+    int32_t bits = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+    std::memcpy(out, &bits, 4);
+}
+
+#endif
+
+#if VCAM_SCALE_NEON || VCAM_SCALE_SSE2
+
+// 4 amostras de saída por iteração, como o vertical: pesos Q14 multiplicados
+// em 16 bits e acumulados em 32, arredondamento e saturação no fim
+void windowFilter(const int *starts, const int16_t *weights, int window, int dstSize,
+                  const uint8_t *src, int channels, uint8_t *const *outs) {
+    int i = 0;
+    if (channels == 1) {
+        for (; i + 4 <= dstSize; i += 4) {
+            const int16_t *w = weights + (size_t)i * window;
+            store4(reduce4(dotWindow(src + starts[i], w, window),
+                           dotWindow(src + starts[i + 1], w + window, window),
+                           dotWindow(src + starts[i + 2], w + 2 * window, window),
+                           dotWindow(src + starts[i + 3], w + 3 * window, window)),
+                   outs[0] + i);
+        }
+    } else {
+        for (; i + 4 <= dstSize; i += 4) {
+            const int16_t *w = weights + (size_t)i * window;
+#if VCAM_SCALE_NEON
+            int32x4_t u[4], v[4];
+#else
+            __m128i u[4], v[4];
+#endif
+            for (int j = 0; j < 4; j++) {
+                dotWindowUV(src + (size_t)starts[i + j] * 2, w + j * window, window, u[j], v[j]);
+            }
+            store4(reduce4(u[0], u[1], u[2], u[3]), outs[0] + i);
+            store4(reduce4(v[0], v[1], v[2], v[3]), outs[1] + i);
+        }
+    }
+    windowScalarFrom(starts, weights, window, dstSize, src, channels, outs, i);
+}
+
+#else
+
+void windowFilter(const int *starts, const int16_t *weights, int window, int dstSize,
+                  const uint8_t *src, int channels, uint8_t *const *outs) {
+    windowScalarFrom(starts, weights, window, dstSize, src, channels, outs, 0);
+}
+
+#endif
+
+} // namespace
+
+// --- YUVSource ---
+
+YUVSource YUVSource::fromI420(const I420Planes &planes, const YUVColorSpace &colorSpace) {
+    YUVSource source = {
+        planes.y, planes.u, planes.v,
+        planes.strideY, planes.strideU, planes.strideV,
+        planes.width, planes.height, colorSpace
+    };
+    return source;
+}
+
+YUVSource YUVSource::fromNV12(const NV12Source &planes, const YUVColorSpace &colorSpace) {
+    YUVSource source = {
+        planes.y, planes.uv, nullptr,
+        planes.strideY, planes.strideUV, 0,
+        planes.width, planes.height, colorSpace
+    };
+    return source;
+}
+
+// --- AxisFilter ---
+
+void FrameScaler::AxisFilter::build(int srcSize, int dstSize, ScaleQuality quality, bool reversed) {
+    this->srcSize = srcSize;
+    this->dstSize = dstSize;
+    this->quality = quality;
+    this->reversed = reversed;
+
+    double scale = (double)srcSize / dstSize;
+    ScaleQuality effective = quality;
+    if (effective == ScaleQuality::Box && scale <= 1.0) {
+        effective = ScaleQuality::Bilinear;
+    }
+
+    // Mesmo tamanho: todos os filtros se reduzem a cópia (1 tap)
+    if (srcSize == dstSize) {
+        effective = ScaleQuality::Nearest;
+    }
+
+    double support = 3.0 * std::max(scale, 1.0);
+    switch (effective) {
+        case ScaleQuality::Nearest:
+            taps = 1;
+            break;
+        case ScaleQuality::Bilinear:
+            taps = 2;
+            break;
+        case ScaleQuality::Box:
+            taps = (int)std::ceil(scale) + 1;
+            break;
+        case ScaleQuality::Lanczos3:
+            taps = (int)std::ceil(2.0 * support) + 1;
+            break;
+    }
+
+    indices.assign((size_t)dstSize * taps, 0);
+    weights.assign((size_t)dstSize * taps, 0);
+    std::vector<double> raw(taps);
+
+    for (int i = 0; i < dstSize; i++) {
+        double center = (i + 0.5) * scale;
+        double pos = center - 0.5;
+        int first = 0;
+
+        switch (effective) {
+            case ScaleQuality::Nearest:
+                first = std::min((int)center, srcSize - 1);
+                raw[0] = 1.0;
+                break;
+            case ScaleQuality::Bilinear: {
+                first = (int)std::floor(pos);
+                double frac = pos - first;
+                raw[0] = 1.0 - frac;
+                raw[1] = frac;
+                break;
+            }
+            case ScaleQuality::Box: {
+                double left = i * scale;
+                double right = (i + 1) * scale;
+                first = (int)std::floor(left);
+                for (int k = 0; k < taps; k++) {
+                    double px = first + k;
+                    raw[k] = std::max(0.0, std::min(right, px + 1.0) - std::max(left, px));
+                }
+                break;
+            }
+            case ScaleQuality::Lanczos3: {
+                double filterScale = std::max(scale, 1.0);
+                first = (int)std::floor(pos - support) + 1;
+                for (int k = 0; k < taps; k++) {
+                    raw[k] = lanczos3((first + k - pos) / filterScale);
+                }
+                break;
+            }
+        }
+
+        // Normaliza para soma exata de kWeightOne, corrigindo no maior peso
+        double total = 0;
+        for (int k = 0; k < taps; k++) {
+            total += raw[k];
+        }
+        int sum = 0;
+        int largest = 0;
+        int16_t *w = &weights[(size_t)i * taps];
+        int *ix = &indices[(size_t)i * taps];
+        for (int k = 0; k < taps; k++) {
+            w[k] = (int16_t)std::lround(raw[k] / total * kWeightOne);
+            sum += w[k];
+            if (w[k] > w[largest]) {
+                largest = k;
+            }
+            ix[k] = std::min(std::max(first + k, 0), srcSize - 1);
+        }
+        w[largest] = (int16_t)(w[largest] + (kWeightOne - sum));
+    }
+
+    // Espelhamento: a amostra de saída i usa o filtro de dstSize - 1 - i
+    if (reversed) {
+        for (int i = 0; i < dstSize / 2; i++) {
+            int j = dstSize - 1 - i;
+            std::swap_ranges(&indices[(size_t)i * taps], &indices[(size_t)(i + 1) * taps], &indices[(size_t)j * taps]);
+            std::swap_ranges(&weights[(size_t)i * taps], &weights[(size_t)(i + 1) * taps], &weights[(size_t)j * taps]);
+        }
+    }
+
+    buildWindows();
+}
+
+void FrameScaler::AxisFilter::buildWindows() {
+    windowTaps = (taps + 3) & ~3;
+    if (taps == 1 || windowTaps > srcSize) {
+        windowTaps = 0;
+        starts.clear();
+        windowWeights.clear();
+        return;
+    }
+
+    // Índices de borda repetidos (clamp) viram um só peso somado; a janela é
+    // deslocada para caber na origem e a sobra fica com peso zero
+    starts.assign(dstSize, 0);
+    windowWeights.assign((size_t)dstSize * windowTaps, 0);
+    for (int i = 0; i < dstSize; i++) {
+        const int *ix = &indices[(size_t)i * taps];
+        const int16_t *w = &weights[(size_t)i * taps];
+        int lowest = *std::min_element(ix, ix + taps);
+        int start = std::min(lowest, srcSize - windowTaps);
+        starts[i] = start;
+        int16_t *window = &windowWeights[(size_t)i * windowTaps];
+        for (int k = 0; k < taps; k++) {
+            window[ix[k] - start] = (int16_t)(window[ix[k] - start] + w[k]);
+        }
+    }
+}
+
+// --- FrameScaler ---
+
+FrameScaler::FrameScaler() : _horizontalSIMD(true) {
+    _lumaX.srcSize = _lumaY.srcSize = _chromaX.srcSize = _chromaY.srcSize = 0;
+}
+
+const uint8_t *FrameScaler::filterVertical(const AxisFilter &filter, int outIndex,
+                                           const uint8_t *base, int stride, int rowBytes,
+                                           std::vector<uint8_t> &column, RowScratch &scratch) {
+    const int *ix = &filter.indices[(size_t)outIndex * filter.taps];
+
+    // Vizinho mais próximo: a própria linha da origem, sem cópia
+    if (filter.taps == 1) {
+        return base + (size_t)ix[0] * stride;
+    }
+
+    for (int k = 0; k < filter.taps; k++) {
+        scratch.rowPointers[k] = base + (size_t)ix[k] * stride;
+    }
+    verticalFilter(scratch.rowPointers.data(), &filter.weights[(size_t)outIndex * filter.taps],
+                   filter.taps, column.data(), rowBytes);
+    return column.data();
+}
+
+void FrameScaler::filterHorizontal(const AxisFilter &filter, const uint8_t *src, int channels,
+                                   uint8_t *const *outs) const {
+    if (filter.windowTaps > 0 && _horizontalSIMD) {
+        windowFilter(filter.starts.data(), filter.windowWeights.data(), filter.windowTaps, filter.dstSize,
+                     src, channels, outs);
+    } else {
+        horizontalFilter(filter.indices.data(), filter.weights.data(), filter.taps, filter.dstSize, src, channels, outs);
+    }
+}
+
+void FrameScaler::processRows(const Pass &pass, int cyBegin, int cyEnd, RowScratch &scratch) const {
+    const YUVSource &src = *pass.src;
+    const ScaleTarget &dst = *pass.dst;
+    const int outChromaWidth = pass.outChromaWidth;
+
+    // Cada participante dimensiona os próprios buffers; só ele toca neste slot
+    size_t maxTaps = std::max(_lumaY.taps, _chromaY.taps);
+    if (scratch.rowPointers.size() < maxTaps) {
+        scratch.rowPointers.resize(maxTaps);
+    }
+    scratch.lumaColumn.resize(pass.cropWidth);
+    scratch.chromaColumn.resize(pass.cropChromaWidth * 2);
+    scratch.chromaColumnV.resize(pass.cropChromaWidth);
+    scratch.lumaRow.resize(dst.width);
+    scratch.uRow.resize(outChromaWidth);
+    scratch.vRow.resize(outChromaWidth);
+
+    for (int cy = cyBegin; cy < cyEnd; cy++) {
+        if (!pass.vBase) {
+            const uint8_t *uvRow = filterVertical(_chromaY, cy, pass.uBase, src.strideU, pass.cropChromaWidth * 2,
+                                                  scratch.chromaColumn, scratch);
+            uint8_t *outs[2] = { scratch.uRow.data(), scratch.vRow.data() };
+            filterHorizontal(_chromaX, uvRow, 2, outs);
+        } else {
+            const uint8_t *uRow = filterVertical(_chromaY, cy, pass.uBase, src.strideU, pass.cropChromaWidth,
+                                                 scratch.chromaColumn, scratch);
+            uint8_t *outU[1] = { scratch.uRow.data() };
+            filterHorizontal(_chromaX, uRow, 1, outU);
+
+            const uint8_t *vRow = filterVertical(_chromaY, cy, pass.vBase, src.strideV, pass.cropChromaWidth,
+                                                 scratch.chromaColumnV, scratch);
+            uint8_t *outV[1] = { scratch.vRow.data() };
+            filterHorizontal(_chromaX, vRow, 1, outV);
+        }
+
+        if (dst.format == ScaleTarget::NV12) {
+            InterleaveChromaRow(scratch.uRow.data(), scratch.vRow.data(), dst.uv + (size_t)cy * dst.strideUV, outChromaWidth,
+                                src.colorSpace.range, dst.range);
+        }
+
+        int lastRow = std::min(2 * cy + 2, dst.height);
+        for (int ly = 2 * cy; ly < lastRow; ly++) {
+            uint8_t *dstRow = dst.y + (size_t)ly * dst.strideY;
+            const uint8_t *column = filterVertical(_lumaY, ly, pass.yBase, src.strideY, pass.cropWidth,
+                                                   scratch.lumaColumn, scratch);
+
+            uint8_t *outY[1] = { pass.directLuma ? dstRow : scratch.lumaRow.data() };
+            filterHorizontal(_lumaX, column, 1, outY);
+
+            if (dst.format == ScaleTarget::BGRA) {
+                ConvertRowToBGRA(scratch.lumaRow.data(), scratch.uRow.data(), scratch.vRow.data(), dstRow, dst.width, src.colorSpace);
+            } else if (!pass.directLuma) {
+                ConvertLumaRow(scratch.lumaRow.data(), dstRow, dst.width, src.colorSpace.range, dst.range);
+            }
+        }
+    }
+}
+
+bool FrameScaler::process(const YUVSource &src, const CropRect &crop, const ScaleTarget &dst, ScaleQuality quality) {
+    CropRect c = crop;
+    c.x = std::max(c.x, 0) & ~1;
+    c.y = std::max(c.y, 0) & ~1;
+    c.width = std::min(c.width, src.width - c.x);
+    c.height = std::min(c.height, src.height - c.y);
+    if (c.width < 2 || c.height < 2 || dst.width < 2 || dst.height < 2) {
+        return false;
+    }
+
+    int cropChromaWidth = (c.width + 1) / 2;
+    int cropChromaHeight = (c.height + 1) / 2;
+    int outChromaWidth = (dst.width + 1) / 2;
+    int outChromaHeight = (dst.height + 1) / 2;
+
+    // Espelhamentos entram nas próprias tabelas de filtro
+    bool flipY = dst.flipY;
+
+    if (!_lumaX.matches(c.width, dst.width, quality, dst.flipX)) {
+        _lumaX.build(c.width, dst.width, quality, dst.flipX);
+    }
+    if (!_lumaY.matches(c.height, dst.height, quality, flipY)) {
+        _lumaY.build(c.height, dst.height, quality, flipY);
+    }
+    if (!_chromaX.matches(cropChromaWidth, outChromaWidth, quality, dst.flipX)) {
+        _chromaX.build(cropChromaWidth, outChromaWidth, quality, dst.flipX);
+    }
+    if (!_chromaY.matches(cropChromaHeight, outChromaHeight, quality, flipY)) {
+        _chromaY.build(cropChromaHeight, outChromaHeight, quality, flipY);
+    }
+
+    const bool interleaved = src.isInterleaved();
+    Pass pass;
+    pass.src = &src;
+    pass.dst = &dst;
+    pass.cropWidth = c.width;
+    pass.cropChromaWidth = cropChromaWidth;
+    pass.outChromaWidth = outChromaWidth;
+    pass.yBase = src.y + (size_t)c.y * src.strideY + c.x;
+    pass.uBase = src.u + (size_t)(c.y / 2) * src.strideU + (interleaved ? c.x : c.x / 2);
+    pass.vBase = interleaved ? nullptr : src.v + (size_t)(c.y / 2) * src.strideV + c.x / 2;
+
+    // NV12 na mesma faixa: o filtro horizontal escreve direto no destino
+    pass.directLuma = dst.format == ScaleTarget::NV12 && dst.range == src.colorSpace.range;
+
+    // Uma faixa = linhas de crominância inteiras com suas duas linhas de luma
+    size_t bytesPerChromaRow = dst.format == ScaleTarget::BGRA ? (size_t)dst.width * 8 : (size_t)dst.width * 3;
+    RowBands bands = PlanRowBands(outChromaHeight, bytesPerChromaRow, 1);
+    if (_scratch.size() < ParallelSlotCount()) {
+        _scratch.resize(ParallelSlotCount());
+    }
+
+    if (bands.count <= 1) {
+        processRows(pass, 0, outChromaHeight, _scratch[0]);
+        return true;
+    }
+
+    ParallelFor(bands.count, [&](size_t band, size_t slot) {
+        processRows(pass, bands.begin((int)band), bands.end((int)band), _scratch[slot]);
+    });
+    return true;
+}
+
+} // namespace vcam
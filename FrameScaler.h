@@ -0,0 +1,177 @@
+#ifndef FRAMESCALER_H
+#define FRAMESCALER_H
+
+#include <cstdint>
+#include <vector>
+#include "YUVConvert.h"
+#include "YUVToBGRA.h"
+
+namespace vcam {
+
+/**
+ * Níveis de qualidade do redimensionamento, do mais barato ao mais caro.
+ */
+enum class ScaleQuality {
+    Nearest,
+    Bilinear,
+    Box,      // média de área; em ampliação equivale ao bilinear
+    Lanczos3
+};
+
+/**
+ * Origem YUV 4:2:0 genérica: I420 (u/v separados) ou NV12 (v nulo, uv em u).
+ */
+struct YUVSource {
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+    int strideY;
+    int strideU;
+    int strideV;
+    int width;
+    int height;
+    YUVColorSpace colorSpace;
+
+    static YUVSource fromI420(const I420Planes &planes, const YUVColorSpace &colorSpace);
+    static YUVSource fromNV12(const NV12Source &planes, const YUVColorSpace &colorSpace);
+
+    bool isInterleaved() const {
+        return v == nullptr;
+    }
+};
+
+/**
+ * Retângulo de recorte em coordenadas de luma da origem.
+ */
+struct CropRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * Destino do redimensionamento: NV12 (planos y/uv) ou BGRA (plano y).
+ */
+struct ScaleTarget {
+    enum Format {
+        NV12,
+        BGRA
+    };
+
+    Format format;
+    uint8_t *y;       // luma NV12 ou pixels BGRA
+    uint8_t *uv;      // crominância NV12 (não usado em BGRA)
+    int strideY;
+    int strideUV;
+    int width;
+    int height;
+    YUVRange range;   // faixa do NV12 de saída
+    bool flipX;       // espelhamento horizontal, sem custo extra (tabelas invertidas)
+    bool flipY;       // espelhamento vertical; os dois juntos equivalem a 180°
+};
+
+/**
+ * FrameScaler
+ *
+ * Recorta, redimensiona e converte em uma única varredura da origem.
+ * Cada linha de saída é filtrada verticalmente e depois horizontalmente
+ * em buffers de linha reutilizados e escrita direto no formato final,
+ * sem buffers I420 intermediários do tamanho do frame.
+ *
+ * As tabelas de filtro são recalculadas apenas quando a geometria ou a
+ * qualidade mudam. Os dois eixos são SIMD (NEON/SSE2, pesos Q14): o
+ * vertical por colunas, o horizontal por janelas contíguas de taps. Frames grandes (4K, presets "ultra") são divididos em
+ * faixas de linhas processadas em paralelo (ParallelFor), cada participante
+ * com seus próprios buffers de linha. Não é thread-safe: use uma instância
+ * por thread.
+ */
+class FrameScaler {
+public:
+    FrameScaler();
+
+    /**
+     * @param crop Região da origem; coordenadas são arredondadas para pares
+     * @return false se a geometria for inválida
+     */
+    bool process(const YUVSource &src, const CropRect &crop, const ScaleTarget &dst, ScaleQuality quality);
+
+    /**
+     * Desligado, o filtro horizontal usa as tabelas escalares de índices.
+     * Só para testes e benchmarks compararem os dois caminhos; o resultado
+     * é idêntico byte a byte.
+     */
+    void setHorizontalSIMD(bool enabled) {
+        _horizontalSIMD = enabled;
+    }
+
+private:
+    // Filtro separável para um eixo: `taps` índices/pesos Q14 por amostra de saída
+    struct AxisFilter {
+        int srcSize;
+        int dstSize;
+        ScaleQuality quality;
+        bool reversed;
+        int taps;
+        std::vector<int> indices;
+        std::vector<int16_t> weights;
+        // Mesmo filtro em janelas contíguas para o caminho SIMD: `windowTaps`
+        // pesos (múltiplo de 4) a partir de starts[i], com as amostras de borda
+        // já somadas; 0 quando não há ganho (1 tap) ou a origem é menor que a janela
+        int windowTaps;
+        std::vector<int> starts;
+        std::vector<int16_t> windowWeights;
+
+        void build(int srcSize, int dstSize, ScaleQuality quality, bool reversed);
+        void buildWindows();
+        bool matches(int srcSize, int dstSize, ScaleQuality quality, bool reversed) const {
+            return this->srcSize == srcSize && this->dstSize == dstSize &&
+                   this->quality == quality && this->reversed == reversed;
+        }
+    };
+
+    // Buffers de linha de um participante
+    struct RowScratch {
+        std::vector<const uint8_t *> rowPointers;
+        std::vector<uint8_t> lumaColumn;
+        std::vector<uint8_t> chromaColumn;
+        std::vector<uint8_t> chromaColumnV;
+        std::vector<uint8_t> lumaRow;
+        std::vector<uint8_t> uRow;
+        std::vector<uint8_t> vRow;
+    };
+
+    // Geometria resolvida de um process(), compartilhada pelas faixas
+    struct Pass {
+        const YUVSource *src;
+        const ScaleTarget *dst;
+        int cropWidth;
+        int cropChromaWidth;
+        int outChromaWidth;
+        const uint8_t *yBase;
+        const uint8_t *uBase;
+        const uint8_t *vBase;
+        bool directLuma;
+    };
+
+    static const uint8_t *filterVertical(const AxisFilter &filter, int outIndex,
+                                         const uint8_t *base, int stride, int rowBytes,
+                                         std::vector<uint8_t> &column, RowScratch &scratch);
+
+    void filterHorizontal(const AxisFilter &filter, const uint8_t *src, int channels, uint8_t *const *outs) const;
+
+    // Linhas de crominância [cyBegin, cyEnd) e as linhas de luma correspondentes
+    void processRows(const Pass &pass, int cyBegin, int cyEnd, RowScratch &scratch) const;
+
+    AxisFilter _lumaX;
+    AxisFilter _lumaY;
+    AxisFilter _chromaX;
+    AxisFilter _chromaY;
+
+    std::vector<RowScratch> _scratch;
+    bool _horizontalSIMD;
+};
+
+} // namespace vcam
+
+#endif /* FRAMESCALER_H */
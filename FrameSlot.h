@@ -0,0 +1,118 @@
+#ifndef FRAMESLOT_H
+#define FRAMESLOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace vcam {
+
+/**
+ * FrameSlot
+ *
+ * Slot de publicação de frames com buffer triplo, sem locks.
+ * Um único produtor (thread de conversão do renderer) publica handles de frame e
+ * qualquer número de consumidores (fila da câmera, display link) lê o mais
+ * recente sem nunca bloquear o produtor.
+ *
+ * T deve ser copiável e a cópia deve ser thread-safe (ex.: handle com
+ * contagem de referências atômica, como CFRetain/CFRelease).
+ */
+template <typename T>
+class FrameSlot {
+public:
+    FrameSlot() : _published(0), _sequence(0) {
+        for (auto &pins : _pins) {
+            pins.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    FrameSlot(const FrameSlot &) = delete;
+    FrameSlot &operator=(const FrameSlot &) = delete;
+
+    /**
+     * Publica um novo frame. Deve ser chamado apenas pelo produtor.
+     * O handle antigo do slot reutilizado é liberado nesta thread.
+     */
+    void publish(T value) {
+        int published = _published.load(std::memory_order_relaxed);
+        int target = acquireFreeSlot(published);
+        _slots[target].value = std::move(value);
+        _sequence.fetch_add(1, std::memory_order_relaxed);
+        _published.store(target, std::memory_order_seq_cst);
+    }
+
+    /**
+     * Esvazia o slot publicado. Conta como operação de produtor.
+     */
+    void clear() {
+        publish(T());
+    }
+
+    /**
+     * Copia o frame publicado mais recente para `out`.
+     * Nunca bloqueia o produtor; o custo no pior caso é uma cópia do handle.
+     * @return false se nenhum frame foi publicado ainda (ou foi limpo).
+     */
+    bool read(T &out) const {
+        for (;;) {
+            int index = _published.load(std::memory_order_seq_cst);
+            _pins[index].value.fetch_add(1, std::memory_order_seq_cst);
+
+            // Confirma que o slot ainda é o publicado depois de fixá-lo;
+            // caso contrário o produtor pode estar escrevendo nele.
+            if (_published.load(std::memory_order_seq_cst) == index) {
+                out = _slots[index].value;
+                _pins[index].value.fetch_sub(1, std::memory_order_release);
+                return static_cast<bool>(out);
+            }
+            _pins[index].value.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Número de publicações feitas até agora (cresce monotonicamente).
+     */
+    uint64_t sequence() const {
+        return _sequence.load(std::memory_order_acquire);
+    }
+
+    /** Handles retidos pelo slot no pior caso (o publicado e os dois anteriores). */
+    static constexpr int kSlotCount = 3;
+
+private:
+    static constexpr int kCacheLine = 64;
+
+    struct alignas(kCacheLine) Slot {
+        T value;
+    };
+
+    struct alignas(kCacheLine) PinCount {
+        std::atomic<int> value;
+    };
+
+    // Escolhe um slot não publicado e sem leitores. Leitores só mantêm o
+    // pino durante a cópia do handle, então a espera é limitada a isso --
+    // exceto se o leitor for preemptado com o pino; por isso cede a CPU
+    // em vez de girar o quantum inteiro quando há mais threads que núcleos.
+    int acquireFreeSlot(int published) {
+        for (;;) {
+            for (int i = 0; i < kSlotCount; i++) {
+                if (i != published && _pins[i].value.load(std::memory_order_seq_cst) == 0) {
+                    return i;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    Slot _slots[kSlotCount];
+    mutable PinCount _pins[kSlotCount];
+    alignas(kCacheLine) std::atomic<int> _published;
+    std::atomic<uint64_t> _sequence;
+};
+
+} // namespace vcam
+
+#endif /* FRAMESLOT_H */
@@ -0,0 +1,344 @@
+#include "FrameTransform.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VCAM_TRANSFORM_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define VCAM_TRANSFORM_SSE2 1
+#endif
+
+namespace vcam {
+
+namespace {
+
+// Tile em elementos: 32x32 cabe com folga no L1 mesmo para UV (2 bytes)
+const int kTileSize = 32;
+
+/**
+ * Endereço de destino do elemento de origem (sx, sy):
+ * origin + sx * colStep + sy * rowStep.
+ */
+struct PlaneWalk {
+    uint8_t *origin;
+    ptrdiff_t colStep;
+    ptrdiff_t rowStep;
+};
+
+PlaneWalk makeWalk(uint8_t *dst, int dstStride, int srcWidth, int srcHeight, int elementSize, const AxisMapping &mapping) {
+    int outWidth = mapping.transpose ? srcHeight : srcWidth;
+    int outHeight = mapping.transpose ? srcWidth : srcHeight;
+
+    ptrdiff_t xStep = mapping.flipX ? -elementSize : elementSize;
+    ptrdiff_t yStep = mapping.flipY ? -(ptrdiff_t)dstStride : dstStride;
+
+    PlaneWalk walk;
+    walk.origin = dst + (mapping.flipY ? (ptrdiff_t)(outHeight - 1) * dstStride : 0)
+                      + (mapping.flipX ? (ptrdiff_t)(outWidth - 1) * elementSize : 0);
+    walk.colStep = mapping.transpose ? yStep : xStep;
+    walk.rowStep = mapping.transpose ? xStep : yStep;
+    return walk;
+}
+
+template <typename T>
+void transformRegionScalar(const uint8_t *src, int srcStride, const PlaneWalk &walk,
+                           int x0, int y0, int x1, int y1) {
+    for (int sy = y0; sy < y1; sy++) {
+        const uint8_t *s = src + (ptrdiff_t)sy * srcStride + (ptrdiff_t)x0 * sizeof(T);
+        uint8_t *d = walk.origin + (ptrdiff_t)sy * walk.rowStep + (ptrdiff_t)x0 * walk.colStep;
+        for (int sx = x0; sx < x1; sx++) {
+            memcpy(d, s, sizeof(T));
+            s += sizeof(T);
+            d += walk.colStep;
+        }
+    }
+}
+
+// --- Transposição 8x8 ---
+
+#if VCAM_TRANSFORM_NEON
+
+void transpose8x8(const uint8_t *const *rows, uint8_t *const *outs, uint8_t) {
+    uint8x8x2_t a0 = vtrn_u8(vld1_u8(rows[0]), vld1_u8(rows[1]));
+    uint8x8x2_t a1 = vtrn_u8(vld1_u8(rows[2]), vld1_u8(rows[3]));
+    uint8x8x2_t a2 = vtrn_u8(vld1_u8(rows[4]), vld1_u8(rows[5]));
+    uint8x8x2_t a3 = vtrn_u8(vld1_u8(rows[6]), vld1_u8(rows[7]));
+
+    uint16x4x2_t b0 = vtrn_u16(vreinterpret_u16_u8(a0.val[0]), vreinterpret_u16_u8(a1.val[0]));
+    uint16x4x2_t b1 = vtrn_u16(vreinterpret_u16_u8(a0.val[1]), vreinterpret_u16_u8(a1.val[1]));
+    uint16x4x2_t b2 = vtrn_u16(vreinterpret_u16_u8(a2.val[0]), vreinterpret_u16_u8(a3.val[0]));
+    uint16x4x2_t b3 = vtrn_u16(vreinterpret_u16_u8(a2.val[1]), vreinterpret_u16_u8(a3.val[1]));
+
+    uint32x2x2_t c0 = vtrn_u32(vreinterpret_u32_u16(b0.val[0]), vreinterpret_u32_u16(b2.val[0]));
+    uint32x2x2_t c1 = vtrn_u32(vreinterpret_u32_u16(b1.val[0]), vreinterpret_u32_u16(b3.val[0]));
+    uint32x2x2_t c2 = vtrn_u32(vreinterpret_u32_u16(b0.val[1]), vreinterpret_u32_u16(b2.val[1]));
+    uint32x2x2_t c3 = vtrn_u32(vreinterpret_u32_u16(b1.val[1]), vreinterpret_u32_u16(b3.val[1]));
+
+    vst1_u8(outs[0], vreinterpret_u8_u32(c0.val[0]));
+    vst1_u8(outs[1], vreinterpret_u8_u32(c1.val[0]));
+    vst1_u8(outs[2], vreinterpret_u8_u32(c2.val[0]));
+    vst1_u8(outs[3], vreinterpret_u8_u32(c3.val[0]));
+    vst1_u8(outs[4], vreinterpret_u8_u32(c0.val[1]));
+    vst1_u8(outs[5], vreinterpret_u8_u32(c1.val[1]));
+    vst1_u8(outs[6], vreinterpret_u8_u32(c2.val[1]));
+    vst1_u8(outs[7], vreinterpret_u8_u32(c3.val[1]));
+}
+
+void transpose8x8(const uint8_t *const *rows, uint8_t *const *outs, uint16_t) {
+    uint16x8x2_t a0 = vtrnq_u16(vld1q_u16((const uint16_t *)rows[0]), vld1q_u16((const uint16_t *)rows[1]));
+    uint16x8x2_t a1 = vtrnq_u16(vld1q_u16((const uint16_t *)rows[2]), vld1q_u16((const uint16_t *)rows[3]));
+    uint16x8x2_t a2 = vtrnq_u16(vld1q_u16((const uint16_t *)rows[4]), vld1q_u16((const uint16_t *)rows[5]));
+    uint16x8x2_t a3 = vtrnq_u16(vld1q_u16((const uint16_t *)rows[6]), vld1q_u16((const uint16_t *)rows[7]));
+
+    uint32x4x2_t b0 = vtrnq_u32(vreinterpretq_u32_u16(a0.val[0]), vreinterpretq_u32_u16(a1.val[0]));
+    uint32x4x2_t b1 = vtrnq_u32(vreinterpretq_u32_u16(a0.val[1]), vreinterpretq_u32_u16(a1.val[1]));
+    uint32x4x2_t b2 = vtrnq_u32(vreinterpretq_u32_u16(a2.val[0]), vreinterpretq_u32_u16(a3.val[0]));
+    uint32x4x2_t b3 = vtrnq_u32(vreinterpretq_u32_u16(a2.val[1]), vreinterpretq_u32_u16(a3.val[1]));
+
+    // Linhas 0-3 na metade baixa de b0/b1, linhas 4-7 em b2/b3
+    vst1q_u16((uint16_t *)outs[0], vcombine_u16(vreinterpret_u16_u32(vget_low_u32(b0.val[0])), vreinterpret_u16_u32(vget_low_u32(b2.val[0]))));
+    vst1q_u16((uint16_t *)outs[1], vcombine_u16(vreinterpret_u16_u32(vget_low_u32(b1.val[0])), vreinterpret_u16_u32(vget_low_u32(b3.val[0]))));
+    vst1q_u16((uint16_t *)outs[2], vcombine_u16(vreinterpret_u16_u32(vget_low_u32(b0.val[1])), vreinterpret_u16_u32(vget_low_u32(b2.val[1]))));
+    vst1q_u16((uint16_t *)outs[3], vcombine_u16(vreinterpret_u16_u32(vget_low_u32(b1.val[1])), vreinterpret_u16_u32(vget_low_u32(b3.val[1]))));
+    vst1q_u16((uint16_t *)outs[4], vcombine_u16(vreinterpret_u16_u32(vget_high_u32(b0.val[0])), vreinterpret_u16_u32(vget_high_u32(b2.val[0]))));
+    vst1q_u16((uint16_t *)outs[5], vcombine_u16(vreinterpret_u16_u32(vget_high_u32(b1.val[0])), vreinterpret_u16_u32(vget_high_u32(b3.val[0]))));
+    vst1q_u16((uint16_t *)outs[6], vcombine_u16(vreinterpret_u16_u32(vget_high_u32(b0.val[1])), vreinterpret_u16_u32(vget_high_u32(b2.val[1]))));
+    vst1q_u16((uint16_t *)outs[7], vcombine_u16(vreinterpret_u16_u32(vget_high_u32(b1.val[1])), vreinterpret_u16_u32(vget_high_u32(b3.val[1]))));
+}
+
+#elif VCAM_TRANSFORM_SSE2
+
+inline void storeHalves(const __m128i &pair, uint8_t *low, uint8_t *high) {
+    _mm_storel_epi64((__m128i *)low, pair);
+    _mm_storel_epi64((__m128i *)high, _mm_srli_si128(pair, 8));
+}
+
+void transpose8x8(const uint8_t *const *rows, uint8_t *const *outs, uint8_t) {
+    __m128i t0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rows[0]), _mm_loadl_epi64((const __m128i *)rows[1]));
+    __m128i t1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rows[2]), _mm_loadl_epi64((const __m128i *)rows[3]));
+    __m128i t2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rows[4]), _mm_loadl_epi64((const __m128i *)rows[5]));
+    __m128i t3 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)rows[6]), _mm_loadl_epi64((const __m128i *)rows[7]));
+
+    __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+    __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+    __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+    __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+
+    // Cada registrador guarda duas colunas completas
+    storeHalves(_mm_unpacklo_epi32(u0, u2), outs[0], outs[1]);
+    storeHalves(_mm_unpackhi_epi32(u0, u2), outs[2], outs[3]);
+    storeHalves(_mm_unpacklo_epi32(u1, u3), outs[4], outs[5]);
+    storeHalves(_mm_unpackhi_epi32(u1, u3), outs[6], outs[7]);
+}
+
+void transpose8x8(const uint8_t *const *rows, uint8_t *const *outs, uint16_t) {
+    __m128i r[8];
+    for (int k = 0; k < 8; k++) {
+        r[k] = _mm_loadu_si128((const __m128i *)rows[k]);
+    }
+
+    __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i t1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i t2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i t3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i t4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i t5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i t6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i t7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+    __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+    __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+    __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+    __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+    __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+    __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+    __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+    __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+    _mm_storeu_si128((__m128i *)outs[0], _mm_unpacklo_epi64(u0, u4));
+    _mm_storeu_si128((__m128i *)outs[1], _mm_unpackhi_epi64(u0, u4));
+    _mm_storeu_si128((__m128i *)outs[2], _mm_unpacklo_epi64(u1, u5));
+    _mm_storeu_si128((__m128i *)outs[3], _mm_unpackhi_epi64(u1, u5));
+    _mm_storeu_si128((__m128i *)outs[4], _mm_unpacklo_epi64(u2, u6));
+    _mm_storeu_si128((__m128i *)outs[5], _mm_unpackhi_epi64(u2, u6));
+    _mm_storeu_si128((__m128i *)outs[6], _mm_unpacklo_epi64(u3, u7));
+    _mm_storeu_si128((__m128i *)outs[7], _mm_unpackhi_epi64(u3, u7));
+}
+
+#else
+
+template <typename T>
+void transpose8x8(const uint8_t *const *rows, uint8_t *const *outs, T) {
+    for (int c = 0; c < 8; c++) {
+        for (int k = 0; k < 8; k++) {
+            memcpy(outs[c] + k * sizeof(T), rows[k] + c * sizeof(T), sizeof(T));
+        }
+    }
+}
+
+#endif
+
+// Bloco 8x8 com origem em (sx0, sy0); cada coluna da origem vira uma linha contígua do destino
+template <typename T>
+void transposeBlock(const uint8_t *src, int srcStride, const PlaneWalk &walk, int sx0, int sy0) {
+    const uint8_t *rows[8];
+    uint8_t *outs[8];
+
+    // Com passo negativo as linhas entram invertidas e a escrita começa no fim do trecho
+    bool reversed = walk.rowStep < 0;
+    const uint8_t *block = src + (ptrdiff_t)sy0 * srcStride + (ptrdiff_t)sx0 * sizeof(T);
+    for (int k = 0; k < 8; k++) {
+        rows[k] = block + (ptrdiff_t)(reversed ? 7 - k : k) * srcStride;
+    }
+
+    uint8_t *start = walk.origin + (ptrdiff_t)sy0 * walk.rowStep + (reversed ? 7 * walk.rowStep : 0);
+    for (int c = 0; c < 8; c++) {
+        outs[c] = start + (ptrdiff_t)(sx0 + c) * walk.colStep;
+    }
+
+    transpose8x8(rows, outs, T());
+}
+
+// Linhas de origem [y0, y1); y0 deve ser múltiplo de kTileSize
+template <typename T>
+void transformRows(const uint8_t *src, int srcStride, int width, const PlaneWalk &walk,
+                   bool transpose, int y0, int y1) {
+    if (!transpose) {
+        // Sem transposição: linhas inteiras, memcpy quando não há espelho horizontal
+        if (walk.colStep == (ptrdiff_t)sizeof(T)) {
+            for (int sy = y0; sy < y1; sy++) {
+                memcpy(walk.origin + (ptrdiff_t)sy * walk.rowStep, src + (ptrdiff_t)sy * srcStride, (size_t)width * sizeof(T));
+            }
+        } else {
+            transformRegionScalar<T>(src, srcStride, walk, 0, y0, width, y1);
+        }
+        return;
+    }
+
+    for (int ty = y0; ty < y1; ty += kTileSize) {
+        int tileHeight = std::min(kTileSize, y1 - ty);
+        int blockHeight = tileHeight & ~7;
+
+        for (int tx = 0; tx < width; tx += kTileSize) {
+            int tileWidth = std::min(kTileSize, width - tx);
+            int blockWidth = tileWidth & ~7;
+
+            for (int by = 0; by < blockHeight; by += 8) {
+                for (int bx = 0; bx < blockWidth; bx += 8) {
+                    transposeBlock<T>(src, srcStride, walk, tx + bx, ty + by);
+                }
+            }
+
+            // Sobras do tile que não formam bloco 8x8
+            transformRegionScalar<T>(src, srcStride, walk, tx + blockWidth, ty, tx + tileWidth, ty + tileHeight);
+            transformRegionScalar<T>(src, srcStride, walk, tx, ty + blockHeight, tx + blockWidth, ty + tileHeight);
+        }
+    }
+}
+
+/**
+ * Faixas de um plano. Na transposição cada linha da origem vira uma coluna
+ * do destino, então a faixa cobre tiles inteiros e ao menos uma linha de
+ * cache de largura no destino.
+ */
+template <typename T>
+RowBands planBands(int width, int height, bool transpose) {
+    int multiple = 1;
+    if (transpose) {
+        multiple = std::max<int>(kTileSize, (int)(kCacheLineBytes / sizeof(T)));
+    }
+    return PlanRowBands(height, (size_t)width * sizeof(T), multiple);
+}
+
+} // namespace
+
+// --- FrameTransform ---
+
+FrameTransform FrameTransform::compose(int streamRotation, int outputRotation, bool mirrored) {
+    int rotation = ((streamRotation + outputRotation) % 360 + 360) % 360;
+
+    FrameTransform transform;
+    transform.rotation = (rotation / 90) * 90;
+    transform.mirrored = mirrored;
+    return transform;
+}
+
+AxisMapping FrameTransform::axisMapping() const {
+    AxisMapping mapping = { false, false, false };
+    switch (rotation) {
+        case 90:
+            mapping.transpose = true;
+            mapping.flipX = true;
+            break;
+        case 180:
+            mapping.flipX = true;
+            mapping.flipY = true;
+            break;
+        case 270:
+            mapping.transpose = true;
+            mapping.flipY = true;
+            break;
+        default:
+            break;
+    }
+
+    // Espelho é aplicado depois da rotação, no eixo horizontal da saída
+    if (mirrored) {
+        mapping.flipX = !mapping.flipX;
+    }
+    return mapping;
+}
+
+void TransformNV12(const NV12Source &src, const NV12Planes &dst, const FrameTransform &transform) {
+    AxisMapping mapping = transform.axisMapping();
+
+    int chromaWidth = (src.width + 1) / 2;
+    int chromaHeight = (src.height + 1) / 2;
+    PlaneWalk lumaWalk = makeWalk(dst.y, dst.strideY, src.width, src.height, 1, mapping);
+    PlaneWalk chromaWalk = makeWalk(dst.uv, dst.strideUV, chromaWidth, chromaHeight, 2, mapping);
+
+    // Faixas dos dois planos em um só laço paralelo: luma primeiro, depois UV
+    RowBands lumaBands = planBands<uint8_t>(src.width, src.height, mapping.transpose);
+    RowBands chromaBands = planBands<uint16_t>(chromaWidth, chromaHeight, mapping.transpose);
+
+    // UV tem metade dos bytes da luma: se a luma cabe em uma faixa, o frame inteiro roda inline
+    if (lumaBands.count <= 1) {
+        transformRows<uint8_t>(src.y, src.strideY, src.width, lumaWalk, mapping.transpose, 0, src.height);
+        transformRows<uint16_t>(src.uv, src.strideUV, chromaWidth, chromaWalk, mapping.transpose, 0, chromaHeight);
+        return;
+    }
+
+    ParallelFor(lumaBands.count + chromaBands.count, [&](size_t index, size_t) {
+        int band = (int)index;
+        if (band < lumaBands.count) {
+            transformRows<uint8_t>(src.y, src.strideY, src.width, lumaWalk, mapping.transpose,
+                                   lumaBands.begin(band), lumaBands.end(band));
+        } else {
+            band -= lumaBands.count;
+            transformRows<uint16_t>(src.uv, src.strideUV, chromaWidth, chromaWalk, mapping.transpose,
+                                    chromaBands.begin(band), chromaBands.end(band));
+        }
+    });
+}
+
+namespace reference {
+
+void TransformNV12(const NV12Source &src, const NV12Planes &dst, const FrameTransform &transform) {
+    AxisMapping mapping = transform.axisMapping();
+
+    PlaneWalk lumaWalk = makeWalk(dst.y, dst.strideY, src.width, src.height, 1, mapping);
+    transformRegionScalar<uint8_t>(src.y, src.strideY, lumaWalk, 0, 0, src.width, src.height);
+
+    int chromaWidth = (src.width + 1) / 2;
+    int chromaHeight = (src.height + 1) / 2;
+    PlaneWalk chromaWalk = makeWalk(dst.uv, dst.strideUV, chromaWidth, chromaHeight, 2, mapping);
+    transformRegionScalar<uint16_t>(src.uv, src.strideUV, chromaWalk, 0, 0, chromaWidth, chromaHeight);
+}
+
+} // namespace reference
+
+} // namespace vcam
@@ -0,0 +1,61 @@
+#ifndef FRAMETRANSFORM_H
+#define FRAMETRANSFORM_H
+
+#include "YUVConvert.h"
+
+namespace vcam {
+
+/**
+ * Decomposição de uma orientação em transposição seguida de espelhamentos,
+ * no espaço da saída: out(x, y) = T(in)(flipX ? w-1-x : x, flipY ? h-1-y : y).
+ */
+struct AxisMapping {
+    bool transpose;
+    bool flipX;
+    bool flipY;
+};
+
+/**
+ * Rotação (graus, sentido horário) seguida de espelhamento horizontal opcional.
+ * Une a rotação do stream, a orientação da conexão e o espelhamento em uma só transformação.
+ */
+struct FrameTransform {
+    int rotation;   // 0, 90, 180 ou 270
+    bool mirrored;
+
+    /**
+     * @param streamRotation Rotação do RTCVideoFrame (RTCVideoRotation)
+     * @param outputRotation Rotação extra pedida pelo consumidor
+     */
+    static FrameTransform compose(int streamRotation, int outputRotation, bool mirrored);
+
+    bool isIdentity() const {
+        return rotation == 0 && !mirrored;
+    }
+
+    // 90/270 trocam largura e altura
+    bool swapsAxes() const {
+        return rotation == 90 || rotation == 270;
+    }
+
+    AxisMapping axisMapping() const;
+};
+
+/**
+ * Aplica a transformação a um NV12 em uma passada por plano.
+ * Rotações de 90/270 usam transposição em blocos (8x8 em NEON/SSE2)
+ * dentro de tiles que cabem no cache; frames grandes são divididos em
+ * faixas de tiles processadas em paralelo.
+ * O destino deve ter as dimensões já rotacionadas.
+ */
+void TransformNV12(const NV12Source &src, const NV12Planes &dst, const FrameTransform &transform);
+
+namespace reference {
+
+void TransformNV12(const NV12Source &src, const NV12Planes &dst, const FrameTransform &transform);
+
+} // namespace reference
+
+} // namespace vcam
+
+#endif /* FRAMETRANSFORM_H */
@@ -0,0 +1,145 @@
+#ifndef HOTPATHSTATE_H
+#define HOTPATHSTATE_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace vcam {
+
+/**
+ * Cópia consistente do estado lido pelo hook de captureOutput.
+ */
+struct HotPathSnapshot {
+    bool active;        // substituição ligada pelo menu
+    bool receiving;     // WebRTCManager recebendo stream
+    bool mirrored;      // espelhamento já repassado ao WebRTCManager
+    bool outputSynced;  // orientação e espelho repassados desde a última ativação
+    int orientation;    // AVCaptureVideoOrientation da conexão (0 = desconhecida)
+    uint64_t frameId;   // último frame publicado (0 = nenhum)
+};
+
+/**
+ * HotPathState
+ *
+ * Estado do caminho quente do hook empacotado em uma única palavra atômica,
+ * em linha de cache própria: o hook lê tudo com um load, sem mensagens
+ * Objective-C e sem ler propriedades nonatomic escritas por outras filas.
+ *
+ * Layout: bit 0 ativo, 1 recebendo, 2 espelhado, 3 saída sincronizada,
+ * bits 4-6 orientação, bits 8-63 id do frame. Escritores (menu, WebRTCManager,
+ * o próprio hook) trocam só os seus campos via compare-and-swap.
+ */
+class HotPathState {
+public:
+    static HotPathState &shared() {
+        static HotPathState state;
+        return state;
+    }
+
+    HotPathSnapshot load() const {
+        uint64_t word = _word.load(std::memory_order_acquire);
+        HotPathSnapshot snapshot;
+        snapshot.active = (word & kActive) != 0;
+        snapshot.receiving = (word & kReceiving) != 0;
+        snapshot.mirrored = (word & kMirrored) != 0;
+        snapshot.outputSynced = (word & kOutputSynced) != 0;
+        snapshot.orientation = (int)((word & kOrientationMask) >> kOrientationShift);
+        snapshot.frameId = word >> kFrameShift;
+        return snapshot;
+    }
+
+    /** Ligar exige novo repasse de orientação e espelho no próximo frame. */
+    void setActive(bool active) {
+        update(kActive | kOutputSynced, active ? kActive : 0);
+    }
+
+    /** Parar de receber também esquece o último frame. */
+    void setReceiving(bool receiving) {
+        update(kReceiving | kFrameMask, receiving ? kReceiving : 0);
+    }
+
+    void publishFrame(uint64_t frameId) {
+        update(kFrameMask, frameId << kFrameShift);
+    }
+
+    /** Estado já repassado ao WebRTCManager pelo hook. */
+    void setOutput(int orientation, bool mirrored) {
+        update(kOrientationMask | kMirrored | kOutputSynced,
+               (((uint64_t)orientation << kOrientationShift) & kOrientationMask) |
+               (mirrored ? kMirrored : 0) | kOutputSynced);
+    }
+
+    /** Câmera trocada: força novo repasse no próximo frame. */
+    void invalidateOutput() {
+        update(kOutputSynced, 0);
+    }
+
+private:
+    static constexpr uint64_t kActive = 1ULL << 0;
+    static constexpr uint64_t kReceiving = 1ULL << 1;
+    static constexpr uint64_t kMirrored = 1ULL << 2;
+    static constexpr uint64_t kOutputSynced = 1ULL << 3;
+    static constexpr int kOrientationShift = 4;
+    static constexpr uint64_t kOrientationMask = 7ULL << kOrientationShift;
+    static constexpr int kFrameShift = 8;
+    static constexpr uint64_t kFrameMask = ~0ULL << kFrameShift;
+
+    HotPathState() : _word(0) {
+    }
+
+    void update(uint64_t mask, uint64_t bits) {
+        uint64_t word = _word.load(std::memory_order_relaxed);
+        while (!_word.compare_exchange_weak(word, (word & ~mask) | (bits & mask),
+                                            std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    alignas(128) std::atomic<uint64_t> _word;
+    char _padding[128 - sizeof(std::atomic<uint64_t>)];
+};
+
+/**
+ * Custo que o hook acrescenta a cada frame, sem contar o método original
+ * do app. Escrito só pelas filas de câmera; lido para log.
+ */
+class HookOverhead {
+public:
+    HookOverhead() : _frames(0), _totalNs(0), _maxNs(0) {
+    }
+
+    void record(uint64_t ns) {
+        _frames.fetch_add(1, std::memory_order_relaxed);
+        _totalNs.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = _maxNs.load(std::memory_order_relaxed);
+        while (ns > max && !_maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t frames() const {
+        return _frames.load(std::memory_order_relaxed);
+    }
+
+    uint64_t meanNs() const {
+        uint64_t frames = this->frames();
+        return frames ? _totalNs.load(std::memory_order_relaxed) / frames : 0;
+    }
+
+    uint64_t maxNs() const {
+        return _maxNs.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        _frames = 0;
+        _totalNs = 0;
+        _maxNs = 0;
+    }
+
+private:
+    std::atomic<uint64_t> _frames;
+    std::atomic<uint64_t> _totalNs;
+    std::atomic<uint64_t> _maxNs;
+};
+
+} // namespace vcam
+
+#endif /* HOTPATHSTATE_H */
@@ -0,0 +1,61 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace vcam {
+
+LatencyHistogram::LatencyHistogram() : _bins(kMaxMs + 1, 0), _count(0), _maxMs(0) {
+}
+
+void LatencyHistogram::record(double latencyMs) {
+    // Relógios mal sincronizados podem dar valores negativos: contam como 0
+    double clamped = std::max(latencyMs, 0.0);
+    int bin = std::min((int)std::floor(clamped), kMaxMs);
+    _bins[bin]++;
+    _count++;
+    _maxMs = std::max(_maxMs, clamped);
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+    if (_count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)std::ceil(std::min(std::max(fraction, 0.0), 1.0) * _count);
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int bin = 0; bin <= kMaxMs; bin++) {
+        seen += _bins[bin];
+        if (seen >= rank) {
+            return bin == kMaxMs ? _maxMs : (double)(bin + 1);
+        }
+    }
+    return _maxMs;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    summary.count = _count;
+    summary.p50Ms = percentile(0.50);
+    summary.p95Ms = percentile(0.95);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = _maxMs;
+    return summary;
+}
+
+std::vector<uint32_t> LatencyHistogram::buckets(int bucketMs) const {
+    bucketMs = std::max(bucketMs, 1);
+    std::vector<uint32_t> result((kMaxMs + bucketMs) / bucketMs, 0);
+    for (int bin = 0; bin <= kMaxMs; bin++) {
+        result[std::min(bin / bucketMs, (int)result.size() - 1)] += _bins[bin];
+    }
+    return result;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(_bins.begin(), _bins.end(), 0);
+    _count = 0;
+    _maxMs = 0;
+}
+
+} // namespace vcam
@@ -0,0 +1,60 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+/**
+ * Resumo de uma janela de medições.
+ */
+struct LatencySummary {
+    uint64_t count;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+};
+
+/**
+ * LatencyHistogram
+ *
+ * Histograma de latência com caixas de 1 ms até kMaxMs; valores acima
+ * caem na última caixa. Percentis são o limite superior da caixa, então
+ * o erro é de no máximo 1 ms. Não é thread-safe.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kMaxMs = 1000;
+
+    LatencyHistogram();
+
+    void record(double latencyMs);
+
+    /** Percentil em ms (0 sem medições). @param fraction Entre 0 e 1 */
+    double percentile(double fraction) const;
+
+    LatencySummary summary() const;
+
+    /**
+     * Contagens agregadas em caixas de `bucketMs` ms, para envio no canal de estatísticas.
+     */
+    std::vector<uint32_t> buckets(int bucketMs) const;
+
+    uint64_t count() const {
+        return _count;
+    }
+
+    void reset();
+
+private:
+    std::vector<uint32_t> _bins;
+    uint64_t _count;
+    double _maxMs;
+};
+
+} // namespace vcam
+
+#endif /* LATENCYHISTOGRAM_H */
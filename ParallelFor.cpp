@@ -0,0 +1,186 @@
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#define VCAM_PARALLEL_DISPATCH 1
+#else
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace vcam {
+
+namespace {
+
+// Faixa que cabe no L2 junto com as linhas de origem correspondentes
+const size_t kBandBytes = 256 * 1024;
+
+// Abaixo disso (~720p NV12) uma faixa só
+const size_t kMinParallelBytes = 2 * 1024 * 1024;
+
+std::atomic<size_t> g_parallelism(0);
+
+size_t coreCount() {
+    static const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return cores;
+}
+
+struct Job {
+    const ParallelBody *body;
+    size_t count;
+    std::atomic<size_t> next;
+};
+
+void drain(Job &job, size_t slot) {
+    for (size_t index = job.next.fetch_add(1, std::memory_order_relaxed); index < job.count;
+         index = job.next.fetch_add(1, std::memory_order_relaxed)) {
+        (*job.body)(index, slot);
+    }
+}
+
+// --- Pool portátil ---
+
+#if !VCAM_PARALLEL_DISPATCH
+
+/**
+ * Threads auxiliares criadas uma vez e nunca destruídas (evita a ordem de
+ * destruição de estáticos). A chamadora participa como slot 0; um único
+ * job por vez, chamadas concorrentes rodam inline.
+ */
+class WorkerPool {
+public:
+    static WorkerPool &shared() {
+        static WorkerPool *pool = new WorkerPool(coreCount() - 1);
+        return *pool;
+    }
+
+    void run(Job &job, size_t helpers) {
+        std::unique_lock<std::mutex> runLock(_runMutex, std::try_to_lock);
+        if (!runLock || helpers == 0) {
+            drain(job, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            _helpers = std::min(helpers, _threads.size());
+            _pending = _helpers;
+            _generation++;
+        }
+        _wake.notify_all();
+
+        drain(job, 0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _pending == 0; });
+        _job = nullptr;
+    }
+
+private:
+    explicit WorkerPool(size_t threads) : _job(nullptr), _helpers(0), _pending(0), _generation(0) {
+        for (size_t i = 0; i < threads; i++) {
+            _threads.emplace_back([this, i] { loop(i + 1); });
+            _threads.back().detach();
+        }
+    }
+
+    void loop(size_t slot) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;) {
+            _wake.wait(lock, [&] { return _generation != seen; });
+            seen = _generation;
+            if (slot > _helpers) {
+                continue;
+            }
+
+            Job *job = _job;
+            lock.unlock();
+            drain(*job, slot);
+            lock.lock();
+
+            if (--_pending == 0) {
+                _done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _runMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    Job *_job;
+    size_t _helpers;
+    size_t _pending;
+    uint64_t _generation;
+};
+
+#endif
+
+size_t participantLimit() {
+    size_t limit = g_parallelism.load(std::memory_order_relaxed);
+    return limit == 0 ? coreCount() : std::min(limit, coreCount());
+}
+
+} // namespace
+
+size_t ParallelSlotCount() {
+    return coreCount();
+}
+
+void SetParallelism(size_t maxParticipants) {
+    g_parallelism.store(maxParticipants, std::memory_order_relaxed);
+}
+
+void ParallelFor(size_t count, const ParallelBody &body) {
+    size_t participants = std::min(count, participantLimit());
+    if (participants <= 1) {
+        for (size_t index = 0; index < count; index++) {
+            body(index, 0);
+        }
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.count = count;
+    job.next.store(0, std::memory_order_relaxed);
+
+#if VCAM_PARALLEL_DISPATCH
+    // Cada iteração do dispatch_apply é um participante; o índice dela vira o slot
+    dispatch_apply_f(participants, DISPATCH_APPLY_AUTO, &job, [](void *context, size_t slot) {
+        drain(*static_cast<Job *>(context), slot);
+    });
+#else
+    WorkerPool::shared().run(job, participants - 1);
+#endif
+}
+
+RowBands PlanRowBands(int rows, size_t bytesPerRow, int rowMultiple) {
+    RowBands bands;
+    bands.rows = std::max(rows, 0);
+    bands.rowsPerBand = std::max(bands.rows, 1);
+    bands.count = bands.rows > 0 ? 1 : 0;
+
+    size_t total = (size_t)bands.rows * bytesPerRow;
+    if (total < kMinParallelBytes || bytesPerRow == 0 || participantLimit() <= 1) {
+        return bands;
+    }
+
+    int multiple = std::max(rowMultiple, 1);
+    int rowsPerBand = (int)std::max<size_t>(kBandBytes / bytesPerRow, 1);
+    rowsPerBand = (rowsPerBand + multiple - 1) / multiple * multiple;
+
+    bands.rowsPerBand = std::min(rowsPerBand, bands.rows);
+    bands.count = (bands.rows + bands.rowsPerBand - 1) / bands.rowsPerBand;
+    return bands;
+}
+
+} // namespace vcam
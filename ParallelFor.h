@@ -0,0 +1,75 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <cstddef>
+#include <functional>
+
+namespace vcam {
+
+/**
+ * Linha de cache considerada na divisão em faixas: 128 bytes cobre os
+ * núcleos Apple (64 bytes em x86 e na maioria dos ARM).
+ */
+constexpr size_t kCacheLineBytes = 128;
+
+/**
+ * Corpo de um laço paralelo.
+ * @param index Item em [0, count)
+ * @param slot Participante que executa o item, em [0, ParallelSlotCount());
+ *             dois itens com o mesmo slot nunca rodam ao mesmo tempo, então
+ *             o slot pode indexar buffers de rascunho
+ */
+typedef std::function<void(size_t index, size_t slot)> ParallelBody;
+
+/**
+ * Executa body(i, slot) para i em [0, count) e retorna quando todos terminam.
+ *
+ * Os participantes (a thread chamadora e até ParallelSlotCount() - 1
+ * auxiliares) pegam o próximo item de um contador atômico, de modo que quem
+ * termina antes rouba o resto do trabalho. No iOS os auxiliares vêm do
+ * dispatch_apply com a QoS da chamadora; fora da Apple, de um pool de
+ * threads persistente. count <= 1 roda inline, sem sincronização.
+ */
+void ParallelFor(size_t count, const ParallelBody &body);
+
+/**
+ * Limite superior dos slots (número de núcleos), independente de SetParallelism.
+ */
+size_t ParallelSlotCount();
+
+/**
+ * Limita os participantes de ParallelFor; 0 usa todos os núcleos.
+ */
+void SetParallelism(size_t maxParticipants);
+
+/**
+ * Divisão de um plano em faixas de linhas inteiras: nenhuma linha é
+ * partida, então duas faixas nunca escrevem na mesma linha de cache.
+ */
+struct RowBands {
+    int rows;
+    int rowsPerBand;
+    int count;
+
+    int begin(int band) const {
+        return band * rowsPerBand;
+    }
+
+    int end(int band) const {
+        int last = (band + 1) * rowsPerBand;
+        return last < rows ? last : rows;
+    }
+};
+
+/**
+ * Divide `rows` linhas em faixas de ~256 KB, cada uma múltipla de rowMultiple.
+ * Frames abaixo de ~2 MB de saída ficam em uma faixa só: o custo de
+ * sincronizar supera o ganho.
+ * @param bytesPerRow Bytes escritos por linha (todos os planos)
+ * @param rowMultiple Granularidade da faixa (ex.: 2 para manter pares de luma)
+ */
+RowBands PlanRowBands(int rows, size_t bytesPerRow, int rowMultiple);
+
+} // namespace vcam
+
+#endif /* PARALLELFOR_H */
@@ -0,0 +1,139 @@
+#include "PixelBufferPool.h"
+
+#include <algorithm>
+
+namespace vcam {
+
+// Maior preset de IOS_OPTIMIZED_CONFIG.videoPresets ("ultra")
+static const int kMaxLongSide = 4032;
+static const int kMaxShortSide = 3024;
+
+// Intervalo mínimo entre varreduras automáticas de buckets ociosos
+static const std::chrono::seconds kTrimInterval(1);
+
+bool PoolKey::isSupported() const {
+    if (pixelFormat != kPoolFormat420f && pixelFormat != kPoolFormat420v && pixelFormat != kPoolFormatBGRA) {
+        return false;
+    }
+    if (width <= 0 || height <= 0 || strideAlignment <= 0 || (strideAlignment & (strideAlignment - 1)) != 0) {
+        return false;
+    }
+
+    int longSide = width > height ? width : height;
+    int shortSide = width > height ? height : width;
+    return longSide <= kMaxLongSide && shortSide <= kMaxShortSide;
+}
+
+PixelBufferPool::PixelBufferPool(std::unique_ptr<PoolBackend> backend,
+                                 size_t highWaterMark,
+                                 Clock::duration idleTimeout)
+    : _backend(std::move(backend)),
+      _highWaterMark(highWaterMark),
+      _idleTimeout(idleTimeout),
+      _lastTrim(Clock::now()),
+      _stats() {
+}
+
+PixelBufferPool::~PixelBufferPool() {
+    purge();
+}
+
+void *PixelBufferPool::acquire(const PoolKey &key) {
+    if (!key.isSupported()) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Clock::time_point now = Clock::now();
+
+    auto it = _buckets.find(key);
+    if (it == _buckets.end()) {
+        void *storage = _backend->createBucket(key, _highWaterMark);
+        if (!storage) {
+            return nullptr;
+        }
+        Bucket bucket;
+        bucket.storage = storage;
+        bucket.recentBuffers.reserve(_highWaterMark * 2);
+        it = _buckets.emplace(key, std::move(bucket)).first;
+    }
+
+    Bucket &bucket = it->second;
+    bucket.lastUse = now;
+
+    void *buffer = _backend->acquire(bucket.storage);
+    if (!buffer) {
+        _stats.exhausted++;
+    } else if (recordBuffer(bucket, buffer)) {
+        // Buffer fora da janela do bucket: alocação nova
+        _stats.misses++;
+    } else {
+        _stats.hits++;
+    }
+
+    if (now - _lastTrim >= kTrimInterval) {
+        trimLocked(now);
+    }
+    return buffer;
+}
+
+// LRU linear: a janela tem no máximo 2 * highWaterMark entradas e não aloca.
+// O backend nunca tem mais que highWaterMark buffers vivos por bucket, então
+// um buffer reciclado sempre está na janela; só sai dela depois de outras
+// 2 * highWaterMark identidades, o que só acontece se o backend trocou os
+// buffers (e aí a próxima entrega é de fato uma alocação nova).
+bool PixelBufferPool::recordBuffer(Bucket &bucket, void *buffer) {
+    std::vector<void *> &recent = bucket.recentBuffers;
+    auto it = std::find(recent.begin(), recent.end(), buffer);
+    if (it != recent.end()) {
+        std::rotate(recent.begin(), it, it + 1);
+        return false;
+    }
+
+    if (!recent.empty() && recent.size() >= _highWaterMark * 2) {
+        recent.pop_back();
+    }
+    recent.insert(recent.begin(), buffer);
+    return true;
+}
+
+void PixelBufferPool::trim() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    trimLocked(Clock::now());
+}
+
+void PixelBufferPool::trimLocked(Clock::time_point now) {
+    _lastTrim = now;
+
+    for (auto it = _buckets.begin(); it != _buckets.end();) {
+        Bucket &bucket = it->second;
+        if (now - bucket.lastUse >= _idleTimeout) {
+            _backend->destroyBucket(bucket.storage);
+            _stats.trimmedBuckets++;
+            it = _buckets.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void PixelBufferPool::purge() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &entry : _buckets) {
+        _backend->destroyBucket(entry.second.storage);
+    }
+    _buckets.clear();
+}
+
+PoolStats PixelBufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    PoolStats stats = _stats;
+    stats.activeBuckets = _buckets.size();
+    stats.distinctBuffers = 0;
+    for (const auto &entry : _buckets) {
+        stats.distinctBuffers += entry.second.recentBuffers.size();
+    }
+    return stats;
+}
+
+} // namespace vcam
@@ -0,0 +1,149 @@
+#ifndef PIXELBUFFERPOOL_H
+#define PIXELBUFFERPOOL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vcam {
+
+// Códigos FourCC dos formatos anunciados em preferredPixelFormats
+enum : uint32_t {
+    kPoolFormat420f = 0x34323066, // '420f' (NV12 faixa completa)
+    kPoolFormat420v = 0x34323076, // '420v' (NV12 faixa de vídeo)
+    kPoolFormatBGRA = 0x42475241  // 'BGRA'
+};
+
+/**
+ * Chave de um bucket do pool: formato, geometria e alinhamento de stride.
+ */
+struct PoolKey {
+    uint32_t pixelFormat;
+    int width;
+    int height;
+    int strideAlignment;
+
+    bool operator==(const PoolKey &other) const {
+        return pixelFormat == other.pixelFormat && width == other.width &&
+               height == other.height && strideAlignment == other.strideAlignment;
+    }
+
+    /**
+     * Formatos 420f/420v/BGRA e dimensões até o preset "ultra" (4032x3024),
+     * em qualquer orientação.
+     */
+    bool isSupported() const;
+};
+
+struct PoolKeyHash {
+    size_t operator()(const PoolKey &key) const {
+        size_t hash = key.pixelFormat;
+        hash = hash * 31 + (size_t)key.width;
+        hash = hash * 31 + (size_t)key.height;
+        hash = hash * 31 + (size_t)key.strideAlignment;
+        return hash;
+    }
+};
+
+/**
+ * Estatísticas agregadas de todos os buckets.
+ */
+struct PoolStats {
+    uint64_t hits;          // buffers reaproveitados
+    uint64_t misses;        // buffers novos alocados
+    uint64_t exhausted;     // pedidos recusados por atingir o limite
+    uint64_t trimmedBuckets;
+    size_t activeBuckets;
+    size_t distinctBuffers; // buffers distintos na janela de identidades dos buckets ativos
+};
+
+/**
+ * Backend de alocação. No dispositivo é um CVPixelBufferPool por bucket
+ * (ver CVPixelBufferPoolBackend.h); o núcleo só faz a contabilidade.
+ */
+class PoolBackend {
+public:
+    virtual ~PoolBackend() {}
+
+    /** Cria o armazenamento do bucket com no máximo `maxBuffers` buffers vivos. */
+    virtual void *createBucket(const PoolKey &key, size_t maxBuffers) = 0;
+
+    /** Retorna um buffer retido, ou nullptr se o limite do bucket foi atingido. */
+    virtual void *acquire(void *bucket) = 0;
+
+    /** Libera o bucket e todos os buffers ociosos dele. */
+    virtual void destroyBucket(void *bucket) = 0;
+};
+
+/**
+ * PixelBufferPool
+ *
+ * Pool reciclável de pixel buffers indexado por PoolKey. Em regime
+ * permanente cada frame convertido reutiliza um buffer existente, sem
+ * alocação no heap. Buckets sem uso por mais de `idleTimeout` são
+ * descartados automaticamente.
+ */
+class PixelBufferPool {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    PixelBufferPool(std::unique_ptr<PoolBackend> backend,
+                    size_t highWaterMark = 6,
+                    Clock::duration idleTimeout = std::chrono::seconds(5));
+    ~PixelBufferPool();
+
+    PixelBufferPool(const PixelBufferPool &) = delete;
+    PixelBufferPool &operator=(const PixelBufferPool &) = delete;
+
+    /**
+     * Obtém um buffer retido para a chave. Retorna nullptr se a chave não
+     * é suportada ou se o bucket já tem `highWaterMark` buffers em uso.
+     */
+    void *acquire(const PoolKey &key);
+
+    /**
+     * Descarta buckets sem uso há mais de `idleTimeout`.
+     * Chamado automaticamente por acquire() no máximo uma vez por segundo.
+     */
+    void trim();
+
+    /** Descarta todos os buckets. */
+    void purge();
+
+    PoolStats stats() const;
+
+    size_t highWaterMark() const {
+        return _highWaterMark;
+    }
+
+private:
+    struct Bucket {
+        void *storage;
+        Clock::time_point lastUse;
+        // Identidades dos buffers entregues, do mais recente ao mais antigo
+        // (no máximo 2 * highWaterMark); reservado na criação do bucket
+        std::vector<void *> recentBuffers;
+    };
+
+    /** Registra o buffer na janela do bucket; true se é uma identidade nova (miss). */
+    bool recordBuffer(Bucket &bucket, void *buffer);
+
+    void trimLocked(Clock::time_point now);
+
+    std::unique_ptr<PoolBackend> _backend;
+    const size_t _highWaterMark;
+    const Clock::duration _idleTimeout;
+
+    mutable std::mutex _mutex;
+    std::unordered_map<PoolKey, Bucket, PoolKeyHash> _buckets;
+    Clock::time_point _lastTrim;
+    PoolStats _stats;
+};
+
+} // namespace vcam
+
+#endif /* PIXELBUFFERPOOL_H */
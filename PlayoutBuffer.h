@@ -0,0 +1,180 @@
+#ifndef PLAYOUTBUFFER_H
+#define PLAYOUTBUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <utility>
+
+namespace vcam {
+
+/**
+ * PlayoutBuffer
+ *
+ * Fila pequena, ordenada por PTS, entre o decoder e o FrameSlot. Cada frame
+ * é liberado em PTS + atraso; com PTS no relógio do host (ClockBridge) isso
+ * troca alguns ms de latência por uma cadência sem o jitter do Wi-Fi.
+ *
+ * O atraso é fixo (targetDelayNs) ou adaptativo: um múltiplo do jitter de
+ * chegada medido (estimador do RFC 3550), limitado ao alvo. Atraso zero é
+ * tratado pelo chamador publicando direto, sem passar pela fila.
+ *
+ * Não é thread-safe.
+ */
+template <typename T>
+class PlayoutBuffer {
+public:
+    static constexpr int64_t kMaxDelayNs = 150000000LL;
+
+    /** Maior taxa do stream prevista para o dimensionamento da fila. */
+    static constexpr int64_t kMaxFrameRate = 60;
+
+    /**
+     * Frames retidos no pior caso: 150 ms a 60 fps são 9 frames esperando, mais
+     * o que está vencendo e folga para rajadas de chegada.
+     */
+    static constexpr size_t kDefaultMaxDepth = (size_t)(kMaxDelayNs * kMaxFrameRate / 1000000000LL) + 3;
+
+    explicit PlayoutBuffer(size_t maxDepth = kDefaultMaxDepth)
+        : _maxDepth(std::max<size_t>(maxDepth, 1)), _targetDelayNs(0), _adaptive(false),
+          _hasArrival(false), _lastPtsNs(0), _lastArrivalNs(0), _jitterNs(0), _dropped(0) {
+    }
+
+    /**
+     * Atraso alvo em ns, limitado a [0, 150 ms]. No modo adaptativo é o teto.
+     */
+    void setTargetDelay(int64_t delayNs) {
+        _targetDelayNs = std::min(std::max<int64_t>(delayNs, 0), kMaxDelayNs);
+    }
+
+    int64_t targetDelayNs() const {
+        return _targetDelayNs;
+    }
+
+    void setAdaptive(bool adaptive) {
+        _adaptive = adaptive;
+    }
+
+    bool isAdaptive() const {
+        return _adaptive;
+    }
+
+    /**
+     * Enfileira um frame. Com a fila cheia descarta o mais antigo se ele já
+     * venceu; senão descarta o seguinte a ele. Descartar sempre o mais antigo
+     * com a fila cheia de frames ainda por vencer (atraso × fps acima da
+     * profundidade) faria nenhum frame vencer: o vídeo congelaria em vez de
+     * só perder frames.
+     * @param ptsNs PTS no relógio do host
+     * @param arrivalNs Instante de chegada no mesmo relógio
+     */
+    void push(T value, int64_t ptsNs, int64_t arrivalNs) {
+        trackJitter(ptsNs, arrivalNs);
+
+        Entry entry = { ptsNs, std::move(value) };
+        auto position = std::upper_bound(_entries.begin(), _entries.end(), ptsNs,
+                                         [](int64_t pts, const Entry &e) { return pts < e.ptsNs; });
+        _entries.insert(position, std::move(entry));
+
+        int64_t delay = currentDelayNs();
+        while (_entries.size() > _maxDepth) {
+            if (_entries.front().ptsNs + delay <= arrivalNs) {
+                _entries.pop_front();
+            } else {
+                _entries.erase(_entries.begin() + 1);
+            }
+            _dropped++;
+        }
+    }
+
+    /**
+     * Retira o frame mais recente já vencido; os vencidos anteriores são descartados.
+     * @return false se nenhum frame venceu ainda
+     */
+    bool popDue(int64_t nowNs, T &out) {
+        int64_t delay = currentDelayNs();
+        bool found = false;
+        while (!_entries.empty() && _entries.front().ptsNs + delay <= nowNs) {
+            if (found) {
+                _dropped++;
+            }
+            out = std::move(_entries.front().value);
+            _entries.pop_front();
+            found = true;
+        }
+        return found;
+    }
+
+    /**
+     * Instante em que o próximo frame vence (0 com a fila vazia).
+     */
+    int64_t nextDueNs() const {
+        return _entries.empty() ? 0 : _entries.front().ptsNs + currentDelayNs();
+    }
+
+    /**
+     * Atraso em uso: o alvo, ou no modo adaptativo 3x o jitter medido limitado ao alvo.
+     */
+    int64_t currentDelayNs() const {
+        if (!_adaptive) {
+            return _targetDelayNs;
+        }
+        return std::min(_jitterNs * 3, _targetDelayNs);
+    }
+
+    /** Jitter de chegada estimado, em ns. */
+    int64_t jitterNs() const {
+        return _jitterNs;
+    }
+
+    size_t depth() const {
+        return _entries.size();
+    }
+
+    /** Frames descartados por fila cheia ou vencidos sem serem lidos. */
+    uint64_t droppedCount() const {
+        return _dropped;
+    }
+
+    void clear() {
+        _entries.clear();
+        _hasArrival = false;
+        _jitterNs = 0;
+    }
+
+private:
+    struct Entry {
+        int64_t ptsNs;
+        T value;
+    };
+
+    // J += (|D| - J) / 16, com D a diferença entre os intervalos de chegada e de PTS
+    void trackJitter(int64_t ptsNs, int64_t arrivalNs) {
+        if (_hasArrival) {
+            int64_t transit = (arrivalNs - _lastArrivalNs) - (ptsNs - _lastPtsNs);
+            _jitterNs += (std::llabs(transit) - _jitterNs) / 16;
+        }
+        _hasArrival = true;
+        _lastPtsNs = ptsNs;
+        _lastArrivalNs = arrivalNs;
+    }
+
+    const size_t _maxDepth;
+    int64_t _targetDelayNs;
+    bool _adaptive;
+
+    std::deque<Entry> _entries;
+
+    bool _hasArrival;
+    int64_t _lastPtsNs;
+    int64_t _lastArrivalNs;
+    int64_t _jitterNs;
+
+    uint64_t _dropped;
+};
+
+} // namespace vcam
+
+#endif /* PLAYOUTBUFFER_H */
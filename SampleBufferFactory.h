@@ -0,0 +1,73 @@
+#ifndef SAMPLEBUFFERFACTORY_H
+#define SAMPLEBUFFERFACTORY_H
+
+#include <CoreMedia/CoreMedia.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "CFHandle.h"
+
+namespace vcam {
+
+/**
+ * Contadores de alocação da fábrica.
+ */
+struct SampleBufferFactoryStats {
+    uint64_t sampleBuffers;       // CMSampleBuffers criados (um por entrega)
+    uint64_t formatDescriptions;  // descrições de formato criadas (faltas de cache)
+    uint64_t formatReuses;        // descrições reaproveitadas do cache
+    uint64_t failures;
+};
+
+/**
+ * SampleBufferFactory
+ *
+ * Monta CMSampleBuffers prontos direto do pixel buffer publicado, em um passo.
+ * As descrições de formato ficam em cache por (formato, dimensões,
+ * attachments de cor) e só são recriadas quando a geometria muda; em regime
+ * a única alocação por entrega é o próprio CMSampleBuffer.
+ *
+ * Thread-safe: o cache é protegido por mutex (poucas entradas, busca curta).
+ */
+class SampleBufferFactory {
+public:
+    SampleBufferFactory();
+
+    /**
+     * @return CMSampleBuffer retido (o chamador deve chamar CFRelease) ou NULL em falha
+     */
+    CMSampleBufferRef create(CVPixelBufferRef pixelBuffer, const CMSampleTimingInfo &timing);
+
+    /** Descarta as descrições em cache. */
+    void purge();
+
+    SampleBufferFactoryStats stats() const;
+
+private:
+    struct Entry {
+        OSType pixelFormat;
+        size_t width;
+        size_t height;
+        CFHandle<CFTypeRef> matrix;
+        CFHandle<CFTypeRef> primaries;
+        CFHandle<CFTypeRef> transfer;
+        CFHandle<CMVideoFormatDescriptionRef> description;
+        uint64_t lastUse;
+    };
+
+    CFHandle<CMVideoFormatDescriptionRef> descriptionFor(CVPixelBufferRef pixelBuffer);
+
+    mutable std::mutex _mutex;
+    std::vector<Entry> _entries;
+    uint64_t _useCounter;
+
+    std::atomic<uint64_t> _sampleBuffers;
+    std::atomic<uint64_t> _formatDescriptions;
+    std::atomic<uint64_t> _formatReuses;
+    std::atomic<uint64_t> _failures;
+};
+
+} // namespace vcam
+
+#endif /* SAMPLEBUFFERFACTORY_H */
@@ -0,0 +1,115 @@
+#import <Foundation/Foundation.h>
+#include "SampleBufferFactory.h"
+#include <algorithm>
+
+namespace vcam {
+
+namespace {
+
+// Descrições distintas vivas ao mesmo tempo (troca de formato/resolução é rara)
+const size_t kMaxCachedDescriptions = 4;
+
+inline bool sameAttachment(CFTypeRef a, CFTypeRef b) {
+    return a == b || (a && b && CFEqual(a, b));
+}
+
+} // namespace
+
+SampleBufferFactory::SampleBufferFactory()
+    : _useCounter(0), _sampleBuffers(0), _formatDescriptions(0), _formatReuses(0), _failures(0) {
+}
+
+CFHandle<CMVideoFormatDescriptionRef> SampleBufferFactory::descriptionFor(CVPixelBufferRef pixelBuffer) {
+    OSType pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer);
+    size_t width = CVPixelBufferGetWidth(pixelBuffer);
+    size_t height = CVPixelBufferGetHeight(pixelBuffer);
+    CFTypeRef matrix = CVBufferGetAttachment(pixelBuffer, kCVImageBufferYCbCrMatrixKey, NULL);
+    CFTypeRef primaries = CVBufferGetAttachment(pixelBuffer, kCVImageBufferColorPrimariesKey, NULL);
+    CFTypeRef transfer = CVBufferGetAttachment(pixelBuffer, kCVImageBufferTransferFunctionKey, NULL);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _useCounter++;
+
+    for (Entry &entry : _entries) {
+        if (entry.pixelFormat == pixelFormat && entry.width == width && entry.height == height &&
+            sameAttachment(entry.matrix.get(), matrix) &&
+            sameAttachment(entry.primaries.get(), primaries) &&
+            sameAttachment(entry.transfer.get(), transfer)) {
+            entry.lastUse = _useCounter;
+            _formatReuses.fetch_add(1, std::memory_order_relaxed);
+            return entry.description;
+        }
+    }
+
+    CMVideoFormatDescriptionRef description = NULL;
+    OSStatus status = CMVideoFormatDescriptionCreateForImageBuffer(kCFAllocatorDefault, pixelBuffer, &description);
+    if (status != noErr || !description) {
+        NSLog(@"[SampleBufferFactory] Erro ao criar descrição de formato: %d", (int)status);
+        return CFHandle<CMVideoFormatDescriptionRef>();
+    }
+    _formatDescriptions.fetch_add(1, std::memory_order_relaxed);
+
+    // Substitui a entrada usada há mais tempo
+    if (_entries.size() >= kMaxCachedDescriptions) {
+        auto oldest = std::min_element(_entries.begin(), _entries.end(), [](const Entry &a, const Entry &b) {
+            return a.lastUse < b.lastUse;
+        });
+        _entries.erase(oldest);
+    }
+
+    Entry entry;
+    entry.pixelFormat = pixelFormat;
+    entry.width = width;
+    entry.height = height;
+    entry.matrix = CFHandle<CFTypeRef>::retain(matrix);
+    entry.primaries = CFHandle<CFTypeRef>::retain(primaries);
+    entry.transfer = CFHandle<CFTypeRef>::retain(transfer);
+    entry.description = CFHandle<CMVideoFormatDescriptionRef>::adopt(description);
+    entry.lastUse = _useCounter;
+    _entries.push_back(entry);
+
+    NSLog(@"[SampleBufferFactory] Nova descrição de formato: %c%c%c%c %zux%zu",
+          (char)(pixelFormat >> 24), (char)(pixelFormat >> 16),
+          (char)(pixelFormat >> 8), (char)pixelFormat, width, height);
+    return entry.description;
+}
+
+CMSampleBufferRef SampleBufferFactory::create(CVPixelBufferRef pixelBuffer, const CMSampleTimingInfo &timing) {
+    if (!pixelBuffer) {
+        return NULL;
+    }
+
+    CFHandle<CMVideoFormatDescriptionRef> description = descriptionFor(pixelBuffer);
+    if (!description) {
+        _failures.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    CMSampleBufferRef sampleBuffer = NULL;
+    OSStatus status = CMSampleBufferCreateReadyWithImageBuffer(kCFAllocatorDefault, pixelBuffer,
+                                                               description.get(), &timing, &sampleBuffer);
+    if (status != noErr || !sampleBuffer) {
+        NSLog(@"[SampleBufferFactory] Erro ao criar sample buffer: %d", (int)status);
+        _failures.fetch_add(1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    _sampleBuffers.fetch_add(1, std::memory_order_relaxed);
+    return sampleBuffer;
+}
+
+void SampleBufferFactory::purge() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+SampleBufferFactoryStats SampleBufferFactory::stats() const {
+    SampleBufferFactoryStats stats;
+    stats.sampleBuffers = _sampleBuffers.load(std::memory_order_relaxed);
+    stats.formatDescriptions = _formatDescriptions.load(std::memory_order_relaxed);
+    stats.formatReuses = _formatReuses.load(std::memory_order_relaxed);
+    stats.failures = _failures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace vcam
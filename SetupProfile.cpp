@@ -0,0 +1,72 @@
+#include "SetupProfile.h"
+
+namespace vcam {
+
+namespace {
+
+const char *const kPhaseNames[kSetupPhaseCount] = {
+    "signalingOpen", "joinSent", "offerReceived", "remoteDescriptionSet", "answerSent", "iceChecking",
+    "iceConnected", "firstRtpPacket", "firstDecodedFrame", "firstSubstitutedFrame", "firstPreviewFrame",
+};
+
+} // namespace
+
+const char *SetupPhaseName(SetupPhase phase) {
+    size_t index = (size_t)phase;
+    return index < kSetupPhaseCount ? kPhaseNames[index] : "unknown";
+}
+
+SetupProfile::SetupProfile() : _startNs(0), _finished(true) {
+    for (auto &mark : _marksNs) {
+        mark.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SetupProfile::begin(int64_t nowNs) {
+    // Fechado enquanto zera: marca atrasada da sessão anterior não entra na nova
+    _finished.store(true, std::memory_order_relaxed);
+    for (auto &mark : _marksNs) {
+        mark.store(0, std::memory_order_relaxed);
+    }
+    _startNs.store(nowNs, std::memory_order_relaxed);
+    _finished.store(false, std::memory_order_release);
+}
+
+bool SetupProfile::mark(SetupPhase phase, int64_t nowNs) {
+    size_t index = (size_t)phase;
+    if (index >= kSetupPhaseCount) {
+        return false;
+    }
+
+    std::atomic<int64_t> &slot = _marksNs[index];
+    if (slot.load(std::memory_order_relaxed) != 0 || _finished.load(std::memory_order_acquire)) {
+        return false;
+    }
+    int64_t unset = 0;
+    return slot.compare_exchange_strong(unset, nowNs, std::memory_order_relaxed);
+}
+
+bool SetupProfile::marked(SetupPhase phase) const {
+    size_t index = (size_t)phase;
+    return index < kSetupPhaseCount && _marksNs[index].load(std::memory_order_relaxed) != 0;
+}
+
+double SetupProfile::elapsedMs(SetupPhase phase) const {
+    size_t index = (size_t)phase;
+    int64_t startNs = _startNs.load(std::memory_order_relaxed);
+    int64_t markNs = index < kSetupPhaseCount ? _marksNs[index].load(std::memory_order_relaxed) : 0;
+    if (startNs == 0 || markNs == 0) {
+        return -1;
+    }
+    return (double)(markNs - startNs) / 1e6;
+}
+
+bool SetupProfile::pending() const {
+    return _startNs.load(std::memory_order_relaxed) != 0 && !_finished.load(std::memory_order_relaxed);
+}
+
+bool SetupProfile::finish() {
+    return _startNs.load(std::memory_order_relaxed) != 0 && !_finished.exchange(true);
+}
+
+} // namespace vcam
@@ -0,0 +1,74 @@
+#ifndef SETUPPROFILE_H
+#define SETUPPROFILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace vcam {
+
+/**
+ * Fases do estabelecimento da conexão, na ordem esperada.
+ */
+enum class SetupPhase : int {
+    SignalingOpen,          // WebSocket aberto
+    JoinSent,               // join enviado
+    OfferReceived,          // oferta recebida
+    RemoteDescriptionSet,   // descrição remota aplicada
+    AnswerSent,             // resposta enviada
+    IceChecking,            // ICE verificando pares
+    IceConnected,           // ICE conectado
+    FirstRtpPacket,         // primeiro pacote RTP de vídeo
+    FirstDecodedFrame,      // primeiro frame decodificado e convertido
+    FirstSubstitutedFrame,  // primeiro frame entregue ao app no lugar da câmera
+    FirstPreviewFrame,      // primeiro frame enfileirado na camada de preview
+    Count
+};
+
+constexpr size_t kSetupPhaseCount = (size_t)SetupPhase::Count;
+
+/** Nome da fase no resumo; deve acompanhar SETUP_PHASES do server.js. */
+const char *SetupPhaseName(SetupPhase phase);
+
+/**
+ * SetupProfile
+ *
+ * Marcos monotônicos de uma sessão, do início até os primeiros frames.
+ * Cada fase guarda só a primeira ocorrência: reconexões e restarts de ICE
+ * não sobrescrevem. As marcas vêm de várias threads (main, sinalização do
+ * WebRTC, renderer, filas da câmera); depois da primeira, mark() custa um
+ * load relaxed.
+ */
+class SetupProfile {
+public:
+    SetupProfile();
+
+    /** Nova sessão: esquece as marcas e o resumo anterior. */
+    void begin(int64_t nowNs);
+
+    /** @return true na primeira marca da fase nesta sessão */
+    bool mark(SetupPhase phase, int64_t nowNs);
+
+    bool marked(SetupPhase phase) const;
+
+    /** ms desde begin até a fase, ou -1 se ela não ocorreu. */
+    double elapsedMs(SetupPhase phase) const;
+
+    /** Sessão iniciada cujo resumo ainda não foi emitido. */
+    bool pending() const;
+
+    /**
+     * Encerra a sessão; as marcas continuam legíveis até o próximo begin.
+     * @return true só para o primeiro chamador, que emite o resumo
+     */
+    bool finish();
+
+private:
+    std::atomic<int64_t> _startNs;  // 0 = nenhuma sessão
+    std::atomic<int64_t> _marksNs[kSetupPhaseCount];
+    std::atomic<bool> _finished;
+};
+
+} // namespace vcam
+
+#endif /* SETUPPROFILE_H */
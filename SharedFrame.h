@@ -0,0 +1,184 @@
+#ifndef SHAREDFRAME_H
+#define SHAREDFRAME_H
+
+#include <CoreMedia/CoreMedia.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "AspectAdapter.h"
+#include "CFHandle.h"
+#include "FrameScaler.h"
+#include "PixelBufferPool.h"
+#include "SampleBufferFactory.h"
+
+namespace vcam {
+
+/**
+ * Formato de uma visão do frame: tipo de pixel e tamanho.
+ * Zero em qualquer campo significa "o do frame publicado".
+ */
+struct FrameFormat {
+    OSType pixelFormat;
+    int width;
+    int height;
+
+    bool operator==(const FrameFormat &other) const {
+        return pixelFormat == other.pixelFormat && width == other.width && height == other.height;
+    }
+};
+
+/**
+ * ViewConverter
+ *
+ * Converte o pixel buffer publicado para outro formato e/ou tamanho. Mantém
+ * um FrameScaler e um AspectAdapter por formato de destino (tabelas de
+ * filtro e recorte reaproveitadas entre frames, até kMaxConverters formatos
+ * com descarte do menos usado) e lembra as combinações origem/destino sem
+ * conversão suportada, que não são tentadas de novo.
+ *
+ * Thread-safe: as conversões são serializadas por mutex. Em regime só o
+ * produtor dos frames o usa (SharedFrame::prepareViews).
+ */
+class ViewConverter {
+public:
+    static const size_t kMaxConverters = 4;
+
+    explicit ViewConverter(PixelBufferPool &pool);
+
+    ViewConverter(const ViewConverter &) = delete;
+    ViewConverter &operator=(const ViewConverter &) = delete;
+
+    /**
+     * @param unsupported Recebe true se a combinação não tem conversão (falha permanente)
+     * @return Vazio se a conversão não é suportada ou o pool está no limite
+     */
+    CFHandle<CVPixelBufferRef> convert(CVPixelBufferRef source, const FrameFormat &format,
+                                       bool *unsupported = nullptr);
+
+    /** Descarta os conversores e as combinações lembradas (nova sessão). */
+    void purge();
+
+private:
+    struct Converter {
+        FrameFormat format;
+        AspectAdapter adapter;
+        FrameScaler scaler;
+        uint64_t lastUse;
+    };
+
+    // Conversor do formato, criado ou reaproveitado; chamado com _mutex travado
+    Converter &converterFor(const FrameFormat &format);
+
+    PixelBufferPool &_pool;
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<Converter>> _converters;
+    std::vector<std::pair<OSType, OSType>> _unsupported;  // (origem, destino)
+    uint64_t _useCounter;
+};
+
+/**
+ * SharedFrame
+ *
+ * Frame imutável compartilhado por todos os consumidores (preview e cada
+ * data output): pixel buffer, PTS e um id crescente por frame publicado.
+ * As visões derivadas (outro formato ou tamanho, CMSampleBuffer pronto) são
+ * memoizadas no próprio frame, inclusive as que falharam, então o número de
+ * conversões e alocações por frame depende de quantos formatos distintos
+ * existem, não de quantos consumidores.
+ *
+ * As visões dos data outputs são produzidas pelo produtor antes da
+ * publicação (prepareViews); na fila da câmera elas são só consultadas
+ * (preparedPixelBuffer), sem conversão e sem esperar outra conversão.
+ *
+ * Thread-safe; a contagem de referências é a do std::shared_ptr.
+ */
+class SharedFrame {
+public:
+    SharedFrame(uint64_t frameId, CFHandle<CVPixelBufferRef> pixelBuffer, CMTime presentationTime,
+                CMTime duration = kCMTimeInvalid, int64_t probeTimestampMs = -1);
+
+    SharedFrame(const SharedFrame &) = delete;
+    SharedFrame &operator=(const SharedFrame &) = delete;
+
+    uint64_t frameId() const {
+        return _frameId;
+    }
+
+    CVPixelBufferRef pixelBuffer() const {
+        return _pixelBuffer.get();
+    }
+
+    CMTime presentationTime() const {
+        return _presentationTime;
+    }
+
+    CMTime duration() const {
+        return _duration;
+    }
+
+    /** Timestamp gravado no frame pelo emissor (TimestampCode.h), em ms; -1 se não há. */
+    int64_t probeTimestampMs() const {
+        return _probeTimestampMs;
+    }
+
+    /**
+     * Produz as visões nos formatos pedidos que ainda não existem. Chamado pelo
+     * produtor antes de publicar o frame. Tamanho diferente do publicado é
+     * redimensionado com recorte central na proporção pedida.
+     * @return Número de conversões feitas
+     */
+    size_t prepareViews(const std::vector<FrameFormat> &formats, ViewConverter &converter) const;
+
+    /**
+     * Visão já produzida no formato e tamanho pedidos; nunca converte.
+     * @param pending Recebe true se a visão ainda não foi produzida (formato
+     *                registrado depois da publicação deste frame)
+     * @return Vazio se pendente ou se a conversão falhou
+     */
+    CFHandle<CVPixelBufferRef> preparedPixelBuffer(const FrameFormat &format, bool *pending = nullptr) const;
+
+    /**
+     * Pixel buffer no formato pedido (0 = formato publicado), convertido uma única vez.
+     * @return Vazio se a conversão não é suportada ou o pool está no limite
+     */
+    CFHandle<CVPixelBufferRef> pixelBufferInFormat(OSType format, ViewConverter &converter) const;
+
+    /**
+     * CMSampleBuffer com o PTS/duração do frame no formato pedido (0 = formato publicado),
+     * criado uma vez e devolvido retido a cada consumidor.
+     */
+    CFHandle<CMSampleBufferRef> sampleBuffer(OSType format, SampleBufferFactory &factory,
+                                             ViewConverter &converter) const;
+
+private:
+    struct View {
+        FrameFormat format;
+        CFHandle<CVPixelBufferRef> pixelBuffer;  // vazio = conversão falhou neste frame
+        CFHandle<CMSampleBufferRef> sampleBuffer;
+    };
+
+    // Zeros do formato pedido viram os do frame publicado
+    FrameFormat resolve(FrameFormat format) const;
+
+    // Visão existente ou nullptr; chamado com _mutex travado
+    View *findView(const FrameFormat &resolved) const;
+
+    // Procura ou cria a visão, memoizando falhas; chamado com _mutex travado
+    View *viewFor(const FrameFormat &resolved, ViewConverter &converter, bool *converted = nullptr) const;
+
+    const uint64_t _frameId;
+    const CFHandle<CVPixelBufferRef> _pixelBuffer;
+    const CMTime _presentationTime;
+    const CMTime _duration;
+    const int64_t _probeTimestampMs;
+
+    mutable std::mutex _mutex;
+    mutable std::vector<View> _views;
+};
+
+typedef std::shared_ptr<const SharedFrame> SharedFrameRef;
+
+} // namespace vcam
+
+#endif /* SHAREDFRAME_H */
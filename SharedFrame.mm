@@ -0,0 +1,252 @@
+#import <Foundation/Foundation.h>
+#include "SharedFrame.h"
+#include "CVPixelBufferPoolBackend.h"
+#include "YUVToBGRA.h"
+#include <algorithm>
+
+namespace vcam {
+
+namespace {
+
+bool isNV12(OSType format) {
+    return format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ||
+           format == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+}
+
+YUVRange rangeFor(OSType format) {
+    return format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ? YUVRange::Full : YUVRange::Video;
+}
+
+YUVColorSpace colorSpaceFor(CVPixelBufferRef pixelBuffer) {
+    CFTypeRef matrix = CVBufferGetAttachment(pixelBuffer, kCVImageBufferYCbCrMatrixKey, NULL);
+
+    YUVColorSpace colorSpace;
+    colorSpace.matrix = (matrix && CFEqual(matrix, kCVImageBufferYCbCrMatrix_ITU_R_709_2))
+        ? YUVMatrix::BT709 : YUVMatrix::BT601;
+    colorSpace.range = rangeFor(CVPixelBufferGetPixelFormatType(pixelBuffer));
+    return colorSpace;
+}
+
+bool isSupportedConversion(OSType source, OSType target) {
+    return isNV12(source) && (target == kCVPixelFormatType_32BGRA || isNV12(target));
+}
+
+} // namespace
+
+ViewConverter::ViewConverter(PixelBufferPool &pool) : _pool(pool), _useCounter(0) {
+}
+
+ViewConverter::Converter &ViewConverter::converterFor(const FrameFormat &format) {
+    _useCounter++;
+    for (auto &converter : _converters) {
+        if (converter->format == format) {
+            converter->lastUse = _useCounter;
+            return *converter;
+        }
+    }
+
+    if (_converters.size() >= kMaxConverters) {
+        auto oldest = std::min_element(_converters.begin(), _converters.end(),
+                                       [](const std::unique_ptr<Converter> &a, const std::unique_ptr<Converter> &b) {
+                                           return a->lastUse < b->lastUse;
+                                       });
+        _converters.erase(oldest);
+    }
+    std::unique_ptr<Converter> converter(new Converter);
+    converter->format = format;
+    converter->lastUse = _useCounter;
+    _converters.push_back(std::move(converter));
+    return *_converters.back();
+}
+
+// NV12 -> BGRA ou NV12 em outra faixa e/ou tamanho; BGRA publicado não é convertido
+CFHandle<CVPixelBufferRef> ViewConverter::convert(CVPixelBufferRef source, const FrameFormat &format,
+                                                  bool *unsupported) {
+    OSType sourceFormat = CVPixelBufferGetPixelFormatType(source);
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::pair<OSType, OSType> combination(sourceFormat, format.pixelFormat);
+    bool known = std::find(_unsupported.begin(), _unsupported.end(), combination) != _unsupported.end();
+    if (known || !isSupportedConversion(sourceFormat, format.pixelFormat)) {
+        if (!known) {
+            _unsupported.push_back(combination);
+            NSLog(@"[ViewConverter] Sem conversão de '%c%c%c%c' para '%c%c%c%c'",
+                  (char)(sourceFormat >> 24), (char)(sourceFormat >> 16), (char)(sourceFormat >> 8), (char)sourceFormat,
+                  (char)(format.pixelFormat >> 24), (char)(format.pixelFormat >> 16),
+                  (char)(format.pixelFormat >> 8), (char)format.pixelFormat);
+        }
+        if (unsupported) {
+            *unsupported = true;
+        }
+        return CFHandle<CVPixelBufferRef>();
+    }
+
+    int width = (int)CVPixelBufferGetWidth(source);
+    int height = (int)CVPixelBufferGetHeight(source);
+    CFHandle<CVPixelBufferRef> output = CFHandle<CVPixelBufferRef>::adopt(
+        CreatePooledPixelBuffer(_pool, format.pixelFormat, format.width, format.height));
+    if (!output) {
+        return output;
+    }
+
+    CVPixelBufferLockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+    CVPixelBufferLockBaseAddress(output.get(), 0);
+
+    NV12Source src = {
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 0),
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 1),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 0),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 1),
+        width, height
+    };
+    YUVColorSpace colorSpace = colorSpaceFor(source);
+
+    bool sameSize = format.width == width && format.height == height;
+    bool ok = true;
+    if (format.pixelFormat == kCVPixelFormatType_32BGRA && sameSize) {
+        BGRAPlane dst = {
+            (uint8_t *)CVPixelBufferGetBaseAddress(output.get()),
+            (int)CVPixelBufferGetBytesPerRow(output.get())
+        };
+        ConvertNV12ToBGRA(src, colorSpace, dst);
+    } else {
+        // Troca de faixa em 1:1 (vizinho mais próximo = cópia com ajuste) ou redimensionamento com recorte central
+        ScaleTarget target;
+        target.flipX = false;
+        target.flipY = false;
+        target.width = format.width;
+        target.height = format.height;
+        target.range = rangeFor(format.pixelFormat);
+        if (format.pixelFormat == kCVPixelFormatType_32BGRA) {
+            target.format = ScaleTarget::BGRA;
+            target.y = (uint8_t *)CVPixelBufferGetBaseAddress(output.get());
+            target.uv = nullptr;
+            target.strideY = (int)CVPixelBufferGetBytesPerRow(output.get());
+            target.strideUV = 0;
+        } else {
+            target.format = ScaleTarget::NV12;
+            target.y = (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output.get(), 0);
+            target.uv = (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output.get(), 1);
+            target.strideY = (int)CVPixelBufferGetBytesPerRowOfPlane(output.get(), 0);
+            target.strideUV = (int)CVPixelBufferGetBytesPerRowOfPlane(output.get(), 1);
+        }
+
+        // Tabelas de filtro e recorte do formato reaproveitadas entre frames
+        Converter &converter = converterFor(format);
+        CropRect crop = { 0, 0, width, height };
+        if (!sameSize) {
+            NormalizedRect whole = { 0, 0, 1, 1 };
+            crop = converter.adapter.layout(crop, format.width, format.height, AspectMode::Fill, whole).crop;
+        }
+
+        ScaleQuality quality = sameSize ? ScaleQuality::Nearest : ScaleQuality::Box;
+        ok = converter.scaler.process(YUVSource::fromNV12(src, colorSpace), crop, target, quality);
+        if (ok && format.pixelFormat != kCVPixelFormatType_32BGRA) {
+            CVBufferPropagateAttachments(source, output.get());
+        }
+    }
+
+    CVPixelBufferUnlockBaseAddress(output.get(), 0);
+    CVPixelBufferUnlockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+    return ok ? output : CFHandle<CVPixelBufferRef>();
+}
+
+void ViewConverter::purge() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _converters.clear();
+    _unsupported.clear();
+}
+
+SharedFrame::SharedFrame(uint64_t frameId, CFHandle<CVPixelBufferRef> pixelBuffer, CMTime presentationTime,
+                         CMTime duration, int64_t probeTimestampMs)
+    : _frameId(frameId), _pixelBuffer(pixelBuffer), _presentationTime(presentationTime), _duration(duration),
+      _probeTimestampMs(probeTimestampMs) {
+}
+
+FrameFormat SharedFrame::resolve(FrameFormat format) const {
+    if (format.pixelFormat == 0) {
+        format.pixelFormat = CVPixelBufferGetPixelFormatType(_pixelBuffer.get());
+    }
+    if (format.width <= 0 || format.height <= 0) {
+        format.width = (int)CVPixelBufferGetWidth(_pixelBuffer.get());
+        format.height = (int)CVPixelBufferGetHeight(_pixelBuffer.get());
+    }
+    return format;
+}
+
+SharedFrame::View *SharedFrame::findView(const FrameFormat &resolved) const {
+    for (View &view : _views) {
+        if (view.format == resolved) {
+            return &view;
+        }
+    }
+    return nullptr;
+}
+
+SharedFrame::View *SharedFrame::viewFor(const FrameFormat &resolved, ViewConverter &converter, bool *converted) const {
+    View *existing = findView(resolved);
+    if (existing) {
+        return existing;
+    }
+
+    FrameFormat published = resolve({ 0, 0, 0 });
+    View view;
+    view.format = resolved;
+    if (resolved == published) {
+        view.pixelBuffer = _pixelBuffer;
+    } else {
+        view.pixelBuffer = converter.convert(_pixelBuffer.get(), resolved);
+        if (converted) {
+            *converted = (bool)view.pixelBuffer;
+        }
+    }
+    // Falha também fica memoizada: os outros consumidores deste frame não tentam de novo
+    _views.push_back(view);
+    return &_views.back();
+}
+
+size_t SharedFrame::prepareViews(const std::vector<FrameFormat> &formats, ViewConverter &converter) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t conversions = 0;
+    for (const FrameFormat &format : formats) {
+        bool converted = false;
+        viewFor(resolve(format), converter, &converted);
+        conversions += converted ? 1 : 0;
+    }
+    return conversions;
+}
+
+CFHandle<CVPixelBufferRef> SharedFrame::preparedPixelBuffer(const FrameFormat &format, bool *pending) const {
+    FrameFormat resolved = resolve(format);
+    if (resolved == resolve({ 0, 0, 0 })) {
+        return _pixelBuffer;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    View *view = findView(resolved);
+    if (pending) {
+        *pending = view == nullptr;
+    }
+    return view ? view->pixelBuffer : CFHandle<CVPixelBufferRef>();
+}
+
+CFHandle<CVPixelBufferRef> SharedFrame::pixelBufferInFormat(OSType format, ViewConverter &converter) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return viewFor(resolve({ format, 0, 0 }), converter)->pixelBuffer;
+}
+
+CFHandle<CMSampleBufferRef> SharedFrame::sampleBuffer(OSType format, SampleBufferFactory &factory,
+                                                      ViewConverter &converter) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    View *view = viewFor(resolve({ format, 0, 0 }), converter);
+    if (!view->pixelBuffer) {
+        return CFHandle<CMSampleBufferRef>();
+    }
+
+    if (!view->sampleBuffer) {
+        // duração, PTS, DTS
+        CMSampleTimingInfo timing = { _duration, _presentationTime, kCMTimeInvalid };
+        view->sampleBuffer = CFHandle<CMSampleBufferRef>::adopt(factory.create(view->pixelBuffer.get(), timing));
+    }
+    return view->sampleBuffer;
+}
+
+} // namespace vcam
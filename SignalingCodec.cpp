@@ -0,0 +1,317 @@
+#include "SignalingCodec.h"
+#include <cmath>
+#include <cstring>
+
+namespace vcam {
+
+namespace {
+
+// --- Tabelas da versão 1 ---
+
+// Ordem fixa: o índice é o código no fio (0-23 ocupam um byte)
+const char *const kKeys[] = {
+    "type", "roomId", "sdp", "candidate", "sdpMid", "sdpMLineIndex", "timestamp", "clientTimestamp",
+    "senderDeviceType", "deviceType", "enabled", "stats", "latency", "count", "p50", "p95",
+    "p99", "max", "clockRtt", "bucketMs", "buckets", "userId", "webcam", "config",
+    "binaryProtocol", "capabilities", "action", "targetBitrate",
+};
+
+const char *const kTypes[] = {
+    "join", "offer", "answer", "ice-candidate", "ping", "pong", "bye", "stats",
+    "latency-probe", "welcome", "user-joined", "user-left", "transmission-active", "transmission-started",
+    "transmission-stopped", "quality-recommendation", "ios-capabilities-update", "server-shutdown", "codec",
+};
+
+const size_t kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+const size_t kTypeCount = sizeof(kTypes) / sizeof(kTypes[0]);
+
+int findCode(const char *const *table, size_t count, const char *name, size_t length) {
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(table[i], name, length) == 0 && table[i][length] == '\0') {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// --- CBOR ---
+
+enum : uint8_t {
+    kMajorUInt = 0,
+    kMajorNegInt = 1,
+    kMajorText = 3,
+    kMajorArray = 4,
+    kMajorMap = 5,
+    kMajorSimple = 7
+};
+
+const uint8_t kFalse = 0xF4;
+const uint8_t kTrue = 0xF5;
+const uint8_t kNull = 0xF6;
+const uint8_t kFloat16 = 0xF9;
+const uint8_t kFloat32 = 0xFA;
+const uint8_t kFloat64 = 0xFB;
+
+double halfToDouble(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = std::ldexp(mantissa, -24);
+    } else if (exponent == 31) {
+        value = mantissa == 0 ? INFINITY : NAN;
+    } else {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+} // namespace
+
+int SignalingKeyCode(const char *name, size_t length) {
+    return findCode(kKeys, kKeyCount, name, length);
+}
+
+const char *SignalingKeyName(uint64_t code) {
+    return code < kKeyCount ? kKeys[code] : nullptr;
+}
+
+int SignalingTypeCode(const char *name, size_t length) {
+    return findCode(kTypes, kTypeCount, name, length);
+}
+
+const char *SignalingTypeName(uint64_t code) {
+    return code < kTypeCount ? kTypes[code] : nullptr;
+}
+
+// --- Escrita ---
+
+SignalingWriter::SignalingWriter(size_t reserve) {
+    _bytes.reserve(reserve);
+    _bytes.push_back(kSignalingMagic);
+    _bytes.push_back(kSignalingProtocolVersion);
+}
+
+void SignalingWriter::writeHead(uint8_t major, uint64_t value) {
+    uint8_t initial = (uint8_t)(major << 5);
+    if (value < 24) {
+        _bytes.push_back(initial | (uint8_t)value);
+        return;
+    }
+
+    int bytes;
+    if (value <= 0xFF) {
+        _bytes.push_back(initial | 24);
+        bytes = 1;
+    } else if (value <= 0xFFFF) {
+        _bytes.push_back(initial | 25);
+        bytes = 2;
+    } else if (value <= 0xFFFFFFFFULL) {
+        _bytes.push_back(initial | 26);
+        bytes = 4;
+    } else {
+        _bytes.push_back(initial | 27);
+        bytes = 8;
+    }
+    for (int i = bytes - 1; i >= 0; i--) {
+        _bytes.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+void SignalingWriter::beginMap(size_t count) {
+    writeHead(kMajorMap, count);
+}
+
+void SignalingWriter::beginArray(size_t count) {
+    writeHead(kMajorArray, count);
+}
+
+void SignalingWriter::writeKey(const char *name, size_t length) {
+    int code = SignalingKeyCode(name, length);
+    if (code >= 0) {
+        writeHead(kMajorUInt, (uint64_t)code);
+    } else {
+        writeText(name, length);
+    }
+}
+
+void SignalingWriter::writeType(const char *name, size_t length) {
+    int code = SignalingTypeCode(name, length);
+    if (code >= 0) {
+        writeHead(kMajorUInt, (uint64_t)code);
+    } else {
+        writeText(name, length);
+    }
+}
+
+void SignalingWriter::writeText(const char *text, size_t length) {
+    writeHead(kMajorText, length);
+    _bytes.insert(_bytes.end(), (const uint8_t *)text, (const uint8_t *)text + length);
+}
+
+void SignalingWriter::writeInt(int64_t value) {
+    if (value >= 0) {
+        writeHead(kMajorUInt, (uint64_t)value);
+    } else {
+        // -1 - value sem overflow em INT64_MIN
+        writeHead(kMajorNegInt, ~(uint64_t)value);
+    }
+}
+
+void SignalingWriter::writeUInt(uint64_t value) {
+    writeHead(kMajorUInt, value);
+}
+
+void SignalingWriter::writeDouble(double value) {
+    // 2^63 é exato em double; abaixo disso o cast para int64 é definido
+    if (value == std::floor(value) && value >= -9223372036854775808.0 && value < 9223372036854775808.0) {
+        writeInt((int64_t)value);
+        return;
+    }
+
+    float single = (float)value;
+    if ((double)single == value || std::isnan(value)) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        _bytes.push_back(kFloat32);
+        for (int i = 3; i >= 0; i--) {
+            _bytes.push_back((uint8_t)(bits >> (8 * i)));
+        }
+        return;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    _bytes.push_back(kFloat64);
+    for (int i = 7; i >= 0; i--) {
+        _bytes.push_back((uint8_t)(bits >> (8 * i)));
+    }
+}
+
+void SignalingWriter::writeBool(bool value) {
+    _bytes.push_back(value ? kTrue : kFalse);
+}
+
+void SignalingWriter::writeNull() {
+    _bytes.push_back(kNull);
+}
+
+// --- Leitura ---
+
+SignalingReader::SignalingReader(const uint8_t *data, size_t length)
+    : _cursor(data), _end(data + length), _valid(false) {
+    if (data && length > kSignalingHeaderBytes && data[0] == kSignalingMagic &&
+        data[1] == kSignalingProtocolVersion) {
+        _cursor += kSignalingHeaderBytes;
+        _valid = true;
+    } else {
+        _cursor = _end;
+    }
+}
+
+bool SignalingReader::readArgument(uint8_t info, uint64_t &value) {
+    if (info < 24) {
+        value = info;
+        return true;
+    }
+    if (info > 27) {
+        return false;  // comprimento indefinido ou reservado
+    }
+
+    size_t bytes = (size_t)1 << (info - 24);
+    if ((size_t)(_end - _cursor) < bytes) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | *_cursor++;
+    }
+    return true;
+}
+
+bool SignalingReader::read(SignalingItem &item) {
+    if (_cursor >= _end) {
+        return false;
+    }
+    uint8_t initial = *_cursor++;
+    uint8_t major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+    size_t remaining;
+
+    switch (major) {
+        case kMajorUInt:
+            item.type = SignalingItemType::UInt;
+            return readArgument(info, item.count);
+
+        case kMajorNegInt:
+            item.type = SignalingItemType::NegInt;
+            if (!readArgument(info, item.count) || item.count > (uint64_t)INT64_MAX) {
+                return false;
+            }
+            item.integer = -1 - (int64_t)item.count;
+            return true;
+
+        case kMajorText:
+            item.type = SignalingItemType::Text;
+            if (!readArgument(info, item.count) || item.count > (uint64_t)(_end - _cursor)) {
+                return false;
+            }
+            item.text = (const char *)_cursor;
+            _cursor += item.count;
+            return true;
+
+        case kMajorArray:
+        case kMajorMap:
+            item.type = major == kMajorArray ? SignalingItemType::Array : SignalingItemType::Map;
+            if (!readArgument(info, item.count)) {
+                return false;
+            }
+            // Cada elemento ocupa ao menos um byte (dois por par no mapa)
+            remaining = (size_t)(_end - _cursor);
+            return item.count <= (major == kMajorArray ? remaining : remaining / 2);
+
+        case kMajorSimple:
+            break;
+
+        default:
+            return false;  // bytes e tags não fazem parte do protocolo
+    }
+
+    switch (initial) {
+        case kFalse:
+        case kTrue:
+            item.type = SignalingItemType::Bool;
+            item.boolean = initial == kTrue;
+            return true;
+
+        case kNull:
+            item.type = SignalingItemType::Null;
+            return true;
+
+        case kFloat16:
+        case kFloat32:
+        case kFloat64: {
+            uint64_t bits;
+            if (!readArgument(info, bits)) {
+                return false;
+            }
+            item.type = SignalingItemType::Double;
+            if (initial == kFloat16) {
+                item.real = halfToDouble((uint16_t)bits);
+            } else if (initial == kFloat32) {
+                uint32_t narrow = (uint32_t)bits;
+                float single;
+                memcpy(&single, &narrow, sizeof(single));
+                item.real = single;
+            } else {
+                memcpy(&item.real, &bits, sizeof(item.real));
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+} // namespace vcam
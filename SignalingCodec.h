@@ -0,0 +1,133 @@
+#ifndef SIGNALINGCODEC_H
+#define SIGNALINGCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+/**
+ * Protocolo binário de sinalização
+ *
+ * Mensagem = cabeçalho fixo [kSignalingMagic, versão] + um item CBOR
+ * (RFC 8949, só comprimentos definidos). Negociado no `join`: o cliente
+ * anuncia `binaryProtocol` com a maior versão que entende e o servidor
+ * responde com `{type: "codec"}` em JSON; dali em diante os dois lados
+ * enviam mensagens binárias do WebSocket e continuam aceitando texto JSON.
+ *
+ * Chaves frequentes e o valor de `type` no nível de topo viram inteiros
+ * de um byte pelas tabelas da versão; o resto vai como texto. As tabelas
+ * devem acompanhar SIGNALING_KEYS/SIGNALING_TYPES do server.js e só podem
+ * crescer no fim (mudar a ordem exige nova versão).
+ */
+constexpr uint8_t kSignalingMagic = 0x56;  // 'V'
+constexpr uint8_t kSignalingProtocolVersion = 1;
+constexpr size_t kSignalingHeaderBytes = 2;
+
+/** Código da chave na tabela, ou -1 se vai como texto. */
+int SignalingKeyCode(const char *name, size_t length);
+
+/** Nome da chave, ou nullptr para código desconhecido. */
+const char *SignalingKeyName(uint64_t code);
+
+/** Código do tipo de mensagem, ou -1 se vai como texto. */
+int SignalingTypeCode(const char *name, size_t length);
+
+/** Nome do tipo de mensagem, ou nullptr para código desconhecido. */
+const char *SignalingTypeName(uint64_t code);
+
+/**
+ * Serializa uma mensagem; o chamador percorre o objeto e chama os
+ * métodos na ordem (mapas e arrays recebem a contagem antecipada).
+ */
+class SignalingWriter {
+public:
+    explicit SignalingWriter(size_t reserve = 256);
+
+    void beginMap(size_t count);
+    void beginArray(size_t count);
+
+    /** Chave de mapa: código da tabela quando houver. */
+    void writeKey(const char *name, size_t length);
+
+    /** Valor de `type` no topo: código da tabela quando houver. */
+    void writeType(const char *name, size_t length);
+
+    void writeText(const char *text, size_t length);
+    void writeInt(int64_t value);
+    void writeUInt(uint64_t value);
+
+    /** Inteiros exatos viram inteiro; o resto float32 se não perder precisão, senão float64. */
+    void writeDouble(double value);
+
+    void writeBool(bool value);
+    void writeNull();
+
+    const std::vector<uint8_t> &bytes() const {
+        return _bytes;
+    }
+
+private:
+    void writeHead(uint8_t major, uint64_t value);
+
+    std::vector<uint8_t> _bytes;
+};
+
+enum class SignalingItemType {
+    UInt,
+    NegInt,
+    Double,
+    Bool,
+    Null,
+    Text,
+    Array,
+    Map
+};
+
+/**
+ * Item lido. Para Array/Map `count` é o número de elementos (pares no
+ * mapa) que vêm a seguir; para Text, `text`/`count` apontam para o buffer
+ * original, sem cópia.
+ */
+struct SignalingItem {
+    SignalingItemType type;
+    uint64_t count;   // UInt: valor; Text: bytes; Array/Map: elementos
+    int64_t integer;  // NegInt
+    double real;      // Double
+    bool boolean;     // Bool
+    const char *text;
+};
+
+/**
+ * Leitor sequencial. Rejeita cabeçalho de outra versão, itens de
+ * comprimento indefinido, tags e contagens maiores que os bytes restantes
+ * (entrada malformada nunca provoca alocação grande).
+ */
+class SignalingReader {
+public:
+    SignalingReader(const uint8_t *data, size_t length);
+
+    /** Cabeçalho com a versão suportada. */
+    bool valid() const {
+        return _valid;
+    }
+
+    /** @return false se malformado ou sem mais bytes */
+    bool read(SignalingItem &item);
+
+    bool atEnd() const {
+        return _cursor == _end;
+    }
+
+private:
+    bool readArgument(uint8_t info, uint64_t &value);
+
+    const uint8_t *_cursor;
+    const uint8_t *_end;
+    bool _valid;
+};
+
+} // namespace vcam
+
+#endif /* SIGNALINGCODEC_H */
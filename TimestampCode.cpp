@@ -0,0 +1,198 @@
+#include "TimestampCode.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VCAM_CODE_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define VCAM_CODE_SSE2 1
+#endif
+
+namespace vcam {
+
+namespace {
+
+typedef uint32_t (*RowSumFn)(const uint8_t *row, int count);
+
+// --- Escalar ---
+
+uint32_t rowSumScalar(const uint8_t *row, int count) {
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += row[i];
+    }
+    return sum;
+}
+
+// --- SIMD ---
+
+#if VCAM_CODE_NEON
+
+uint32_t rowSumNEON(const uint8_t *row, int count) {
+    uint32x4_t acc = vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t pairs = vpaddlq_u8(vld1q_u8(row + i));
+        acc = vpadalq_u16(acc, pairs);
+    }
+    uint32_t sum = vaddvq_u32(acc);
+    return sum + rowSumScalar(row + i, count - i);
+}
+
+#elif VCAM_CODE_SSE2
+
+uint32_t rowSumSSE2(const uint8_t *row, int count) {
+    // psadbw contra zero soma 8 bytes em cada metade
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint32_t sum = (uint32_t)_mm_cvtsi128_si32(acc) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    return sum + rowSumScalar(row + i, count - i);
+}
+
+#endif
+
+RowSumFn selectRowSum() {
+#if VCAM_CODE_NEON
+    return rowSumNEON;
+#elif VCAM_CODE_SSE2
+    return rowSumSSE2;
+#else
+    return rowSumScalar;
+#endif
+}
+
+// --- Código ---
+
+uint8_t crc8(const uint8_t *data, int count) {
+    uint8_t crc = 0;
+    for (int i = 0; i < count; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void timestampBytes(uint64_t timestampMs, uint8_t bytes[6]) {
+    for (int i = 0; i < 6; i++) {
+        bytes[i] = (uint8_t)(timestampMs >> (8 * (5 - i)));
+    }
+}
+
+int cellStart(int cell, int width) {
+    return (int)((int64_t)cell * width / TimestampCodeLayout::kCellCount);
+}
+
+// Média do miolo da célula: metade central nas duas direções, longe das bordas borradas pelo encoder
+uint32_t cellMean(const LumaPlane &plane, int cell, int stripHeight, RowSumFn rowSum) {
+    int x0 = cellStart(cell, plane.width);
+    int x1 = cellStart(cell + 1, plane.width);
+    int inset = (x1 - x0) / 4;
+    int columns = std::max(x1 - x0 - 2 * inset, 1);
+    int rowStart = stripHeight / 4;
+    int rows = std::max(stripHeight / 2, 1);
+
+    uint32_t sum = 0;
+    for (int row = rowStart; row < rowStart + rows; row++) {
+        sum += rowSum(plane.data + (size_t)row * plane.stride + x0 + inset, columns);
+    }
+    return sum / (uint32_t)(columns * rows);
+}
+
+bool readCode(const LumaPlane &plane, uint64_t &timestampMs, RowSumFn rowSum) {
+    if (!plane.data || plane.width < TimestampCodeLayout::kCellCount * 2) {
+        return false;
+    }
+    int stripHeight = TimestampCodeLayout::stripHeight(plane.height);
+    if (stripHeight > plane.height) {
+        return false;
+    }
+
+    uint32_t white = cellMean(plane, 0, stripHeight, rowSum);
+    uint32_t black = cellMean(plane, 1, stripHeight, rowSum);
+    // Sem contraste suficiente não há código (frame comum)
+    if (white < black + 64) {
+        return false;
+    }
+    uint32_t threshold = (white + black) / 2;
+
+    uint64_t value = 0;
+    for (int bit = 0; bit < TimestampCodeLayout::kDataBits; bit++) {
+        uint32_t mean = cellMean(plane, TimestampCodeLayout::kSyncCells + bit, stripHeight, rowSum);
+        value = (value << 1) | (mean > threshold ? 1 : 0);
+    }
+
+    uint8_t crc = 0;
+    for (int bit = 0; bit < TimestampCodeLayout::kCrcBits; bit++) {
+        uint32_t mean = cellMean(plane, TimestampCodeLayout::kSyncCells + TimestampCodeLayout::kDataBits + bit,
+                                 stripHeight, rowSum);
+        crc = (uint8_t)((crc << 1) | (mean > threshold ? 1 : 0));
+    }
+
+    uint8_t bytes[6];
+    timestampBytes(value, bytes);
+    if (crc8(bytes, 6) != crc) {
+        return false;
+    }
+    timestampMs = value;
+    return true;
+}
+
+} // namespace
+
+int TimestampCodeLayout::stripHeight(int frameHeight) {
+    return std::max(frameHeight / kStripHeightDivisor, kMinStripHeight);
+}
+
+void WriteTimestampCode(uint8_t *luma, int stride, int width, int height,
+                        uint64_t timestampMs, uint8_t white, uint8_t black) {
+    int stripHeight = std::min(TimestampCodeLayout::stripHeight(height), height);
+
+    uint8_t bytes[6];
+    timestampBytes(timestampMs, bytes);
+    uint8_t crc = crc8(bytes, 6);
+
+    bool cells[TimestampCodeLayout::kCellCount];
+    cells[0] = true;
+    cells[1] = false;
+    for (int bit = 0; bit < TimestampCodeLayout::kDataBits; bit++) {
+        cells[TimestampCodeLayout::kSyncCells + bit] = (timestampMs >> (TimestampCodeLayout::kDataBits - 1 - bit)) & 1;
+    }
+    for (int bit = 0; bit < TimestampCodeLayout::kCrcBits; bit++) {
+        cells[TimestampCodeLayout::kSyncCells + TimestampCodeLayout::kDataBits + bit] = (crc >> (7 - bit)) & 1;
+    }
+
+    // Monta uma linha e replica na altura da faixa
+    uint8_t *first = luma;
+    for (int cell = 0; cell < TimestampCodeLayout::kCellCount; cell++) {
+        int x0 = cellStart(cell, width);
+        int x1 = cellStart(cell + 1, width);
+        memset(first + x0, cells[cell] ? white : black, x1 - x0);
+    }
+    for (int row = 1; row < stripHeight; row++) {
+        memcpy(luma + (size_t)row * stride, first, width);
+    }
+}
+
+bool ReadTimestampCode(const LumaPlane &plane, uint64_t &timestampMs) {
+    static const RowSumFn rowSum = selectRowSum();
+    return readCode(plane, timestampMs, rowSum);
+}
+
+namespace reference {
+
+bool ReadTimestampCode(const LumaPlane &plane, uint64_t &timestampMs) {
+    return readCode(plane, timestampMs, rowSumScalar);
+}
+
+} // namespace reference
+
+} // namespace vcam
@@ -0,0 +1,68 @@
+#ifndef TIMESTAMPCODE_H
+#define TIMESTAMPCODE_H
+
+#include <cstdint>
+
+namespace vcam {
+
+/**
+ * Código de timestamp gravado no topo do frame pelo emissor (ver
+ * /latency-probe.js em server.js) para medir a latência glass-to-glass.
+ *
+ * Faixa horizontal com a largura do frame e altura kStripHeightDivisor-ésimo
+ * da altura (mínimo kMinStripHeight linhas), dividida em kCellCount células
+ * de mesma largura:
+ *   [branco][preto] sincronismo e referência de limiar
+ *   48 bits do timestamp em ms, MSB primeiro (branco = 1)
+ *   8 bits de CRC-8 (polinômio 0x07) dos 6 bytes do timestamp, big-endian
+ *
+ * Células grandes e só dois níveis sobrevivem à compressão H.264; a leitura
+ * usa a média do miolo de cada célula.
+ */
+struct TimestampCodeLayout {
+    static constexpr int kSyncCells = 2;
+    static constexpr int kDataBits = 48;
+    static constexpr int kCrcBits = 8;
+    static constexpr int kCellCount = kSyncCells + kDataBits + kCrcBits;
+    static constexpr int kStripHeightDivisor = 20;
+    static constexpr int kMinStripHeight = 16;
+
+    static int stripHeight(int frameHeight);
+};
+
+/**
+ * Plano de luma somente leitura.
+ */
+struct LumaPlane {
+    const uint8_t *data;
+    int stride;
+    int width;
+    int height;
+};
+
+/**
+ * Grava o código no plano de luma (emissores nativos e frames de teste).
+ * @param white Nível de luma do branco (235 em faixa de vídeo, 255 em completa)
+ * @param black Nível de luma do preto (16 / 0)
+ */
+void WriteTimestampCode(uint8_t *luma, int stride, int width, int height,
+                        uint64_t timestampMs, uint8_t white = 235, uint8_t black = 16);
+
+/**
+ * Lê o código do plano de luma.
+ * @return false se a faixa não tem sincronismo válido ou o CRC não confere
+ */
+bool ReadTimestampCode(const LumaPlane &plane, uint64_t &timestampMs);
+
+namespace reference {
+
+/**
+ * Leitura escalar de referência; o caminho SIMD deve decodificar os mesmos valores.
+ */
+bool ReadTimestampCode(const LumaPlane &plane, uint64_t &timestampMs);
+
+} // namespace reference
+
+} // namespace vcam
+
+#endif /* TIMESTAMPCODE_H */
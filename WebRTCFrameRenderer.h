@@ -0,0 +1,159 @@
+#ifndef WEBRTCFRAMERENDERER_H
+#define WEBRTCFRAMERENDERER_H
+
+#import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+#import <WebRTC/WebRTC.h>
+
+/**
+ * Bloco chamado na thread de conversão do renderer para cada frame pronto para publicação.
+ * O pixelBuffer só é garantido durante a chamada; quem quiser mantê-lo deve retê-lo.
+ */
+typedef void (^WebRTCFrameHandler)(CVPixelBufferRef pixelBuffer, RTCVideoFrame *frame);
+
+/**
+ * Qualidade do redimensionamento aplicado quando há tamanho alvo ou crop.
+ */
+typedef NS_ENUM(NSInteger, WebRTCScaleQuality) {
+    WebRTCScaleQualityNearest,
+    WebRTCScaleQualityBilinear,
+    WebRTCScaleQualityBox,
+    WebRTCScaleQualityLanczos3
+};
+
+/**
+ * Contadores e tempos do pipeline entre o decoder e a thread de conversão.
+ */
+typedef struct {
+    uint64_t submitted;
+    uint64_t processed;
+    uint64_t dropped;       // descartados por fila cheia (o mais antigo sai)
+    uint64_t maxDepth;
+    double queueAverageMs;  // espera entre o decoder e a conversão
+    double queueMaxMs;
+    double workAverageMs;   // conversão + publicação
+    double workMaxMs;
+} WebRTCPipelineStats;
+
+/**
+ * Encaixe do frame num tamanho alvo de outra proporção.
+ */
+typedef NS_ENUM(NSInteger, WebRTCAspectMode) {
+    WebRTCAspectModeStretch,  // distorce
+    WebRTCAspectModeFill,     // recorta (centro ou regionOfInterest)
+    WebRTCAspectModeFit       // encaixa com faixas pretas
+};
+
+/**
+ * WebRTCFrameRenderer
+ *
+ * Renderer adicionado à faixa de vídeo remota que alimenta o pipeline de substituição.
+ * Buffers RTCCVPixelBuffer em formato aceito são repassados sem cópia;
+ * buffers I420 ou com crop/escala passam por conversão, e o redimensionamento
+ * para `targetSize` é feito junto com a conversão pelo vcam::FrameScaler.
+ *
+ * A thread do decoder só enfileira o frame (vcam::FramePipeline, fila limitada
+ * que descarta o mais antigo); conversão e publicação rodam numa thread própria
+ * com QoS user-interactive.
+ */
+@interface WebRTCFrameRenderer : NSObject <RTCVideoRenderer>
+
+/**
+ * Cria o renderer.
+ * @param pixelFormats Formatos (OSType em NSNumber) aceitos pelo consumidor sem conversão
+ * @param handler Bloco que recebe cada frame pronto
+ */
+- (instancetype)initWithAcceptedPixelFormats:(NSSet<NSNumber *> *)pixelFormats
+                                frameHandler:(WebRTCFrameHandler)handler;
+
+/**
+ * Cria o renderer com o pool de conversão dimensionado pelo consumidor.
+ * @param maxBuffersInFlight Buffers convertidos de um mesmo formato/tamanho que
+ *        podem estar retidos ao mesmo tempo (filas, slot, consumidores) mais o
+ *        frame em conversão; além disso os frames convertidos são descartados
+ */
+- (instancetype)initWithAcceptedPixelFormats:(NSSet<NSNumber *> *)pixelFormats
+                          maxBuffersInFlight:(NSUInteger)maxBuffersInFlight
+                                frameHandler:(WebRTCFrameHandler)handler;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Zera os contadores de frames.
+ */
+- (void)resetCounters;
+
+/**
+ * Descarta os frames ainda na fila e espera a conversão em andamento terminar.
+ * Depois de remover o renderer da faixa, garante que o frameHandler não será mais chamado.
+ */
+- (void)discardPendingFrames;
+
+/**
+ * Formato gerado quando um frame precisa de conversão
+ * (420f, 420v ou BGRA; padrão 420v). Com BGRA, buffers NV12 nativos
+ * fora dos formatos aceitos também são convertidos.
+ */
+@property (atomic, assign) OSType conversionPixelFormat;
+
+/**
+ * Tamanho de saída desejado. Zero mantém o tamanho do frame recebido.
+ * Frames de outro tamanho são recortados, escalados e convertidos em uma única passada.
+ */
+@property (atomic, assign) CGSize targetSize;
+
+/**
+ * Qualidade do redimensionamento (padrão bilinear).
+ */
+@property (atomic, assign) WebRTCScaleQuality scaleQuality;
+
+/**
+ * Encaixe quando a proporção do alvo difere da do frame (padrão: distorce).
+ */
+@property (atomic, assign) WebRTCAspectMode aspectMode;
+
+/**
+ * Região de interesse normalizada (0-1) usada pelo modo Fill.
+ * O recorte é a menor janela na proporção do alvo que a contém; o padrão (0,0,1,1) centraliza.
+ */
+@property (atomic, assign) CGRect regionOfInterest;
+
+/**
+ * Rotação extra (graus, sentido horário) somada à rotação de cada frame.
+ * Rotação e espelhamento viram uma única transformação; a identidade não custa nada.
+ */
+@property (atomic, assign) NSInteger outputRotation;
+
+/**
+ * Espelha horizontalmente a saída, depois da rotação.
+ */
+@property (atomic, assign) BOOL outputMirrored;
+
+/**
+ * Frames repassados sem cópia (CVPixelBuffer nativo).
+ */
+@property (nonatomic, readonly) uint64_t zeroCopyFrameCount;
+
+/**
+ * Frames que precisaram de conversão (I420 ou crop/escala).
+ */
+@property (nonatomic, readonly) uint64_t convertedFrameCount;
+
+/**
+ * Buffers de conversão reaproveitados do pool.
+ */
+@property (nonatomic, readonly) uint64_t poolHitCount;
+
+/**
+ * Buffers de conversão alocados pelo pool.
+ */
+@property (nonatomic, readonly) uint64_t poolMissCount;
+
+/**
+ * Contadores e latência por estágio do pipeline.
+ */
+@property (nonatomic, readonly) WebRTCPipelineStats pipelineStats;
+
+@end
+
+#endif /* WEBRTCFRAMERENDERER_H */
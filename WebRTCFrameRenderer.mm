@@ -0,0 +1,637 @@
+#import "WebRTCFrameRenderer.h"
+#include <pthread.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "AspectAdapter.h"
+#include "CVPixelBufferPoolBackend.h"
+#include "FramePipeline.h"
+#include "FrameScaler.h"
+#include "FrameTransform.h"
+#include "YUVConvert.h"
+#include "YUVToBGRA.h"
+
+// Frames esperando conversão; com mais que isso o mais antigo é descartado
+static const size_t kPipelineCapacity = 2;
+
+// Buffers do pool retidos ao mesmo tempo quando o consumidor não informa
+static const NSUInteger kDefaultBuffersInFlight = 6;
+
+// Sem buffer livre o aviso se repetiria a cada frame: loga o primeiro e depois 1 a cada N
+static const uint64_t kPoolExhaustedLogInterval = 300;
+
+static BOOL IsNV12Format(OSType format) {
+    return format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ||
+           format == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+}
+
+// Espaço de cor a partir dos attachments do CVPixelBuffer
+static vcam::YUVColorSpace ColorSpaceForPixelBuffer(CVPixelBufferRef pixelBuffer) {
+    CFTypeRef matrix = CVBufferGetAttachment(pixelBuffer, kCVImageBufferYCbCrMatrixKey, NULL);
+
+    vcam::YUVColorSpace colorSpace;
+    colorSpace.matrix = (matrix && CFEqual(matrix, kCVImageBufferYCbCrMatrix_ITU_R_709_2))
+        ? vcam::YUVMatrix::BT709 : vcam::YUVMatrix::BT601;
+    colorSpace.range = CVPixelBufferGetPixelFormatType(pixelBuffer) == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange
+        ? vcam::YUVRange::Full : vcam::YUVRange::Video;
+    return colorSpace;
+}
+
+static vcam::ScaleQuality ScaleQualityForRenderer(WebRTCScaleQuality quality) {
+    switch (quality) {
+        case WebRTCScaleQualityNearest:  return vcam::ScaleQuality::Nearest;
+        case WebRTCScaleQualityBox:      return vcam::ScaleQuality::Box;
+        case WebRTCScaleQualityLanczos3: return vcam::ScaleQuality::Lanczos3;
+        default:                         return vcam::ScaleQuality::Bilinear;
+    }
+}
+
+static vcam::AspectMode AspectModeForRenderer(WebRTCAspectMode mode) {
+    switch (mode) {
+        case WebRTCAspectModeFill: return vcam::AspectMode::Fill;
+        case WebRTCAspectModeFit:  return vcam::AspectMode::Fit;
+        default:                   return vcam::AspectMode::Stretch;
+    }
+}
+
+// I420 do WebRTC não traz attachments: BT.709 para HD, BT.601 para SD, faixa de vídeo
+static vcam::YUVColorSpace ColorSpaceForI420(id<RTCI420Buffer> i420) {
+    vcam::YUVColorSpace colorSpace;
+    colorSpace.matrix = i420.height >= 720 ? vcam::YUVMatrix::BT709 : vcam::YUVMatrix::BT601;
+    colorSpace.range = vcam::YUVRange::Video;
+    return colorSpace;
+}
+
+@implementation WebRTCFrameRenderer {
+    NSSet<NSNumber *> *_acceptedPixelFormats;
+    WebRTCFrameHandler _frameHandler;
+
+    // Buffer temporário reutilizado pelo cropAndScaleTo:withTempBuffer:
+    std::vector<uint8_t> _scaleTempBuffer;
+
+    // Pool reciclável para os buffers convertidos
+    std::unique_ptr<vcam::PixelBufferPool> _pool;
+
+    // Decoder -> fila limitada -> thread de conversão
+    std::unique_ptr<vcam::FramePipeline<RTCVideoFrame *>> _pipeline;
+
+    // Recorte + escala + conversão em passada única (só na thread de conversão)
+    vcam::FrameScaler _scaler;
+
+    // Recorte/faixas por geometria, recalculados só quando algo muda
+    vcam::AspectAdapter _aspect;
+
+    // NV12 intermediários das rotações de 90/270 (antes e depois da transposição)
+    std::vector<uint8_t> _orientedScratch;
+    std::vector<uint8_t> _rotatedScratch;
+
+    std::atomic<uint64_t> _zeroCopyFrameCount;
+    std::atomic<uint64_t> _convertedFrameCount;
+
+    // Frames descartados por falta de buffer no pool (só na thread de conversão)
+    uint64_t _poolExhaustedCount;
+}
+
+- (instancetype)initWithAcceptedPixelFormats:(NSSet<NSNumber *> *)pixelFormats
+                                frameHandler:(WebRTCFrameHandler)handler {
+    return [self initWithAcceptedPixelFormats:pixelFormats maxBuffersInFlight:kDefaultBuffersInFlight frameHandler:handler];
+}
+
+- (instancetype)initWithAcceptedPixelFormats:(NSSet<NSNumber *> *)pixelFormats
+                          maxBuffersInFlight:(NSUInteger)maxBuffersInFlight
+                                frameHandler:(WebRTCFrameHandler)handler {
+    self = [super init];
+    if (self) {
+        _acceptedPixelFormats = [pixelFormats copy];
+        _frameHandler = [handler copy];
+        _zeroCopyFrameCount = 0;
+        _convertedFrameCount = 0;
+        _conversionPixelFormat = kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+        _targetSize = CGSizeZero;
+        _scaleQuality = WebRTCScaleQualityBilinear;
+        _outputRotation = 0;
+        _outputMirrored = NO;
+        _aspectMode = WebRTCAspectModeStretch;
+        _regionOfInterest = CGRectMake(0, 0, 1, 1);
+        _pool.reset(new vcam::PixelBufferPool(std::unique_ptr<vcam::PoolBackend>(new vcam::CVPixelBufferPoolBackend()),
+                                              MAX(maxBuffersInFlight, (NSUInteger)1)));
+        _poolExhaustedCount = 0;
+
+        __weak typeof(self) weakSelf = self;
+        _pipeline.reset(new vcam::FramePipeline<RTCVideoFrame *>(kPipelineCapacity, [weakSelf](RTCVideoFrame *&frame) {
+            @autoreleasepool {
+                [weakSelf processFrame:frame];
+            }
+        }, [] {
+            pthread_setname_np("com.vcam.webrtc.convert");
+            pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+        }));
+        _pipeline->start();
+    }
+    return self;
+}
+
+- (uint64_t)zeroCopyFrameCount {
+    return _zeroCopyFrameCount.load(std::memory_order_relaxed);
+}
+
+- (uint64_t)convertedFrameCount {
+    return _convertedFrameCount.load(std::memory_order_relaxed);
+}
+
+- (uint64_t)poolHitCount {
+    return _pool->stats().hits;
+}
+
+- (uint64_t)poolMissCount {
+    return _pool->stats().misses;
+}
+
+- (void)resetCounters {
+    _zeroCopyFrameCount = 0;
+    _convertedFrameCount = 0;
+    _pipeline->resetStats();
+}
+
+- (void)discardPendingFrames {
+    _pipeline->stop();
+    _pipeline->start();
+}
+
+- (WebRTCPipelineStats)pipelineStats {
+    vcam::FramePipelineStats stats = _pipeline->stats();
+    WebRTCPipelineStats result;
+    result.submitted = stats.submitted;
+    result.processed = stats.processed;
+    result.dropped = stats.dropped;
+    result.maxDepth = stats.maxDepth;
+    result.queueAverageMs = stats.processed > 0 ? stats.queueNsTotal / 1e6 / stats.processed : 0;
+    result.queueMaxMs = stats.queueNsMax / 1e6;
+    result.workAverageMs = stats.processed > 0 ? stats.workNsTotal / 1e6 / stats.processed : 0;
+    result.workMaxMs = stats.workNsMax / 1e6;
+    return result;
+}
+
+#pragma mark - RTCVideoRenderer
+
+- (void)setSize:(CGSize)size {
+    NSLog(@"[WebRTCFrameRenderer] Tamanho do stream: %.0fx%.0f", size.width, size.height);
+}
+
+// Thread do decoder: só enfileira
+- (void)renderFrame:(RTCVideoFrame *)frame {
+    if (!frame || !_frameHandler) {
+        return;
+    }
+    _pipeline->submit(frame);
+}
+
+// Thread de conversão
+- (void)processFrame:(RTCVideoFrame *)frame {
+    if (!frame) {
+        return;
+    }
+
+    id<RTCVideoFrameBuffer> buffer = frame.buffer;
+    OSType conversionFormat = self.conversionPixelFormat;
+    vcam::FrameTransform transform = vcam::FrameTransform::compose((int)frame.rotation,
+                                                                   (int)self.outputRotation,
+                                                                   self.outputMirrored);
+    BOOL swapsAxes = transform.swapsAxes();
+
+    CGSize targetSize = self.targetSize;
+    BOOL hasTarget = targetSize.width >= 2 && targetSize.height >= 2;
+
+    // Tamanho final, já rotacionado. Dimensões pares: o NV12 de saída precisa de crominância inteira
+    int outputWidth = hasTarget ? ((int)targetSize.width & ~1) : (swapsAxes ? buffer.height : buffer.width);
+    int outputHeight = hasTarget ? ((int)targetSize.height & ~1) : (swapsAxes ? buffer.width : buffer.height);
+
+    // Tamanho na orientação da origem, usado para decidir se há escala
+    int targetWidth = swapsAxes ? outputHeight : outputWidth;
+    int targetHeight = swapsAxes ? outputWidth : outputHeight;
+
+    if ([buffer isKindOfClass:[RTCCVPixelBuffer class]]) {
+        RTCCVPixelBuffer *cvBuffer = (RTCCVPixelBuffer *)buffer;
+        OSType format = CVPixelBufferGetPixelFormatType(cvBuffer.pixelBuffer);
+        BOOL accepted = [_acceptedPixelFormats containsObject:@(format)];
+        BOOL needsResample = [cvBuffer requiresCropping] ||
+                             [cvBuffer requiresScalingToWidth:targetWidth height:targetHeight];
+
+        // Caminho sem cópia: CVPixelBuffer nativo, sem crop/escala/rotação, em formato aceito
+        if (accepted && !needsResample && transform.isIdentity()) {
+            _zeroCopyFrameCount.fetch_add(1, std::memory_order_relaxed);
+            _frameHandler(cvBuffer.pixelBuffer, frame);
+            return;
+        }
+
+        if (!needsResample && transform.isIdentity() && IsNV12Format(format) && conversionFormat == kCVPixelFormatType_32BGRA) {
+            [self deliverConvertedBuffer:[self copyBGRABufferFromNV12:cvBuffer.pixelBuffer] frame:frame];
+            return;
+        }
+
+        // NV12 nativo com crop/escala/rotação: passada única, sem I420 intermediário
+        if (IsNV12Format(format)) {
+            [self deliverConvertedBuffer:[self copyScaledBufferFromNV12:cvBuffer
+                                                                 format:accepted ? format : conversionFormat
+                                                                  width:outputWidth
+                                                                 height:outputHeight
+                                                              transform:transform]
+                                   frame:frame];
+            return;
+        }
+
+        // Demais formatos nativos (os decoders do iOS entregam NV12) seguem sem rotação
+
+        [self deliverConvertedBuffer:[self copyCroppedAndScaledBuffer:cvBuffer
+                                                               format:accepted ? format : kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange
+                                                                width:targetWidth
+                                                               height:targetHeight]
+                               frame:frame];
+        return;
+    }
+
+    // Caminho de conversão: qualquer outro buffer é lido como I420
+    id<RTCI420Buffer> i420 = [buffer toI420];
+    if (i420 && (targetWidth != i420.width || targetHeight != i420.height || !transform.isIdentity())) {
+        [self deliverConvertedBuffer:[self copyScaledBufferFromI420:i420
+                                                             format:conversionFormat
+                                                              width:outputWidth
+                                                             height:outputHeight
+                                                          transform:transform]
+                               frame:frame];
+    } else if (conversionFormat == kCVPixelFormatType_32BGRA) {
+        [self deliverConvertedBuffer:[self copyBGRABufferFromI420:i420] frame:frame];
+    } else {
+        [self deliverConvertedBuffer:[self copyNV12BufferFromI420:i420 format:conversionFormat] frame:frame];
+    }
+}
+
+- (void)deliverConvertedBuffer:(CVPixelBufferRef)converted frame:(RTCVideoFrame *)frame {
+    if (converted) {
+        _convertedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        _frameHandler(converted, frame);
+        CVPixelBufferRelease(converted);
+    }
+}
+
+#pragma mark - Conversão
+
+- (CVPixelBufferRef)copyCroppedAndScaledBuffer:(RTCCVPixelBuffer *)buffer
+                                         format:(OSType)format
+                                          width:(int)width
+                                         height:(int)height {
+    CVPixelBufferRef output = [self createPixelBufferWithFormat:format width:width height:height];
+    if (!output) {
+        return NULL;
+    }
+
+    int tempSize = [buffer bufferSizeForCroppingAndScalingToWidth:width height:height];
+    if (tempSize > 0 && _scaleTempBuffer.size() < (size_t)tempSize) {
+        _scaleTempBuffer.resize(tempSize);
+    }
+
+    if (![buffer cropAndScaleTo:output withTempBuffer:tempSize > 0 ? _scaleTempBuffer.data() : NULL]) {
+        NSLog(@"[WebRTCFrameRenderer] Falha ao recortar/escalar buffer");
+        CVPixelBufferRelease(output);
+        return NULL;
+    }
+    return output;
+}
+
+- (CVPixelBufferRef)copyScaledBufferFromNV12:(RTCCVPixelBuffer *)buffer
+                                      format:(OSType)format
+                                       width:(int)width
+                                      height:(int)height
+                                   transform:(const vcam::FrameTransform &)transform {
+    CVPixelBufferRef source = buffer.pixelBuffer;
+    CVPixelBufferLockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+
+    vcam::NV12Source planes = {
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 0),
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 1),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 0),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 1),
+        (int)CVPixelBufferGetWidth(source),
+        (int)CVPixelBufferGetHeight(source)
+    };
+    vcam::CropRect crop = { buffer.cropX, buffer.cropY, buffer.cropWidth, buffer.cropHeight };
+
+    CVPixelBufferRef output = [self copyScaledBufferFromSource:vcam::YUVSource::fromNV12(planes, ColorSpaceForPixelBuffer(source))
+                                                          crop:crop
+                                                        format:format
+                                                         width:width
+                                                        height:height
+                                                     transform:transform];
+
+    CVPixelBufferUnlockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+    return output;
+}
+
+- (CVPixelBufferRef)copyScaledBufferFromI420:(id<RTCI420Buffer>)i420
+                                      format:(OSType)format
+                                       width:(int)width
+                                      height:(int)height
+                                   transform:(const vcam::FrameTransform &)transform {
+    vcam::I420Planes planes = {
+        i420.dataY, i420.dataU, i420.dataV,
+        i420.strideY, i420.strideU, i420.strideV,
+        i420.width, i420.height
+    };
+    vcam::CropRect crop = { 0, 0, i420.width, i420.height };
+
+    return [self copyScaledBufferFromSource:vcam::YUVSource::fromI420(planes, ColorSpaceForI420(i420))
+                                       crop:crop
+                                     format:format
+                                      width:width
+                                     height:height
+                                  transform:transform];
+}
+
+// Origem já travada pelo chamador; saída em BGRA ou NV12 (420v se o formato não for 420f).
+// width/height são as dimensões finais, já rotacionadas
+- (CVPixelBufferRef)copyScaledBufferFromSource:(const vcam::YUVSource &)source
+                                          crop:(const vcam::CropRect &)crop
+                                        format:(OSType)format
+                                         width:(int)width
+                                        height:(int)height
+                                     transform:(const vcam::FrameTransform &)transform {
+    if (format != kCVPixelFormatType_32BGRA && format != kCVPixelFormatType_420YpCbCr8BiPlanarFullRange) {
+        format = kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+    }
+
+    CVPixelBufferRef output = [self createPixelBufferWithFormat:format width:width height:height];
+    if (!output) {
+        return NULL;
+    }
+
+    CVPixelBufferLockBaseAddress(output, 0);
+
+    if (transform.swapsAxes()) {
+        bool ok = [self writeTransposedFrom:source crop:crop output:output format:format transform:transform];
+        CVPixelBufferUnlockBaseAddress(output, 0);
+        if (!ok) {
+            NSLog(@"[WebRTCFrameRenderer] Geometria inválida para rotação: %dx%d", width, height);
+            CVPixelBufferRelease(output);
+            return NULL;
+        }
+        return output;
+    }
+
+    // 180° e espelhos entram no próprio scaler
+    vcam::AxisMapping mapping = transform.axisMapping();
+    vcam::ScaleTarget target;
+    target.width = width;
+    target.height = height;
+    target.range = format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange ? vcam::YUVRange::Full : vcam::YUVRange::Video;
+    if (format == kCVPixelFormatType_32BGRA) {
+        target.format = vcam::ScaleTarget::BGRA;
+        target.y = (uint8_t *)CVPixelBufferGetBaseAddress(output);
+        target.uv = NULL;
+        target.strideY = (int)CVPixelBufferGetBytesPerRow(output);
+        target.strideUV = 0;
+    } else {
+        target.format = vcam::ScaleTarget::NV12;
+        target.y = (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 0);
+        target.uv = (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 1);
+        target.strideY = (int)CVPixelBufferGetBytesPerRowOfPlane(output, 0);
+        target.strideUV = (int)CVPixelBufferGetBytesPerRowOfPlane(output, 1);
+    }
+    target.flipX = mapping.flipX;
+    target.flipY = mapping.flipY;
+
+    bool ok = [self scaleSource:source crop:crop target:target];
+
+    CVPixelBufferUnlockBaseAddress(output, 0);
+
+    if (!ok) {
+        NSLog(@"[WebRTCFrameRenderer] Geometria inválida para escala: %dx%d", width, height);
+        CVPixelBufferRelease(output);
+        return NULL;
+    }
+    return output;
+}
+
+// 90/270: NV12 na orientação da origem (a própria origem quando não há escala) e transposição em tiles
+- (bool)writeTransposedFrom:(const vcam::YUVSource &)source
+                       crop:(const vcam::CropRect &)crop
+                     output:(CVPixelBufferRef)output
+                     format:(OSType)format
+                  transform:(const vcam::FrameTransform &)transform {
+    int width = (int)CVPixelBufferGetWidth(output);
+    int height = (int)CVPixelBufferGetHeight(output);
+    int orientedWidth = height;
+    int orientedHeight = width;
+
+    vcam::YUVRange range = source.colorSpace.range;
+    if (format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange) {
+        range = vcam::YUVRange::Full;
+    } else if (format == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange) {
+        range = vcam::YUVRange::Video;
+    }
+
+    const vcam::AspectLayout &layout = [self aspectLayoutForCrop:crop width:orientedWidth height:orientedHeight];
+    const vcam::CropRect &region = layout.crop;
+
+    vcam::NV12Source oriented;
+    bool direct = source.isInterleaved() && source.colorSpace.range == range &&
+                  !layout.hasBars(orientedWidth, orientedHeight) &&
+                  region.x % 2 == 0 && region.y % 2 == 0 &&
+                  region.width == orientedWidth && region.height == orientedHeight;
+    if (direct) {
+        oriented.y = source.y + (size_t)region.y * source.strideY + region.x;
+        oriented.uv = source.u + (size_t)(region.y / 2) * source.strideU + region.x;
+        oriented.strideY = source.strideY;
+        oriented.strideUV = source.strideU;
+    } else {
+        int strideY = orientedWidth;
+        int strideUV = ((orientedWidth + 1) / 2) * 2;
+        size_t lumaSize = (size_t)strideY * orientedHeight;
+        _orientedScratch.resize(lumaSize + (size_t)strideUV * ((orientedHeight + 1) / 2));
+
+        vcam::ScaleTarget target;
+        target.format = vcam::ScaleTarget::NV12;
+        target.y = _orientedScratch.data();
+        target.uv = _orientedScratch.data() + lumaSize;
+        target.strideY = strideY;
+        target.strideUV = strideUV;
+        target.width = orientedWidth;
+        target.height = orientedHeight;
+        target.range = range;
+        target.flipX = false;
+        target.flipY = false;
+        if (![self scaleSource:source crop:crop target:target]) {
+            return false;
+        }
+
+        oriented.y = target.y;
+        oriented.uv = target.uv;
+        oriented.strideY = strideY;
+        oriented.strideUV = strideUV;
+    }
+    oriented.width = orientedWidth;
+    oriented.height = orientedHeight;
+
+    if (format != kCVPixelFormatType_32BGRA) {
+        vcam::NV12Planes dst = {
+            (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 0),
+            (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 1),
+            (int)CVPixelBufferGetBytesPerRowOfPlane(output, 0),
+            (int)CVPixelBufferGetBytesPerRowOfPlane(output, 1)
+        };
+        vcam::TransformNV12(oriented, dst, transform);
+        return true;
+    }
+
+    // BGRA: transpõe em NV12 (1,5 byte/pixel) e converte depois
+    int strideUV = ((width + 1) / 2) * 2;
+    size_t lumaSize = (size_t)width * height;
+    _rotatedScratch.resize(lumaSize + (size_t)strideUV * ((height + 1) / 2));
+
+    vcam::NV12Planes rotated = { _rotatedScratch.data(), _rotatedScratch.data() + lumaSize, width, strideUV };
+    vcam::TransformNV12(oriented, rotated, transform);
+
+    vcam::NV12Source rotatedSource = { rotated.y, rotated.uv, rotated.strideY, rotated.strideUV, width, height };
+    vcam::YUVColorSpace colorSpace = { source.colorSpace.matrix, range };
+    vcam::BGRAPlane dst = {
+        (uint8_t *)CVPixelBufferGetBaseAddress(output),
+        (int)CVPixelBufferGetBytesPerRow(output)
+    };
+    vcam::ConvertNV12ToBGRA(rotatedSource, colorSpace, dst);
+    return true;
+}
+
+- (const vcam::AspectLayout &)aspectLayoutForCrop:(const vcam::CropRect &)crop width:(int)width height:(int)height {
+    CGRect roi = self.regionOfInterest;
+    vcam::NormalizedRect region = {
+        (float)roi.origin.x, (float)roi.origin.y, (float)roi.size.width, (float)roi.size.height
+    };
+    return _aspect.layout(crop, width, height, AspectModeForRenderer(self.aspectMode), region);
+}
+
+// Faixas pretas fora da área útil; recorte da proporção aplicado pelo próprio scaler
+- (bool)scaleSource:(const vcam::YUVSource &)source crop:(const vcam::CropRect &)crop target:(vcam::ScaleTarget)target {
+    const vcam::AspectLayout &layout = [self aspectLayoutForCrop:crop width:target.width height:target.height];
+
+    if (layout.hasBars(target.width, target.height)) {
+        const vcam::CropRect &content = layout.content;
+        if (target.format == vcam::ScaleTarget::BGRA) {
+            vcam::BGRAPlane plane = { target.y, target.strideY };
+            vcam::FillBGRABars(plane, target.width, target.height, content);
+            target.y += (size_t)content.y * target.strideY + (size_t)content.x * 4;
+        } else {
+            vcam::NV12Planes planes = { target.y, target.uv, target.strideY, target.strideUV };
+            vcam::FillNV12Bars(planes, target.width, target.height, content, target.range);
+            target.y += (size_t)content.y * target.strideY + content.x;
+            target.uv += (size_t)(content.y / 2) * target.strideUV + content.x;
+        }
+        target.width = content.width;
+        target.height = content.height;
+    }
+
+    return _scaler.process(source, layout.crop, target, ScaleQualityForRenderer(self.scaleQuality));
+}
+
+- (CVPixelBufferRef)copyNV12BufferFromI420:(id<RTCI420Buffer>)i420 format:(OSType)format {
+    if (!i420) {
+        return NULL;
+    }
+
+    if (format != kCVPixelFormatType_420YpCbCr8BiPlanarFullRange) {
+        format = kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+    }
+
+    CVPixelBufferRef output = [self createPixelBufferWithFormat:format width:i420.width height:i420.height];
+    if (!output) {
+        return NULL;
+    }
+
+    CVPixelBufferLockBaseAddress(output, 0);
+
+    vcam::I420Planes src = {
+        i420.dataY, i420.dataU, i420.dataV,
+        i420.strideY, i420.strideU, i420.strideV,
+        i420.width, i420.height
+    };
+    vcam::NV12Planes dst = {
+        (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 0),
+        (uint8_t *)CVPixelBufferGetBaseAddressOfPlane(output, 1),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(output, 0),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(output, 1)
+    };
+
+    // I420 do decoder usa faixa de vídeo (16-235); 420f exige expansão
+    vcam::YUVRange dstRange = format == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange
+        ? vcam::YUVRange::Full : vcam::YUVRange::Video;
+    vcam::ConvertI420ToNV12(src, vcam::YUVRange::Video, dst, dstRange);
+
+    CVPixelBufferUnlockBaseAddress(output, 0);
+    return output;
+}
+
+- (CVPixelBufferRef)copyBGRABufferFromI420:(id<RTCI420Buffer>)i420 {
+    if (!i420) {
+        return NULL;
+    }
+
+    CVPixelBufferRef output = [self createPixelBufferWithFormat:kCVPixelFormatType_32BGRA width:i420.width height:i420.height];
+    if (!output) {
+        return NULL;
+    }
+
+    CVPixelBufferLockBaseAddress(output, 0);
+
+    vcam::I420Planes src = {
+        i420.dataY, i420.dataU, i420.dataV,
+        i420.strideY, i420.strideU, i420.strideV,
+        i420.width, i420.height
+    };
+    vcam::BGRAPlane dst = {
+        (uint8_t *)CVPixelBufferGetBaseAddress(output),
+        (int)CVPixelBufferGetBytesPerRow(output)
+    };
+    vcam::ConvertI420ToBGRA(src, ColorSpaceForI420(i420), dst);
+
+    CVPixelBufferUnlockBaseAddress(output, 0);
+    return output;
+}
+
+- (CVPixelBufferRef)copyBGRABufferFromNV12:(CVPixelBufferRef)source {
+    int width = (int)CVPixelBufferGetWidth(source);
+    int height = (int)CVPixelBufferGetHeight(source);
+
+    CVPixelBufferRef output = [self createPixelBufferWithFormat:kCVPixelFormatType_32BGRA width:width height:height];
+    if (!output) {
+        return NULL;
+    }
+
+    CVPixelBufferLockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+    CVPixelBufferLockBaseAddress(output, 0);
+
+    vcam::NV12Source src = {
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 0),
+        (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(source, 1),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 0),
+        (int)CVPixelBufferGetBytesPerRowOfPlane(source, 1),
+        width, height
+    };
+    vcam::BGRAPlane dst = {
+        (uint8_t *)CVPixelBufferGetBaseAddress(output),
+        (int)CVPixelBufferGetBytesPerRow(output)
+    };
+    vcam::ConvertNV12ToBGRA(src, ColorSpaceForPixelBuffer(source), dst);
+
+    CVPixelBufferUnlockBaseAddress(output, 0);
+    CVPixelBufferUnlockBaseAddress(source, kCVPixelBufferLock_ReadOnly);
+    return output;
+}
+
+- (CVPixelBufferRef)createPixelBufferWithFormat:(OSType)format width:(int)width height:(int)height {
+    CVPixelBufferRef pixelBuffer = vcam::CreatePooledPixelBuffer(*_pool, format, width, height);
+    if (!pixelBuffer && _poolExhaustedCount++ % kPoolExhaustedLogInterval == 0) {
+        NSLog(@"[WebRTCFrameRenderer] Pool sem buffer livre para %dx%d (limite %zu), frames descartados: %llu",
+              width, height, _pool->highWaterMark(), _poolExhaustedCount);
+    }
+    return pixelBuffer;
+}
+
+@end
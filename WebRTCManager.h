@@ -12,7 +12,7 @@
  * Classe responsável por gerenciar conexões WebRTC.
  * Versão simplificada otimizada para VCamWebRTC.
  */
-@interface WebRTCManager : NSObject <RTCPeerConnectionDelegate, NSURLSessionWebSocketDelegate>
+@interface WebRTCManager : NSObject <RTCPeerConnectionDelegate, RTCRtpReceiverDelegate, NSURLSessionWebSocketDelegate>
 
 /**
  * Obtém a instância compartilhada (singleton).
@@ -20,7 +20,8 @@
 + (instancetype)sharedInstance;
 
 /**
- * Inicia a conexão WebRTC com o servidor.
+ * Inicia a conexão WebRTC com o servidor. Retorna logo: sinalização, JSON e
+ * transições de estado rodam numa fila serial própria, fora da main thread.
  * @param serverIP Endereço IP do servidor WebRTC
  */
 - (void)startWebRTCWithServer:(NSString *)serverIP;
@@ -31,16 +32,33 @@
 - (void)startWebRTC;
 
 /**
- * Encerra a conexão WebRTC.
+ * Encerra a conexão WebRTC (assíncrono, na fila de sinalização).
  */
 - (void)stopWebRTC;
 
+/**
+ * Cria a fábrica de conexões em segundo plano, antes de ela ser necessária, e,
+ * com speculativePeerConnection, uma conexão reserva. Pode ser chamado várias vezes;
+ * a fábrica é criada uma vez e mantida entre sessões.
+ */
+- (void)prewarm;
+
 /**
  * Obtém o último frame como CMSampleBuffer para substituição da câmera.
  * @return CMSampleBufferRef formatado para compatibilidade com câmera nativa
  */
 - (CMSampleBufferRef)getLatestVideoSampleBuffer;
 
+/**
+ * Obtém o último frame no formato pedido. O CMSampleBuffer é o mesmo para
+ * todos os consumidores do frame; a conversão de formato é feita uma vez por frame.
+ * PTS e duração já vêm no relógio do host (ver ClockBridge.h).
+ * @param pixelFormat Formato desejado (0 = formato publicado pelo renderer)
+ * @param frameId Recebe o id crescente do frame (opcional), útil para pular repetidos
+ * @return CMSampleBufferRef retido (chamar CFRelease) ou NULL
+ */
+- (CMSampleBufferRef)getLatestVideoSampleBufferInFormat:(OSType)pixelFormat frameId:(uint64_t *)frameId;
+
 /**
  * Versão aprimorada que permite aplicar metadados da câmera original
  * ao buffer criado pelo WebRTC para uma substituição perfeita
@@ -50,6 +68,37 @@
  */
 - (CMSampleBufferRef)getLatestVideoSampleBufferWithOriginalMetadata:(CMSampleBufferRef)originalBuffer;
 
+/**
+ * Frame substituto para uma chamada da câmera, no ritmo da câmera: frame novo,
+ * repetição do anterior ou nenhum (ver CadenceMatcher.h). O timing é o do buffer
+ * da câmera, então os PTS entregues ficam uniformes qualquer que seja a taxa do stream,
+ * e os attachments propagáveis dele (EXIF, intrínsecos) são copiados.
+ * @param cameraBuffer Buffer original da câmera
+ * @param dropped Recebe YES quando a chamada deve ser descartada em vez de usar o buffer original
+ * @return CMSampleBufferRef retido (chamar CFRelease) ou NULL
+ */
+- (CMSampleBufferRef)getConformedSampleBufferForCameraBuffer:(CMSampleBufferRef)cameraBuffer dropped:(BOOL *)dropped;
+
+/**
+ * Como getConformedSampleBufferForCameraBuffer:dropped:, para um output específico.
+ * Cada output tem cadência própria e recebe o frame no formato pedido em
+ * setVideoSettings:forOutput: e no tamanho do seu buffer nativo. A conversão é
+ * feita uma vez por formato/tamanho distinto por frame, na publicação do frame
+ * (fora da fila da câmera), e compartilhada entre os outputs iguais; aqui a
+ * visão é só consultada. Um formato novo descarta as chamadas até o próximo
+ * frame publicado. O maior buffer nativo entre os outputs define a resolução alvo.
+ * Deve ser chamado a cada frame com a substituição ativa, mesmo sem stream.
+ */
+- (CMSampleBufferRef)getConformedSampleBufferForCameraBuffer:(CMSampleBufferRef)cameraBuffer
+                                                      output:(AVCaptureOutput *)output
+                                                     dropped:(BOOL *)dropped;
+
+/**
+ * Registra os videoSettings pedidos por um AVCaptureVideoDataOutput
+ * (kCVPixelBufferPixelFormatTypeKey, largura e altura). nil volta ao formato nativo.
+ */
+- (void)setVideoSettings:(NSDictionary *)videoSettings forOutput:(AVCaptureOutput *)output;
+
 /**
  * Adapta-se à câmera nativa com a posição especificada.
  * @param position Posição da câmera (frontal/traseira).
@@ -90,12 +139,123 @@
 @property (nonatomic, assign, readonly) BOOL isReceivingFrames;
 
 /**
- * Estado atual da conexão.
+ * Atraso de playout em segundos (0 a 0.15). Com 0 os frames são publicados assim
+ * que decodificados (menor latência); acima disso passam por uma fila ordenada por
+ * PTS que absorve o jitter da rede. Padrão: 0.
+ */
+@property (nonatomic, assign) NSTimeInterval playoutDelay;
+
+/**
+ * Se YES, o atraso acompanha o jitter de chegada medido, com playoutDelay como teto.
+ */
+@property (nonatomic, assign) BOOL adaptivePlayoutDelay;
+
+/**
+ * Frames aguardando na fila de playout.
+ */
+@property (nonatomic, readonly) NSUInteger playoutDepth;
+
+/**
+ * Atraso de playout em uso, em segundos (0 quando a fila está desligada).
+ */
+@property (nonatomic, readonly) NSTimeInterval currentPlayoutDelay;
+
+/**
+ * Camada de preview alimentada a cada frame publicado, numa fila própria e com
+ * kCMSampleAttachmentKey_DisplayImmediately; acompanha a taxa do stream (até 60 fps).
+ * A contrapressão vem de readyForMoreMediaData. nil desliga o preview.
+ */
+@property (atomic, strong) AVSampleBufferDisplayLayer *previewLayer;
+
+/**
+ * Lê o código de timestamp gravado pelo emissor (ver TimestampCode.h) e envia
+ * p50/p95/p99 da latência glass-to-glass pelo canal de estatísticas. Também
+ * ligado/desligado pelo servidor com a mensagem "latency-probe".
+ */
+@property (nonatomic, assign) BOOL latencyProbeEnabled;
+
+/**
+ * Chamadas da câmera atendidas com o frame anterior (stream mais lento que a câmera), por sessão.
+ * Este e os três contadores seguintes são somados entre os outputs.
+ */
+@property (nonatomic, readonly) uint64_t repeatedFrameCount;
+
+/**
+ * Frames do stream nunca entregues (stream mais rápido que a câmera), por sessão.
+ */
+@property (nonatomic, readonly) uint64_t droppedFrameCount;
+
+/**
+ * Chamadas da câmera descartadas por falta de frame, por sessão.
+ */
+@property (nonatomic, readonly) uint64_t droppedCallbackCount;
+
+/**
+ * Repetições com o stream parado (sem frame novo há mais de 500 ms), por sessão;
+ * já incluídas em repeatedFrameCount.
+ */
+@property (nonatomic, readonly) uint64_t stalledCallbackCount;
+
+/**
+ * Outputs de captura vistos desde a conexão.
+ */
+@property (nonatomic, readonly) NSUInteger captureOutputCount;
+
+/**
+ * Entregas em formato ou tamanho diferente do frame publicado, por sessão.
+ */
+@property (nonatomic, readonly) uint64_t formatRequestCount;
+
+/**
+ * Conversões de fato executadas para essas entregas, por sessão.
+ */
+@property (nonatomic, readonly) uint64_t formatConversionCount;
+
+/**
+ * Entregas servidas por conversão (formatRequestCount / formatConversionCount);
+ * 1 sem compartilhamento, N com N outputs no mesmo formato. 0 sem conversões.
+ */
+@property (nonatomic, readonly) double formatDeduplicationRatio;
+
+/**
+ * Reconexões da sinalização (WebSocket) desde o início da sessão. A conexão
+ * de mídia continua pelo ICE enquanto o WebSocket reconecta.
+ */
+@property (nonatomic, readonly) NSUInteger signalingReconnectCount;
+
+/**
+ * Duração da última queda da sinalização, em segundos (0 se nunca caiu).
+ */
+@property (nonatomic, readonly) NSTimeInterval lastSignalingOutage;
+
+/**
+ * restartIce executados após falha do ICE desde o início da sessão.
+ */
+@property (nonatomic, readonly) NSUInteger iceRestartCount;
+
+/**
+ * Se YES, prewarm também cria uma conexão com candidatos ICE pré-coletados,
+ * usada pela próxima sessão se iniciada em até 30 s. Padrão: NO.
+ */
+@property (nonatomic, assign) BOOL speculativePeerConnection;
+
+/**
+ * Tempo do início da sessão até o primeiro frame decodificado, em segundos
+ * (0 até o primeiro frame). O resumo de estabelecimento no log e no canal de
+ * estatísticas detalha as fases (ver SetupProfile.h) e separa fábrica
+ * pronta/fria e conexão especulativa/nova.
+ */
+@property (nonatomic, readonly) NSTimeInterval timeToFirstFrame;
+
+/**
+ * Estado atual da conexão, legível de qualquer thread. Muda só por transições
+ * válidas: depois de encerrada, só um novo início tira a conexão de desconectada.
  */
 @property (nonatomic, assign, readonly) int connectionState;
 
 /**
- * Callback para atualização de status.
+ * Callback para atualização de status, chamado na main thread. É o único
+ * trabalho do WebRTCManager na main; o tempo gasto nele vai para o log do fim da sessão.
  */
 @property (nonatomic, copy) void (^statusUpdateCallback)(NSString *status);
 
@@ -0,0 +1,2451 @@
+#import "WebRTCManager.h"
+#import "WebRTCFrameRenderer.h"
+#include "CFHandle.h"
+#include "FrameSlot.h"
+#include "CVPixelBufferPoolBackend.h"
+#include "SampleBufferFactory.h"
+#include "SharedFrame.h"
+#include "ClockBridge.h"
+#include "CadenceMatcher.h"
+#include "PlayoutBuffer.h"
+#include "TimestampCode.h"
+#include "LatencyHistogram.h"
+#include "AttachmentPropagator.h"
+#include "HotPathState.h"
+#include "SignalingCodec.h"
+#include "SetupProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Enum para estados de conexão
+typedef NS_ENUM(int, WebRTCConnectionState) {
+    WebRTCConnectionStateDisconnected = 0,
+    WebRTCConnectionStateConnecting,
+    WebRTCConnectionStateConnected,
+    WebRTCConnectionStateError
+};
+
+// Estado de um AVCaptureVideoDataOutput: formato pedido, tamanho nativo e cadência próprios
+struct CaptureOutputState {
+    __weak AVCaptureOutput *output;                  // detecta endereço reaproveitado por outro output
+    vcam::FrameFormat requested = { 0, 0, 0 };      // videoSettings; zeros = o do buffer nativo
+    CMVideoDimensions cameraDimensions = { 0, 0 };  // último buffer nativo entregue a este output
+    vcam::FrameFormat conformed = { 0, 0, 0 };      // formato entregue; as visões são produzidas na publicação
+    vcam::CadenceMatcher cadence;
+};
+
+typedef std::unordered_map<const void *, CaptureOutputState> CaptureOutputMap;
+
+// Conteúdo do FrameSlot: o frame mais recente e o publicado antes dele, com os
+// instantes de publicação, para o CadenceMatcher poder segurar um frame que
+// chegou colado à chamada da câmera e entregar o anterior
+struct PublishedFrames {
+    vcam::SharedFrameRef latest;
+    vcam::SharedFrameRef previous;
+    int64_t latestNs = 0;
+    int64_t previousNs = 0;
+
+    explicit operator bool() const {
+        return static_cast<bool>(latest);
+    }
+};
+
+// Buffers convertidos pelo renderer que podem estar retidos ao mesmo tempo: a fila de
+// playout cheia, os slots do FrameSlot mais o anterior do slot mais antigo, o frame
+// em conversão e dois consumidores (fila da câmera e preview) ainda segurando um frame anterior
+static const NSUInteger kRendererBuffersInFlight =
+    vcam::PlayoutBuffer<vcam::SharedFrameRef>::kDefaultMaxDepth +
+    vcam::FrameSlot<PublishedFrames>::kSlotCount + 1 + 1 + 2;
+
+// Buffers de visão retidos ao mesmo tempo por formato: as visões são produzidas na
+// publicação, então só frames fora da fila de playout as têm (mesma conta acima)
+static const size_t kViewBuffersInFlight = vcam::FrameSlot<PublishedFrames>::kSlotCount + 1 + 1 + 2;
+
+// Com o mutex dos outputs travado; output novo no endereço de um já liberado recomeça do zero
+static CaptureOutputState &StateForOutput(CaptureOutputMap &outputs, AVCaptureOutput *output) {
+    const void *key = (__bridge const void *)output;
+    auto it = outputs.find(key);
+    if (it != outputs.end() && it->second.output != output) {
+        outputs.erase(it);
+        it = outputs.end();
+    }
+    if (it == outputs.end()) {
+        it = outputs.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+        it->second.output = output;
+    }
+    return it->second;
+}
+
+@interface WebRTCManager () {
+    // Frame mais recente, publicado sem locks (ver FrameSlot.h) e compartilhado por todos os consumidores
+    vcam::FrameSlot<PublishedFrames> _frameSlot;
+    std::atomic<uint64_t> _nextFrameId;
+
+    // Serializa os produtores do slot: decoder e, com atraso, a fila de playout
+    std::mutex _publishMutex;
+    PublishedFrames _published;  // último conteúdo do slot, protegido por _publishMutex
+    std::vector<vcam::FrameFormat> _preparedFormats;  // cópia de _viewFormats, protegida por _publishMutex
+    uint64_t _preparedGeneration;
+
+    // Fila de playout na frente do slot; com atraso zero o decoder publica direto
+    vcam::PlayoutBuffer<vcam::SharedFrameRef> _playoutBuffer;
+    std::mutex _playoutMutex;
+    std::atomic<bool> _playoutEnabled;
+    int64_t _playoutScheduledNs;  // próxima liberação agendada (0 = nenhuma), protegido por _playoutMutex
+    dispatch_queue_t _playoutQueue;
+
+    // Preview alimentado a cada publicação; os dois últimos só são usados na _previewQueue
+    dispatch_queue_t _previewQueue;
+    std::atomic<bool> _previewScheduled;
+    BOOL _previewWaiting;
+    uint64_t _lastPreviewFrameId;
+
+    // Latência glass-to-glass: código gravado pelo emissor no relógio do servidor
+    std::atomic<bool> _latencyProbeEnabled;
+    vcam::LatencyHistogram _latencyHistogram;
+    std::mutex _latencyMutex;
+    int64_t _serverClockOffsetMs;  // relógio do servidor - relógio local, protegido por _latencyMutex
+    int64_t _serverClockRttMs;     // RTT da amostra usada no offset (-1 = nenhuma)
+
+    // Versão do protocolo binário aceita pelo servidor nesta conexão (0 = só JSON)
+    std::atomic<int> _signalingVersion;
+
+    // Sinalização de sessão gerada com o WebSocket caído, enviada ao reconectar
+    NSMutableArray<NSDictionary *> *_pendingSignals;
+    std::mutex _pendingSignalsMutex;
+    int64_t _signalingLostNs;  // início da queda atual (0 = conectado), só na fila de sinalização
+
+    // Fila serial de toda a sinalização: delegate do NSURLSession, JSON/CBOR, keep-alive,
+    // timeouts e transições; a main thread só recebe o statusUpdateCallback
+    dispatch_queue_t _signalingQueue;
+    NSOperationQueue *_signalingOperationQueue;
+    dispatch_source_t _keepAliveTimer;
+
+    // Máquina de estados da conexão (WebRTCConnectionState), escrita por transitionToState:
+    std::atomic<int> _connectionState;
+
+    // Blocos que o WebRTCManager executa na main thread, para medir o que sobra nela
+    vcam::HookOverhead _mainThreadCost;
+
+    // Fábrica criada uma vez, fora da main (prewarm ou primeira conexão), e mantida entre sessões
+    dispatch_queue_t _factoryQueue;
+    std::atomic<bool> _factoryReady;
+
+    // Conexão especulativa, com candidatos ICE já coletados; só na fila de sinalização
+    RTCPeerConnection *_sparePeerConnection;
+    int64_t _sparePeerConnectionNs;
+
+    // Marcos do estabelecimento da sessão atual, até os primeiros frames
+    vcam::SetupProfile _setupProfile;
+    NSUInteger _setupGeneration;          // sessões iniciadas, só na fila de sinalização
+    std::atomic<bool> _warmStart;         // fábrica já pronta no início da sessão
+    std::atomic<bool> _speculativeStart;  // sessão usou a conexão especulativa
+
+    // timeStampNs do stream -> relógio do host; só usado na thread de conversão do renderer
+    vcam::ClockBridge _clockBridge;
+    std::atomic<bool> _clockResetPending;
+
+    // Por output de captura: formato pedido e repetição/descarte para casar o stream com a cadência da câmera
+    CaptureOutputMap _outputs;
+    CMVideoDimensions _outputTargetDimensions;  // maior buffer nativo entre os outputs
+    std::mutex _outputsMutex;
+
+    // Entregas em formato/tamanho derivado e conversões feitas para elas
+    std::atomic<uint64_t> _formatRequestCount;
+    std::atomic<uint64_t> _formatConversionCount;
+
+    // Metadados do buffer original (EXIF, intrínsecos) copiados para o substituto
+    vcam::AttachmentPropagator _attachmentPropagator;
+
+    // Buffers das visões em outros formatos e os conversores persistentes por formato
+    std::unique_ptr<vcam::PixelBufferPool> _viewPool;
+    std::unique_ptr<vcam::ViewConverter> _viewConverter;
+    
+    // Formatos distintos entregues aos outputs (protegido por _outputsMutex); a geração
+    // muda a cada alteração para o produtor só copiar a lista quando ela muda
+    std::vector<vcam::FrameFormat> _viewFormats;
+    std::atomic<uint64_t> _viewFormatsGeneration;
+
+    // Descrições de formato em cache e contagem de alocações por entrega
+    vcam::SampleBufferFactory _sampleBufferFactory;
+    std::atomic<uint64_t> _deliveredFrameCount;
+}
+
+// Conexão WebRTC; a fábrica só é escrita na _factoryQueue
+@property (nonatomic, strong) RTCPeerConnectionFactory *factory;
+@property (nonatomic, strong) RTCPeerConnection *peerConnection;
+@property (nonatomic, strong) RTCVideoTrack *videoTrack;
+@property (nonatomic, strong) WebRTCFrameRenderer *frameRenderer;
+
+// WebSocket para sinalização
+@property (nonatomic, strong) NSURLSession *session;
+@property (nonatomic, strong) NSURLSessionWebSocketTask *webSocketTask;
+@property (nonatomic, assign) BOOL signalingOpen;           // WebSocket aberto e join enviado
+@property (nonatomic, assign) BOOL shouldReconnect;         // NO depois de stopWebRTC
+@property (nonatomic, assign) BOOL reconnectScheduled;
+@property (nonatomic, assign) NSUInteger reconnectAttempt;  // zera quando o WebSocket abre
+@property (nonatomic, strong) NSString *resumeToken;        // dado pelo servidor; reata a sala sem renegociar
+@property (nonatomic, assign, readwrite) NSUInteger signalingReconnectCount;
+@property (nonatomic, assign, readwrite) NSTimeInterval lastSignalingOutage;
+
+// Recuperação do ICE
+@property (nonatomic, assign) NSUInteger iceRestartAttempt;  // restarts seguidos sem reconectar
+@property (nonatomic, assign, readwrite) NSUInteger iceRestartCount;
+
+// Medição de tempo até o primeiro frame (escrita na thread de publicação)
+@property (atomic, assign, readwrite) NSTimeInterval timeToFirstFrame;
+
+// Estado
+@property (nonatomic, assign, readwrite) BOOL isReceivingFrames;
+@property (nonatomic, strong) NSString *roomId;
+
+// Configurações de câmera
+@property (nonatomic, assign) AVCaptureDevicePosition currentCameraPosition;
+@property (nonatomic, assign) CMVideoDimensions targetResolution;
+@property (nonatomic, assign) BOOL videoMirrored;
+@property (nonatomic, assign) int videoOrientation;
+
+@end
+
+// Rotação horária que leva o frame em pé para a orientação pedida pela conexão,
+// assumindo a interface em retrato (o buffer nativo da câmera é paisagem)
+static NSInteger RotationForVideoOrientation(int orientation) {
+    switch (orientation) {
+        case AVCaptureVideoOrientationPortraitUpsideDown: return 180;
+        case AVCaptureVideoOrientationLandscapeRight:     return 270;
+        case AVCaptureVideoOrientationLandscapeLeft:      return 90;
+        default:                                          return 0;
+    }
+}
+
+static int64_t WallTimeMs() {
+    return (int64_t)([[NSDate date] timeIntervalSince1970] * 1000);
+}
+
+// Timestamp do código no topo do frame recebido, antes de crop/rotação; -1 se não há
+static int64_t ReadProbeTimestamp(id<RTCVideoFrameBuffer> buffer) {
+    uint64_t timestampMs = 0;
+    bool found = false;
+    
+    if ([buffer isKindOfClass:[RTCCVPixelBuffer class]]) {
+        CVPixelBufferRef pixelBuffer = ((RTCCVPixelBuffer *)buffer).pixelBuffer;
+        if (CVPixelBufferGetPlaneCount(pixelBuffer) < 2) {
+            return -1;
+        }
+        CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+        vcam::LumaPlane luma = {
+            (const uint8_t *)CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0),
+            (int)CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0),
+            (int)CVPixelBufferGetWidthOfPlane(pixelBuffer, 0),
+            (int)CVPixelBufferGetHeightOfPlane(pixelBuffer, 0)
+        };
+        found = vcam::ReadTimestampCode(luma, timestampMs);
+        CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    } else if ([buffer conformsToProtocol:@protocol(RTCI420Buffer)]) {
+        id<RTCI420Buffer> i420 = (id<RTCI420Buffer>)buffer;
+        vcam::LumaPlane luma = { i420.dataY, i420.strideY, i420.width, i420.height };
+        found = vcam::ReadTimestampCode(luma, timestampMs);
+    }
+    return found ? (int64_t)timestampMs : -1;
+}
+
+static int64_t HostTimeNs() {
+    return CMTimeConvertScale(CMClockGetTime(CMClockGetHostTimeClock()), NSEC_PER_SEC, kCMTimeRoundingMethod_Default).value;
+}
+
+// Reconexão da sinalização e recuperação do ICE
+static const NSUInteger kMaxPendingSignals = 64;
+static const NSUInteger kMaxIceRestarts = 3;
+static const NSTimeInterval kIceRestartTimeout = 10.0;
+
+// Com max-bundle e rtcp-mux há um único transporte: um alocador pré-coletado basta
+static const int kIceCandidatePoolSize = 1;
+
+// Candidatos srflx envelhecem com os mapeamentos do NAT; conexão especulativa mais velha é refeita
+static const NSTimeInterval kSparePeerConnectionMaxAge = 30.0;
+
+// Espera pelos primeiros frames substituído e de preview após o primeiro decodificado;
+// sem câmera ativa eles não chegam e o resumo sai sem eles
+static const NSTimeInterval kSetupProfileGrace = 5.0;
+
+// Intervalo do ping de keep-alive (e do relatório de latência)
+static const NSTimeInterval kKeepAliveInterval = 5.0;
+
+// Marca a fila de sinalização, para sendMessage: saber se já está nela
+static const void *const kSignalingQueueKey = &kSignalingQueueKey;
+
+// Transições aceitas: encerrada a sessão, só um novo início sai de Disconnected,
+// então eventos atrasados do WebRTC não reabrem o estado
+static bool IsValidConnectionTransition(int from, int to) {
+    if (from == to) {
+        return true;
+    }
+    if (from == WebRTCConnectionStateDisconnected) {
+        return to == WebRTCConnectionStateConnecting;
+    }
+    return to >= WebRTCConnectionStateDisconnected && to <= WebRTCConnectionStateError;
+}
+
+// Backoff exponencial (0,5 s, 1 s, 2 s... até 10 s) com jitter de ±20%
+static NSTimeInterval ReconnectDelay(NSUInteger attempt) {
+    NSTimeInterval delay = MIN(0.5 * (double)(1u << MIN(attempt, (NSUInteger)5)), 10.0);
+    return delay * (0.8 + 0.4 * arc4random_uniform(1001) / 1000.0);
+}
+
+// --- Sinalização binária (SignalingCodec.h): NSDictionary <-> CBOR ---
+
+// Aninhamento máximo aceito nas mensagens (as nossas usam 3 níveis)
+static const int kSignalingMaxDepth = 16;
+
+// Nomes das tabelas do codec como NSString, criados uma vez
+static NSArray<NSString *> *SignalingNames(const char *(*nameForCode)(uint64_t)) {
+    NSMutableArray<NSString *> *names = [NSMutableArray array];
+    for (uint64_t code = 0; nameForCode(code); code++) {
+        [names addObject:@(nameForCode(code))];
+    }
+    return names;
+}
+
+static NSString *SignalingKeyString(uint64_t code) {
+    static NSArray<NSString *> *keys = SignalingNames(vcam::SignalingKeyName);
+    return code < keys.count ? keys[(NSUInteger)code] : nil;
+}
+
+static NSString *SignalingTypeString(uint64_t code) {
+    static NSArray<NSString *> *types = SignalingNames(vcam::SignalingTypeName);
+    return code < types.count ? types[(NSUInteger)code] : nil;
+}
+
+// false para valores sem representação no protocolo (a mensagem segue em JSON)
+static bool WriteSignalingValue(vcam::SignalingWriter &writer, id value, int depth) {
+    if (depth > kSignalingMaxDepth) {
+        return false;
+    }
+    
+    if ([value isKindOfClass:[NSString class]]) {
+        const char *text = [(NSString *)value UTF8String];
+        writer.writeText(text, strlen(text));
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = value;
+        if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+            writer.writeBool(number.boolValue);
+        } else if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+            writer.writeDouble(number.doubleValue);
+        } else if (strcmp(number.objCType, @encode(unsigned long long)) == 0) {
+            writer.writeUInt(number.unsignedLongLongValue);
+        } else {
+            writer.writeInt(number.longLongValue);
+        }
+    } else if ([value isKindOfClass:[NSNull class]]) {
+        writer.writeNull();
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        NSArray *array = value;
+        writer.beginArray(array.count);
+        for (id element in array) {
+            if (!WriteSignalingValue(writer, element, depth + 1)) {
+                return false;
+            }
+        }
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = value;
+        writer.beginMap(dictionary.count);
+        for (id key in dictionary) {
+            if (![key isKindOfClass:[NSString class]]) {
+                return false;
+            }
+            const char *name = [(NSString *)key UTF8String];
+            writer.writeKey(name, strlen(name));
+            if (!WriteSignalingValue(writer, dictionary[key], depth + 1)) {
+                return false;
+            }
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// nil se a mensagem não cabe no protocolo binário
+static NSData *EncodeSignalingMessage(NSDictionary *message) {
+    vcam::SignalingWriter writer;
+    writer.beginMap(message.count);
+    for (id key in message) {
+        if (![key isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+        const char *name = [(NSString *)key UTF8String];
+        writer.writeKey(name, strlen(name));
+        
+        id value = message[key];
+        if ([key isEqualToString:@"type"]) {
+            // O tipo no topo é sempre texto; numérico seria ambíguo com o código da tabela
+            if (![value isKindOfClass:[NSString class]]) {
+                return nil;
+            }
+            const char *type = [(NSString *)value UTF8String];
+            writer.writeType(type, strlen(type));
+        } else if (!WriteSignalingValue(writer, value, 1)) {
+            return nil;
+        }
+    }
+    return [NSData dataWithBytes:writer.bytes().data() length:writer.bytes().size()];
+}
+
+static id ReadSignalingValue(vcam::SignalingReader &reader, int depth);
+
+static NSString *ReadSignalingText(const vcam::SignalingItem &item) {
+    return [[NSString alloc] initWithBytes:item.text length:(NSUInteger)item.count encoding:NSUTF8StringEncoding];
+}
+
+static NSDictionary *ReadSignalingMap(vcam::SignalingReader &reader, uint64_t count, int depth, bool topLevel) {
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        vcam::SignalingItem item;
+        if (!reader.read(item)) {
+            return nil;
+        }
+        NSString *key = nil;
+        if (item.type == vcam::SignalingItemType::UInt) {
+            key = SignalingKeyString(item.count);
+        } else if (item.type == vcam::SignalingItemType::Text) {
+            key = ReadSignalingText(item);
+        }
+        if (!key) {
+            return nil;
+        }
+        
+        id value = nil;
+        if (topLevel && [key isEqualToString:@"type"]) {
+            if (!reader.read(item)) {
+                return nil;
+            }
+            if (item.type == vcam::SignalingItemType::UInt) {
+                value = SignalingTypeString(item.count);
+            } else if (item.type == vcam::SignalingItemType::Text) {
+                value = ReadSignalingText(item);
+            }
+        } else {
+            value = ReadSignalingValue(reader, depth + 1);
+        }
+        if (!value) {
+            return nil;
+        }
+        dictionary[key] = value;
+    }
+    return dictionary;
+}
+
+// nil para valor malformado
+static id ReadSignalingValue(vcam::SignalingReader &reader, int depth) {
+    vcam::SignalingItem item;
+    if (depth > kSignalingMaxDepth || !reader.read(item)) {
+        return nil;
+    }
+    
+    switch (item.type) {
+        case vcam::SignalingItemType::UInt:
+            return @(item.count);
+        case vcam::SignalingItemType::NegInt:
+            return @(item.integer);
+        case vcam::SignalingItemType::Double:
+            return @(item.real);
+        case vcam::SignalingItemType::Bool:
+            return item.boolean ? @YES : @NO;
+        case vcam::SignalingItemType::Null:
+            return [NSNull null];
+        case vcam::SignalingItemType::Text:
+            return ReadSignalingText(item);
+        case vcam::SignalingItemType::Array: {
+            NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)item.count];
+            for (uint64_t i = 0; i < item.count; i++) {
+                id element = ReadSignalingValue(reader, depth + 1);
+                if (!element) {
+                    return nil;
+                }
+                [array addObject:element];
+            }
+            return array;
+        }
+        case vcam::SignalingItemType::Map:
+            return ReadSignalingMap(reader, item.count, depth, false);
+    }
+    return nil;
+}
+
+// nil se não é uma mensagem binária válida desta versão
+static NSDictionary *DecodeSignalingMessage(NSData *data) {
+    vcam::SignalingReader reader((const uint8_t *)data.bytes, data.length);
+    vcam::SignalingItem item;
+    if (!reader.valid() || !reader.read(item) || item.type != vcam::SignalingItemType::Map) {
+        return nil;
+    }
+    // Mesma contagem do WriteSignalingValue: valores do topo estão no nível 1
+    NSDictionary *message = ReadSignalingMap(reader, item.count, 0, true);
+    return reader.atEnd() ? message : nil;
+}
+
+@implementation WebRTCManager
+
+#pragma mark - Propriedades
+
+- (BOOL)isConnected {
+    return self.connectionState == WebRTCConnectionStateConnected;
+}
+
+- (int)connectionState {
+    return _connectionState.load(std::memory_order_acquire);
+}
+
+// De qualquer thread; transição inválida é ignorada e registrada
+- (BOOL)transitionToState:(WebRTCConnectionState)state {
+    int current = _connectionState.load(std::memory_order_relaxed);
+    do {
+        if (!IsValidConnectionTransition(current, state)) {
+            NSLog(@"[WebRTCManager] Transição de estado ignorada: %d -> %d", current, (int)state);
+            return NO;
+        }
+    } while (!_connectionState.compare_exchange_weak(current, state, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed));
+    return YES;
+}
+
+- (BOOL)isOnSignalingQueue {
+    return dispatch_get_specific(kSignalingQueueKey) == kSignalingQueueKey;
+}
+
+// Espelhado no HotPathState: o hook de captureOutput lê de lá, sem mensagem
+- (void)setIsReceivingFrames:(BOOL)isReceivingFrames {
+    _isReceivingFrames = isReceivingFrames;
+    vcam::HotPathState::shared().setReceiving(isReceivingFrames);
+}
+
+#pragma mark - Singleton
+
++ (instancetype)sharedInstance {
+    static WebRTCManager *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[self alloc] init];
+    });
+    return instance;
+}
+
+#pragma mark - Lifecycle
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _connectionState = WebRTCConnectionStateDisconnected;
+        _isReceivingFrames = NO;
+        _deliveredFrameCount = 0;
+        _nextFrameId = 0;
+        _outputTargetDimensions = { 0, 0 };
+        _formatRequestCount = 0;
+        _formatConversionCount = 0;
+        _clockResetPending = false;
+        _playoutEnabled = false;
+        _playoutScheduledNs = 0;
+        _playoutQueue = dispatch_queue_create("com.vcam.webrtc.playout", DISPATCH_QUEUE_SERIAL);
+        _previewQueue = dispatch_queue_create("com.vcam.webrtc.preview", DISPATCH_QUEUE_SERIAL);
+        _previewScheduled = false;
+        _previewWaiting = NO;
+        _lastPreviewFrameId = 0;
+        _latencyProbeEnabled = false;
+        _serverClockOffsetMs = 0;
+        _serverClockRttMs = -1;
+        _signalingVersion = 0;
+        _pendingSignals = [NSMutableArray array];
+        _signalingLostNs = 0;
+        _signalingQueue = dispatch_queue_create("com.vcam.webrtc.signaling", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_signalingQueue, kSignalingQueueKey, (void *)kSignalingQueueKey, NULL);
+        _signalingOperationQueue = [[NSOperationQueue alloc] init];
+        _signalingOperationQueue.underlyingQueue = _signalingQueue;
+        _signalingOperationQueue.maxConcurrentOperationCount = 1;
+        _keepAliveTimer = nil;
+        _factoryQueue = dispatch_queue_create("com.vcam.webrtc.factory", DISPATCH_QUEUE_SERIAL);
+        _factoryReady = false;
+        _sparePeerConnectionNs = 0;
+        _setupGeneration = 0;
+        _warmStart = false;
+        _speculativeStart = false;
+        _viewPool.reset(new vcam::PixelBufferPool(std::unique_ptr<vcam::PoolBackend>(new vcam::CVPixelBufferPoolBackend()),
+                                                  kViewBuffersInFlight));
+        _viewConverter.reset(new vcam::ViewConverter(*_viewPool));
+        _viewFormatsGeneration = 0;
+        _preparedGeneration = 0;
+        _roomId = @"ios-camera";
+        _videoMirrored = NO;
+        _videoOrientation = 1; // Default para Portrait
+        _currentCameraPosition = AVCaptureDevicePositionUnspecified;
+        _serverIP = @"192.168.0.178"; // IP padrão
+        
+        // Inicializar dimensões alvo com valor padrão (1080p)
+        _targetResolution.width = 1920;
+        _targetResolution.height = 1080;
+        
+        // Renderer que publica os frames recebidos no slot de substituição
+        __weak typeof(self) weakSelf = self;
+        _frameRenderer = [[WebRTCFrameRenderer alloc]
+                          initWithAcceptedPixelFormats:[NSSet setWithObjects:
+                                                        @(kCVPixelFormatType_420YpCbCr8BiPlanarFullRange),
+                                                        @(kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange),
+                                                        @(kCVPixelFormatType_32BGRA), nil]
+                          maxBuffersInFlight:kRendererBuffersInFlight
+                          frameHandler:^(CVPixelBufferRef pixelBuffer, RTCVideoFrame *frame) {
+            [weakSelf publishPixelBuffer:pixelBuffer frame:frame];
+        }];
+        // Primeiro formato de preferredPixelFormats anunciado no join
+        _frameRenderer.conversionPixelFormat = kCVPixelFormatType_420YpCbCr8BiPlanarFullRange;
+        // Stream 16:9 em formatos 4:3 da câmera: recorta em vez de distorcer
+        _frameRenderer.aspectMode = WebRTCAspectModeFill;
+        
+        NSLog(@"[WebRTCManager] Inicializado");
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // Sem passar pela fila: nenhum bloco pode reter self daqui em diante
+    self.shouldReconnect = NO;
+    [self cleanupResources];
+    
+    NSLog(@"[WebRTCManager] Liberado");
+}
+
+#pragma mark - Gerenciamento de Conexão
+
+- (void)startWebRTC {
+    // Usa o serverIP atual para iniciar a conexão
+    NSString *serverIP = self.serverIP;
+    dispatch_async(_signalingQueue, ^{
+        // Evita múltiplas tentativas de conexão simultâneas
+        if (self.connectionState == WebRTCConnectionStateConnected ||
+            self.connectionState == WebRTCConnectionStateConnecting) {
+            NSLog(@"[WebRTCManager] Já conectado ou conectando ao servidor");
+            [self updateStatus:@"Já conectado ou conectando"];
+            return;
+        }
+        [self startSessionWithServer:serverIP];
+    });
+}
+
+- (void)startWebRTCWithServer:(NSString *)serverIP {
+    self.serverIP = serverIP; // Atualiza o serverIP
+    dispatch_async(_signalingQueue, ^{
+        [self startSessionWithServer:serverIP];
+    });
+}
+
+// Na fila de sinalização
+- (void)startSessionWithServer:(NSString *)serverIP {
+    [self transitionToState:WebRTCConnectionStateConnecting];
+    _mainThreadCost.reset();
+    
+    // Nova sessão: sem token de retomada, contadores zerados
+    self.shouldReconnect = YES;
+    self.reconnectAttempt = 0;
+    self.resumeToken = nil;
+    self.signalingReconnectCount = 0;
+    self.lastSignalingOutage = 0;
+    self.iceRestartAttempt = 0;
+    self.iceRestartCount = 0;
+    
+    // Marcos do estabelecimento, a partir daqui
+    _setupGeneration++;
+    _warmStart = _factoryReady.load();
+    _setupProfile.begin(HostTimeNs());
+    {
+        // Novo servidor, novo offset de relógio
+        std::lock_guard<std::mutex> lock(_latencyMutex);
+        _serverClockRttMs = -1;
+        _latencyHistogram.reset();
+    }
+    [self updateStatus:@"Conectando ao servidor"];
+    NSLog(@"[WebRTCManager] Conectando ao servidor: %@", serverIP);
+    
+    // Configurar WebRTC
+    [self setupWebRTC];
+    
+    // Conectar ao WebSocket
+    [self connectWebSocketWithServer:serverIP];
+}
+
+- (void)stopWebRTC {
+    dispatch_async(_signalingQueue, ^{
+        [self stopSession];
+    });
+}
+
+// Na fila de sinalização
+- (void)stopSession {
+    [self updateStatus:@"Desconectando"];
+    NSLog(@"[WebRTCManager] Desconectando do servidor");
+    
+    // Queda a partir daqui é intencional
+    self.shouldReconnect = NO;
+    
+    // Parar keep-alive timer
+    [self stopKeepAliveTimer];
+    
+    // Enviar mensagem "bye" para o servidor
+    if (self.webSocketTask && self.webSocketTask.state == NSURLSessionTaskStateRunning) {
+        [self sendMessage:@{
+            @"type": @"bye",
+            @"roomId": self.roomId
+        }];
+        
+        // Pequeno delay para garantir que a mensagem seja enviada
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), _signalingQueue, ^{
+            [self cleanupResources];
+        });
+    } else {
+        [self cleanupResources];
+    }
+}
+
+- (void)cleanupResources {
+    // Resumo parcial de sessão encerrada antes dos primeiros frames, enquanto a sinalização existe
+    [self finishSetupProfile];
+    
+    // Limpar conexão WebRTC
+    if (self.peerConnection) {
+        [self.peerConnection close];
+        self.peerConnection = nil;
+    }
+    
+    // Limpar WebSocket e sessão
+    [self teardownSignaling];
+    self.resumeToken = nil;
+    self.iceRestartAttempt = 0;
+    _signalingLostNs = 0;
+    {
+        std::lock_guard<std::mutex> lock(_pendingSignalsMutex);
+        [_pendingSignals removeAllObjects];
+    }
+    
+    // Desanexar o renderer antes de limpar o slot (único produtor)
+    [self detachFrameRenderer];
+    
+    // Limpar buffer
+    {
+        std::lock_guard<std::mutex> lock(_playoutMutex);
+        _playoutBuffer.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_publishMutex);
+        _published = PublishedFrames();
+        _frameSlot.clear();
+    }
+    _sampleBufferFactory.purge();
+    _viewConverter->purge();
+    
+    // Resetar estado; a fábrica fica para a próxima sessão
+    self.isReceivingFrames = NO;
+    [self transitionToState:WebRTCConnectionStateDisconnected];
+    
+    [self updateStatus:@"Desconectado"];
+    NSLog(@"[WebRTCManager] Desconectado do servidor (main thread: %llu blocos, %.2f ms, máx. %.2f ms)",
+          _mainThreadCost.frames(), (double)_mainThreadCost.meanNs() * _mainThreadCost.frames() / 1e6,
+          (double)_mainThreadCost.maxNs() / 1e6);
+}
+
+- (RTCConfiguration *)peerConnectionConfiguration {
+    // Configurações para conexão WebRTC otimizadas para iOS
+    RTCConfiguration *config = [[RTCConfiguration alloc] init];
+    
+    // Servidores STUN para NAT traversal (necessário para redes locais)
+    config.iceServers = @[
+        [[RTCIceServer alloc] initWithURLStrings:@[
+            @"stun:stun.l.google.com:19302",
+            @"stun:stun1.l.google.com:19302"
+        ]]
+    ];
+    
+    // Configurações otimizadas para redes locais
+    config.iceTransportPolicy = RTCIceTransportPolicyAll;
+    config.bundlePolicy = RTCBundlePolicyMaxBundle;
+    config.rtcpMuxPolicy = RTCRtcpMuxPolicyRequire;
+    config.tcpCandidatePolicy = RTCTcpCandidatePolicyEnabled;
+    config.candidateNetworkPolicy = RTCCandidateNetworkPolicyAll;
+    
+    // Coleta candidatos já na criação, em paralelo com o WebSocket e a espera pela oferta
+    config.iceCandidatePoolSize = kIceCandidatePoolSize;
+    
+    return config;
+}
+
+// Só na _factoryQueue
+- (RTCPeerConnectionFactory *)createFactoryIfNeeded {
+    if (!self.factory) {
+        int64_t start = HostTimeNs();
+        
+        // Inicializar a fábrica de conexões
+        RTCDefaultVideoDecoderFactory *decoderFactory = [[RTCDefaultVideoDecoderFactory alloc] init];
+        RTCDefaultVideoEncoderFactory *encoderFactory = [[RTCDefaultVideoEncoderFactory alloc] init];
+        
+        self.factory = [[RTCPeerConnectionFactory alloc] initWithEncoderFactory:encoderFactory
+                                                               decoderFactory:decoderFactory];
+        _factoryReady = true;
+        NSLog(@"[WebRTCManager] Fábrica WebRTC criada em %.1f ms", (double)(HostTimeNs() - start) / 1e6);
+    }
+    return self.factory;
+}
+
+// Espera o prewarm em andamento, se houver, em vez de criar outra fábrica
+- (RTCPeerConnectionFactory *)peerConnectionFactory {
+    __block RTCPeerConnectionFactory *factory = nil;
+    dispatch_sync(_factoryQueue, ^{
+        factory = [self createFactoryIfNeeded];
+    });
+    return factory;
+}
+
+- (RTCPeerConnection *)createPeerConnection {
+    RTCPeerConnectionFactory *factory = [self peerConnectionFactory];
+    
+    // Constraints para conexão (receber apenas vídeo, sem áudio)
+    RTCMediaConstraints *constraints = [[RTCMediaConstraints alloc]
+                                   initWithMandatoryConstraints:@{
+                                       @"OfferToReceiveVideo": @"true",
+                                       @"OfferToReceiveAudio": @"false"
+                                   }
+                                   optionalConstraints:@{
+                                       @"DtlsSrtpKeyAgreement": @"true"
+                                   }];
+    
+    // Criar a conexão Peer
+    return [factory peerConnectionWithConfiguration:[self peerConnectionConfiguration]
+                                        constraints:constraints
+                                           delegate:self];
+}
+
+- (void)prewarm {
+    dispatch_async(_factoryQueue, ^{
+        [self createFactoryIfNeeded];
+        
+        dispatch_async(self->_signalingQueue, ^{
+            [self prepareSparePeerConnection];
+        });
+    });
+}
+
+// Só na fila de sinalização
+- (void)prepareSparePeerConnection {
+    if (!self.speculativePeerConnection || self.peerConnection) {
+        return;
+    }
+    if (_sparePeerConnection &&
+        (double)(HostTimeNs() - _sparePeerConnectionNs) / NSEC_PER_SEC < kSparePeerConnectionMaxAge) {
+        return;
+    }
+    
+    [_sparePeerConnection close];
+    _sparePeerConnection = [self createPeerConnection];
+    _sparePeerConnectionNs = HostTimeNs();
+    NSLog(@"[WebRTCManager] Conexão especulativa criada, pré-coletando candidatos ICE");
+}
+
+// Conexão especulativa ainda fresca, ou nil
+- (RTCPeerConnection *)takeSparePeerConnection {
+    RTCPeerConnection *spare = _sparePeerConnection;
+    _sparePeerConnection = nil;
+    if (spare && (double)(HostTimeNs() - _sparePeerConnectionNs) / NSEC_PER_SEC >= kSparePeerConnectionMaxAge) {
+        [spare close];
+        spare = nil;
+    }
+    return spare;
+}
+
+- (void)setupWebRTC {
+    RTCPeerConnection *spare = [self takeSparePeerConnection];
+    _speculativeStart = spare != nil;
+    self.peerConnection = spare ?: [self createPeerConnection];
+    
+    NSLog(@"[WebRTCManager] WebRTC configurado%@", spare ? @" (conexão especulativa)" : @"");
+}
+
+#pragma mark - WebSocket
+
+- (void)connectWebSocketWithServer:(NSString *)serverIP {
+    // Construir URL do servidor
+    NSString *wsURLString = [NSString stringWithFormat:@"ws://%@:8080", serverIP];
+    NSURL *wsURL = [NSURL URLWithString:wsURLString];
+    
+    if (!wsURL) {
+        [self transitionToState:WebRTCConnectionStateError];
+        [self updateStatus:@"URL do servidor inválida"];
+        return;
+    }
+    
+    // Conexão nova começa em JSON até o servidor confirmar o codec binário
+    _signalingVersion.store(0, std::memory_order_relaxed);
+    
+    // Criar sessão URLSession; delegate e handlers de recepção rodam na fila de sinalização
+    self.session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                               delegate:self
+                                          delegateQueue:_signalingOperationQueue];
+    
+    // Criar tarefa WebSocket
+    self.webSocketTask = [self.session webSocketTaskWithURL:wsURL];
+    [self.webSocketTask resume];
+    
+    // Configurar recepção de mensagens
+    [self receiveMessages];
+    
+    NSLog(@"[WebRTCManager] Conectando ao WebSocket: %@", wsURLString);
+    
+    // Configurar timeout para a conexão (15 segundos); expirado, entra no backoff de reconexão
+    NSURLSessionWebSocketTask *task = self.webSocketTask;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(15 * NSEC_PER_SEC)), _signalingQueue, ^{
+        if (self.webSocketTask == task && !self.signalingOpen) {
+            NSLog(@"[WebRTCManager] Timeout de conexão WebSocket");
+            [self updateStatus:@"Timeout na conexão com servidor"];
+            [self signalingLostWithReason:@"timeout"];
+        }
+    });
+}
+
+// Fecha só o WebSocket; a conexão de mídia não depende dele
+- (void)teardownSignaling {
+    [self stopKeepAliveTimer];
+    
+    self.signalingOpen = NO;
+    _signalingVersion.store(0, std::memory_order_relaxed);
+    
+    if (self.webSocketTask) {
+        [self.webSocketTask cancel];
+        self.webSocketTask = nil;
+    }
+    if (self.session) {
+        [self.session invalidateAndCancel];
+        self.session = nil;
+    }
+}
+
+// WebSocket caiu sem stopWebRTC: reconecta com backoff sem tocar no RTCPeerConnection,
+// que segue recebendo mídia pelo ICE. Chamado na fila de sinalização.
+- (void)signalingLostWithReason:(NSString *)reason {
+    if (!self.shouldReconnect) {
+        return;
+    }
+    NSLog(@"[WebRTCManager] Sinalização perdida (%@); mídia continua pelo ICE", reason);
+    
+    if (_signalingLostNs == 0) {
+        _signalingLostNs = HostTimeNs();
+    }
+    [self teardownSignaling];
+    [self scheduleReconnect];
+}
+
+- (void)scheduleReconnect {
+    if (self.reconnectScheduled || !self.shouldReconnect) {
+        return;
+    }
+    self.reconnectScheduled = YES;
+    
+    NSTimeInterval delay = ReconnectDelay(self.reconnectAttempt++);
+    [self updateStatus:[NSString stringWithFormat:@"Reconectando ao servidor em %.1f s", delay]];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _signalingQueue, ^{
+        self.reconnectScheduled = NO;
+        if (self.shouldReconnect && !self.webSocketTask) {
+            [self connectWebSocketWithServer:self.serverIP];
+        }
+    });
+}
+
+- (void)startKeepAliveTimer {
+    // Limpar timer existente
+    [self stopKeepAliveTimer];
+    
+    // Timer na fila de sinalização, fora do run loop da main, para enviar pings a cada 5 segundos
+    uint64_t intervalNs = (uint64_t)(kKeepAliveInterval * NSEC_PER_SEC);
+    __weak typeof(self) weakSelf = self;
+    _keepAliveTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _signalingQueue);
+    dispatch_source_set_timer(_keepAliveTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)intervalNs), intervalNs,
+                              intervalNs / 10);
+    dispatch_source_set_event_handler(_keepAliveTimer, ^{
+        [weakSelf sendKeepAlive];
+    });
+    dispatch_resume(_keepAliveTimer);
+}
+
+- (void)stopKeepAliveTimer {
+    if (_keepAliveTimer) {
+        dispatch_source_cancel(_keepAliveTimer);
+        _keepAliveTimer = nil;
+    }
+}
+
+- (void)sendKeepAlive {
+    if (self.webSocketTask && self.webSocketTask.state == NSURLSessionTaskStateRunning) {
+        // Enviar ping nativo
+        [self.webSocketTask sendPingWithPongReceiveHandler:^(NSError *error) {
+            if (error) {
+                NSLog(@"[WebRTCManager] Erro ao receber pong: %@", error);
+            }
+        }];
+        
+        // Enviar também mensagem de ping JSON para compatibilidade
+        [self sendMessage:@{
+            @"type": @"ping",
+            @"roomId": self.roomId,
+            @"timestamp": @([[NSDate date] timeIntervalSince1970] * 1000)
+        }];
+        
+        [self sendLatencyReport];
+    }
+}
+
+- (void)receiveMessages {
+    __weak typeof(self) weakSelf = self;
+    NSURLSessionWebSocketTask *task = self.webSocketTask;
+    
+    [task receiveMessageWithCompletionHandler:^(NSURLSessionWebSocketMessage * _Nullable message, NSError * _Nullable error) {
+        // Socket já substituído por uma reconexão
+        if (task != weakSelf.webSocketTask) {
+            return;
+        }
+        
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao receber mensagem: %@", error);
+            
+            // Erro de conexão: reconecta a sinalização, a mídia segue
+            if ([error.domain isEqualToString:NSURLErrorDomain] || task.state != NSURLSessionTaskStateRunning) {
+                [weakSelf updateStatus:[NSString stringWithFormat:@"Erro de conexão: %@", error.localizedDescription]];
+                [weakSelf signalingLostWithReason:error.localizedDescription];
+                return;
+            }
+            
+            // Tentar receber mais mensagens mesmo com erro
+            [weakSelf receiveMessages];
+            return;
+        }
+        
+        if (message.type == NSURLSessionWebSocketMessageTypeData) {
+            NSDictionary *decoded = DecodeSignalingMessage(message.data);
+            if (!decoded) {
+                NSLog(@"[WebRTCManager] Mensagem binária inválida (%lu bytes)", (unsigned long)message.data.length);
+            } else {
+                [weakSelf handleSignalingMessage:decoded];
+            }
+        } else if (message.type == NSURLSessionWebSocketMessageTypeString) {
+            NSData *data = [message.string dataUsingEncoding:NSUTF8StringEncoding];
+            NSError *jsonError = nil;
+            NSDictionary *jsonDict = [NSJSONSerialization JSONObjectWithData:data
+                                                                   options:0
+                                                                     error:&jsonError];
+            
+            if (jsonError) {
+                NSLog(@"[WebRTCManager] Erro ao analisar mensagem JSON: %@", jsonError);
+            } else {
+                NSLog(@"[WebRTCManager] Recebida mensagem JSON tipo: %@", jsonDict[@"type"]);
+                [weakSelf handleSignalingMessage:jsonDict];
+            }
+        }
+        
+        // Continuar recebendo mensagens
+        if (task == weakSelf.webSocketTask && task.state == NSURLSessionTaskStateRunning) {
+            [weakSelf receiveMessages];
+        }
+    }];
+}
+
+// De qualquer thread (completions do WebRTC incluídas); o envio acontece na fila de sinalização
+- (void)sendMessage:(NSDictionary *)message {
+    if (![self isOnSignalingQueue]) {
+        dispatch_async(_signalingQueue, ^{
+            [self sendMessage:message];
+        });
+        return;
+    }
+    
+    if (!self.signalingOpen || !self.webSocketTask || self.webSocketTask.state != NSURLSessionTaskStateRunning) {
+        if (self.shouldReconnect && [self queuePendingSignal:message]) {
+            return;
+        }
+        NSLog(@"[WebRTCManager] WebSocket não está conectado");
+        return;
+    }
+    
+    NSURLSessionWebSocketMessage *webSocketMessage = nil;
+    
+    // Com o codec negociado vai binário; o que não cabe nele segue em JSON
+    if (_signalingVersion.load(std::memory_order_relaxed) == vcam::kSignalingProtocolVersion) {
+        NSData *binary = EncodeSignalingMessage(message);
+        if (binary) {
+            webSocketMessage = [[NSURLSessionWebSocketMessage alloc] initWithData:binary];
+        }
+    }
+    
+    if (!webSocketMessage) {
+        NSError *error = nil;
+        NSData *jsonData = [NSJSONSerialization dataWithJSONObject:message
+                                                         options:0
+                                                           error:&error];
+        
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao serializar mensagem: %@", error);
+            return;
+        }
+        
+        NSString *jsonString = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
+        webSocketMessage = [[NSURLSessionWebSocketMessage alloc] initWithString:jsonString];
+    }
+    
+    [self.webSocketTask sendMessage:webSocketMessage completionHandler:^(NSError * _Nullable error) {
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao enviar mensagem: %@", error);
+        }
+    }];
+}
+
+// Guarda oferta/resposta/candidatos enquanto o WebSocket reconecta; ping e stats
+// perdem o sentido com o atraso e são descartados
+- (BOOL)queuePendingSignal:(NSDictionary *)message {
+    NSString *type = message[@"type"];
+    if (![type isEqualToString:@"ice-candidate"] && ![type isEqualToString:@"answer"] &&
+        ![type isEqualToString:@"offer"]) {
+        return NO;
+    }
+    
+    std::lock_guard<std::mutex> lock(_pendingSignalsMutex);
+    if (_pendingSignals.count >= kMaxPendingSignals) {
+        [_pendingSignals removeObjectAtIndex:0];
+    }
+    [_pendingSignals addObject:message];
+    return YES;
+}
+
+- (void)flushPendingSignals {
+    NSArray<NSDictionary *> *pending;
+    {
+        std::lock_guard<std::mutex> lock(_pendingSignalsMutex);
+        pending = [_pendingSignals copy];
+        [_pendingSignals removeAllObjects];
+    }
+    if (pending.count == 0) {
+        return;
+    }
+    
+    NSLog(@"[WebRTCManager] Enviando %lu mensagens retidas durante a reconexão", (unsigned long)pending.count);
+    for (NSDictionary *message in pending) {
+        [self sendMessage:message];
+    }
+}
+
+- (void)handleSignalingMessage:(NSDictionary *)message {
+    NSString *type = message[@"type"];
+    
+    if ([type isEqualToString:@"offer"]) {
+        [self handleOfferMessage:message];
+    }
+    else if ([type isEqualToString:@"answer"]) {
+        [self handleAnswerMessage:message];
+    }
+    else if ([type isEqualToString:@"session"]) {
+        BOOL resumed = [message[@"resumed"] boolValue];
+        NSLog(@"[WebRTCManager] Sessão de sinalização %@", resumed ? @"retomada sem renegociação" : @"nova");
+        
+        // Sessão expirou no servidor: o emissor vai oferecer para uma conexão nova
+        if (!resumed && self.resumeToken && self.peerConnection.remoteDescription) {
+            [self resetPeerConnection];
+        }
+        
+        // Token para reatar a sala depois de uma queda do WebSocket
+        NSString *token = message[@"resumeToken"];
+        if ([token isKindOfClass:[NSString class]]) {
+            self.resumeToken = token;
+        }
+    }
+    else if ([type isEqualToString:@"ice-candidate"]) {
+        [self handleIceCandidateMessage:message];
+    }
+    else if ([type isEqualToString:@"pong"]) {
+        // Pong do servidor ecoa o nosso timestamp: amostra de offset de relógio
+        [self updateServerClockWithPong:message];
+    }
+    else if ([type isEqualToString:@"codec"]) {
+        // Servidor aceitou o protocolo binário anunciado no join
+        int version = [message[@"binaryProtocol"] intValue];
+        if (version == vcam::kSignalingProtocolVersion) {
+            _signalingVersion.store(version, std::memory_order_relaxed);
+            NSLog(@"[WebRTCManager] Sinalização binária v%d ativa", version);
+        }
+    }
+    else if ([type isEqualToString:@"latency-probe"]) {
+        self.latencyProbeEnabled = [message[@"enabled"] boolValue];
+    }
+    else if ([type isEqualToString:@"ping"]) {
+        // Responder com pong
+        [self sendMessage:@{
+            @"type": @"pong",
+            @"roomId": self.roomId,
+            @"timestamp": @([[NSDate date] timeIntervalSince1970] * 1000)
+        }];
+    }
+    else {
+        NSLog(@"[WebRTCManager] Mensagem não tratada: %@", type);
+    }
+}
+
+- (void)handleOfferMessage:(NSDictionary *)message {
+    NSString *sdp = message[@"sdp"];
+    if (!sdp) {
+        NSLog(@"[WebRTCManager] Oferta sem SDP");
+        return;
+    }
+    
+    _setupProfile.mark(vcam::SetupPhase::OfferReceived, HostTimeNs());
+    
+    // Completions chegam na thread de sinalização do WebRTC: usam a conexão capturada
+    // aqui, não a propriedade, que a fila de sinalização pode trocar nesse meio tempo
+    RTCPeerConnection *peerConnection = self.peerConnection;
+    __weak typeof(self) weakSelf = self;
+    
+    // Colisão com a nossa oferta de ICE restart: a do emissor prevalece
+    if (peerConnection.signalingState == RTCSignalingStateHaveLocalOffer) {
+        dispatch_queue_t signalingQueue = _signalingQueue;
+        RTCSessionDescription *rollback = [[RTCSessionDescription alloc] initWithType:RTCSdpTypeRollback sdp:@""];
+        [peerConnection setLocalDescription:rollback completionHandler:^(NSError * _Nullable error) {
+            if (error) {
+                NSLog(@"[WebRTCManager] Erro ao desfazer oferta local: %@", error);
+                return;
+            }
+            dispatch_async(signalingQueue, ^{
+                [weakSelf handleOfferMessage:message];
+            });
+        }];
+        return;
+    }
+    
+    RTCSessionDescription *description = [[RTCSessionDescription alloc] initWithType:RTCSdpTypeOffer sdp:sdp];
+    
+    [peerConnection setRemoteDescription:description completionHandler:^(NSError * _Nullable error) {
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao definir descrição remota: %@", error);
+            [weakSelf transitionToState:WebRTCConnectionStateError];
+            [weakSelf updateStatus:@"Erro na conexão WebRTC"];
+            return;
+        }
+        
+        typeof(self) strongSelf = weakSelf;
+        if (strongSelf) {
+            strongSelf->_setupProfile.mark(vcam::SetupPhase::RemoteDescriptionSet, HostTimeNs());
+        }
+        
+        // Criar resposta
+        RTCMediaConstraints *constraints = [[RTCMediaConstraints alloc]
+                                       initWithMandatoryConstraints:@{
+                                           @"OfferToReceiveVideo": @"true",
+                                           @"OfferToReceiveAudio": @"false"
+                                       }
+                                       optionalConstraints:nil];
+        
+        [peerConnection answerForConstraints:constraints
+                           completionHandler:^(RTCSessionDescription * _Nullable sdp, NSError * _Nullable error) {
+            if (error) {
+                NSLog(@"[WebRTCManager] Erro ao criar resposta: %@", error);
+                [weakSelf transitionToState:WebRTCConnectionStateError];
+                [weakSelf updateStatus:@"Erro ao criar resposta"];
+                return;
+            }
+            
+            [peerConnection setLocalDescription:sdp completionHandler:^(NSError * _Nullable error) {
+                if (error) {
+                    NSLog(@"[WebRTCManager] Erro ao definir descrição local: %@", error);
+                    return;
+                }
+                
+                // Enviar resposta
+                [weakSelf sendMessage:@{
+                    @"type": @"answer",
+                    @"sdp": sdp.sdp,
+                    @"roomId": weakSelf.roomId,
+                    @"senderDeviceType": @"ios"
+                }];
+                
+                typeof(self) strongSelf = weakSelf;
+                if (strongSelf) {
+                    strongSelf->_setupProfile.mark(vcam::SetupPhase::AnswerSent, HostTimeNs());
+                }
+                NSLog(@"[WebRTCManager] Resposta enviada");
+            }];
+        }];
+    }];
+}
+
+// Resposta do emissor à oferta de ICE restart
+- (void)handleAnswerMessage:(NSDictionary *)message {
+    NSString *sdp = message[@"sdp"];
+    if (!sdp) {
+        NSLog(@"[WebRTCManager] Resposta sem SDP");
+        return;
+    }
+    if (self.peerConnection.signalingState != RTCSignalingStateHaveLocalOffer) {
+        NSLog(@"[WebRTCManager] Resposta sem oferta local pendente, ignorada");
+        return;
+    }
+    
+    RTCSessionDescription *description = [[RTCSessionDescription alloc] initWithType:RTCSdpTypeAnswer sdp:sdp];
+    [self.peerConnection setRemoteDescription:description completionHandler:^(NSError * _Nullable error) {
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao aplicar resposta: %@", error);
+        }
+    }];
+}
+
+- (void)handleIceCandidateMessage:(NSDictionary *)message {
+    NSString *candidate = message[@"candidate"];
+    NSString *sdpMid = message[@"sdpMid"];
+    NSNumber *sdpMLineIndex = message[@"sdpMLineIndex"];
+    
+    if (!candidate || !sdpMid || !sdpMLineIndex) {
+        NSLog(@"[WebRTCManager] Candidato ICE com dados incompletos");
+        return;
+    }
+    
+    RTCIceCandidate *iceCandidate = [[RTCIceCandidate alloc] initWithSdp:candidate
+                                                      sdpMLineIndex:[sdpMLineIndex intValue]
+                                                             sdpMid:sdpMid];
+    
+    [self.peerConnection addIceCandidate:iceCandidate completionHandler:^(NSError * _Nullable error) {
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao adicionar candidato ICE: %@", error);
+        }
+    }];
+}
+
+#pragma mark - NSURLSessionWebSocketDelegate
+
+// Entrar na sala; com token, o servidor reata a sessão anterior sem avisar o emissor
+- (void)sendJoin {
+    NSMutableDictionary *join = [@{
+        @"type": @"join",
+        @"roomId": self.roomId,
+        @"deviceType": @"ios",
+        @"binaryProtocol": @((int)vcam::kSignalingProtocolVersion),
+        @"resumable": @YES,
+        @"capabilities": @{
+            @"preferredPixelFormats": @[@"420f", @"420v", @"BGRA"],
+            @"resolution": @{
+                @"width": @(self.targetResolution.width),
+                @"height": @(self.targetResolution.height)
+            }
+        }
+    } mutableCopy];
+    if (self.resumeToken) {
+        join[@"resumeToken"] = self.resumeToken;
+    }
+    [self sendMessage:join];
+    _setupProfile.mark(vcam::SetupPhase::JoinSent, HostTimeNs());
+}
+
+- (void)URLSession:(NSURLSession *)session webSocketTask:(NSURLSessionWebSocketTask *)webSocketTask didOpenWithProtocol:(NSString *)protocol {
+    if (webSocketTask != self.webSocketTask) {
+        return;
+    }
+    NSLog(@"[WebRTCManager] WebSocket conectado");
+    _setupProfile.mark(vcam::SetupPhase::SignalingOpen, HostTimeNs());
+    
+    self.signalingOpen = YES;
+    self.reconnectAttempt = 0;
+    
+    BOOL resuming = _signalingLostNs != 0;
+    if (resuming) {
+        self.lastSignalingOutage = (double)(HostTimeNs() - _signalingLostNs) / NSEC_PER_SEC;
+        _signalingLostNs = 0;
+        self.signalingReconnectCount++;
+        NSLog(@"[WebRTCManager] Sinalização restabelecida após %.0f ms (reconexão %lu, ICE %ld, recebendo %d)",
+              self.lastSignalingOutage * 1000, (unsigned long)self.signalingReconnectCount,
+              (long)self.peerConnection.iceConnectionState, self.isReceivingFrames);
+    }
+    
+    // Enviar mensagem de join para entrar na sala, depois o que ficou retido
+    [self sendJoin];
+    [self flushPendingSignals];
+    
+    [self updateStatus:resuming && self.isReceivingFrames ? @"Sinalização restabelecida, recebendo stream"
+                                                          : @"Conectado ao servidor, aguardando stream"];
+    
+    // Iniciar timer de keep-alive
+    [self startKeepAliveTimer];
+}
+
+- (void)URLSession:(NSURLSession *)session webSocketTask:(NSURLSessionWebSocketTask *)webSocketTask didCloseWithCode:(NSURLSessionWebSocketCloseCode)closeCode reason:(NSData *)reason {
+    NSString *reasonStr = [[NSString alloc] initWithData:reason encoding:NSUTF8StringEncoding] ?: @"Desconhecido";
+    NSLog(@"[WebRTCManager] WebSocket fechado: %@", reasonStr);
+    
+    // Se não foi uma desconexão explícita, reconectar só a sinalização
+    if (webSocketTask == self.webSocketTask) {
+        [self updateStatus:@"Conexão com o servidor perdida"];
+        [self signalingLostWithReason:reasonStr];
+    }
+}
+
+#pragma mark - RTCPeerConnectionDelegate
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection
+        didAddReceiver:(RTCRtpReceiver *)rtpReceiver
+               streams:(NSArray<RTCMediaStream *> *)mediaStreams {
+    // A conexão especulativa também reporta aqui; eventos dela (ou de uma já substituída) são ignorados
+    if (peerConnection != self.peerConnection) {
+        return;
+    }
+    
+    // Só para o marco do primeiro pacote RTP
+    rtpReceiver.delegate = self;
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didAddStream:(RTCMediaStream *)stream {
+    // Na fila de sinalização, como os demais eventos que mexem em videoTrack e no estado
+    dispatch_async(_signalingQueue, ^{
+        if (peerConnection != self.peerConnection) {
+            return;
+        }
+        
+        NSLog(@"[WebRTCManager] Stream adicionada: %@", stream.streamId);
+        
+        // Verificar se há faixas de vídeo
+        if (stream.videoTracks.count > 0) {
+            [self detachFrameRenderer];
+            self.videoTrack = stream.videoTracks[0];
+            NSLog(@"[WebRTCManager] Faixa de vídeo recebida: %@", self.videoTrack.trackId);
+            
+            // Anexar renderer para alimentar a substituição; nova stream, novo relógio
+            [self.frameRenderer resetCounters];
+            self->_clockResetPending = true;
+            {
+                std::lock_guard<std::mutex> lock(self->_outputsMutex);
+                for (auto &entry : self->_outputs) {
+                    entry.second.cadence.reset();
+                }
+            }
+            self->_formatRequestCount = 0;
+            self->_formatConversionCount = 0;
+            self->_attachmentPropagator.reset();
+            {
+                std::lock_guard<std::mutex> lock(self->_playoutMutex);
+                self->_playoutBuffer.clear();
+            }
+            [self.videoTrack addRenderer:self.frameRenderer];
+            
+            [self transitionToState:WebRTCConnectionStateConnected];
+            self.isReceivingFrames = YES;
+            [self updateStatus:@"Recebendo stream de vídeo"];
+        }
+    });
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didRemoveStream:(RTCMediaStream *)stream {
+    dispatch_async(_signalingQueue, ^{
+        if (peerConnection != self.peerConnection) {
+            return;
+        }
+        
+        NSLog(@"[WebRTCManager] Stream removida: %@", stream.streamId);
+        
+        if ([stream.videoTracks containsObject:self.videoTrack]) {
+            [self detachFrameRenderer];
+            self.isReceivingFrames = NO;
+            [self updateStatus:@"Stream de vídeo interrompida"];
+        }
+    });
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didGenerateIceCandidate:(RTCIceCandidate *)candidate {
+    // Na fila de sinalização, onde a conexão é trocada: candidatos da especulativa antes de ser
+    // adotada, ou de uma conexão já recriada, não podem sair com o roomId atual. A ordem em
+    // relação à resposta se mantém, porque sendMessage também enfileira nela.
+    dispatch_async(_signalingQueue, ^{
+        if (peerConnection != self.peerConnection) {
+            return;
+        }
+        
+        NSLog(@"[WebRTCManager] Candidato ICE gerado");
+        
+        // Enviar candidato para o servidor
+        [self sendMessage:@{
+            @"type": @"ice-candidate",
+            @"candidate": candidate.sdp,
+            @"sdpMid": candidate.sdpMid,
+            @"sdpMLineIndex": @(candidate.sdpMLineIndex),
+            @"roomId": self.roomId
+        }];
+    });
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didChangeIceConnectionState:(RTCIceConnectionState)newState {
+    NSLog(@"[WebRTCManager] Estado ICE alterado: %ld", (long)newState);
+    int64_t changedNs = HostTimeNs();
+    
+    // Na fila de sinalização, junto com a reconexão; eventos de uma conexão já recriada são ignorados
+    dispatch_async(_signalingQueue, ^{
+        if (peerConnection != self.peerConnection) {
+            return;
+        }
+        
+        switch (newState) {
+            case RTCIceConnectionStateChecking:
+                self->_setupProfile.mark(vcam::SetupPhase::IceChecking, changedNs);
+                break;
+                
+            case RTCIceConnectionStateConnected:
+            case RTCIceConnectionStateCompleted:
+                self->_setupProfile.mark(vcam::SetupPhase::IceConnected, changedNs);
+                self.iceRestartAttempt = 0;
+                [self transitionToState:WebRTCConnectionStateConnected];
+                [self updateStatus:@"Conexão WebRTC estabelecida"];
+                break;
+                
+            case RTCIceConnectionStateDisconnected:
+                // Costuma voltar sozinho; só Failed aciona o restart
+                [self transitionToState:WebRTCConnectionStateError];
+                [self updateStatus:@"Problema na conexão WebRTC"];
+                break;
+                
+            case RTCIceConnectionStateFailed:
+                [self transitionToState:WebRTCConnectionStateError];
+                [self updateStatus:@"Problema na conexão WebRTC"];
+                [self recoverFromIceFailure];
+                break;
+                
+            case RTCIceConnectionStateClosed:
+                [self transitionToState:WebRTCConnectionStateDisconnected];
+                [self updateStatus:@"Conexão WebRTC fechada"];
+                break;
+                
+            default:
+                // Outros estados não alteram o estado atual
+                break;
+        }
+    });
+}
+
+// ICE falhou: restartIce troca só o caminho de rede, mantendo conexão, decoder e
+// renderer. A conexão só é recriada quando os restarts se esgotam.
+- (void)recoverFromIceFailure {
+    if (self.iceRestartAttempt >= kMaxIceRestarts) {
+        [self rebuildPeerConnection];
+        return;
+    }
+    
+    NSUInteger attempt = ++self.iceRestartAttempt;
+    self.iceRestartCount++;
+    NSLog(@"[WebRTCManager] ICE falhou, restartIce (tentativa %lu de %lu)",
+          (unsigned long)attempt, (unsigned long)kMaxIceRestarts);
+    [self updateStatus:@"Reiniciando ICE"];
+    [self.peerConnection restartIce];
+    
+    // Sem reconexão a tempo (emissor não respondeu, rede ainda fora), tenta de novo
+    RTCPeerConnection *peerConnection = self.peerConnection;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kIceRestartTimeout * NSEC_PER_SEC)), _signalingQueue, ^{
+        RTCIceConnectionState state = peerConnection.iceConnectionState;
+        if (peerConnection == self.peerConnection && self.iceRestartAttempt == attempt &&
+            state != RTCIceConnectionStateConnected && state != RTCIceConnectionStateCompleted) {
+            [self recoverFromIceFailure];
+        }
+    });
+}
+
+// Último recurso: nova RTCPeerConnection e novo join sem token, para o emissor
+// ver um participante novo e refazer a oferta
+- (void)rebuildPeerConnection {
+    NSLog(@"[WebRTCManager] ICE não se recuperou após %lu restarts, recriando conexão", (unsigned long)kMaxIceRestarts);
+    [self updateStatus:@"Recriando conexão WebRTC"];
+    
+    [self resetPeerConnection];
+    
+    self.resumeToken = nil;
+    if (self.signalingOpen) {
+        [self sendJoin];
+    }
+}
+
+- (void)resetPeerConnection {
+    self.iceRestartAttempt = 0;
+    [self detachFrameRenderer];
+    self.isReceivingFrames = NO;
+    [self.peerConnection close];
+    self.peerConnection = nil;
+    [self setupWebRTC];
+}
+
+// Oferta com credenciais ICE novas para o emissor
+- (void)sendIceRestartOffer {
+    RTCPeerConnection *peerConnection = self.peerConnection;
+    RTCMediaConstraints *constraints = [[RTCMediaConstraints alloc]
+                                   initWithMandatoryConstraints:@{
+                                       @"OfferToReceiveVideo": @"true",
+                                       @"OfferToReceiveAudio": @"false",
+                                       kRTCMediaConstraintsIceRestart: @"true"
+                                   }
+                                   optionalConstraints:nil];
+    
+    __weak typeof(self) weakSelf = self;
+    [peerConnection offerForConstraints:constraints completionHandler:^(RTCSessionDescription * _Nullable sdp, NSError * _Nullable error) {
+        if (error) {
+            NSLog(@"[WebRTCManager] Erro ao criar oferta de ICE restart: %@", error);
+            return;
+        }
+        
+        [peerConnection setLocalDescription:sdp completionHandler:^(NSError * _Nullable error) {
+            if (error) {
+                NSLog(@"[WebRTCManager] Erro ao definir oferta de ICE restart: %@", error);
+                return;
+            }
+            
+            [weakSelf sendMessage:@{
+                @"type": @"offer",
+                @"sdp": sdp.sdp,
+                @"roomId": weakSelf.roomId,
+                @"senderDeviceType": @"ios"
+            }];
+            NSLog(@"[WebRTCManager] Oferta de ICE restart enviada");
+        }];
+    }];
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didOpenDataChannel:(RTCDataChannel *)dataChannel {
+    if (peerConnection != self.peerConnection) {
+        return;
+    }
+    NSLog(@"[WebRTCManager] Data channel aberto: %@", dataChannel.label);
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didRemoveIceCandidates:(NSArray<RTCIceCandidate *> *)candidates {
+    // Não é necessário implementar para este caso
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didChangeIceGatheringState:(RTCIceGatheringState)newState {
+    // Não é necessário implementar para este caso
+}
+
+- (void)peerConnection:(RTCPeerConnection *)peerConnection didChangeSignalingState:(RTCSignalingState)newState {
+    // Não é necessário implementar para este caso
+}
+
+- (void)peerConnectionShouldNegotiate:(RTCPeerConnection *)peerConnection {
+    // Só renegociamos para o ICE restart; a oferta inicial sempre vem do emissor
+    dispatch_async(_signalingQueue, ^{
+        if (peerConnection == self.peerConnection && self.iceRestartAttempt > 0) {
+            [self sendIceRestartOffer];
+        }
+    });
+}
+
+#pragma mark - Video Frames
+
+- (void)detachFrameRenderer {
+    if (self.videoTrack) {
+        [self.videoTrack removeRenderer:self.frameRenderer];
+        [self.frameRenderer discardPendingFrames];
+        NSLog(@"[WebRTCManager] Renderer removido (sem cópia: %llu, convertidos: %llu, pool: %llu/%llu)",
+              self.frameRenderer.zeroCopyFrameCount, self.frameRenderer.convertedFrameCount,
+              self.frameRenderer.poolHitCount, self.frameRenderer.poolMissCount);
+        [self logAllocationStats];
+        WebRTCPipelineStats pipeline = self.frameRenderer.pipelineStats;
+        NSLog(@"[WebRTCManager] Pipeline: %llu/%llu frames, descartados: %llu, profundidade máx.: %llu, fila %.2f/%.2f ms, conversão %.2f/%.2f ms (média/máx.)",
+              pipeline.processed, pipeline.submitted, pipeline.dropped, pipeline.maxDepth,
+              pipeline.queueAverageMs, pipeline.queueMaxMs, pipeline.workAverageMs, pipeline.workMaxMs);
+        vcam::AttachmentPropagatorStats propagation = _attachmentPropagator.stats();
+        NSLog(@"[WebRTCManager] Metadados: %llu frames, %.1f attachments/frame, %.2f us/frame (%llu chaves, conjunto mudou %llu vezes, %llu cópias completas)",
+              propagation.frames,
+              propagation.frames > 0 ? (double)propagation.attachments / propagation.frames : 0,
+              propagation.frames > 0 ? (double)propagation.totalNs / propagation.frames / 1000.0 : 0,
+              propagation.keys, propagation.resolves, propagation.scans);
+        // Lido fora da thread de conversão, mas o renderer já foi removido e a fila esvaziada
+        NSLog(@"[WebRTCManager] Relógio: deriva %.1f ppm, descontinuidades: %llu",
+              _clockBridge.driftPpm(), _clockBridge.discontinuityCount());
+        NSLog(@"[WebRTCManager] Playout: atraso atual %.1f ms, profundidade: %lu",
+              self.currentPlayoutDelay * 1000, (unsigned long)self.playoutDepth);
+        NSLog(@"[WebRTCManager] Cadência: repetidos: %llu (com stream parado: %llu), descartados: %llu, chamadas sem frame: %llu",
+              self.repeatedFrameCount, self.stalledCallbackCount, self.droppedFrameCount, self.droppedCallbackCount);
+        NSLog(@"[WebRTCManager] Outputs: %lu, entregas em outro formato: %llu, conversões: %llu (%.2f entregas/conversão)",
+              (unsigned long)self.captureOutputCount, self.formatRequestCount, self.formatConversionCount,
+              self.formatDeduplicationRatio);
+        self.videoTrack = nil;
+    }
+}
+
+// Alocações por entrega; em regime fica em 1 ou menos, já que consumidores do mesmo frame compartilham o buffer.
+// Inclui as cópias do dicionário de attachments, que em regime só acontecem a cada kRescanInterval frames
+- (void)logAllocationStats {
+    vcam::SampleBufferFactoryStats stats = _sampleBufferFactory.stats();
+    uint64_t scans = _attachmentPropagator.stats().scans;
+    uint64_t delivered = _deliveredFrameCount.load(std::memory_order_relaxed);
+    double perFrame = delivered > 0 ? (double)(stats.sampleBuffers + stats.formatDescriptions + scans) / delivered : 0;
+    NSLog(@"[WebRTCManager] Entregas: %llu, alocações/frame: %.3f (sample buffers: %llu, descrições: %llu, reaproveitadas: %llu, dicionários de attachments: %llu, falhas: %llu)",
+          delivered, perFrame, stats.sampleBuffers, stats.formatDescriptions, stats.formatReuses, scans, stats.failures);
+}
+
+// Chamado na thread de conversão do renderer para cada frame pronto
+- (void)publishPixelBuffer:(CVPixelBufferRef)pixelBuffer frame:(RTCVideoFrame *)frame {
+    if (_clockResetPending.exchange(false)) {
+        _clockBridge.reset();
+    }
+    
+    // PTS no mesmo relógio dos buffers da câmera, para gravações com cadência estável
+    int64_t arrivalNs = HostTimeNs();
+    if (_setupProfile.mark(vcam::SetupPhase::FirstDecodedFrame, arrivalNs)) {
+        [self firstFrameDecoded];
+    }
+    vcam::MappedTime mapped = _clockBridge.map(frame.timeStampNs, arrivalNs);
+    CMTime duration = mapped.durationNs > 0 ? CMTimeMake(mapped.durationNs, NSEC_PER_SEC) : kCMTimeInvalid;
+    
+    int64_t probeTimestampMs = _latencyProbeEnabled.load(std::memory_order_relaxed) ? ReadProbeTimestamp(frame.buffer) : -1;
+    
+    uint64_t frameId = _nextFrameId.fetch_add(1, std::memory_order_relaxed) + 1;
+    vcam::SharedFrameRef shared = std::make_shared<const vcam::SharedFrame>(frameId,
+                                                                            vcam::CFHandle<CVPixelBufferRef>::retain(pixelBuffer),
+                                                                            CMTimeMake(mapped.ptsNs, NSEC_PER_SEC),
+                                                                            duration,
+                                                                            probeTimestampMs);
+    if (!_playoutEnabled.load(std::memory_order_relaxed)) {
+        [self publishFrame:std::move(shared)];
+        return;
+    }
+    
+    int64_t scheduleNs = 0;
+    {
+        std::lock_guard<std::mutex> lock(_playoutMutex);
+        _playoutBuffer.push(std::move(shared), mapped.ptsNs, arrivalNs);
+        int64_t dueNs = _playoutBuffer.nextDueNs();
+        if (_playoutScheduledNs == 0 || dueNs < _playoutScheduledNs) {
+            _playoutScheduledNs = dueNs;
+            scheduleNs = dueNs;
+        }
+    }
+    if (scheduleNs != 0) {
+        [self schedulePlayoutAt:scheduleNs];
+    }
+}
+
+- (void)publishFrame:(vcam::SharedFrameRef)frame {
+    {
+        std::lock_guard<std::mutex> lock(_publishMutex);
+        
+        // Visões de cada output produzidas aqui, fora da fila da câmera, antes do frame ficar visível
+        uint64_t generation = _viewFormatsGeneration.load(std::memory_order_acquire);
+        if (generation != _preparedGeneration) {
+            std::lock_guard<std::mutex> outputsLock(_outputsMutex);
+            _preparedFormats = _viewFormats;
+            _preparedGeneration = _viewFormatsGeneration.load(std::memory_order_relaxed);
+        }
+        if (!_preparedFormats.empty()) {
+            size_t conversions = frame->prepareViews(_preparedFormats, *_viewConverter);
+            _formatConversionCount.fetch_add(conversions, std::memory_order_relaxed);
+        }
+        
+        vcam::HotPathState::shared().publishFrame(frame->frameId());
+        _published.previous = std::move(_published.latest);
+        _published.previousNs = _published.latestNs;
+        _published.latest = std::move(frame);
+        _published.latestNs = HostTimeNs();
+        _frameSlot.publish(_published);
+    }
+    
+    // Publicações seguidas antes da fila rodar viram uma única atualização
+    if (self.previewLayer && !_previewScheduled.exchange(true)) {
+        __weak typeof(self) weakSelf = self;
+        dispatch_async(_previewQueue, ^{
+            typeof(self) strongSelf = weakSelf;
+            if (strongSelf) {
+                strongSelf->_previewScheduled = false;
+                [strongSelf feedPreviewLayer];
+            }
+        });
+    }
+}
+
+- (void)schedulePlayoutAt:(int64_t)dueNs {
+    __weak typeof(self) weakSelf = self;
+    int64_t waitNs = std::max<int64_t>(dueNs - HostTimeNs(), 0);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, waitNs), _playoutQueue, ^{
+        [weakSelf releaseDuePlayoutFrames];
+    });
+}
+
+// Na fila de playout: publica o frame vencido mais recente e reagenda para o próximo
+- (void)releaseDuePlayoutFrames {
+    vcam::SharedFrameRef due;
+    bool found;
+    int64_t scheduleNs = 0;
+    {
+        std::lock_guard<std::mutex> lock(_playoutMutex);
+        found = _playoutBuffer.popDue(HostTimeNs(), due);
+        _playoutScheduledNs = _playoutBuffer.nextDueNs();
+        scheduleNs = _playoutScheduledNs;
+    }
+    if (found) {
+        [self publishFrame:std::move(due)];
+    }
+    if (scheduleNs != 0) {
+        [self schedulePlayoutAt:scheduleNs];
+    }
+}
+
+// Com timing próprio o CMSampleBuffer é exclusivo do chamador; sem ele, é a visão compartilhada do frame
+- (CMSampleBufferRef)createSampleBufferFromFrame:(const vcam::SharedFrameRef &)frame
+                                        inFormat:(OSType)format
+                                          timing:(const CMSampleTimingInfo *)timing {
+    CMSampleBufferRef sampleBuffer = NULL;
+    if (timing) {
+        vcam::CFHandle<CVPixelBufferRef> pixelBuffer = frame->pixelBufferInFormat(format, *_viewConverter);
+        sampleBuffer = pixelBuffer ? _sampleBufferFactory.create(pixelBuffer.get(), *timing) : NULL;
+    } else {
+        sampleBuffer = frame->sampleBuffer(format, _sampleBufferFactory, *_viewConverter).release();
+    }
+    
+    if (sampleBuffer) {
+        _deliveredFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return sampleBuffer;
+}
+
+// Entrega com timing da câmera em formato/tamanho arbitrário; só consulta a visão produzida na publicação.
+// `pending` recebe YES se o formato foi registrado depois da publicação do frame
+- (CMSampleBufferRef)createSampleBufferFromFrame:(const vcam::SharedFrameRef &)frame
+                                   inFrameFormat:(const vcam::FrameFormat &)format
+                                          timing:(const CMSampleTimingInfo &)timing
+                                         pending:(BOOL *)pending {
+    CVPixelBufferRef published = frame->pixelBuffer();
+    bool derived = format.pixelFormat != CVPixelBufferGetPixelFormatType(published) ||
+                   format.width != (int)CVPixelBufferGetWidth(published) ||
+                   format.height != (int)CVPixelBufferGetHeight(published);
+    
+    bool notReady = false;
+    vcam::CFHandle<CVPixelBufferRef> pixelBuffer = frame->preparedPixelBuffer(format, &notReady);
+    if (derived) {
+        _formatRequestCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (pending) {
+        *pending = notReady;
+    }
+    if (!pixelBuffer) {
+        return NULL;
+    }
+    
+    CMSampleBufferRef sampleBuffer = _sampleBufferFactory.create(pixelBuffer.get(), timing);
+    if (sampleBuffer) {
+        _deliveredFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return sampleBuffer;
+}
+
+- (CMSampleBufferRef)createSampleBufferFromLatestInFormat:(OSType)format
+                                                   timing:(const CMSampleTimingInfo *)timing
+                                                  frameId:(uint64_t *)frameId {
+    PublishedFrames published;
+    if (!_frameSlot.read(published)) {
+        return NULL;
+    }
+    const vcam::SharedFrameRef &latest = published.latest;
+    
+    CMSampleBufferRef sampleBuffer = [self createSampleBufferFromFrame:latest inFormat:format timing:timing];
+    if (sampleBuffer && frameId) {
+        *frameId = latest->frameId();
+    }
+    return sampleBuffer;
+}
+
+- (CMSampleBufferRef)getConformedSampleBufferForCameraBuffer:(CMSampleBufferRef)cameraBuffer dropped:(BOOL *)dropped {
+    return [self getConformedSampleBufferForCameraBuffer:cameraBuffer output:nil dropped:dropped];
+}
+
+- (CMSampleBufferRef)getConformedSampleBufferForCameraBuffer:(CMSampleBufferRef)cameraBuffer
+                                                      output:(AVCaptureOutput *)output
+                                                     dropped:(BOOL *)dropped {
+    if (dropped) {
+        *dropped = NO;
+    }
+    if (!cameraBuffer) {
+        return NULL;
+    }
+    
+    CVImageBufferRef nativeBuffer = CMSampleBufferGetImageBuffer(cameraBuffer);
+    vcam::FrameFormat native = { 0, 0, 0 };
+    if (nativeBuffer) {
+        native.pixelFormat = CVPixelBufferGetPixelFormatType(nativeBuffer);
+        native.width = (int)CVPixelBufferGetWidth(nativeBuffer);
+        native.height = (int)CVPixelBufferGetHeight(nativeBuffer);
+    }
+    
+    // Estado de recepção lido do snapshot atômico, não da propriedade nonatomic
+    vcam::HotPathSnapshot hotPath = vcam::HotPathState::shared().load();
+    CMSampleTimingInfo timing;
+    bool deliver = hotPath.receiving && hotPath.frameId != 0 &&
+                   CMSampleBufferGetSampleTimingInfo(cameraBuffer, 0, &timing) == noErr;
+    
+    // Lê o par publicado antes de decidir: a decisão vale para exatamente estes frames
+    PublishedFrames published;
+    if (deliver) {
+        _frameSlot.read(published);
+    }
+    
+    vcam::FrameFormat format;
+    vcam::CadenceDecision decision = vcam::CadenceDecision::Drop;
+    int64_t intervalNs = 0;
+    uint64_t chosenId = 0;
+    bool resize = false;
+    CMVideoDimensions target = { 0, 0 };
+    {
+        std::lock_guard<std::mutex> lock(_outputsMutex);
+        CaptureOutputState &state = StateForOutput(_outputs, output);
+        
+        if (native.width != state.cameraDimensions.width || native.height != state.cameraDimensions.height) {
+            state.cameraDimensions.width = native.width;
+            state.cameraDimensions.height = native.height;
+            target = [self largestOutputDimensions];
+            resize = target.width != _outputTargetDimensions.width || target.height != _outputTargetDimensions.height;
+            _outputTargetDimensions = target;
+        }
+        
+        // Formato pedido pelo output; o tamanho segue o buffer nativo, que já sai rotacionado pela conexão
+        format.pixelFormat = state.requested.pixelFormat ? state.requested.pixelFormat : native.pixelFormat;
+        format.width = native.width ? native.width : state.requested.width;
+        format.height = native.height ? native.height : state.requested.height;
+        if (!(format == state.conformed)) {
+            state.conformed = format;
+            [self updateViewFormats];
+        }
+        
+        if (deliver) {
+            CMTime callbackTime = CMTimeConvertScale(timing.presentationTimeStamp, NSEC_PER_SEC, kCMTimeRoundingMethod_Default);
+            vcam::CadenceFrame latestFrame = { published.latest ? published.latest->frameId() : 0, published.latestNs };
+            vcam::CadenceFrame previousFrame = { published.previous ? published.previous->frameId() : 0,
+                                                 published.previousNs };
+            decision = state.cadence.decide(latestFrame, previousFrame, callbackTime.value);
+            intervalNs = state.cadence.cameraIntervalNs();
+            chosenId = state.cadence.frameId();
+        }
+    }
+    
+    if (resize && target.width > 0 && target.height > 0) {
+        [self setTargetResolution:target];
+    }
+    if (!deliver) {
+        return NULL;
+    }
+    
+    if (decision == vcam::CadenceDecision::Drop) {
+        if (dropped) {
+            *dropped = YES;
+        }
+        return NULL;
+    }
+    
+    // O matcher pode segurar o mais recente e entregar (ou repetir) o anterior
+    const vcam::SharedFrameRef &latest =
+        published.previous && published.previous->frameId() == chosenId ? published.previous : published.latest;
+    
+    // Só a primeira entrega do frame conta para a latência
+    if (decision == vcam::CadenceDecision::Deliver && latest->probeTimestampMs() >= 0) {
+        [self recordLatencyForProbeTimestamp:latest->probeTimestampMs()];
+    }
+    
+    // Repetição também recebe PTS próprio: o do buffer da câmera
+    if (!CMTIME_IS_VALID(timing.duration) && intervalNs > 0) {
+        timing.duration = CMTimeMake(intervalNs, NSEC_PER_SEC);
+    }
+    // Visão ainda não produzida (formato novo): pula a chamada em vez de entregar a câmera real
+    BOOL pending = NO;
+    CMSampleBufferRef sampleBuffer = [self createSampleBufferFromFrame:latest inFrameFormat:format timing:timing pending:&pending];
+    if (pending) {
+        if (dropped) {
+            *dropped = YES;
+        }
+        return NULL;
+    }
+    _attachmentPropagator.propagate(cameraBuffer, sampleBuffer);
+    if (sampleBuffer && _setupProfile.mark(vcam::SetupPhase::FirstSubstitutedFrame, HostTimeNs())) {
+        [self setupPhaseReached];
+    }
+    return sampleBuffer;
+}
+
+// Com _outputsMutex travado; formatos distintos dos outputs vivos, produzidos a cada publicação
+- (void)updateViewFormats {
+    _viewFormats.clear();
+    for (const auto &entry : _outputs) {
+        const vcam::FrameFormat &format = entry.second.conformed;
+        if (entry.first && !entry.second.output) {
+            continue;
+        }
+        if (std::find(_viewFormats.begin(), _viewFormats.end(), format) == _viewFormats.end()) {
+            _viewFormats.push_back(format);
+        }
+    }
+    _viewFormatsGeneration.fetch_add(1, std::memory_order_release);
+}
+
+// Com _outputsMutex travado; descarta outputs já liberados
+- (CMVideoDimensions)largestOutputDimensions {
+    CMVideoDimensions largest = { 0, 0 };
+    for (auto it = _outputs.begin(); it != _outputs.end();) {
+        if (it->first && !it->second.output) {
+            it = _outputs.erase(it);
+            continue;
+        }
+        const CMVideoDimensions &dimensions = it->second.cameraDimensions;
+        if ((int64_t)dimensions.width * dimensions.height > (int64_t)largest.width * largest.height) {
+            largest = dimensions;
+        }
+        ++it;
+    }
+    return largest;
+}
+
+- (void)setVideoSettings:(NSDictionary *)videoSettings forOutput:(AVCaptureOutput *)output {
+    NSNumber *pixelFormat = videoSettings[(id)kCVPixelBufferPixelFormatTypeKey];
+    NSNumber *width = videoSettings[(id)kCVPixelBufferWidthKey] ?: videoSettings[AVVideoWidthKey];
+    NSNumber *height = videoSettings[(id)kCVPixelBufferHeightKey] ?: videoSettings[AVVideoHeightKey];
+    
+    vcam::FrameFormat requested = {
+        [pixelFormat isKindOfClass:[NSNumber class]] ? (OSType)pixelFormat.unsignedIntValue : 0,
+        [width isKindOfClass:[NSNumber class]] ? width.intValue : 0,
+        [height isKindOfClass:[NSNumber class]] ? height.intValue : 0
+    };
+    {
+        std::lock_guard<std::mutex> lock(_outputsMutex);
+        StateForOutput(_outputs, output).requested = requested;
+    }
+    
+    NSLog(@"[WebRTCManager] Output %p: formato '%c%c%c%c', %dx%d", output,
+          (char)(requested.pixelFormat >> 24), (char)(requested.pixelFormat >> 16),
+          (char)(requested.pixelFormat >> 8), (char)requested.pixelFormat,
+          requested.width, requested.height);
+}
+
+- (uint64_t)repeatedFrameCount {
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    uint64_t total = 0;
+    for (const auto &entry : _outputs) {
+        total += entry.second.cadence.stats().repeated;
+    }
+    return total;
+}
+
+- (uint64_t)droppedFrameCount {
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    uint64_t total = 0;
+    for (const auto &entry : _outputs) {
+        total += entry.second.cadence.stats().droppedFrames;
+    }
+    return total;
+}
+
+- (uint64_t)droppedCallbackCount {
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    uint64_t total = 0;
+    for (const auto &entry : _outputs) {
+        total += entry.second.cadence.stats().droppedCallbacks;
+    }
+    return total;
+}
+
+- (uint64_t)stalledCallbackCount {
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    uint64_t total = 0;
+    for (const auto &entry : _outputs) {
+        total += entry.second.cadence.stats().stalledCallbacks;
+    }
+    return total;
+}
+
+- (NSUInteger)captureOutputCount {
+    std::lock_guard<std::mutex> lock(_outputsMutex);
+    return _outputs.size();
+}
+
+- (uint64_t)formatRequestCount {
+    return _formatRequestCount.load(std::memory_order_relaxed);
+}
+
+- (uint64_t)formatConversionCount {
+    return _formatConversionCount.load(std::memory_order_relaxed);
+}
+
+- (double)formatDeduplicationRatio {
+    uint64_t conversions = self.formatConversionCount;
+    return conversions > 0 ? (double)self.formatRequestCount / conversions : 0;
+}
+
+- (CMSampleBufferRef)getLatestVideoSampleBuffer {
+    return [self getLatestVideoSampleBufferInFormat:0 frameId:NULL];
+}
+
+- (CMSampleBufferRef)getLatestVideoSampleBufferInFormat:(OSType)pixelFormat frameId:(uint64_t *)frameId {
+    // Thread da câmera ou do preview: nada de propriedades nonatomic mudadas na fila de sinalização
+    if (!vcam::HotPathState::shared().load().receiving) {
+        return NULL;
+    }
+    
+    return [self createSampleBufferFromLatestInFormat:pixelFormat timing:NULL frameId:frameId];
+}
+
+#pragma mark - Preview
+
+// Na _previewQueue. A contrapressão vem da própria camada: sem espaço, espera o
+// requestMediaDataWhenReady em vez de descartar o que já está enfileirado
+- (void)feedPreviewLayer {
+    AVSampleBufferDisplayLayer *layer = self.previewLayer;
+    if (!layer || _previewWaiting) {
+        return;
+    }
+    
+    if (layer.status == AVQueuedSampleBufferRenderingStatusFailed) {
+        NSLog(@"[WebRTCManager] Preview falhou (%@), reiniciando camada", layer.error);
+        [layer flush];
+    }
+    
+    if (!layer.readyForMoreMediaData) {
+        _previewWaiting = YES;
+        __weak typeof(self) weakSelf = self;
+        __weak AVSampleBufferDisplayLayer *weakLayer = layer;
+        [layer requestMediaDataWhenReadyOnQueue:_previewQueue usingBlock:^{
+            [weakLayer stopRequestingMediaData];
+            typeof(self) strongSelf = weakSelf;
+            if (strongSelf) {
+                strongSelf->_previewWaiting = NO;
+                [strongSelf feedPreviewLayer];
+            }
+        }];
+        return;
+    }
+    
+    PublishedFrames published;
+    if (!_frameSlot.read(published) || published.latest->frameId() == _lastPreviewFrameId) {
+        return;
+    }
+    const vcam::SharedFrameRef &latest = published.latest;
+    
+    // Buffer próprio do preview: o anexo não pode vazar para o buffer compartilhado com os data outputs
+    CMSampleTimingInfo timing = { kCMTimeInvalid, latest->presentationTime(), kCMTimeInvalid };
+    CMSampleBufferRef sampleBuffer = [self createSampleBufferFromFrame:latest inFormat:0 timing:&timing];
+    if (!sampleBuffer) {
+        return;
+    }
+    
+    CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, true);
+    if (attachments && CFArrayGetCount(attachments) > 0) {
+        CFMutableDictionaryRef attachment = (CFMutableDictionaryRef)CFArrayGetValueAtIndex(attachments, 0);
+        CFDictionarySetValue(attachment, kCMSampleAttachmentKey_DisplayImmediately, kCFBooleanTrue);
+    }
+    
+    _lastPreviewFrameId = latest->frameId();
+    [layer enqueueSampleBuffer:sampleBuffer];
+    CFRelease(sampleBuffer);
+    
+    if (_setupProfile.mark(vcam::SetupPhase::FirstPreviewFrame, HostTimeNs())) {
+        [self setupPhaseReached];
+    }
+}
+
+#pragma mark - Playout
+
+- (void)setPlayoutDelay:(NSTimeInterval)playoutDelay {
+    int64_t delayNs = (int64_t)(std::max(playoutDelay, 0.0) * NSEC_PER_SEC);
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    _playoutBuffer.setTargetDelay(delayNs);
+    
+    // Atraso zero: o decoder volta a publicar direto; frames ainda na fila são descartados
+    bool enabled = _playoutBuffer.targetDelayNs() > 0;
+    if (!enabled) {
+        _playoutBuffer.clear();
+    }
+    _playoutEnabled.store(enabled, std::memory_order_relaxed);
+    NSLog(@"[WebRTCManager] Atraso de playout: %.0f ms%@", _playoutBuffer.targetDelayNs() / 1e6,
+          _playoutBuffer.isAdaptive() ? @" (adaptativo)" : @"");
+}
+
+- (NSTimeInterval)playoutDelay {
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    return (NSTimeInterval)_playoutBuffer.targetDelayNs() / NSEC_PER_SEC;
+}
+
+- (void)setAdaptivePlayoutDelay:(BOOL)adaptivePlayoutDelay {
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    _playoutBuffer.setAdaptive(adaptivePlayoutDelay);
+}
+
+- (BOOL)adaptivePlayoutDelay {
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    return _playoutBuffer.isAdaptive();
+}
+
+- (NSUInteger)playoutDepth {
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    return _playoutBuffer.depth();
+}
+
+- (NSTimeInterval)currentPlayoutDelay {
+    std::lock_guard<std::mutex> lock(_playoutMutex);
+    return _playoutEnabled.load(std::memory_order_relaxed) ? (NSTimeInterval)_playoutBuffer.currentDelayNs() / NSEC_PER_SEC : 0;
+}
+
+#pragma mark - Latência
+
+- (void)setLatencyProbeEnabled:(BOOL)latencyProbeEnabled {
+    _latencyProbeEnabled.store(latencyProbeEnabled, std::memory_order_relaxed);
+    NSLog(@"[WebRTCManager] Sonda de latência %@", latencyProbeEnabled ? @"ativada" : @"desativada");
+}
+
+- (BOOL)latencyProbeEnabled {
+    return _latencyProbeEnabled.load(std::memory_order_relaxed);
+}
+
+// Mantém a amostra de menor RTT: é a de menor erro no ponto médio
+- (void)updateServerClockWithPong:(NSDictionary *)message {
+    NSNumber *clientTimestamp = message[@"clientTimestamp"];
+    NSNumber *serverTimestamp = message[@"timestamp"];
+    if (!clientTimestamp || !serverTimestamp) {
+        return;
+    }
+    
+    int64_t now = WallTimeMs();
+    int64_t sent = clientTimestamp.longLongValue;
+    int64_t rtt = now - sent;
+    if (rtt < 0) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(_latencyMutex);
+    if (_serverClockRttMs < 0 || rtt <= _serverClockRttMs) {
+        _serverClockRttMs = rtt;
+        _serverClockOffsetMs = serverTimestamp.longLongValue - (sent + now) / 2;
+    }
+}
+
+- (void)recordLatencyForProbeTimestamp:(int64_t)probeTimestampMs {
+    std::lock_guard<std::mutex> lock(_latencyMutex);
+    if (_serverClockRttMs < 0) {
+        return;
+    }
+    _latencyHistogram.record((double)(WallTimeMs() + _serverClockOffsetMs - probeTimestampMs));
+}
+
+// Envia e zera a janela de medições pelo canal de estatísticas
+- (void)sendLatencyReport {
+    static const int kBucketMs = 10;
+    vcam::LatencySummary summary;
+    std::vector<uint32_t> buckets;
+    int64_t rtt;
+    {
+        std::lock_guard<std::mutex> lock(_latencyMutex);
+        if (_latencyHistogram.count() == 0) {
+            return;
+        }
+        summary = _latencyHistogram.summary();
+        buckets = _latencyHistogram.buckets(kBucketMs);
+        rtt = _serverClockRttMs;
+        _latencyHistogram.reset();
+    }
+    
+    NSMutableArray *bucketArray = [NSMutableArray arrayWithCapacity:buckets.size()];
+    for (uint32_t count : buckets) {
+        [bucketArray addObject:@(count)];
+    }
+    
+    NSLog(@"[WebRTCManager] Latência: p50 %.0f ms, p95 %.0f ms, p99 %.0f ms (%llu frames)",
+          summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.count);
+    [self sendMessage:@{
+        @"type": @"stats",
+        @"roomId": self.roomId,
+        @"stats": @{
+            @"latency": @{
+                @"count": @(summary.count),
+                @"p50": @(summary.p50Ms),
+                @"p95": @(summary.p95Ms),
+                @"p99": @(summary.p99Ms),
+                @"max": @(summary.maxMs),
+                @"clockRtt": @(rtt),
+                @"bucketMs": @(kBucketMs),
+                @"buckets": bucketArray
+            }
+        }
+    }];
+}
+
+#pragma mark - RTCRtpReceiverDelegate
+
+- (void)rtpReceiver:(RTCRtpReceiver *)rtpReceiver didReceiveFirstPacketForMediaType:(RTCRtpMediaType)mediaType {
+    if (mediaType == RTCRtpMediaTypeVideo) {
+        _setupProfile.mark(vcam::SetupPhase::FirstRtpPacket, HostTimeNs());
+    }
+}
+
+#pragma mark - Perfil de estabelecimento
+
+// Na thread do renderer, uma vez por sessão
+- (void)firstFrameDecoded {
+    self.timeToFirstFrame = _setupProfile.elapsedMs(vcam::SetupPhase::FirstDecodedFrame) / 1000.0;
+    
+    dispatch_async(_signalingQueue, ^{
+        NSUInteger generation = self->_setupGeneration;
+        __weak typeof(self) weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kSetupProfileGrace * NSEC_PER_SEC)),
+                       self->_signalingQueue, ^{
+            typeof(self) strongSelf = weakSelf;
+            if (strongSelf && strongSelf->_setupGeneration == generation) {
+                [strongSelf finishSetupProfile];
+            }
+        });
+    });
+    [self setupPhaseReached];
+}
+
+// De qualquer thread: fecha o perfil quando os últimos marcos esperados chegaram
+- (void)setupPhaseReached {
+    dispatch_async(_signalingQueue, ^{
+        if (self->_setupProfile.marked(vcam::SetupPhase::FirstDecodedFrame) &&
+            self->_setupProfile.marked(vcam::SetupPhase::FirstSubstitutedFrame) &&
+            (self->_setupProfile.marked(vcam::SetupPhase::FirstPreviewFrame) || !self.previewLayer)) {
+            [self finishSetupProfile];
+        }
+    });
+}
+
+// Na fila de sinalização: um resumo por sessão, no log e pelo canal de estatísticas
+- (void)finishSetupProfile {
+    if (!_setupProfile.finish()) {
+        return;
+    }
+    
+    NSMutableDictionary *phases = [NSMutableDictionary dictionaryWithCapacity:vcam::kSetupPhaseCount];
+    NSMutableString *summary = [NSMutableString string];
+    for (size_t i = 0; i < vcam::kSetupPhaseCount; i++) {
+        vcam::SetupPhase phase = (vcam::SetupPhase)i;
+        double elapsedMs = _setupProfile.elapsedMs(phase);
+        if (elapsedMs < 0) {
+            continue;
+        }
+        NSString *name = @(vcam::SetupPhaseName(phase));
+        phases[name] = @(lround(elapsedMs));
+        [summary appendFormat:@" %@ %.0f", name, elapsedMs];
+    }
+    
+    BOOL warm = _warmStart.load();
+    BOOL speculative = _speculativeStart.load();
+    NSLog(@"[WebRTCManager] Estabelecimento (ms, fábrica %@, conexão %@):%@",
+          warm ? @"pronta" : @"fria", speculative ? @"especulativa" : @"nova",
+          summary.length > 0 ? summary : @" nenhuma fase");
+    
+    if (phases.count == 0 || !self.roomId) {
+        return;
+    }
+    [self sendMessage:@{
+        @"type": @"stats",
+        @"roomId": self.roomId,
+        @"stats": @{
+            @"setup": @{
+                @"phases": phases,
+                @"factoryWarm": @(warm),
+                @"speculative": @(speculative)
+            }
+        }
+    }];
+}
+
+#pragma mark - Utilidades
+
+- (void)updateStatus:(NSString *)status {
+    NSLog(@"[WebRTCManager] Status: %@", status);
+    
+    // Único trabalho do WebRTCManager na main thread; o custo entra no log do fim da sessão
+    void (^callback)(NSString *) = self.statusUpdateCallback;
+    if (callback) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            int64_t start = HostTimeNs();
+            callback(status);
+            self->_mainThreadCost.record((uint64_t)(HostTimeNs() - start));
+        });
+    }
+}
+
+- (CMSampleBufferRef)getLatestVideoSampleBufferWithOriginalMetadata:(CMSampleBufferRef)originalBuffer {
+    // Mesma leitura atômica de getLatestVideoSampleBufferInFormat:
+    if (!vcam::HotPathState::shared().load().receiving) {
+        return NULL;
+    }
+    
+    // Timing do buffer original aplicado direto na criação; sem ele, usa o PTS do stream já no relógio do host
+    CMSampleTimingInfo timing;
+    if (originalBuffer && CMSampleBufferGetSampleTimingInfo(originalBuffer, 0, &timing) == noErr) {
+        CMSampleBufferRef sampleBuffer = [self createSampleBufferFromLatestInFormat:0 timing:&timing frameId:NULL];
+        _attachmentPropagator.propagate(originalBuffer, sampleBuffer);
+        return sampleBuffer;
+    }
+    
+    return [self createSampleBufferFromLatestInFormat:0 timing:NULL frameId:NULL];
+}
+
+- (void)adaptToNativeCameraWithPosition:(AVCaptureDevicePosition)position {
+    self.currentCameraPosition = position;
+    
+    // Outra câmera, outro conjunto de metadados
+    _attachmentPropagator.reset();
+    
+    // Tamanhos nativos mudam com a câmera: o próximo buffer de cada output redefine o alvo
+    {
+        std::lock_guard<std::mutex> lock(_outputsMutex);
+        for (auto &entry : _outputs) {
+            entry.second.cameraDimensions = { 0, 0 };
+        }
+        _outputTargetDimensions = { 0, 0 };
+    }
+    
+    NSLog(@"[WebRTCManager] Adaptando para câmera: %@",
+          position == AVCaptureDevicePositionFront ? @"frontal" : @"traseira");
+    
+    // Usa o formato ativo da câmera nativa como alvo até chegar o primeiro buffer real
+    AVCaptureDevice *device = [AVCaptureDevice defaultDeviceWithDeviceType:AVCaptureDeviceTypeBuiltInWideAngleCamera
+                                                                 mediaType:AVMediaTypeVideo
+                                                                  position:position];
+    if (!device) {
+        return;
+    }
+    
+    CMVideoDimensions dimensions = CMVideoFormatDescriptionGetDimensions(device.activeFormat.formatDescription);
+    if (dimensions.width <= 0 || dimensions.height <= 0) {
+        return;
+    }
+    
+    // Formato ativo é paisagem (sensor); em retrato a saída troca largura e altura
+    if (self.videoOrientation == AVCaptureVideoOrientationPortrait ||
+        self.videoOrientation == AVCaptureVideoOrientationPortraitUpsideDown) {
+        int32_t width = dimensions.width;
+        dimensions.width = dimensions.height;
+        dimensions.height = width;
+    }
+    [self setTargetResolution:dimensions];
+}
+
+- (void)setTargetResolution:(CMVideoDimensions)resolution {
+    _targetResolution = resolution;
+    self.frameRenderer.targetSize = CGSizeMake(resolution.width, resolution.height);
+    
+    NSLog(@"[WebRTCManager] Definindo resolução alvo: %dx%d",
+          resolution.width, resolution.height);
+}
+
+- (void)adaptOutputToVideoOrientation:(int)orientation {
+    self.videoOrientation = orientation;
+    self.frameRenderer.outputRotation = RotationForVideoOrientation(orientation);
+    
+    NSLog(@"[WebRTCManager] Adaptando para orientação: %d", orientation);
+}
+
+- (void)setVideoMirrored:(BOOL)mirrored {
+    _videoMirrored = mirrored;
+    self.frameRenderer.outputMirrored = mirrored;
+    
+    NSLog(@"[WebRTCManager] Espelhamento: %@", mirrored ? @"ativado" : @"desativado");
+}
+
+@end
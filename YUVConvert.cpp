@@ -0,0 +1,408 @@
+#include "YUVConvert.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VCAM_YUV_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VCAM_YUV_X86 1
+#endif
+
+namespace vcam {
+
+namespace {
+
+// Operação de faixa aplicada a cada amostra
+enum class RangeOp {
+    Copy,     // mesma faixa
+    Expand,   // vídeo -> completa
+    Compress  // completa -> vídeo
+};
+
+RangeOp rangeOpFor(YUVRange srcRange, YUVRange dstRange) {
+    if (srcRange == dstRange) {
+        return RangeOp::Copy;
+    }
+    return srcRange == YUVRange::Video ? RangeOp::Expand : RangeOp::Compress;
+}
+
+typedef void (*LumaRowFn)(const uint8_t *src, uint8_t *dst, int width, RangeOp op);
+typedef void (*ChromaRowFn)(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width, RangeOp op);
+
+// --- Escalar ---
+
+// Fórmulas em ponto fixo Q8 escolhidas para caber em lanes de 16 bits:
+//   Y vídeo->completa:  t = max(Y-16, 0); Y' = t + (t*42 + 128) >> 8   (~255/219)
+//   C vídeo->completa:  d = C-128;        C' = d + (d*36 + 128) >> 8 + 128 (~255/224)
+//   Y completa->vídeo:  Y' = (Y*219 + 128) >> 8 + 16
+//   C completa->vídeo:  C' = (d*224 + 128) >> 8 + 128
+
+inline uint8_t clampToByte(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline uint8_t lumaScalar(uint8_t x, RangeOp op) {
+    switch (op) {
+        case RangeOp::Expand: {
+            int t = x > 16 ? x - 16 : 0;
+            return clampToByte(t + ((t * 42 + 128) >> 8));
+        }
+        case RangeOp::Compress:
+            return (uint8_t)(((x * 219 + 128) >> 8) + 16);
+        default:
+            return x;
+    }
+}
+
+inline uint8_t chromaScalar(uint8_t x, RangeOp op) {
+    int d = x - 128;
+    switch (op) {
+        case RangeOp::Expand:
+            return clampToByte(d + ((d * 36 + 128) >> 8) + 128);
+        case RangeOp::Compress:
+            return clampToByte(((d * 224 + 128) >> 8) + 128);
+        default:
+            return x;
+    }
+}
+
+void lumaRowScalar(const uint8_t *src, uint8_t *dst, int width, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        memcpy(dst, src, width);
+        return;
+    }
+    for (int i = 0; i < width; i++) {
+        dst[i] = lumaScalar(src[i], op);
+    }
+}
+
+void chromaRowScalar(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width, RangeOp op) {
+    for (int i = 0; i < width; i++) {
+        uv[2 * i] = chromaScalar(u[i], op);
+        uv[2 * i + 1] = chromaScalar(v[i], op);
+    }
+}
+
+#if VCAM_YUV_NEON
+
+// --- NEON ---
+
+inline uint8x16_t lumaNEON(uint8x16_t x, RangeOp op) {
+    if (op == RangeOp::Expand) {
+        uint8x16_t t = vqsubq_u8(x, vdupq_n_u8(16));
+        uint16x8_t lo = vmovl_u8(vget_low_u8(t));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(t));
+        lo = vaddq_u16(lo, vshrq_n_u16(vaddq_u16(vmulq_n_u16(lo, 42), vdupq_n_u16(128)), 8));
+        hi = vaddq_u16(hi, vshrq_n_u16(vaddq_u16(vmulq_n_u16(hi, 42), vdupq_n_u16(128)), 8));
+        return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+    }
+    uint16x8_t lo = vmovl_u8(vget_low_u8(x));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(x));
+    lo = vaddq_u16(vshrq_n_u16(vaddq_u16(vmulq_n_u16(lo, 219), vdupq_n_u16(128)), 8), vdupq_n_u16(16));
+    hi = vaddq_u16(vshrq_n_u16(vaddq_u16(vmulq_n_u16(hi, 219), vdupq_n_u16(128)), 8), vdupq_n_u16(16));
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+inline int16x8_t chromaHalfNEON(uint8x8_t x, RangeOp op) {
+    int16x8_t d = vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(x), vdupq_n_u16(128)));
+    if (op == RangeOp::Expand) {
+        int16x8_t t = vshrq_n_s16(vaddq_s16(vmulq_n_s16(d, 36), vdupq_n_s16(128)), 8);
+        return vaddq_s16(vaddq_s16(d, t), vdupq_n_s16(128));
+    }
+    int16x8_t t = vshrq_n_s16(vaddq_s16(vmulq_n_s16(d, 224), vdupq_n_s16(128)), 8);
+    return vaddq_s16(t, vdupq_n_s16(128));
+}
+
+inline uint8x16_t chromaNEON(uint8x16_t x, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        return x;
+    }
+    return vcombine_u8(vqmovun_s16(chromaHalfNEON(vget_low_u8(x), op)),
+                       vqmovun_s16(chromaHalfNEON(vget_high_u8(x), op)));
+}
+
+void lumaRowNEON(const uint8_t *src, uint8_t *dst, int width, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        memcpy(dst, src, width);
+        return;
+    }
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        vst1q_u8(dst + i, lumaNEON(vld1q_u8(src + i), op));
+    }
+    lumaRowScalar(src + i, dst + i, width - i, op);
+}
+
+void chromaRowNEON(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width, RangeOp op) {
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        uint8x16x2_t pair;
+        pair.val[0] = chromaNEON(vld1q_u8(u + i), op);
+        pair.val[1] = chromaNEON(vld1q_u8(v + i), op);
+        vst2q_u8(uv + 2 * i, pair);
+    }
+    chromaRowScalar(u + i, v + i, uv + 2 * i, width - i, op);
+}
+
+#endif // VCAM_YUV_NEON
+
+#if VCAM_YUV_X86
+
+// --- SSE2 ---
+
+inline __m128i lumaHalfSSE2(__m128i x, RangeOp op) {
+    if (op == RangeOp::Expand) {
+        __m128i t = _mm_subs_epu16(x, _mm_set1_epi16(16));
+        __m128i scaled = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(t, _mm_set1_epi16(42)), _mm_set1_epi16(128)), 8);
+        return _mm_add_epi16(t, scaled);
+    }
+    __m128i scaled = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(x, _mm_set1_epi16(219)), _mm_set1_epi16(128)), 8);
+    return _mm_add_epi16(scaled, _mm_set1_epi16(16));
+}
+
+inline __m128i chromaHalfSSE2(__m128i x, RangeOp op) {
+    __m128i d = _mm_sub_epi16(x, _mm_set1_epi16(128));
+    if (op == RangeOp::Expand) {
+        __m128i t = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d, _mm_set1_epi16(36)), _mm_set1_epi16(128)), 8);
+        return _mm_add_epi16(_mm_add_epi16(d, t), _mm_set1_epi16(128));
+    }
+    __m128i t = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d, _mm_set1_epi16(224)), _mm_set1_epi16(128)), 8);
+    return _mm_add_epi16(t, _mm_set1_epi16(128));
+}
+
+inline __m128i lumaSSE2(__m128i x, RangeOp op) {
+    __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(lumaHalfSSE2(_mm_unpacklo_epi8(x, zero), op),
+                            lumaHalfSSE2(_mm_unpackhi_epi8(x, zero), op));
+}
+
+inline __m128i chromaSSE2(__m128i x, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        return x;
+    }
+    __m128i zero = _mm_setzero_si128();
+    return _mm_packus_epi16(chromaHalfSSE2(_mm_unpacklo_epi8(x, zero), op),
+                            chromaHalfSSE2(_mm_unpackhi_epi8(x, zero), op));
+}
+
+void lumaRowSSE2(const uint8_t *src, uint8_t *dst, int width, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        memcpy(dst, src, width);
+        return;
+    }
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), lumaSSE2(x, op));
+    }
+    lumaRowScalar(src + i, dst + i, width - i, op);
+}
+
+void chromaRowSSE2(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width, RangeOp op) {
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        __m128i cu = chromaSSE2(_mm_loadu_si128((const __m128i *)(u + i)), op);
+        __m128i cv = chromaSSE2(_mm_loadu_si128((const __m128i *)(v + i)), op);
+        _mm_storeu_si128((__m128i *)(uv + 2 * i), _mm_unpacklo_epi8(cu, cv));
+        _mm_storeu_si128((__m128i *)(uv + 2 * i + 16), _mm_unpackhi_epi8(cu, cv));
+    }
+    chromaRowScalar(u + i, v + i, uv + 2 * i, width - i, op);
+}
+
+// --- AVX2 ---
+
+#define VCAM_AVX2 __attribute__((target("avx2")))
+
+VCAM_AVX2 inline __m256i lumaHalfAVX2(__m256i x, RangeOp op) {
+    if (op == RangeOp::Expand) {
+        __m256i t = _mm256_subs_epu16(x, _mm256_set1_epi16(16));
+        __m256i scaled = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(t, _mm256_set1_epi16(42)), _mm256_set1_epi16(128)), 8);
+        return _mm256_add_epi16(t, scaled);
+    }
+    __m256i scaled = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(x, _mm256_set1_epi16(219)), _mm256_set1_epi16(128)), 8);
+    return _mm256_add_epi16(scaled, _mm256_set1_epi16(16));
+}
+
+VCAM_AVX2 inline __m256i chromaHalfAVX2(__m256i x, RangeOp op) {
+    __m256i d = _mm256_sub_epi16(x, _mm256_set1_epi16(128));
+    if (op == RangeOp::Expand) {
+        __m256i t = _mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(36)), _mm256_set1_epi16(128)), 8);
+        return _mm256_add_epi16(_mm256_add_epi16(d, t), _mm256_set1_epi16(128));
+    }
+    __m256i t = _mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(224)), _mm256_set1_epi16(128)), 8);
+    return _mm256_add_epi16(t, _mm256_set1_epi16(128));
+}
+
+// unpack/pack operam por lane de 128 bits, então a ordem dos bytes se preserva
+VCAM_AVX2 inline __m256i lumaAVX2(__m256i x, RangeOp op) {
+    __m256i zero = _mm256_setzero_si256();
+    return _mm256_packus_epi16(lumaHalfAVX2(_mm256_unpacklo_epi8(x, zero), op),
+                               lumaHalfAVX2(_mm256_unpackhi_epi8(x, zero), op));
+}
+
+VCAM_AVX2 inline __m256i chromaAVX2(__m256i x, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        return x;
+    }
+    __m256i zero = _mm256_setzero_si256();
+    return _mm256_packus_epi16(chromaHalfAVX2(_mm256_unpacklo_epi8(x, zero), op),
+                               chromaHalfAVX2(_mm256_unpackhi_epi8(x, zero), op));
+}
+
+VCAM_AVX2 void lumaRowAVX2(const uint8_t *src, uint8_t *dst, int width, RangeOp op) {
+    if (op == RangeOp::Copy) {
+        memcpy(dst, src, width);
+        return;
+    }
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), lumaAVX2(x, op));
+    }
+    lumaRowScalar(src + i, dst + i, width - i, op);
+}
+
+VCAM_AVX2 void chromaRowAVX2(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width, RangeOp op) {
+    int i = 0;
+    for (; i + 32 <= width; i += 32) {
+        __m256i cu = chromaAVX2(_mm256_loadu_si256((const __m256i *)(u + i)), op);
+        __m256i cv = chromaAVX2(_mm256_loadu_si256((const __m256i *)(v + i)), op);
+        // unpack intercala dentro de cada lane; permute reordena as metades
+        __m256i lo = _mm256_unpacklo_epi8(cu, cv);
+        __m256i hi = _mm256_unpackhi_epi8(cu, cv);
+        _mm256_storeu_si256((__m256i *)(uv + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(uv + 2 * i + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    chromaRowScalar(u + i, v + i, uv + 2 * i, width - i, op);
+}
+
+#endif // VCAM_YUV_X86
+
+// --- Seleção ---
+
+struct Kernels {
+    LumaRowFn luma;
+    ChromaRowFn chroma;
+    const char *name;
+};
+
+Kernels detectKernels() {
+#if VCAM_YUV_NEON
+    return { lumaRowNEON, chromaRowNEON, "neon" };
+#elif VCAM_YUV_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { lumaRowAVX2, chromaRowAVX2, "avx2" };
+    }
+    return { lumaRowSSE2, chromaRowSSE2, "sse2" };
+#else
+    return { lumaRowScalar, chromaRowScalar, "scalar" };
+#endif
+}
+
+// Kernels compilados e suportados por esta CPU, pelo nome
+bool kernelsNamed(const char *name, Kernels &out) {
+    if (std::strcmp(name, "scalar") == 0) {
+        out = { lumaRowScalar, chromaRowScalar, "scalar" };
+        return true;
+    }
+#if VCAM_YUV_NEON
+    if (std::strcmp(name, "neon") == 0) {
+        out = { lumaRowNEON, chromaRowNEON, "neon" };
+        return true;
+    }
+#elif VCAM_YUV_X86
+    __builtin_cpu_init();
+    if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        out = { lumaRowAVX2, chromaRowAVX2, "avx2" };
+        return true;
+    }
+    if (std::strcmp(name, "sse2") == 0) {
+        out = { lumaRowSSE2, chromaRowSSE2, "sse2" };
+        return true;
+    }
+#endif
+    return false;
+}
+
+Kernels &kernels() {
+    static Kernels selected = detectKernels();
+    return selected;
+}
+
+// Linhas de crominância [cyBegin, cyEnd) e os pares de luma correspondentes
+void convertRows(LumaRowFn luma, ChromaRowFn chroma, const I420Planes &src, const NV12Planes &dst,
+                 RangeOp op, int cyBegin, int cyEnd) {
+    int lumaEnd = std::min(cyEnd * 2, src.height);
+    for (int row = cyBegin * 2; row < lumaEnd; row++) {
+        luma(src.y + (size_t)row * src.strideY, dst.y + (size_t)row * dst.strideY, src.width, op);
+    }
+
+    int chromaWidth = (src.width + 1) / 2;
+    for (int row = cyBegin; row < cyEnd; row++) {
+        chroma(src.u + (size_t)row * src.strideU,
+               src.v + (size_t)row * src.strideV,
+               dst.uv + (size_t)row * dst.strideUV,
+               chromaWidth, op);
+    }
+}
+
+void convertWith(LumaRowFn luma, ChromaRowFn chroma,
+                 const I420Planes &src, YUVRange srcRange,
+                 const NV12Planes &dst, YUVRange dstRange) {
+    convertRows(luma, chroma, src, dst, rangeOpFor(srcRange, dstRange), 0, (src.height + 1) / 2);
+}
+
+} // namespace
+
+void ConvertI420ToNV12(const I420Planes &src, YUVRange srcRange,
+                       const NV12Planes &dst, YUVRange dstRange) {
+    const Kernels selected = kernels();
+    RangeOp op = rangeOpFor(srcRange, dstRange);
+
+    // Cada linha de crominância leva duas de luma: 3 bytes de saída por pixel de largura
+    RowBands bands = PlanRowBands((src.height + 1) / 2, (size_t)src.width * 3, 1);
+    ParallelFor(bands.count, [&](size_t band, size_t) {
+        convertRows(selected.luma, selected.chroma, src, dst, op, bands.begin((int)band), bands.end((int)band));
+    });
+}
+
+void ConvertLumaRow(const uint8_t *src, uint8_t *dst, int width, YUVRange srcRange, YUVRange dstRange) {
+    kernels().luma(src, dst, width, rangeOpFor(srcRange, dstRange));
+}
+
+void InterleaveChromaRow(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width,
+                         YUVRange srcRange, YUVRange dstRange) {
+    kernels().chroma(u, v, uv, width, rangeOpFor(srcRange, dstRange));
+}
+
+const char *YUVConvertBackendName() {
+    return kernels().name;
+}
+
+bool SetYUVConvertBackend(const char *name) {
+    if (name == nullptr) {
+        kernels() = detectKernels();
+        return true;
+    }
+    Kernels requested;
+    if (!kernelsNamed(name, requested)) {
+        return false;
+    }
+    kernels() = requested;
+    return true;
+}
+
+namespace reference {
+
+void ConvertI420ToNV12(const I420Planes &src, YUVRange srcRange,
+                       const NV12Planes &dst, YUVRange dstRange) {
+    convertWith(lumaRowScalar, chromaRowScalar, src, srcRange, dst, dstRange);
+}
+
+} // namespace reference
+
+} // namespace vcam
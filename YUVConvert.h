@@ -0,0 +1,107 @@
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+#include <cstdint>
+
+namespace vcam {
+
+/**
+ * Faixa de valores YUV: vídeo (Y 16-235, C 16-240) ou completa (0-255).
+ */
+enum class YUVRange {
+    Video,
+    Full
+};
+
+/**
+ * Planos de um buffer I420 (RTCI420Buffer / RTCYUVPlanarBuffer).
+ */
+struct I420Planes {
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+    int strideY;
+    int strideU;
+    int strideV;
+    int width;
+    int height;
+};
+
+/**
+ * Planos de destino NV12 bi-planar (420f / 420v).
+ */
+struct NV12Planes {
+    uint8_t *y;
+    uint8_t *uv;
+    int strideY;
+    int strideUV;
+};
+
+/**
+ * Planos de origem NV12 (CVPixelBuffer nativo 420f / 420v).
+ */
+struct NV12Source {
+    const uint8_t *y;
+    const uint8_t *uv;
+    int strideY;
+    int strideUV;
+    int width;
+    int height;
+};
+
+/**
+ * Plano de destino BGRA intercalado (kCVPixelFormatType_32BGRA).
+ */
+struct BGRAPlane {
+    uint8_t *data;
+    int stride;
+};
+
+/**
+ * Converte I420 em NV12, ajustando a faixa se `srcRange` e `dstRange` diferem.
+ * Usa NEON em arm64, AVX2/SSE2 em x86 (escolhido em tempo de execução)
+ * e a implementação escalar nos demais casos ou nas sobras de cada linha.
+ * Frames grandes são divididos em faixas de linhas convertidas em paralelo.
+ */
+void ConvertI420ToNV12(const I420Planes &src, YUVRange srcRange,
+                       const NV12Planes &dst, YUVRange dstRange);
+
+/**
+ * Converte uma linha de luma entre faixas (cópia simples se iguais).
+ */
+void ConvertLumaRow(const uint8_t *src, uint8_t *dst, int width, YUVRange srcRange, YUVRange dstRange);
+
+/**
+ * Intercala uma linha de U e V em UV (NV12), ajustando a faixa.
+ * @param width Número de amostras de crominância
+ */
+void InterleaveChromaRow(const uint8_t *u, const uint8_t *v, uint8_t *uv, int width,
+                         YUVRange srcRange, YUVRange dstRange);
+
+/**
+ * Nome do conjunto de instruções selecionado ("neon", "avx2", "sse2" ou "scalar").
+ */
+const char *YUVConvertBackendName();
+
+/**
+ * Força um conjunto de instruções ("neon", "avx2", "sse2", "scalar") ou,
+ * com nullptr, volta à detecção automática. Para testes e benchmarks:
+ * não é seguro chamar com conversões em andamento.
+ * @return false se o backend não foi compilado ou a CPU não o suporta
+ */
+bool SetYUVConvertBackend(const char *name);
+
+namespace reference {
+
+/**
+ * Implementação escalar de referência; os caminhos SIMD devem produzir
+ * exatamente os mesmos bytes.
+ */
+void ConvertI420ToNV12(const I420Planes &src, YUVRange srcRange,
+                       const NV12Planes &dst, YUVRange dstRange);
+
+} // namespace reference
+
+} // namespace vcam
+
+#endif /* YUVCONVERT_H */
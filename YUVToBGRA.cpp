@@ -0,0 +1,290 @@
+#include "YUVToBGRA.h"
+#include "ParallelFor.h"
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VCAM_BGRA_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define VCAM_BGRA_SSE2 1
+#endif
+
+namespace vcam {
+
+namespace {
+
+// Coeficientes em ponto fixo Q6. Todos os produtos cabem em int16 e as
+// somas saturam (como _mm_adds_epi16 / vqaddq_s16), o que equivale a
+// limitar o resultado a 0..255 depois do deslocamento.
+struct Coefficients {
+    int16_t yOffset;
+    int16_t yScale;
+    int16_t rv;
+    int16_t gu;
+    int16_t gv;
+    int16_t bu;
+};
+
+const Coefficients kBT601Video = { 16, 75, 102, 25, 52, 129 };
+const Coefficients kBT601Full  = {  0, 64,  90, 22, 46, 113 };
+const Coefficients kBT709Video = { 16, 75, 115, 14, 34, 135 };
+const Coefficients kBT709Full  = {  0, 64, 101, 12, 30, 119 };
+
+const Coefficients &coefficientsFor(const YUVColorSpace &colorSpace) {
+    if (colorSpace.matrix == YUVMatrix::BT709) {
+        return colorSpace.range == YUVRange::Full ? kBT709Full : kBT709Video;
+    }
+    return colorSpace.range == YUVRange::Full ? kBT601Full : kBT601Video;
+}
+
+// Linha de origem: `v` nulo indica crominância intercalada (NV12) em `u`
+struct SourceRow {
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+};
+
+typedef void (*BGRARowFn)(const SourceRow &row, uint8_t *dst, int width, const Coefficients &c);
+
+// --- Escalar ---
+
+inline int sat16(int value) {
+    return value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+}
+
+inline uint8_t clampToByte(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void pixelScalar(uint8_t Y, uint8_t U, uint8_t V, const Coefficients &c, uint8_t *out) {
+    int yy = (Y - c.yOffset) * c.yScale + 32;
+    int u = U - 128;
+    int v = V - 128;
+
+    int r = sat16(yy + c.rv * v);
+    int g = sat16(sat16(yy - c.gu * u) - c.gv * v);
+    int b = sat16(yy + c.bu * u);
+
+    out[0] = clampToByte(b >> 6);
+    out[1] = clampToByte(g >> 6);
+    out[2] = clampToByte(r >> 6);
+    out[3] = 255;
+}
+
+void rowScalarFrom(const SourceRow &row, uint8_t *dst, int start, int width, const Coefficients &c) {
+    for (int x = start; x < width; x++) {
+        int cx = x >> 1;
+        uint8_t U = row.v ? row.u[cx] : row.u[2 * cx];
+        uint8_t V = row.v ? row.v[cx] : row.u[2 * cx + 1];
+        pixelScalar(row.y[x], U, V, c, dst + 4 * x);
+    }
+}
+
+void rowScalar(const SourceRow &row, uint8_t *dst, int width, const Coefficients &c) {
+    rowScalarFrom(row, dst, 0, width, c);
+}
+
+#if VCAM_BGRA_NEON
+
+// --- NEON ---
+
+inline uint8x16_t channelNEON(int16x8_t lo, int16x8_t hi) {
+    return vcombine_u8(vqmovun_s16(vshrq_n_s16(lo, 6)), vqmovun_s16(vshrq_n_s16(hi, 6)));
+}
+
+void rowNEON(const SourceRow &row, uint8_t *dst, int width, const Coefficients &c) {
+    const int16x8_t yOffset = vdupq_n_s16(c.yOffset);
+    const int16x8_t rounding = vdupq_n_s16(32);
+    const uint16x8_t bias = vdupq_n_u16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x8_t u8;
+        uint8x8_t v8;
+        if (row.v) {
+            u8 = vld1_u8(row.u + x / 2);
+            v8 = vld1_u8(row.v + x / 2);
+        } else {
+            uint8x8x2_t uv = vld2_u8(row.u + x);
+            u8 = uv.val[0];
+            v8 = uv.val[1];
+        }
+
+        int16x8x2_t u = vzipq_s16(vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(u8), bias)),
+                                  vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(u8), bias)));
+        int16x8x2_t v = vzipq_s16(vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(v8), bias)),
+                                  vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(v8), bias)));
+
+        uint8x16_t y8 = vld1q_u8(row.y + x);
+        int16x8_t yLo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8)));
+        int16x8_t yHi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8)));
+        yLo = vaddq_s16(vmulq_n_s16(vsubq_s16(yLo, yOffset), c.yScale), rounding);
+        yHi = vaddq_s16(vmulq_n_s16(vsubq_s16(yHi, yOffset), c.yScale), rounding);
+
+        int16x8_t rLo = vqaddq_s16(yLo, vmulq_n_s16(v.val[0], c.rv));
+        int16x8_t rHi = vqaddq_s16(yHi, vmulq_n_s16(v.val[1], c.rv));
+        int16x8_t gLo = vqsubq_s16(vqsubq_s16(yLo, vmulq_n_s16(u.val[0], c.gu)), vmulq_n_s16(v.val[0], c.gv));
+        int16x8_t gHi = vqsubq_s16(vqsubq_s16(yHi, vmulq_n_s16(u.val[1], c.gu)), vmulq_n_s16(v.val[1], c.gv));
+        int16x8_t bLo = vqaddq_s16(yLo, vmulq_n_s16(u.val[0], c.bu));
+        int16x8_t bHi = vqaddq_s16(yHi, vmulq_n_s16(u.val[1], c.bu));
+
+        uint8x16x4_t pixels;
+        pixels.val[0] = channelNEON(bLo, bHi);
+        pixels.val[1] = channelNEON(gLo, gHi);
+        pixels.val[2] = channelNEON(rLo, rHi);
+        pixels.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst + 4 * x, pixels);
+    }
+    rowScalarFrom(row, dst, x, width, c);
+}
+
+#endif // VCAM_BGRA_NEON
+
+#if VCAM_BGRA_SSE2
+
+// --- SSE2 ---
+
+inline __m128i channelSSE2(__m128i lo, __m128i hi) {
+    return _mm_packus_epi16(_mm_srai_epi16(lo, 6), _mm_srai_epi16(hi, 6));
+}
+
+void rowSSE2(const SourceRow &row, uint8_t *dst, int width, const Coefficients &c) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i yOffset = _mm_set1_epi16(c.yOffset);
+    const __m128i yScale = _mm_set1_epi16(c.yScale);
+    const __m128i rounding = _mm_set1_epi16(32);
+    const __m128i rv = _mm_set1_epi16(c.rv);
+    const __m128i gu = _mm_set1_epi16(c.gu);
+    const __m128i gv = _mm_set1_epi16(c.gv);
+    const __m128i bu = _mm_set1_epi16(c.bu);
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i u16;
+        __m128i v16;
+        if (row.v) {
+            u16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row.u + x / 2)), zero);
+            v16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row.v + x / 2)), zero);
+        } else {
+            __m128i uv = _mm_loadu_si128((const __m128i *)(row.u + x));
+            u16 = _mm_and_si128(uv, _mm_set1_epi16(0x00FF));
+            v16 = _mm_srli_epi16(uv, 8);
+        }
+        u16 = _mm_sub_epi16(u16, bias);
+        v16 = _mm_sub_epi16(v16, bias);
+
+        // Cada amostra de crominância cobre dois pixels
+        __m128i uLo = _mm_unpacklo_epi16(u16, u16);
+        __m128i uHi = _mm_unpackhi_epi16(u16, u16);
+        __m128i vLo = _mm_unpacklo_epi16(v16, v16);
+        __m128i vHi = _mm_unpackhi_epi16(v16, v16);
+
+        __m128i y8 = _mm_loadu_si128((const __m128i *)(row.y + x));
+        __m128i yLo = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), yOffset), yScale), rounding);
+        __m128i yHi = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), yOffset), yScale), rounding);
+
+        __m128i r = channelSSE2(_mm_adds_epi16(yLo, _mm_mullo_epi16(vLo, rv)),
+                                _mm_adds_epi16(yHi, _mm_mullo_epi16(vHi, rv)));
+        __m128i g = channelSSE2(_mm_subs_epi16(_mm_subs_epi16(yLo, _mm_mullo_epi16(uLo, gu)), _mm_mullo_epi16(vLo, gv)),
+                                _mm_subs_epi16(_mm_subs_epi16(yHi, _mm_mullo_epi16(uHi, gu)), _mm_mullo_epi16(vHi, gv)));
+        __m128i b = channelSSE2(_mm_adds_epi16(yLo, _mm_mullo_epi16(uLo, bu)),
+                                _mm_adds_epi16(yHi, _mm_mullo_epi16(uHi, bu)));
+
+        __m128i bgLo = _mm_unpacklo_epi8(b, g);
+        __m128i bgHi = _mm_unpackhi_epi8(b, g);
+        __m128i raLo = _mm_unpacklo_epi8(r, alpha);
+        __m128i raHi = _mm_unpackhi_epi8(r, alpha);
+
+        uint8_t *out = dst + 4 * x;
+        _mm_storeu_si128((__m128i *)(out), _mm_unpacklo_epi16(bgLo, raLo));
+        _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi16(bgLo, raLo));
+        _mm_storeu_si128((__m128i *)(out + 32), _mm_unpacklo_epi16(bgHi, raHi));
+        _mm_storeu_si128((__m128i *)(out + 48), _mm_unpackhi_epi16(bgHi, raHi));
+    }
+    rowScalarFrom(row, dst, x, width, c);
+}
+
+#endif // VCAM_BGRA_SSE2
+
+BGRARowFn selectedRow() {
+#if VCAM_BGRA_NEON
+    return rowNEON;
+#elif VCAM_BGRA_SSE2
+    return rowSSE2;
+#else
+    return rowScalar;
+#endif
+}
+
+void convertI420Rows(BGRARowFn rowFn, const I420Planes &src, const Coefficients &c, const BGRAPlane &dst,
+                     int yBegin, int yEnd) {
+    for (int y = yBegin; y < yEnd; y++) {
+        SourceRow row = {
+            src.y + (size_t)y * src.strideY,
+            src.u + (size_t)(y >> 1) * src.strideU,
+            src.v + (size_t)(y >> 1) * src.strideV
+        };
+        rowFn(row, dst.data + (size_t)y * dst.stride, src.width, c);
+    }
+}
+
+void convertNV12Rows(BGRARowFn rowFn, const NV12Source &src, const Coefficients &c, const BGRAPlane &dst,
+                     int yBegin, int yEnd) {
+    for (int y = yBegin; y < yEnd; y++) {
+        SourceRow row = {
+            src.y + (size_t)y * src.strideY,
+            src.uv + (size_t)(y >> 1) * src.strideUV,
+            nullptr
+        };
+        rowFn(row, dst.data + (size_t)y * dst.stride, src.width, c);
+    }
+}
+
+// Faixas de linhas pares: um par de luma nunca é separado da sua linha de crominância
+void convertI420(BGRARowFn rowFn, const I420Planes &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    const Coefficients &c = coefficientsFor(colorSpace);
+    RowBands bands = PlanRowBands(src.height, (size_t)src.width * 4, 2);
+    ParallelFor(bands.count, [&](size_t band, size_t) {
+        convertI420Rows(rowFn, src, c, dst, bands.begin((int)band), bands.end((int)band));
+    });
+}
+
+void convertNV12(BGRARowFn rowFn, const NV12Source &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    const Coefficients &c = coefficientsFor(colorSpace);
+    RowBands bands = PlanRowBands(src.height, (size_t)src.width * 4, 2);
+    ParallelFor(bands.count, [&](size_t band, size_t) {
+        convertNV12Rows(rowFn, src, c, dst, bands.begin((int)band), bands.end((int)band));
+    });
+}
+
+} // namespace
+
+void ConvertI420ToBGRA(const I420Planes &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    convertI420(selectedRow(), src, colorSpace, dst);
+}
+
+void ConvertNV12ToBGRA(const NV12Source &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    convertNV12(selectedRow(), src, colorSpace, dst);
+}
+
+void ConvertRowToBGRA(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst,
+                      int width, const YUVColorSpace &colorSpace) {
+    SourceRow row = { y, u, v };
+    selectedRow()(row, dst, width, coefficientsFor(colorSpace));
+}
+
+namespace reference {
+
+void ConvertI420ToBGRA(const I420Planes &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    convertI420Rows(rowScalar, src, coefficientsFor(colorSpace), dst, 0, src.height);
+}
+
+void ConvertNV12ToBGRA(const NV12Source &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst) {
+    convertNV12Rows(rowScalar, src, coefficientsFor(colorSpace), dst, 0, src.height);
+}
+
+} // namespace reference
+
+} // namespace vcam
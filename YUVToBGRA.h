@@ -0,0 +1,52 @@
+#ifndef YUVTOBGRA_H
+#define YUVTOBGRA_H
+
+#include "YUVConvert.h"
+
+namespace vcam {
+
+/**
+ * Matriz de conversão YCbCr -> RGB.
+ */
+enum class YUVMatrix {
+    BT601,
+    BT709
+};
+
+/**
+ * Espaço de cor da origem, normalmente lido dos attachments do frame
+ * (kCVImageBufferYCbCrMatrixKey e formato 420f/420v).
+ */
+struct YUVColorSpace {
+    YUVMatrix matrix;
+    YUVRange range;
+};
+
+/**
+ * Converte I420 em BGRA (alfa 255).
+ * NEON em arm64, SSE2 em x86 e escalar nos demais casos.
+ * Frames grandes são divididos em faixas de linhas pares convertidas em paralelo.
+ */
+void ConvertI420ToBGRA(const I420Planes &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst);
+
+/**
+ * Converte NV12 em BGRA (alfa 255).
+ */
+void ConvertNV12ToBGRA(const NV12Source &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst);
+
+/**
+ * Converte uma linha I420 (U/V na resolução de crominância) em BGRA.
+ */
+void ConvertRowToBGRA(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst,
+                      int width, const YUVColorSpace &colorSpace);
+
+namespace reference {
+
+void ConvertI420ToBGRA(const I420Planes &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst);
+void ConvertNV12ToBGRA(const NV12Source &src, const YUVColorSpace &colorSpace, const BGRAPlane &dst);
+
+} // namespace reference
+
+} // namespace vcam
+
+#endif /* YUVTOBGRA_H */
@@ -10,11 +10,16 @@ const WebSocket = require('ws');
 const { exec } = require('child_process');
 const readline = require('readline');
 const os = require('os');
+const crypto = require('crypto');
 
 // Configurações
 const PORT = process.env.PORT || 8080;
 const DEFAULT_ROOM_ID = 'ios-camera'; // Sala padrão para conexão
 
+// Retomada de sessão: cliente que caiu sem 'bye' segue na sala por esse tempo
+const RESUME_GRACE_MS = 30000;
+const RESUME_QUEUE_LIMIT = 64; // mensagens guardadas para quem está reconectando
+
 // Configurações otimizadas para iOS baseadas nos logs de diagnóstico
 const IOS_OPTIMIZED_CONFIG = {
     // Formatos de pixel preferidos pelo iOS (em ordem)
@@ -45,8 +50,400 @@ const IOS_OPTIMIZED_CONFIG = {
     }
 };
 
+// Sonda de latência glass-to-glass: o emissor grava o relógio do servidor no topo
+// de cada frame e o iOS devolve p50/p95/p99 pelo canal 'stats'.
+// O layout deve acompanhar TimestampCode.h.
+const LATENCY_PROBE = {
+    syncCells: 2,
+    dataBits: 48,
+    crcBits: 8,
+    stripHeightDivisor: 20,
+    minStripHeight: 16
+};
+let latencyProbeEnabled = false;
+
+// Script para a página emissora: sincroniza com o servidor via ping/pong e
+// desenha o código no canvas antes de capturá-lo (canvas.captureStream)
+const LATENCY_PROBE_SCRIPT = `
+(function () {
+    const LAYOUT = ${JSON.stringify(LATENCY_PROBE)};
+    const cellCount = LAYOUT.syncCells + LAYOUT.dataBits + LAYOUT.crcBits;
+    let offsetMs = 0;
+    let bestRtt = Infinity;
+
+    function crc8(bytes) {
+        let crc = 0;
+        for (const byte of bytes) {
+            crc ^= byte;
+            for (let bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) & 0xff : (crc << 1) & 0xff;
+            }
+        }
+        return crc;
+    }
+
+    window.latencyProbe = {
+        enabled: false,
+
+        // Chamar com cada pong do servidor (mensagem com clientTimestamp)
+        onPong(message) {
+            const now = Date.now();
+            const rtt = now - message.clientTimestamp;
+            if (rtt >= 0 && rtt <= bestRtt) {
+                bestRtt = rtt;
+                offsetMs = message.timestamp - (message.clientTimestamp + now) / 2;
+            }
+        },
+
+        // Chamar depois de desenhar o frame de vídeo no canvas
+        draw(ctx, width, height) {
+            if (!this.enabled) {
+                return;
+            }
+            const value = BigInt(Math.round(Date.now() + offsetMs));
+            const bytes = [];
+            for (let i = 5; i >= 0; i--) {
+                bytes.push(Number((value >> BigInt(8 * i)) & 0xffn));
+            }
+            const crc = crc8(bytes);
+
+            const cells = [true, false];
+            for (let bit = LAYOUT.dataBits - 1; bit >= 0; bit--) {
+                cells.push(((value >> BigInt(bit)) & 1n) === 1n);
+            }
+            for (let bit = LAYOUT.crcBits - 1; bit >= 0; bit--) {
+                cells.push(((crc >> bit) & 1) === 1);
+            }
+
+            const stripHeight = Math.max(Math.floor(height / LAYOUT.stripHeightDivisor), LAYOUT.minStripHeight);
+            for (let cell = 0; cell < cellCount; cell++) {
+                const x0 = Math.floor(cell * width / cellCount);
+                const x1 = Math.floor((cell + 1) * width / cellCount);
+                ctx.fillStyle = cells[cell] ? '#ffffff' : '#000000';
+                ctx.fillRect(x0, 0, x1 - x0, stripHeight);
+            }
+        }
+    };
+})();
+`;
+
+// Protocolo binário de sinalização (ver SignalingCodec.h): cabeçalho
+// [SIGNALING_MAGIC, versão] + um item CBOR. Negociado no 'join' pelo campo
+// binaryProtocol; clientes sem ele continuam em JSON. As tabelas devem
+// acompanhar SignalingCodec.cpp e só crescem no fim.
+const SIGNALING_MAGIC = 0x56;
+const SIGNALING_VERSION = 1;
+const SIGNALING_KEYS = [
+    'type', 'roomId', 'sdp', 'candidate', 'sdpMid', 'sdpMLineIndex', 'timestamp', 'clientTimestamp',
+    'senderDeviceType', 'deviceType', 'enabled', 'stats', 'latency', 'count', 'p50', 'p95',
+    'p99', 'max', 'clockRtt', 'bucketMs', 'buckets', 'userId', 'webcam', 'config',
+    'binaryProtocol', 'capabilities', 'action', 'targetBitrate'
+];
+const SIGNALING_TYPES = [
+    'join', 'offer', 'answer', 'ice-candidate', 'ping', 'pong', 'bye', 'stats',
+    'latency-probe', 'welcome', 'user-joined', 'user-left', 'transmission-active', 'transmission-started',
+    'transmission-stopped', 'quality-recommendation', 'ios-capabilities-update', 'server-shutdown', 'codec'
+];
+const SIGNALING_KEY_CODES = new Map(SIGNALING_KEYS.map((name, code) => [name, code]));
+const SIGNALING_TYPE_CODES = new Map(SIGNALING_TYPES.map((name, code) => [name, code]));
+const SIGNALING_MAX_DEPTH = 16;
+
+class SignalingWriter {
+    constructor(size) {
+        this.buffer = Buffer.allocUnsafe(size);
+        this.length = 0;
+    }
+    
+    reserve(bytes) {
+        if (this.length + bytes > this.buffer.length) {
+            const grown = Buffer.allocUnsafe(Math.max(this.buffer.length * 2, this.length + bytes));
+            this.buffer.copy(grown, 0, 0, this.length);
+            this.buffer = grown;
+        }
+    }
+    
+    byte(value) {
+        this.reserve(1);
+        this.buffer[this.length++] = value;
+    }
+    
+    head(major, value) {
+        const initial = major << 5;
+        if (value < 24) {
+            this.byte(initial | value);
+        } else if (value <= 0xff) {
+            this.reserve(2);
+            this.buffer[this.length++] = initial | 24;
+            this.buffer[this.length++] = value;
+        } else if (value <= 0xffff) {
+            this.reserve(3);
+            this.buffer[this.length++] = initial | 25;
+            this.length = this.buffer.writeUInt16BE(value, this.length);
+        } else if (value <= 0xffffffff) {
+            this.reserve(5);
+            this.buffer[this.length++] = initial | 26;
+            this.length = this.buffer.writeUInt32BE(value, this.length);
+        } else {
+            this.reserve(9);
+            this.buffer[this.length++] = initial | 27;
+            this.length = this.buffer.writeBigUInt64BE(BigInt(value), this.length);
+        }
+    }
+    
+    text(value) {
+        const bytes = Buffer.byteLength(value);
+        this.head(3, bytes);
+        this.reserve(bytes);
+        this.length += this.buffer.write(value, this.length);
+    }
+    
+    number(value) {
+        if (Number.isSafeInteger(value)) {
+            if (value >= 0) {
+                this.head(0, value);
+            } else {
+                this.head(1, -1 - value);
+            }
+        } else if (Math.fround(value) === value || Number.isNaN(value)) {
+            this.reserve(5);
+            this.buffer[this.length++] = 0xfa;
+            this.length = this.buffer.writeFloatBE(value, this.length);
+        } else {
+            this.reserve(9);
+            this.buffer[this.length++] = 0xfb;
+            this.length = this.buffer.writeDoubleBE(value, this.length);
+        }
+    }
+    
+    // Mesmas regras do JSON.stringify: undefined/funções somem dos objetos e viram null em arrays
+    value(value, depth) {
+        if (depth > SIGNALING_MAX_DEPTH) {
+            throw new Error('mensagem aninhada demais');
+        }
+        if (value === null || value === undefined || typeof value === 'function') {
+            this.byte(0xf6);
+        } else if (typeof value === 'string') {
+            this.text(value);
+        } else if (typeof value === 'number') {
+            this.number(value);
+        } else if (typeof value === 'boolean') {
+            this.byte(value ? 0xf5 : 0xf4);
+        } else if (Array.isArray(value)) {
+            this.head(4, value.length);
+            for (const element of value) {
+                this.value(element, depth + 1);
+            }
+        } else if (typeof value === 'object') {
+            this.map(value, depth, false);
+        } else {
+            throw new Error(`tipo sem representação: ${typeof value}`);
+        }
+    }
+    
+    map(object, depth, topLevel) {
+        const keys = Object.keys(object).filter(key => object[key] !== undefined && typeof object[key] !== 'function');
+        this.head(5, keys.length);
+        for (const key of keys) {
+            const keyCode = SIGNALING_KEY_CODES.get(key);
+            if (keyCode !== undefined) {
+                this.head(0, keyCode);
+            } else {
+                this.text(key);
+            }
+            
+            const value = object[key];
+            if (topLevel && key === 'type') {
+                // Tipo no topo sempre texto: numérico seria ambíguo com o código da tabela
+                if (typeof value !== 'string') {
+                    throw new Error('type deve ser texto');
+                }
+                const typeCode = SIGNALING_TYPE_CODES.get(value);
+                if (typeCode !== undefined) {
+                    this.head(0, typeCode);
+                } else {
+                    this.text(value);
+                }
+            } else {
+                this.value(value, depth + 1);
+            }
+        }
+    }
+}
+
+function encodeSignal(message) {
+    const writer = new SignalingWriter(256);
+    writer.byte(SIGNALING_MAGIC);
+    writer.byte(SIGNALING_VERSION);
+    writer.map(message, 0, true);
+    return writer.buffer.subarray(0, writer.length);
+}
+
+class SignalingReader {
+    constructor(buffer) {
+        this.buffer = buffer;
+        this.offset = 0;
+    }
+    
+    need(bytes) {
+        if (this.offset + bytes > this.buffer.length) {
+            throw new Error('mensagem truncada');
+        }
+    }
+    
+    argument(info) {
+        if (info < 24) {
+            return info;
+        }
+        const offset = this.offset;
+        switch (info) {
+            case 24: this.need(1); this.offset += 1; return this.buffer[offset];
+            case 25: this.need(2); this.offset += 2; return this.buffer.readUInt16BE(offset);
+            case 26: this.need(4); this.offset += 4; return this.buffer.readUInt32BE(offset);
+            case 27: {
+                this.need(8);
+                this.offset += 8;
+                const value = this.buffer.readBigUInt64BE(offset);
+                if (value > BigInt(Number.MAX_SAFE_INTEGER)) {
+                    throw new Error('inteiro fora do intervalo');
+                }
+                return Number(value);
+            }
+            default: throw new Error('comprimento indefinido não suportado');
+        }
+    }
+    
+    // Contagens maiores que os bytes restantes são malformadas (evita alocação grande)
+    count(info, bytesPerElement) {
+        const count = this.argument(info);
+        if (count * bytesPerElement > this.buffer.length - this.offset) {
+            throw new Error('contagem inválida');
+        }
+        return count;
+    }
+    
+    key() {
+        const initial = this.buffer[this.offset];
+        if (initial >> 5 === 0) {
+            this.offset++;
+            const name = SIGNALING_KEYS[this.argument(initial & 0x1f)];
+            if (name === undefined) {
+                throw new Error('chave desconhecida');
+            }
+            return name;
+        }
+        const key = this.value(SIGNALING_MAX_DEPTH);
+        if (typeof key !== 'string') {
+            throw new Error('chave inválida');
+        }
+        return key;
+    }
+    
+    value(depth) {
+        if (depth > SIGNALING_MAX_DEPTH) {
+            throw new Error('mensagem aninhada demais');
+        }
+        this.need(1);
+        const initial = this.buffer[this.offset++];
+        const major = initial >> 5;
+        const info = initial & 0x1f;
+        
+        switch (major) {
+            case 0: return this.argument(info);
+            case 1: return -1 - this.argument(info);
+            case 3: {
+                const bytes = this.count(info, 1);
+                const text = this.buffer.toString('utf8', this.offset, this.offset + bytes);
+                this.offset += bytes;
+                return text;
+            }
+            case 4: {
+                const count = this.count(info, 1);
+                const array = new Array(count);
+                for (let i = 0; i < count; i++) {
+                    array[i] = this.value(depth + 1);
+                }
+                return array;
+            }
+            case 5: return this.map(this.count(info, 2), depth, false);
+            case 7: break;
+            default: throw new Error(`tipo CBOR ${major} não suportado`);
+        }
+        
+        const offset = this.offset;
+        switch (initial) {
+            case 0xf4: return false;
+            case 0xf5: return true;
+            case 0xf6:
+            case 0xf7: return null;
+            case 0xf9: {
+                this.need(2);
+                this.offset += 2;
+                const half = this.buffer.readUInt16BE(offset);
+                const exponent = (half >> 10) & 0x1f;
+                const mantissa = half & 0x3ff;
+                const magnitude = exponent === 0 ? mantissa * 2 ** -24
+                    : exponent === 31 ? (mantissa === 0 ? Infinity : NaN)
+                    : (mantissa + 1024) * 2 ** (exponent - 25);
+                return half & 0x8000 ? -magnitude : magnitude;
+            }
+            case 0xfa: this.need(4); this.offset += 4; return this.buffer.readFloatBE(offset);
+            case 0xfb: this.need(8); this.offset += 8; return this.buffer.readDoubleBE(offset);
+            default: throw new Error('valor simples não suportado');
+        }
+    }
+    
+    map(count, depth, topLevel) {
+        const object = {};
+        for (let i = 0; i < count; i++) {
+            this.need(1);
+            const key = this.key();
+            if (topLevel && key === 'type') {
+                const type = this.value(depth + 1);
+                object.type = typeof type === 'number' ? SIGNALING_TYPES[type] : type;
+                if (typeof object.type !== 'string') {
+                    throw new Error('tipo de mensagem inválido');
+                }
+            } else {
+                object[key] = this.value(depth + 1);
+            }
+        }
+        return object;
+    }
+}
+
+function decodeSignal(buffer) {
+    if (buffer.length <= 2 || buffer[0] !== SIGNALING_MAGIC || buffer[1] !== SIGNALING_VERSION) {
+        throw new Error('cabeçalho binário inválido');
+    }
+    const reader = new SignalingReader(buffer);
+    reader.offset = 2;
+    const initial = buffer[reader.offset++];
+    if (initial >> 5 !== 5) {
+        throw new Error('mensagem binária não é um mapa');
+    }
+    const message = reader.map(reader.count(initial & 0x1f, 2), 0, true);
+    if (reader.offset !== buffer.length) {
+        throw new Error('bytes sobrando na mensagem');
+    }
+    return message;
+}
+
+// Envia no codec negociado com o cliente; JSON se ele não anunciou o binário
+function sendSignal(ws, message) {
+    if (ws.binaryProtocol === SIGNALING_VERSION) {
+        ws.send(encodeSignal(message), { binary: true });
+    } else {
+        ws.send(JSON.stringify(message));
+    }
+}
+
 // Inicializar servidor HTTP mínimo
 const server = http.createServer((req, res) => {
+    if (req.url === '/latency-probe.js') {
+        res.writeHead(200, { 'Content-Type': 'application/javascript' });
+        res.end(LATENCY_PROBE_SCRIPT);
+        return;
+    }
     res.writeHead(200, { 'Content-Type': 'text/plain' });
     res.end('Servidor WebRTC rodando. Controle via console.');
 });
@@ -56,6 +453,7 @@ const wss = new WebSocket.Server({ server });
 // Armazenamento de estado
 const rooms = {};
 const clients = new Map();
+const sessions = new Map(); // resumeToken -> { token, ws, roomId, expireTimer, detachedAt, pending }
 const webcams = [];
 let selectedWebcam = null;
 let isTransmitting = false;
@@ -110,6 +508,138 @@ function detectWebcams() {
     });
 }
 
+// Liga/desliga a gravação e a leitura do código de latência em todos os clientes
+function setLatencyProbe(enabled) {
+    latencyProbeEnabled = enabled;
+    log(`Sonda de latência ${enabled ? 'ativada' : 'desativada'}`);
+    
+    for (const clientWs of clients.values()) {
+        if (clientWs.readyState === WebSocket.OPEN) {
+            sendSignal(clientWs, {
+                type: 'latency-probe',
+                enabled
+            });
+        }
+    }
+}
+
+// Percentil a partir de caixas de largura fixa (limite superior da caixa)
+function histogramPercentile(buckets, bucketMs, fraction) {
+    const total = buckets.reduce((sum, count) => sum + count, 0);
+    if (total === 0) {
+        return 0;
+    }
+    const rank = Math.max(Math.ceil(fraction * total), 1);
+    let seen = 0;
+    for (let i = 0; i < buckets.length; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return (i + 1) * bucketMs;
+        }
+    }
+    return buckets.length * bucketMs;
+}
+
+// Acumula o relatório do cliente e registra a janela e o acumulado da sessão
+function processLatencyStats(latency, ws) {
+    if (!Array.isArray(latency.buckets) || !latency.bucketMs) {
+        return;
+    }
+    
+    if (!ws.latencyHistogram || ws.latencyHistogram.bucketMs !== latency.bucketMs) {
+        ws.latencyHistogram = { bucketMs: latency.bucketMs, buckets: new Array(latency.buckets.length).fill(0) };
+    }
+    const histogram = ws.latencyHistogram;
+    latency.buckets.forEach((count, i) => {
+        if (i < histogram.buckets.length) {
+            histogram.buckets[i] += count;
+        }
+    });
+    
+    ws.latencyStats = {
+        window: { p50: latency.p50, p95: latency.p95, p99: latency.p99, max: latency.max, count: latency.count },
+        session: {
+            p50: histogramPercentile(histogram.buckets, histogram.bucketMs, 0.50),
+            p95: histogramPercentile(histogram.buckets, histogram.bucketMs, 0.95),
+            p99: histogramPercentile(histogram.buckets, histogram.bucketMs, 0.99),
+            count: histogram.buckets.reduce((sum, count) => sum + count, 0)
+        },
+        timestamp: Date.now()
+    };
+    
+    const session = ws.latencyStats.session;
+    log(`Latência ${ws.id.substring(0, 8)}: p50 ${latency.p50} ms, p95 ${latency.p95} ms, p99 ${latency.p99} ms ` +
+        `(${latency.count} frames) | sessão p50/p95/p99: ${session.p50}/${session.p95}/${session.p99} ms`);
+}
+
+// Fases do estabelecimento da conexão no iOS, em ms desde o início da sessão.
+// Deve acompanhar SetupProfile.h.
+const SETUP_PHASES = [
+    'signalingOpen', 'joinSent', 'offerReceived', 'remoteDescriptionSet', 'answerSent', 'iceChecking',
+    'iceConnected', 'firstRtpPacket', 'firstDecodedFrame', 'firstSubstitutedFrame', 'firstPreviewFrame'
+];
+const SETUP_SAMPLE_LIMIT = 200; // sessões mais recentes por fase
+const setupSamples = new Map(SETUP_PHASES.map(phase => [phase, []]));
+let setupSessionCount = 0;
+
+// Percentil por posição (nearest-rank) em amostras já ordenadas
+function samplePercentile(sorted, fraction) {
+    if (sorted.length === 0) {
+        return 0;
+    }
+    const rank = Math.max(Math.ceil(fraction * sorted.length), 1);
+    return sorted[rank - 1];
+}
+
+// p50/p95/máximo de cada fase com amostras
+function setupPercentiles() {
+    const result = [];
+    for (const [phase, samples] of setupSamples) {
+        if (samples.length === 0) {
+            continue;
+        }
+        const sorted = [...samples].sort((a, b) => a - b);
+        result.push({
+            phase,
+            count: sorted.length,
+            p50: samplePercentile(sorted, 0.50),
+            p95: samplePercentile(sorted, 0.95),
+            max: sorted[sorted.length - 1]
+        });
+    }
+    return result;
+}
+
+// Registra o resumo de uma sessão e o agregado de todas as sessões
+function processSetupProfile(setup, ws) {
+    if (!setup.phases || typeof setup.phases !== 'object') {
+        return;
+    }
+    
+    const reached = SETUP_PHASES.filter(phase => {
+        const ms = setup.phases[phase];
+        return typeof ms === 'number' && Number.isFinite(ms) && ms >= 0;
+    });
+    if (reached.length === 0) {
+        return;
+    }
+    
+    setupSessionCount++;
+    for (const phase of reached) {
+        const samples = setupSamples.get(phase);
+        samples.push(setup.phases[phase]);
+        if (samples.length > SETUP_SAMPLE_LIMIT) {
+            samples.shift();
+        }
+    }
+    
+    log(`Estabelecimento ${ws.id.substring(0, 8)} (fábrica ${setup.factoryWarm ? 'pronta' : 'fria'}, ` +
+        `conexão ${setup.speculative ? 'especulativa' : 'nova'}): ` +
+        reached.map(phase => `${phase} ${setup.phases[phase]}`).join(', ') + ' ms');
+    log(`Estabelecimento p50/p95 (${setupSessionCount} sessões): ` +
+        setupPercentiles().map(stats => `${stats.phase} ${stats.p50}/${stats.p95}`).join(', ') + ' ms');
+}
+
 // Iniciar transmissão
 function startTransmission() {
     if (!selectedWebcam) {
@@ -137,11 +667,11 @@ function startTransmission() {
     // Notificar todos os clientes conectados
     for (const clientWs of clients.values()) {
         if (clientWs.readyState === WebSocket.OPEN) {
-            clientWs.send(JSON.stringify({
+            sendSignal(clientWs, {
                 type: 'transmission-started',
                 webcam: selectedWebcam.name,
                 config: streamConfig
-            }));
+            });
         }
     }
     
@@ -156,9 +686,9 @@ function stopTransmission() {
     // Notificar todos os clientes conectados
     for (const clientWs of clients.values()) {
         if (clientWs.readyState === WebSocket.OPEN) {
-            clientWs.send(JSON.stringify({
+            sendSignal(clientWs, {
                 type: 'transmission-stopped'
-            }));
+            });
         }
     }
 }
@@ -224,6 +754,7 @@ function showOperationalMenu() {
     console.log('  2. Trocar Webcam');
     console.log('  3. Ver Clientes Conectados');
     console.log('  4. Ver Configurações Atuais');
+    console.log(`  5. ${latencyProbeEnabled ? 'Desativar' : 'Ativar'} Sonda de Latência`);
     console.log('  0. Sair');
     console.log('---------------------------------------------');
     
@@ -248,6 +779,10 @@ function showOperationalMenu() {
             case '4':
                 showCurrentConfig();
                 break;
+            case '5':
+                setLatencyProbe(!latencyProbeEnabled);
+                setTimeout(showOperationalMenu, 1000);
+                break;
             case '0':
                 log('Encerrando servidor...');
                 process.exit(0);
@@ -273,10 +808,23 @@ function showClientsInfo() {
             const deviceType = ws.deviceType || 'desconhecido';
             const state = ws.readyState === WebSocket.OPEN ? 'Conectado' : 'Desconectado';
             console.log(`${index + 1}. ID: ${clientId.substring(0, 8)}... | Tipo: ${deviceType} | Estado: ${state}`);
+            if (ws.latencyStats) {
+                const session = ws.latencyStats.session;
+                console.log(`   Latência p50/p95/p99: ${session.p50}/${session.p95}/${session.p99} ms (${session.count} frames)`);
+            }
             index++;
         }
     }
     
+    const setupStats = setupPercentiles();
+    if (setupStats.length > 0) {
+        console.log('---------------------------------------------');
+        console.log(`Estabelecimento (${setupSessionCount} sessões, ms desde o início):`);
+        setupStats.forEach(stats => {
+            console.log(`  ${stats.phase}: p50 ${stats.p50} | p95 ${stats.p95} | máx ${stats.max} (${stats.count})`);
+        });
+    }
+    
     console.log('---------------------------------------------');
     rl.question('Pressione ENTER para voltar...', () => {
         showOperationalMenu();
@@ -322,22 +870,43 @@ wss.on('connection', (ws, req) => {
     clients.set(clientId, ws);
     
     // Enviar informações de conexão
-    ws.send(JSON.stringify({
+    sendSignal(ws, {
         type: 'welcome',
         id: clientId,
         isTransmitting,
         webcam: selectedWebcam ? selectedWebcam.name : null,
         iosConfig: ws.deviceType === 'ios' ? IOS_OPTIMIZED_CONFIG : null
-    }));
+    });
+    
+    if (latencyProbeEnabled) {
+        sendSignal(ws, {
+            type: 'latency-probe',
+            enabled: true
+        });
+    }
     
-    ws.on('message', (message) => {
+    ws.on('message', (message, isBinary) => {
         try {
-            const data = JSON.parse(message);
-            log(`Mensagem recebida de ${clientId}: ${data.type}`);
+            // ws >= 8 entrega texto como Buffer e informa isBinary; versões antigas entregam string
+            const binary = isBinary === undefined ? typeof message !== 'string' : isBinary;
+            const data = binary ? decodeSignal(message) : JSON.parse(message);
+            log(`Mensagem recebida de ${ws.id}: ${data.type}`);
             
             // Processar diferentes tipos de mensagens
             switch (data.type) {
                 case 'join':
+                    // Reconexão com token válido: reata a sessão sem avisar a sala
+                    if (resumeSession(ws, data.resumeToken)) {
+                        negotiateCodec(ws, data);
+                        sendSignal(ws, {
+                            type: 'session',
+                            resumeToken: ws.session.token,
+                            resumed: true
+                        });
+                        flushSession(ws.session);
+                        break;
+                    }
+                    
                     // Cliente entrando em uma sala
                     const roomId = data.roomId || DEFAULT_ROOM_ID;
                     
@@ -348,16 +917,28 @@ wss.on('connection', (ws, req) => {
                     rooms[roomId].add(ws);
                     ws.roomId = roomId;
                     
-                    log(`Cliente ${clientId} entrou na sala: ${roomId}`);
+                    log(`Cliente ${ws.id} entrou na sala: ${roomId}`);
+                    
+                    negotiateCodec(ws, data);
+                    
+                    // Join sem token (primeiro ou após recriar a conexão WebRTC): sessão nova
+                    if (data.resumable === true) {
+                        startSession(ws);
+                        sendSignal(ws, {
+                            type: 'session',
+                            resumeToken: ws.session.token,
+                            resumed: false
+                        });
+                    }
                     
                     // Notificar outros na sala
                     for (const client of rooms[roomId]) {
                         if (client !== ws && client.readyState === WebSocket.OPEN) {
-                            client.send(JSON.stringify({
+                            sendSignal(client, {
                                 type: 'user-joined',
-                                userId: clientId,
+                                userId: ws.id,
                                 deviceType: ws.deviceType
-                            }));
+                            });
                         }
                     }
                     
@@ -366,17 +947,17 @@ wss.on('connection', (ws, req) => {
                         // Broadcast das capacidades do iOS para todos na sala
                         for (const client of rooms[roomId]) {
                             if (client !== ws && client.readyState === WebSocket.OPEN) {
-                                client.send(JSON.stringify({
+                                sendSignal(client, {
                                     type: 'ios-capabilities-update',
                                     capabilities: IOS_OPTIMIZED_CONFIG
-                                }));
+                                });
                             }
                         }
                     }
                     
                     // Se já estiver transmitindo, enviar configurações atuais
                     if (isTransmitting && selectedWebcam) {
-                        ws.send(JSON.stringify({
+                        sendSignal(ws, {
                             type: 'transmission-active',
                             webcam: selectedWebcam.name,
                             config: {
@@ -384,7 +965,7 @@ wss.on('connection', (ws, req) => {
                                 minBitrate: IOS_OPTIMIZED_CONFIG.adaptiveRate.min_bitrate,
                                 maxBitrate: IOS_OPTIMIZED_CONFIG.adaptiveRate.max_bitrate
                             }
-                        }));
+                        });
                     }
                     break;
                     
@@ -395,30 +976,34 @@ wss.on('connection', (ws, req) => {
                     const room = rooms[ws.roomId];
                     if (room) {
                         for (const client of room) {
-                            if (client !== ws && client.readyState === WebSocket.OPEN) {
+                            if (client !== ws) {
                                 // Para ofertas, otimizar SDP para o dispositivo de destino
                                 if (data.type === 'offer' && client.deviceType === 'ios' && data.sdp) {
                                     // Modificar SDP para otimizar para iOS
                                     data.sdp = optimizeSdpForIOS(data.sdp);
                                 }
                                 
-                                client.send(JSON.stringify(data));
+                                // Quem está reconectando recebe ao retomar a sessão
+                                deliverSignal(client, data);
                             }
                         }
                     }
                     break;
                     
                 case 'bye':
-                    // Cliente saindo da sala
+                    // Cliente saindo da sala; saída explícita não é retomável
+                    endSession(ws);
                     handleClientLeave(ws);
                     break;
                     
                 case 'ping':
                     // Responder a ping para manter conexão viva
-                    ws.send(JSON.stringify({
+                    // Ecoa o timestamp do cliente para a estimativa de offset de relógio
+                    sendSignal(ws, {
                         type: 'pong',
-                        timestamp: Date.now()
-                    }));
+                        timestamp: Date.now(),
+                        clientTimestamp: data.timestamp
+                    });
                     break;
                     
                 case 'stats':
@@ -426,6 +1011,12 @@ wss.on('connection', (ws, req) => {
                     if (data.stats && data.stats.video) {
                         processConnectionStats(data.stats, ws);
                     }
+                    if (data.stats && data.stats.latency) {
+                        processLatencyStats(data.stats.latency, ws);
+                    }
+                    if (data.stats && data.stats.setup) {
+                        processSetupProfile(data.stats.setup, ws);
+                    }
                     break;
             }
         } catch (e) {
@@ -434,9 +1025,19 @@ wss.on('connection', (ws, req) => {
     });
     
     ws.on('close', () => {
-        log(`Conexão fechada: ${clientId}`);
-        handleClientLeave(ws);
-        clients.delete(clientId);
+        log(`Conexão fechada: ${ws.id}`);
+        
+        // Socket substituído por uma retomada: o novo já ocupa o lugar dele
+        if (ws.replaced) {
+            return;
+        }
+        
+        if (ws.session && ws.session.ws === ws) {
+            detachSession(ws.session);
+        } else {
+            handleClientLeave(ws);
+            clients.delete(ws.id);
+        }
         
         // Atualizar a tela operacional se estiver ativa
         if (isTransmitting) {
@@ -446,15 +1047,15 @@ wss.on('connection', (ws, req) => {
     });
     
     ws.on('error', (error) => {
-        log(`Erro na conexão ${clientId}: ${error.message}`);
+        log(`Erro na conexão ${ws.id}: ${error.message}`);
     });
     
     // Se já estiver transmitindo, notificar o novo cliente
     if (isTransmitting && selectedWebcam) {
-        ws.send(JSON.stringify({
+        sendSignal(ws, {
             type: 'transmission-active',
             webcam: selectedWebcam.name
-        }));
+        });
     }
     
     // Atualizar a tela operacional se estiver ativa
@@ -480,27 +1081,27 @@ function processConnectionStats(stats, ws) {
         if (stats.packetLoss > 5) { // mais de 5% de perda de pacotes
             // Enviar recomendação para reduzir qualidade
             if (ws.readyState === WebSocket.OPEN) {
-                ws.send(JSON.stringify({
+                sendSignal(ws, {
                     type: 'quality-recommendation',
                     action: 'decrease-bitrate',
                     targetBitrate: Math.max(
                         stats.bandwidth * 0.7, // 70% da largura de banda atual
                         IOS_OPTIMIZED_CONFIG.adaptiveRate.min_bitrate // não cair abaixo do mínimo
                     )
-                }));
+                });
             }
         } 
         else if (stats.packetLoss < 1 && stats.bandwidth > IOS_OPTIMIZED_CONFIG.adaptiveRate.initial_bitrate * 1.2) {
             // Conexão boa, pode aumentar a qualidade
             if (ws.readyState === WebSocket.OPEN) {
-                ws.send(JSON.stringify({
+                sendSignal(ws, {
                     type: 'quality-recommendation',
                     action: 'increase-bitrate',
                     targetBitrate: Math.min(
                         stats.bandwidth * 1.2, // 120% da largura de banda atual
                         IOS_OPTIMIZED_CONFIG.adaptiveRate.max_bitrate // não exceder o máximo
                     )
-                }));
+                });
             }
         }
     }
@@ -509,16 +1110,15 @@ function processConnectionStats(stats, ws) {
 // Função para lidar com cliente que sai
 function handleClientLeave(ws) {
     const roomId = ws.roomId;
-    if (roomId && rooms[roomId]) {
-        rooms[roomId].delete(ws);
-        
+    // 'bye' seguido do fechamento do socket não avisa a sala duas vezes
+    if (roomId && rooms[roomId] && rooms[roomId].delete(ws)) {
         // Notificar outros na sala
         for (const client of rooms[roomId]) {
             if (client.readyState === WebSocket.OPEN) {
-                client.send(JSON.stringify({
+                sendSignal(client, {
                     type: 'user-left',
                     userId: ws.id
-                }));
+                });
             }
         }
         
@@ -529,6 +1129,118 @@ function handleClientLeave(ws) {
     }
 }
 
+// Sessões retomáveis: só para clientes que pedem no 'join' (resumable). Se o
+// WebSocket cai, o socket antigo fica na sala por RESUME_GRACE_MS e as mensagens
+// para ele são guardadas; reconectando com o token, o novo socket assume o lugar
+// sem 'user-left'/'user-joined', e a conexão WebRTC segue sem renegociar.
+function startSession(ws) {
+    endSession(ws);
+    const session = {
+        token: crypto.randomBytes(16).toString('hex'),
+        ws,
+        roomId: ws.roomId,
+        expireTimer: null,
+        detachedAt: 0,
+        pending: []
+    };
+    sessions.set(session.token, session);
+    ws.session = session;
+}
+
+function endSession(ws) {
+    const session = ws.session;
+    if (session) {
+        clearTimeout(session.expireTimer);
+        sessions.delete(session.token);
+        ws.session = null;
+    }
+}
+
+// Reata o novo socket à sessão do token; false se não existe ou já expirou
+function resumeSession(ws, token) {
+    const session = typeof token === 'string' ? sessions.get(token) : undefined;
+    if (!session || !rooms[session.roomId]) {
+        return false;
+    }
+    
+    const previous = session.ws;
+    clearTimeout(session.expireTimer);
+    session.expireTimer = null;
+    
+    if (previous !== ws) {
+        // O socket antigo pode estar meio aberto (queda ainda não detectada aqui)
+        previous.replaced = true;
+        previous.session = null;
+        rooms[session.roomId].delete(previous);
+        if (previous.readyState === WebSocket.OPEN) {
+            previous.terminate();
+        }
+        
+        clients.delete(ws.id);
+        ws.id = previous.id;
+        ws.deviceType = previous.deviceType;
+        clients.set(ws.id, ws);
+    }
+    
+    rooms[session.roomId].add(ws);
+    ws.roomId = session.roomId;
+    ws.session = session;
+    session.ws = ws;
+    
+    const outage = session.detachedAt ? Date.now() - session.detachedAt : 0;
+    session.detachedAt = 0;
+    log(`Cliente ${ws.id} retomou a sessão na sala ${session.roomId} após ${outage} ms ` +
+        `(${session.pending.length} mensagens guardadas)`);
+    return true;
+}
+
+// WebSocket caiu sem 'bye': segura o lugar na sala até o prazo de retomada
+function detachSession(session) {
+    session.detachedAt = Date.now();
+    log(`Cliente ${session.ws.id} desconectado; aguardando retomada por ${RESUME_GRACE_MS / 1000} s`);
+    
+    session.expireTimer = setTimeout(() => {
+        const ws = session.ws;
+        log(`Sessão de ${ws.id} expirou sem retomada`);
+        endSession(ws);
+        handleClientLeave(ws);
+        clients.delete(ws.id);
+    }, RESUME_GRACE_MS);
+}
+
+// Envia a um membro da sala; se ele está reconectando, guarda para a retomada
+function deliverSignal(client, message) {
+    if (client.readyState === WebSocket.OPEN) {
+        sendSignal(client, message);
+    } else if (client.session && client.session.expireTimer) {
+        const pending = client.session.pending;
+        if (pending.length >= RESUME_QUEUE_LIMIT) {
+            pending.shift();
+        }
+        pending.push(message);
+    }
+}
+
+function flushSession(session) {
+    const pending = session.pending;
+    session.pending = [];
+    for (const message of pending) {
+        sendSignal(session.ws, message);
+    }
+}
+
+// Cliente anunciou o protocolo binário: confirma ainda em JSON e troca o codec
+function negotiateCodec(ws, data) {
+    if (Number.isInteger(data.binaryProtocol) && data.binaryProtocol >= SIGNALING_VERSION) {
+        ws.send(JSON.stringify({
+            type: 'codec',
+            binaryProtocol: SIGNALING_VERSION
+        }));
+        ws.binaryProtocol = SIGNALING_VERSION;
+        log(`Cliente ${ws.id} usando sinalização binária v${SIGNALING_VERSION}`);
+    }
+}
+
 // Otimização SDP para iOS (baseado nos logs de diagnóstico)
 function optimizeSdpForIOS(sdp) {
     const lines = sdp.split('\n');
@@ -687,9 +1399,9 @@ function shutdown() {
     // Notificar todos os clientes
     for (const ws of clients.values()) {
         if (ws.readyState === WebSocket.OPEN) {
-            ws.send(JSON.stringify({
+            sendSignal(ws, {
                 type: 'server-shutdown'
-            }));
+            });
             ws.terminate();
         }
     }
@@ -0,0 +1,570 @@
+#ifndef SIGNALINGMESSAGE_H
+#define SIGNALINGMESSAGE_H
+
+#include "SignalingCodec.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef VCAM_TEST_DATA_DIR
+#define VCAM_TEST_DATA_DIR "data"
+#endif
+
+namespace vcam {
+namespace test {
+
+/**
+ * Valor de mensagem de sinalização no host, no lugar do NSDictionary do
+ * WebRTCManager. Mapas guardam a ordem de inserção.
+ */
+struct Value {
+    enum Kind { Null, Bool, Int, UInt, Double, Text, Array, Map };
+
+    Kind kind = Null;
+    bool boolean = false;
+    int64_t integer = 0;
+    uint64_t unsignedInteger = 0;
+    double real = 0;
+    std::string text;
+    std::vector<Value> items;
+    std::vector<std::pair<std::string, Value>> fields;
+
+    static Value makeText(std::string s) {
+        Value v;
+        v.kind = Text;
+        v.text = std::move(s);
+        return v;
+    }
+};
+
+/** Igualdade semântica: números comparam pelo valor (5 == 5.0), NaN == NaN. */
+inline bool sameValue(const Value &a, const Value &b) {
+    auto isNumber = [](const Value &v) { return v.kind == Value::Int || v.kind == Value::UInt || v.kind == Value::Double; };
+    if (isNumber(a) && isNumber(b)) {
+        if (a.kind == Value::Double || b.kind == Value::Double) {
+            double x = a.kind == Value::Double ? a.real : a.kind == Value::Int ? (double)a.integer : (double)a.unsignedInteger;
+            double y = b.kind == Value::Double ? b.real : b.kind == Value::Int ? (double)b.integer : (double)b.unsignedInteger;
+            return x == y || (std::isnan(x) && std::isnan(y));
+        }
+        if (a.kind == Value::UInt || b.kind == Value::UInt) {
+            bool aNeg = a.kind == Value::Int && a.integer < 0, bNeg = b.kind == Value::Int && b.integer < 0;
+            uint64_t x = a.kind == Value::UInt ? a.unsignedInteger : (uint64_t)a.integer;
+            uint64_t y = b.kind == Value::UInt ? b.unsignedInteger : (uint64_t)b.integer;
+            return !aNeg && !bNeg && x == y;
+        }
+        return a.integer == b.integer;
+    }
+    if (a.kind != b.kind) {
+        return false;
+    }
+    switch (a.kind) {
+        case Value::Null: return true;
+        case Value::Bool: return a.boolean == b.boolean;
+        case Value::Text: return a.text == b.text;
+        case Value::Array:
+            if (a.items.size() != b.items.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.items.size(); i++) {
+                if (!sameValue(a.items[i], b.items[i])) {
+                    return false;
+                }
+            }
+            return true;
+        case Value::Map:
+            if (a.fields.size() != b.fields.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.fields.size(); i++) {
+                if (a.fields[i].first != b.fields[i].first || !sameValue(a.fields[i].second, b.fields[i].second)) {
+                    return false;
+                }
+            }
+            return true;
+        default: return false;
+    }
+}
+
+// --- Binário (espelha EncodeSignalingMessage/DecodeSignalingMessage do WebRTCManager) ---
+
+const int kSignalingMaxDepth = 16;
+
+inline bool writeValue(SignalingWriter &writer, const Value &value, int depth) {
+    if (depth > kSignalingMaxDepth) {
+        return false;
+    }
+    switch (value.kind) {
+        case Value::Null: writer.writeNull(); break;
+        case Value::Bool: writer.writeBool(value.boolean); break;
+        case Value::Int: writer.writeInt(value.integer); break;
+        case Value::UInt: writer.writeUInt(value.unsignedInteger); break;
+        case Value::Double: writer.writeDouble(value.real); break;
+        case Value::Text: writer.writeText(value.text.data(), value.text.size()); break;
+        case Value::Array:
+            writer.beginArray(value.items.size());
+            for (const Value &item : value.items) {
+                if (!writeValue(writer, item, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+        case Value::Map:
+            writer.beginMap(value.fields.size());
+            for (const auto &field : value.fields) {
+                writer.writeKey(field.first.data(), field.first.size());
+                if (!writeValue(writer, field.second, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+    }
+    return true;
+}
+
+/** @return false se a mensagem não cabe no protocolo binário (o emissor usaria JSON) */
+inline bool encodeMessage(const Value &message, std::vector<uint8_t> &out) {
+    if (message.kind != Value::Map) {
+        return false;
+    }
+    SignalingWriter writer;
+    writer.beginMap(message.fields.size());
+    for (const auto &field : message.fields) {
+        writer.writeKey(field.first.data(), field.first.size());
+        if (field.first == "type") {
+            if (field.second.kind != Value::Text) {
+                return false;
+            }
+            writer.writeType(field.second.text.data(), field.second.text.size());
+        } else if (!writeValue(writer, field.second, 1)) {
+            return false;
+        }
+    }
+    out = writer.bytes();
+    return true;
+}
+
+inline bool readValue(SignalingReader &reader, int depth, Value &out);
+
+inline bool readMap(SignalingReader &reader, uint64_t count, int depth, bool topLevel, Value &out) {
+    out = Value();
+    out.kind = Value::Map;
+    for (uint64_t i = 0; i < count; i++) {
+        SignalingItem item;
+        if (!reader.read(item)) {
+            return false;
+        }
+        std::string key;
+        if (item.type == SignalingItemType::UInt) {
+            const char *name = SignalingKeyName(item.count);
+            if (!name) {
+                return false;
+            }
+            key = name;
+        } else if (item.type == SignalingItemType::Text) {
+            key.assign(item.text, (size_t)item.count);
+        } else {
+            return false;
+        }
+
+        Value value;
+        if (topLevel && key == "type") {
+            if (!reader.read(item)) {
+                return false;
+            }
+            if (item.type == SignalingItemType::UInt) {
+                const char *name = SignalingTypeName(item.count);
+                if (!name) {
+                    return false;
+                }
+                value = Value::makeText(name);
+            } else if (item.type == SignalingItemType::Text) {
+                value = Value::makeText(std::string(item.text, (size_t)item.count));
+            } else {
+                return false;
+            }
+        } else if (!readValue(reader, depth + 1, value)) {
+            return false;
+        }
+        out.fields.emplace_back(std::move(key), std::move(value));
+    }
+    return true;
+}
+
+inline bool readValue(SignalingReader &reader, int depth, Value &out) {
+    SignalingItem item;
+    if (depth > kSignalingMaxDepth || !reader.read(item)) {
+        return false;
+    }
+    out = Value();
+    switch (item.type) {
+        case SignalingItemType::UInt:
+            out.kind = Value::UInt;
+            out.unsignedInteger = item.count;
+            return true;
+        case SignalingItemType::NegInt:
+            out.kind = Value::Int;
+            out.integer = item.integer;
+            return true;
+        case SignalingItemType::Double:
+            out.kind = Value::Double;
+            out.real = item.real;
+            return true;
+        case SignalingItemType::Bool:
+            out.kind = Value::Bool;
+            out.boolean = item.boolean;
+            return true;
+        case SignalingItemType::Null:
+            return true;
+        case SignalingItemType::Text:
+            out = Value::makeText(std::string(item.text, (size_t)item.count));
+            return true;
+        case SignalingItemType::Array:
+            out.kind = Value::Array;
+            for (uint64_t i = 0; i < item.count; i++) {
+                Value element;
+                if (!readValue(reader, depth + 1, element)) {
+                    return false;
+                }
+                out.items.push_back(std::move(element));
+            }
+            return true;
+        case SignalingItemType::Map:
+            return readMap(reader, item.count, depth, false, out);
+    }
+    return false;
+}
+
+/** @return false se não é uma mensagem binária válida desta versão */
+inline bool decodeMessage(const uint8_t *data, size_t length, Value &out) {
+    SignalingReader reader(data, length);
+    SignalingItem item;
+    if (!reader.valid() || !reader.read(item) || item.type != SignalingItemType::Map) {
+        return false;
+    }
+    return readMap(reader, item.count, 0, true, out) && reader.atEnd();
+}
+
+// --- JSON (referência de tamanho e custo, como JSON.stringify/JSON.parse) ---
+
+inline void appendJSONString(std::string &out, const std::string &text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char escape[8];
+                    std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    out += escape;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void appendJSON(std::string &out, const Value &value) {
+    char number[32];
+    switch (value.kind) {
+        case Value::Null: out += "null"; break;
+        case Value::Bool: out += value.boolean ? "true" : "false"; break;
+        case Value::Int: out += std::to_string(value.integer); break;
+        case Value::UInt: out += std::to_string(value.unsignedInteger); break;
+        case Value::Double:
+            // Menor representação que volta ao mesmo double, como JSON.stringify
+            for (int precision = 15; precision <= 17; precision++) {
+                std::snprintf(number, sizeof(number), "%.*g", precision, value.real);
+                if (std::strtod(number, nullptr) == value.real) {
+                    break;
+                }
+            }
+            out += number;
+            break;
+        case Value::Text: appendJSONString(out, value.text); break;
+        case Value::Array:
+            out += '[';
+            for (size_t i = 0; i < value.items.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                appendJSON(out, value.items[i]);
+            }
+            out += ']';
+            break;
+        case Value::Map:
+            out += '{';
+            for (size_t i = 0; i < value.fields.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                appendJSONString(out, value.fields[i].first);
+                out += ':';
+                appendJSON(out, value.fields[i].second);
+            }
+            out += '}';
+            break;
+    }
+}
+
+inline std::string toJSON(const Value &value) {
+    std::string out;
+    appendJSON(out, value);
+    return out;
+}
+
+class JSONParser {
+public:
+    JSONParser(const char *text, size_t length) : _p(text), _end(text + length) {}
+
+    bool parse(Value &out) {
+        if (!parseValue(out, 0)) {
+            return false;
+        }
+        skipSpace();
+        return _p == _end;
+    }
+
+private:
+    void skipSpace() {
+        while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t')) {
+            _p++;
+        }
+    }
+
+    bool literal(const char *word) {
+        size_t n = std::strlen(word);
+        if ((size_t)(_end - _p) < n || std::strncmp(_p, word, n) != 0) {
+            return false;
+        }
+        _p += n;
+        return true;
+    }
+
+    static void appendUTF8(std::string &out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool hex4(uint32_t &cp) {
+        if (_end - _p < 4) {
+            return false;
+        }
+        char digits[5] = { _p[0], _p[1], _p[2], _p[3], 0 };
+        char *stop;
+        cp = (uint32_t)std::strtoul(digits, &stop, 16);
+        _p += 4;
+        return stop == digits + 4;
+    }
+
+    bool parseString(std::string &out) {
+        if (_p >= _end || *_p != '"') {
+            return false;
+        }
+        _p++;
+        while (_p < _end && *_p != '"') {
+            if (*_p != '\\') {
+                out += *_p++;
+                continue;
+            }
+            if (++_p >= _end) {
+                return false;
+            }
+            char c = *_p++;
+            switch (c) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!hex4(cp)) {
+                        return false;
+                    }
+                    if (cp >= 0xD800 && cp < 0xDC00 && _end - _p >= 6 && _p[0] == '\\' && _p[1] == 'u') {
+                        _p += 2;
+                        uint32_t low;
+                        if (!hex4(low)) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUTF8(out, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (_p >= _end) {
+            return false;
+        }
+        _p++;
+        return true;
+    }
+
+    bool parseNumber(Value &out) {
+        const char *start = _p;
+        bool isFloat = false;
+        while (_p < _end && (std::strchr("+-0123456789", *_p) || *_p == '.' || *_p == 'e' || *_p == 'E')) {
+            isFloat |= *_p == '.' || *_p == 'e' || *_p == 'E';
+            _p++;
+        }
+        std::string digits(start, _p);
+        char *stop;
+        if (!isFloat) {
+            errno = 0;
+            long long value = std::strtoll(digits.c_str(), &stop, 10);
+            if (errno == 0 && *stop == '\0' && !digits.empty()) {
+                out.kind = Value::Int;
+                out.integer = value;
+                return true;
+            }
+        }
+        out.kind = Value::Double;
+        out.real = std::strtod(digits.c_str(), &stop);
+        return !digits.empty() && *stop == '\0';
+    }
+
+    bool parseValue(Value &out, int depth) {
+        skipSpace();
+        if (_p >= _end || depth > kSignalingMaxDepth) {
+            return false;
+        }
+        out = Value();
+        switch (*_p) {
+            case 'n': return literal("null");
+            case 't': out.kind = Value::Bool; out.boolean = true; return literal("true");
+            case 'f': out.kind = Value::Bool; return literal("false");
+            case '"': out.kind = Value::Text; return parseString(out.text);
+            case '[':
+                out.kind = Value::Array;
+                _p++;
+                skipSpace();
+                if (_p < _end && *_p == ']') {
+                    _p++;
+                    return true;
+                }
+                for (;;) {
+                    Value item;
+                    if (!parseValue(item, depth + 1)) {
+                        return false;
+                    }
+                    out.items.push_back(std::move(item));
+                    skipSpace();
+                    if (_p < _end && *_p == ',') {
+                        _p++;
+                    } else if (_p < _end && *_p == ']') {
+                        _p++;
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+            case '{':
+                out.kind = Value::Map;
+                _p++;
+                skipSpace();
+                if (_p < _end && *_p == '}') {
+                    _p++;
+                    return true;
+                }
+                for (;;) {
+                    std::string key;
+                    skipSpace();
+                    if (!parseString(key)) {
+                        return false;
+                    }
+                    skipSpace();
+                    if (_p >= _end || *_p != ':') {
+                        return false;
+                    }
+                    _p++;
+                    Value item;
+                    if (!parseValue(item, depth + 1)) {
+                        return false;
+                    }
+                    out.fields.emplace_back(std::move(key), std::move(item));
+                    skipSpace();
+                    if (_p < _end && *_p == ',') {
+                        _p++;
+                    } else if (_p < _end && *_p == '}') {
+                        _p++;
+                        return true;
+                    } else {
+                        return false;
+                    }
+                }
+            default: return parseNumber(out);
+        }
+    }
+
+    const char *_p;
+    const char *_end;
+};
+
+inline bool parseJSON(const std::string &text, Value &out) {
+    return JSONParser(text.data(), text.size()).parse(out);
+}
+
+/**
+ * Mensagens de data/signaling_messages.json: pares [tipo, mensagem] com o
+ * formato enviado pelo WebRTCManager e pelo server.js.
+ */
+inline std::vector<std::pair<std::string, Value>> loadSignalingCorpus(
+    const std::string &path = VCAM_TEST_DATA_DIR "/signaling_messages.json") {
+    std::vector<std::pair<std::string, Value>> corpus;
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return corpus;
+    }
+    std::string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, n);
+    }
+    std::fclose(file);
+
+    Value root;
+    if (!parseJSON(text, root) || root.kind != Value::Array) {
+        return corpus;
+    }
+    for (Value &entry : root.items) {
+        if (entry.kind == Value::Array && entry.items.size() == 2 && entry.items[0].kind == Value::Text) {
+            corpus.emplace_back(entry.items[0].text, std::move(entry.items[1]));
+        }
+    }
+    return corpus;
+}
+
+} // namespace test
+} // namespace vcam
+
+#endif /* SIGNALINGMESSAGE_H */
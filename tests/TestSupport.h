@@ -0,0 +1,83 @@
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace vcam {
+namespace test {
+
+/** Falhas acumuladas pelos CHECKs do executável atual. */
+inline int &failureCount() {
+    static int count = 0;
+    return count;
+}
+
+/** Imprime o resultado do executável; use como valor de retorno do main. */
+inline int finish(const char *name) {
+    if (failureCount() != 0) {
+        std::printf("%s: %d falha(s)\n", name, failureCount());
+        return 1;
+    }
+    std::printf("%s: ok\n", name);
+    return 0;
+}
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** Percentil (0..1) de amostras; ordena o vetor recebido. */
+inline int64_t percentile(std::vector<int64_t> &samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = (size_t)(p * (double)(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+/**
+ * Mede fn em rodadas e devolve a mediana em ns por chamada.
+ * Uma chamada de aquecimento fica de fora (caches, páginas, pool de threads).
+ */
+template <typename Fn>
+double medianNsPerCall(Fn &&fn, int rounds = 7, int callsPerRound = 3) {
+    fn();
+    std::vector<int64_t> samples;
+    for (int r = 0; r < rounds; r++) {
+        int64_t start = nowNs();
+        for (int c = 0; c < callsPerRound; c++) {
+            fn();
+        }
+        samples.push_back((nowNs() - start) / callsPerRound);
+    }
+    return (double)percentile(samples, 0.5);
+}
+
+} // namespace test
+} // namespace vcam
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond);              \
+            vcam::test::failureCount()++;                                               \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_MSG(cond, ...)                                                            \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::printf("%s:%d: falhou: %s: ", __FILE__, __LINE__, #cond);              \
+            std::printf(__VA_ARGS__);                                                   \
+            std::printf("\n");                                                          \
+            vcam::test::failureCount()++;                                               \
+        }                                                                               \
+    } while (0)
+
+#endif /* TESTSUPPORT_H */
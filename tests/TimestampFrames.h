@@ -0,0 +1,109 @@
+#ifndef TIMESTAMPFRAMES_H
+#define TIMESTAMPFRAMES_H
+
+#include "TimestampCode.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+#ifndef VCAM_TEST_DATA_DIR
+#define VCAM_TEST_DATA_DIR "data"
+#endif
+
+namespace vcam {
+namespace test {
+
+/**
+ * Faixa do código de timestamp lida de data/timestamp_code (gerada por
+ * gen_timestamp_frames). Só as linhas da faixa estão no arquivo; frameHeight
+ * é a altura do frame original, da qual o leitor deriva a altura da faixa.
+ */
+struct TimestampFrame {
+    std::string name;
+    int width = 0;
+    int rows = 0;
+    int frameHeight = 0;
+    uint64_t timestampMs = 0;
+    bool expectValid = false;
+    std::vector<uint8_t> luma;
+
+    LumaPlane plane() const {
+        return { luma.data(), width, width, frameHeight };
+    }
+};
+
+/** Lê um PGM binário (P5) com os comentários frame-height, timestamp-ms e expect. */
+inline bool loadTimestampFrame(const std::string &path, TimestampFrame &frame) {
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char line[256];
+    int header[5];  // largura, altura, máximo (com folga para o sscanf)
+    int fields = 0;
+    bool ok = std::fgets(line, sizeof(line), file) && std::strncmp(line, "P5", 2) == 0;
+    while (ok && fields < 3 && std::fgets(line, sizeof(line), file)) {
+        unsigned long long value;
+        char expect[16];
+        if (line[0] == '#') {
+            if (std::sscanf(line, "# timestamp-ms %llu", &value) == 1) {
+                frame.timestampMs = value;
+            } else if (std::sscanf(line, "# expect %15s", expect) == 1) {
+                frame.expectValid = std::strcmp(expect, "valid") == 0;
+            } else {
+                std::sscanf(line, "# frame-height %d", &frame.frameHeight);
+            }
+            continue;
+        }
+        fields += std::sscanf(line, "%d %d %d", &header[fields], &header[fields + 1], &header[fields + 2]);
+    }
+    ok = ok && fields == 3 && header[2] == 255 && frame.frameHeight >= header[1];
+    if (ok) {
+        frame.width = header[0];
+        frame.rows = header[1];
+        frame.luma.resize((size_t)frame.width * frame.rows);
+        ok = std::fread(frame.luma.data(), 1, frame.luma.size(), file) == frame.luma.size();
+        // O leitor não pode passar da faixa gravada
+        ok = ok && TimestampCodeLayout::stripHeight(frame.frameHeight) <= frame.rows;
+    }
+    std::fclose(file);
+    const char *slash = std::strrchr(path.c_str(), '/');
+    frame.name = slash ? slash + 1 : path;
+    return ok;
+}
+
+/** Todos os frames do diretório, em ordem alfabética; vazio se algum arquivo for inválido. */
+inline std::vector<TimestampFrame> loadTimestampFrames(const std::string &dir = VCAM_TEST_DATA_DIR "/timestamp_code") {
+    std::vector<std::string> paths;
+    if (DIR *d = opendir(dir.c_str())) {
+        while (dirent *entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".pgm") == 0) {
+                paths.push_back(dir + "/" + name);
+            }
+        }
+        closedir(d);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<TimestampFrame> frames;
+    for (const std::string &path : paths) {
+        TimestampFrame frame;
+        if (!loadTimestampFrame(path, frame)) {
+            std::printf("frame inválido: %s\n", path.c_str());
+            return {};
+        }
+        frames.push_back(std::move(frame));
+    }
+    return frames;
+}
+
+} // namespace test
+} // namespace vcam
+
+#endif /* TIMESTAMPFRAMES_H */
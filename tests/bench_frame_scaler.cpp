@@ -0,0 +1,136 @@
+// FrameScaler fundido (recorte + escala + conversão em uma varredura) contra
+// o caminho em duas etapas que substituiu: cropAndScaleWith: para um buffer
+// escalado alocado por frame, toI420 materializando planos I420 e então a
+// conversão para o formato final. A escala das duas etapas usa o mesmo nível
+// de qualidade, então a diferença medida é só a da fusão. A coluna
+// "h. escalar" é o fundido com o filtro horizontal pela tabela escalar, para
+// medir o ganho do horizontal SIMD.
+
+#include "FrameScaler.h"
+#include "ParallelFor.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct Source {
+    int width, height;
+    std::vector<uint8_t> y, uv;
+
+    Source(int w, int h) : width(w), height(h), y((size_t)w * h), uv((size_t)w * ((h + 1) / 2)) {
+        for (size_t i = 0; i < y.size(); i++) {
+            y[i] = (uint8_t)(16 + (i * 13) % 220);
+        }
+        for (size_t i = 0; i < uv.size(); i++) {
+            uv[i] = (uint8_t)(16 + (i * 7) % 225);
+        }
+    }
+
+    YUVSource yuv() const {
+        NV12Source planes = { y.data(), uv.data(), width, width, width, height };
+        return YUVSource::fromNV12(planes, { YUVMatrix::BT709, YUVRange::Video });
+    }
+};
+
+struct Output {
+    std::vector<uint8_t> y, uv;
+    ScaleTarget target;
+
+    Output(ScaleTarget::Format format, int w, int h) {
+        int chromaHeight = (h + 1) / 2;
+        if (format == ScaleTarget::BGRA) {
+            y.resize((size_t)w * 4 * h);
+            target = { format, y.data(), nullptr, w * 4, 0, w, h, YUVRange::Full, false, false };
+        } else {
+            y.resize((size_t)w * h);
+            uv.resize((size_t)((w + 1) / 2) * 2 * chromaHeight);
+            target = { format, y.data(), uv.data(), w, ((w + 1) / 2) * 2, w, h, YUVRange::Full, false, false };
+        }
+    }
+};
+
+void twoStep(FrameScaler &scaler, const YUVSource &src, const CropRect &crop, const ScaleTarget &dst,
+             ScaleQuality quality) {
+    int w = dst.width, h = dst.height;
+    int chromaWidth = (w + 1) / 2, chromaHeight = (h + 1) / 2;
+
+    // 1. cropAndScaleWith: buffer escalado novo a cada frame, mesma faixa da origem
+    std::vector<uint8_t> scaledY((size_t)w * h), scaledUV((size_t)chromaWidth * 2 * chromaHeight);
+    ScaleTarget scaled = { ScaleTarget::NV12, scaledY.data(), scaledUV.data(), w, chromaWidth * 2, w, h,
+                           src.colorSpace.range, false, false };
+    scaler.process(src, crop, scaled, quality);
+
+    // 2. toI420: separa U e V em planos próprios
+    std::vector<uint8_t> u((size_t)chromaWidth * chromaHeight), v(u.size());
+    for (size_t i = 0; i < u.size(); i++) {
+        u[i] = scaledUV[2 * i];
+        v[i] = scaledUV[2 * i + 1];
+    }
+    I420Planes i420 = { scaledY.data(), u.data(), v.data(), w, chromaWidth, chromaWidth, w, h };
+
+    // 3. conversão para o formato pedido pelo consumidor
+    if (dst.format == ScaleTarget::BGRA) {
+        ConvertI420ToBGRA(i420, src.colorSpace, { dst.y, dst.strideY });
+    } else {
+        ConvertI420ToNV12(i420, src.colorSpace.range, { dst.y, dst.uv, dst.strideY, dst.strideUV }, dst.range);
+    }
+}
+
+const char *qualityName(ScaleQuality quality) {
+    switch (quality) {
+        case ScaleQuality::Nearest: return "nearest";
+        case ScaleQuality::Bilinear: return "bilinear";
+        case ScaleQuality::Box: return "box";
+        case ScaleQuality::Lanczos3: return "lanczos3";
+    }
+    return "?";
+}
+
+} // namespace
+
+int main() {
+    SetParallelism(1);
+
+    struct Case {
+        const char *name;
+        int srcWidth, srcHeight;
+        CropRect crop;
+        int dstWidth, dstHeight;
+    };
+    const Case cases[] = {
+        { "1080p -> 720p", 1920, 1080, { 0, 0, 1920, 1080 }, 1280, 720 },
+        { "1080p 4:3 -> 640x480", 1920, 1080, { 240, 0, 1440, 1080 }, 640, 480 },
+        { "2160p -> 1080p", 3840, 2160, { 0, 0, 3840, 2160 }, 1920, 1080 },
+        { "720p -> 1080p", 1280, 720, { 0, 0, 1280, 720 }, 1920, 1080 },
+    };
+    const ScaleQuality tiers[] = { ScaleQuality::Nearest, ScaleQuality::Bilinear, ScaleQuality::Box,
+                                   ScaleQuality::Lanczos3 };
+
+    std::printf("%-22s %-5s %-9s %10s %10s %8s %10s %8s\n", "caso", "saída", "nível", "fundido", "h. escalar",
+                "SIMD", "2 etapas", "fusão");
+    for (const Case &c : cases) {
+        Source source(c.srcWidth, c.srcHeight);
+        YUVSource src = source.yuv();
+        for (ScaleTarget::Format format : { ScaleTarget::NV12, ScaleTarget::BGRA }) {
+            Output output(format, c.dstWidth, c.dstHeight);
+            for (ScaleQuality quality : tiers) {
+                FrameScaler fused, scalar, unfused;
+                scalar.setHorizontalSIMD(false);
+                double fusedNs = vcam::test::medianNsPerCall(
+                    [&] { fused.process(src, c.crop, output.target, quality); });
+                double scalarNs = vcam::test::medianNsPerCall(
+                    [&] { scalar.process(src, c.crop, output.target, quality); });
+                double twoStepNs = vcam::test::medianNsPerCall(
+                    [&] { twoStep(unfused, src, c.crop, output.target, quality); });
+                std::printf("%-22s %-5s %-9s %7.3f ms %7.3f ms %7.2fx %7.3f ms %7.2fx\n", c.name,
+                            format == ScaleTarget::BGRA ? "BGRA" : "NV12", qualityName(quality),
+                            fusedNs / 1e6, scalarNs / 1e6, scalarNs / fusedNs, twoStepNs / 1e6, twoStepNs / fusedNs);
+            }
+        }
+    }
+    SetParallelism(0);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Contenção do FrameSlot: um produtor publicando a 30/60/120 fps e vários
+// leitores em laço (pior caso de fila da câmera + display link + preview).
+// Compara com um slot protegido por mutex, equivalente ao @synchronized antigo.
+// "Vazias/atrasadas" são leituras sem frame ou com um id anterior ao último
+// publicado antes da leitura começar (leituras antes do primeiro publish não contam).
+
+#include "FrameSlot.h"
+#include "TestSupport.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using vcam::test::nowNs;
+using vcam::test::percentile;
+
+namespace {
+
+struct Frame {
+    uint64_t id;
+};
+using FrameHandle = std::shared_ptr<Frame>;
+
+class MutexSlot {
+public:
+    void publish(FrameHandle value) {
+        FrameHandle old;
+        std::lock_guard<std::mutex> lock(_mutex);
+        old.swap(_value);
+        _value = std::move(value);
+    }
+
+    bool read(FrameHandle &out) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        out = _value;
+        return static_cast<bool>(out);
+    }
+
+private:
+    mutable std::mutex _mutex;
+    FrameHandle _value;
+};
+
+struct Result {
+    std::vector<int64_t> publishNs;
+    std::vector<int64_t> readNs;
+    uint64_t reads = 0;
+    uint64_t staleOrEmpty = 0;
+};
+
+template <typename Slot>
+Result run(int fps, int readers, int64_t durationNs) {
+    Slot slot;
+    Result result;
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> latestId(0);
+    std::vector<std::vector<int64_t>> readSamples(readers);
+    std::vector<uint64_t> readCounts(readers, 0);
+    std::vector<uint64_t> staleCounts(readers, 0);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&, r] {
+            FrameHandle frame;
+            while (running.load(std::memory_order_relaxed)) {
+                uint64_t expected = latestId.load(std::memory_order_acquire);
+                int64_t start = nowNs();
+                bool ok = slot.read(frame);
+                int64_t elapsed = nowNs() - start;
+                // Amostra 1 em 16 para não medir só o custo do relógio
+                if ((readCounts[r] & 15) == 0) {
+                    readSamples[r].push_back(elapsed);
+                }
+                readCounts[r]++;
+                if (expected > 0 && (!ok || frame->id < expected)) {
+                    staleCounts[r]++;
+                }
+            }
+        });
+    }
+
+    int64_t intervalNs = 1000000000LL / fps;
+    int64_t begin = nowNs();
+    int64_t next = begin;
+    for (uint64_t id = 1; nowNs() - begin < durationNs; id++) {
+        FrameHandle frame = std::make_shared<Frame>(Frame{id});
+        int64_t start = nowNs();
+        slot.publish(std::move(frame));
+        result.publishNs.push_back(nowNs() - start);
+        latestId.store(id, std::memory_order_release);
+        next += intervalNs;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(std::max<int64_t>(0, next - nowNs())));
+    }
+    running.store(false);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (int r = 0; r < readers; r++) {
+        result.readNs.insert(result.readNs.end(), readSamples[r].begin(), readSamples[r].end());
+        result.reads += readCounts[r];
+        result.staleOrEmpty += staleCounts[r];
+    }
+    return result;
+}
+
+template <typename Slot>
+void report(const char *name, int fps, int readers, int64_t durationNs) {
+    Result result = run<Slot>(fps, readers, durationNs);
+    std::printf("%-9s %4d fps %2d leitores | publish p50 %6lld p99 %7lld max %8lld ns"
+                " | read p50 %5lld p99 %7lld max %8lld ns | %6.2f Mreads/s, %5.2f%% vazias/atrasadas\n",
+                name, fps, readers,
+                (long long)percentile(result.publishNs, 0.5), (long long)percentile(result.publishNs, 0.99),
+                (long long)percentile(result.publishNs, 1.0),
+                (long long)percentile(result.readNs, 0.5), (long long)percentile(result.readNs, 0.99),
+                (long long)percentile(result.readNs, 1.0),
+                (double)result.reads / ((double)durationNs / 1e9) / 1e6,
+                result.reads > 0 ? 100.0 * result.staleOrEmpty / result.reads : 0.0);
+}
+
+} // namespace
+
+int main() {
+    const int64_t durationNs = 400 * 1000000LL;
+    std::printf("FrameSlot vs mutex, %u CPU(s) no host\n", std::thread::hardware_concurrency());
+    for (int fps : {30, 60, 120}) {
+        for (int readers : {1, 3, 6}) {
+            report<vcam::FrameSlot<FrameHandle>>("FrameSlot", fps, readers, durationNs);
+            report<MutexSlot>("mutex", fps, readers, durationNs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Escalonamento das conversões divididas em faixas (ParallelFor) de 1 até
+// ParallelSlotCount() participantes, via SetParallelism, nos presets grandes
+// de IOS_OPTIMIZED_CONFIG (4032x3024, 3088x2320) e em 4K. Cada linha mede
+// um estágio isolado e a soma de um frame completo (I420 -> NV12, escala com
+// recorte para BGRA e rotação de 90°) contra o orçamento de 33 ms.
+// Com um núcleo só aparece apenas a linha de 1 participante.
+
+#include "YUVConvert.h"
+#include "YUVToBGRA.h"
+#include "FrameScaler.h"
+#include "FrameTransform.h"
+#include "ParallelFor.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct Frame {
+    int width, height, chromaWidth, chromaHeight;
+    std::vector<uint8_t> y, u, v, nv12Y, nv12UV, rotatedY, rotatedUV, bgra, scaled;
+
+    Frame(int w, int h) : width(w), height(h), chromaWidth((w + 1) / 2), chromaHeight((h + 1) / 2) {
+        y.resize((size_t)w * h);
+        u.resize((size_t)chromaWidth * chromaHeight);
+        v.resize(u.size());
+        nv12Y.resize(y.size());
+        nv12UV.resize(u.size() * 2);
+        rotatedY.resize(y.size());
+        rotatedUV.resize(nv12UV.size());
+        bgra.resize((size_t)w * h * 4);
+        scaled.resize((size_t)1920 * 1440 * 4);
+        for (size_t i = 0; i < y.size(); i++) {
+            y[i] = (uint8_t)(16 + (i * 7) % 220);
+        }
+        for (size_t i = 0; i < u.size(); i++) {
+            u[i] = (uint8_t)(16 + (i * 3) % 225);
+            v[i] = (uint8_t)(240 - (i * 5) % 225);
+        }
+    }
+
+    I420Planes i420() const {
+        return { y.data(), u.data(), v.data(), width, chromaWidth, chromaWidth, width, height };
+    }
+
+    NV12Source nv12() const {
+        return { nv12Y.data(), nv12UV.data(), width, chromaWidth * 2, width, height };
+    }
+};
+
+struct Timings {
+    double convertNs, bgraNs, scaleNs, rotateNs;
+
+    double frameNs() const {
+        return convertNs + scaleNs + rotateNs;
+    }
+};
+
+Timings measure(Frame &frame, FrameScaler &scaler) {
+    Timings t;
+    const YUVColorSpace space = { YUVMatrix::BT709, YUVRange::Video };
+    NV12Planes nv12 = { frame.nv12Y.data(), frame.nv12UV.data(), frame.width, frame.chromaWidth * 2 };
+    t.convertNs = test::medianNsPerCall([&] { ConvertI420ToNV12(frame.i420(), YUVRange::Video, nv12, YUVRange::Full); });
+    t.bgraNs = test::medianNsPerCall([&] { ConvertNV12ToBGRA(frame.nv12(), space, { frame.bgra.data(), frame.width * 4 }); });
+
+    // Recorte 4:3 centralizado escalado para 1920x1440 BGRA, como o preset "ultra" entregue à câmera
+    YUVSource src = YUVSource::fromNV12(frame.nv12(), space);
+    int cropWidth = std::min(frame.width, frame.height * 4 / 3) & ~1;
+    CropRect crop = { (frame.width - cropWidth) / 2 & ~1, 0, cropWidth, frame.height };
+    ScaleTarget target = { ScaleTarget::BGRA, frame.scaled.data(), nullptr, 1920 * 4, 0, 1920, 1440,
+                           YUVRange::Full, false, false };
+    t.scaleNs = test::medianNsPerCall([&] { scaler.process(src, crop, target, ScaleQuality::Bilinear); });
+
+    FrameTransform rotation = FrameTransform::compose(90, 0, false);
+    NV12Planes rotated = { frame.rotatedY.data(), frame.rotatedUV.data(), frame.height, frame.chromaHeight * 2 };
+    t.rotateNs = test::medianNsPerCall([&] { TransformNV12(frame.nv12(), rotated, rotation); });
+    return t;
+}
+
+} // namespace
+
+int main() {
+    const int sizes[][2] = { { 4032, 3024 }, { 3088, 2320 }, { 3840, 2160 } };
+    size_t cores = ParallelSlotCount();
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < cores; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(cores);
+
+    std::printf("%zu núcleos disponíveis\n", cores);
+    std::printf("%-10s %5s %9s %9s %9s %9s %9s %8s %7s\n", "tamanho", "part.", "I420>NV12", "NV12>BGRA", "escala",
+                "rotação", "frame", "ganho", "33 ms");
+    for (const auto &size : sizes) {
+        Frame frame(size[0], size[1]);
+        FrameScaler scaler;
+        double baseline = 0;
+        for (size_t n : counts) {
+            SetParallelism(n);
+            Timings t = measure(frame, scaler);
+            if (n == 1) {
+                baseline = t.frameNs();
+            }
+            std::printf("%4dx%-5d %5zu %6.2f ms %6.2f ms %6.2f ms %6.2f ms %6.2f ms %7.2fx %6.0f%%\n", size[0], size[1],
+                        n, t.convertNs / 1e6, t.bgraNs / 1e6, t.scaleNs / 1e6, t.rotateNs / 1e6, t.frameNs() / 1e6,
+                        baseline / t.frameNs(), t.frameNs() / (1e9 / 30) * 100);
+        }
+    }
+    SetParallelism(0);
+    return 0;
+}
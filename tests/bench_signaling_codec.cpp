@@ -0,0 +1,52 @@
+// Bytes no fio e custo por tipo de mensagem, JSON contra o protocolo binário
+// (CBOR com tabelas), sobre as mensagens de data/signaling_messages.json.
+// O lado JSON é o serializador/parser mínimo de SignalingMessage.h, não o
+// NSJSONSerialization do dispositivo: serve de referência de custo no host,
+// com a mesma árvore de valores dos dois lados. O lado do servidor (JSON.parse
+// contra decodeSignal do server.js) é medido em bench_signaling_codec.js.
+
+#include "SignalingMessage.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+using vcam::test::Value;
+
+int main() {
+    auto corpus = test::loadSignalingCorpus();
+    if (corpus.empty()) {
+        std::printf("nenhuma mensagem em %s/signaling_messages.json\n", VCAM_TEST_DATA_DIR);
+        return 1;
+    }
+
+    int mismatches = 0;
+    size_t jsonTotal = 0, binaryTotal = 0;
+    std::printf("%-24s %7s %7s %6s | %9s %9s | %9s %9s\n", "tipo", "JSON B", "bin. B", "bin/J", "JSON esc.",
+                "bin. esc.", "JSON lei.", "bin. lei.");
+    for (const auto &entry : corpus) {
+        const Value &message = entry.second;
+        std::string json = test::toJSON(message);
+        std::vector<uint8_t> binary;
+        Value fromJSON, fromBinary;
+        if (!test::encodeMessage(message, binary) || !test::parseJSON(json, fromJSON) ||
+            !test::decodeMessage(binary.data(), binary.size(), fromBinary) || !test::sameValue(fromJSON, fromBinary)) {
+            std::printf("divergência em %s\n", entry.first.c_str());
+            mismatches++;
+            continue;
+        }
+        jsonTotal += json.size();
+        binaryTotal += binary.size();
+
+        double jsonWriteNs = test::medianNsPerCall([&] { json = test::toJSON(message); }, 9, 200);
+        double binaryWriteNs = test::medianNsPerCall([&] { test::encodeMessage(message, binary); }, 9, 200);
+        double jsonReadNs = test::medianNsPerCall([&] { test::parseJSON(json, fromJSON); }, 9, 200);
+        double binaryReadNs = test::medianNsPerCall(
+            [&] { test::decodeMessage(binary.data(), binary.size(), fromBinary); }, 9, 200);
+        std::printf("%-24s %7zu %7zu %5.0f%% | %6.2f us %6.2f us | %6.2f us %6.2f us\n", entry.first.c_str(),
+                    json.size(), binary.size(), 100.0 * binary.size() / json.size(), jsonWriteNs / 1e3,
+                    binaryWriteNs / 1e3, jsonReadNs / 1e3, binaryReadNs / 1e3);
+    }
+    std::printf("%-24s %7zu %7zu %5.0f%%\n", "total", jsonTotal, binaryTotal, 100.0 * binaryTotal / jsonTotal);
+    return mismatches == 0 ? 0 : 1;
+}
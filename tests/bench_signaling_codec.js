@@ -0,0 +1,66 @@
+// Lado do servidor do bench_signaling_codec: JSON.stringify/JSON.parse contra
+// encodeSignal/decodeSignal do server.js, por tipo de mensagem de
+// data/signaling_messages.json. O codec é carregado do próprio server.js
+// (bloco do protocolo binário) sem subir o servidor.
+//
+//   node tests/bench_signaling_codec.js
+
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+function loadCodec() {
+    const source = fs.readFileSync(path.join(__dirname, '..', 'server.js'), 'utf8');
+    const start = source.indexOf('// Protocolo binário de sinalização');
+    const end = source.indexOf('// Envia no codec negociado');
+    if (start < 0 || end < start) {
+        throw new Error('bloco do protocolo binário não encontrado no server.js');
+    }
+    const context = vm.createContext({ Buffer, BigInt, Number, Error, Map, Array });
+    vm.runInContext(source.slice(start, end) + '\n;this.codec = { encodeSignal, decodeSignal };', context);
+    return context.codec;
+}
+
+// Mediana de ns por chamada, como medianNsPerCall do TestSupport.h
+function medianNs(fn, rounds = 9, calls = 2000) {
+    fn();
+    const samples = [];
+    for (let r = 0; r < rounds; r++) {
+        const start = process.hrtime.bigint();
+        for (let c = 0; c < calls; c++) {
+            fn();
+        }
+        samples.push(Number(process.hrtime.bigint() - start) / calls);
+    }
+    samples.sort((a, b) => a - b);
+    return samples[rounds >> 1];
+}
+
+const { encodeSignal, decodeSignal } = loadCodec();
+const corpus = JSON.parse(fs.readFileSync(path.join(__dirname, 'data', 'signaling_messages.json'), 'utf8'));
+const pad = (value, width) => String(value).padStart(width);
+let mismatches = 0;
+let jsonTotal = 0;
+let binaryTotal = 0;
+
+console.log(`${'tipo'.padEnd(24)} ${pad('JSON B', 7)} ${pad('bin. B', 7)} | ${pad('stringify', 9)} ${pad('encode', 9)} | ${pad('parse', 9)} ${pad('decode', 9)}`);
+for (const [name, message] of corpus) {
+    const text = JSON.stringify(message);
+    const textBuffer = Buffer.from(text);
+    const binary = encodeSignal(message);
+    if (JSON.stringify(decodeSignal(binary)) !== text) {
+        console.log(`divergência em ${name}`);
+        mismatches++;
+        continue;
+    }
+    jsonTotal += textBuffer.length;
+    binaryTotal += binary.length;
+
+    // O ws entrega texto como Buffer: o parse inclui a decodificação UTF-8, como no servidor
+    const us = (ns) => `${pad((ns / 1000).toFixed(2), 6)} us`;
+    console.log(`${name.padEnd(24)} ${pad(textBuffer.length, 7)} ${pad(binary.length, 7)} | ` +
+        `${us(medianNs(() => JSON.stringify(message)))} ${us(medianNs(() => encodeSignal(message)))} | ` +
+        `${us(medianNs(() => JSON.parse(textBuffer.toString())))} ${us(medianNs(() => decodeSignal(binary)))}`);
+}
+console.log(`${'total'.padEnd(24)} ${pad(jsonTotal, 7)} ${pad(binaryTotal, 7)}`);
+process.exitCode = mismatches === 0 ? 0 : 1;
@@ -0,0 +1,42 @@
+// Custo de ReadTimestampCode por frame de data/timestamp_code, caminho SIMD
+// contra reference::ReadTimestampCode. A leitura roda em todo frame recebido
+// com a sonda ligada, então o número que importa é a fração do intervalo de
+// 60 fps. Sai com erro se SIMD e referência divergirem em algum frame.
+
+#include "TimestampCode.h"
+#include "TimestampFrames.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+int main() {
+    std::vector<test::TimestampFrame> frames = test::loadTimestampFrames();
+    if (frames.empty()) {
+        std::printf("nenhum frame em %s/timestamp_code\n", VCAM_TEST_DATA_DIR);
+        return 1;
+    }
+
+    int mismatches = 0;
+    std::printf("%-24s %9s %10s %10s %7s\n", "frame", "leitura", "SIMD", "referência", "ganho");
+    for (const test::TimestampFrame &frame : frames) {
+        uint64_t fast = 0, slow = 0;
+        bool fastOk = ReadTimestampCode(frame.plane(), fast);
+        bool slowOk = reference::ReadTimestampCode(frame.plane(), slow);
+        if (fastOk != slowOk || fast != slow || fastOk != frame.expectValid ||
+            (fastOk && fast != frame.timestampMs)) {
+            std::printf("divergência em %s: SIMD %d/%llu, referência %d/%llu, esperado %d/%llu\n",
+                        frame.name.c_str(), fastOk, (unsigned long long)fast, slowOk, (unsigned long long)slow,
+                        frame.expectValid, (unsigned long long)frame.timestampMs);
+            mismatches++;
+        }
+
+        uint64_t sink = 0;
+        double fastNs = vcam::test::medianNsPerCall([&] { ReadTimestampCode(frame.plane(), sink); }, 9, 200);
+        double slowNs = vcam::test::medianNsPerCall([&] { reference::ReadTimestampCode(frame.plane(), sink); }, 9, 200);
+        std::printf("%-24s %9s %7.2f us %7.2f us %6.2fx\n", frame.name.c_str(), fastOk ? "válida" : "inválida",
+                    fastNs / 1e3, slowNs / 1e3, slowNs / fastNs);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
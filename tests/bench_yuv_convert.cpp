@@ -0,0 +1,49 @@
+// Vazão de I420 -> NV12 por backend em 720p, 1080p e 4032x3024 (foto da
+// câmera traseira). GB/s conta bytes lidos + escritos (3 bytes por pixel).
+
+#include "YUVConvert.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+void bench(const char *backend, int width, int height, YUVRange srcRange, YUVRange dstRange) {
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    std::vector<uint8_t> y((size_t)width * height, 100), u((size_t)chromaWidth * chromaHeight, 90),
+        v((size_t)chromaWidth * chromaHeight, 160);
+    std::vector<uint8_t> dstY(y.size()), dstUV((size_t)chromaWidth * 2 * chromaHeight);
+    for (size_t i = 0; i < y.size(); i++) {
+        y[i] = (uint8_t)(i * 31);
+    }
+
+    I420Planes src = { y.data(), u.data(), v.data(), width, chromaWidth, chromaWidth, width, height };
+    NV12Planes dst = { dstY.data(), dstUV.data(), width, chromaWidth * 2 };
+
+    double ns = vcam::test::medianNsPerCall([&] {
+        ConvertI420ToNV12(src, srcRange, dst, dstRange);
+    });
+    double bytes = (double)(y.size() + u.size() + v.size() + dstY.size() + dstUV.size());
+    std::printf("%-6s %4dx%-4d %-16s %8.3f ms %6.2f GB/s\n", backend, width, height,
+                srcRange == dstRange ? "cópia" : "vídeo->completa", ns / 1e6, bytes / ns);
+}
+
+} // namespace
+
+int main() {
+    const int sizes[][2] = { { 1280, 720 }, { 1920, 1080 }, { 4032, 3024 } };
+    for (const char *backend : { "scalar", "sse2", "avx2", "neon" }) {
+        if (!SetYUVConvertBackend(backend)) {
+            continue;
+        }
+        for (const auto &size : sizes) {
+            bench(backend, size[0], size[1], YUVRange::Video, YUVRange::Video);
+            bench(backend, size[0], size[1], YUVRange::Video, YUVRange::Full);
+        }
+    }
+    SetYUVConvertBackend(nullptr);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Vazão de YUV -> BGRA (I420 e NV12, BT.601/BT.709) em um núcleo, contra a
+// referência escalar. O orçamento é um frame a 60 fps (16,7 ms); a coluna
+// "orçamento" mostra quanto dele a conversão consome.
+
+#include "YUVToBGRA.h"
+#include "ParallelFor.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct Frame {
+    int width, height, chromaWidth, chromaHeight;
+    std::vector<uint8_t> y, u, v, uv, bgra;
+
+    Frame(int w, int h) : width(w), height(h), chromaWidth((w + 1) / 2), chromaHeight((h + 1) / 2) {
+        y.resize((size_t)w * h);
+        u.resize((size_t)chromaWidth * chromaHeight);
+        v.resize(u.size());
+        uv.resize(u.size() * 2);
+        bgra.resize((size_t)w * h * 4);
+        for (size_t i = 0; i < y.size(); i++) {
+            y[i] = (uint8_t)(16 + (i * 7) % 220);
+        }
+        for (size_t i = 0; i < u.size(); i++) {
+            u[i] = (uint8_t)(16 + (i * 3) % 225);
+            v[i] = (uint8_t)(240 - (i * 5) % 225);
+            uv[2 * i] = u[i];
+            uv[2 * i + 1] = v[i];
+        }
+    }
+
+    I420Planes i420() const {
+        return { y.data(), u.data(), v.data(), width, chromaWidth, chromaWidth, width, height };
+    }
+
+    NV12Source nv12() const {
+        return { y.data(), uv.data(), width, chromaWidth * 2, width, height };
+    }
+
+    BGRAPlane dst() {
+        return { bgra.data(), width * 4 };
+    }
+};
+
+void report(const char *label, const Frame &frame, double ns) {
+    double pixels = (double)frame.width * frame.height;
+    std::printf("%-22s %4dx%-4d %7.3f ms %7.1f Mpx/s  orçamento 60 fps %5.1f%%\n", label, frame.width,
+                frame.height, ns / 1e6, pixels / ns * 1e3, ns / (1e9 / 60) * 100);
+}
+
+} // namespace
+
+int main() {
+    SetParallelism(1);
+    const int sizes[][2] = { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+    const YUVColorSpace spaces[] = { { YUVMatrix::BT601, YUVRange::Video }, { YUVMatrix::BT709, YUVRange::Full } };
+
+    for (const auto &size : sizes) {
+        Frame frame(size[0], size[1]);
+        for (const YUVColorSpace &space : spaces) {
+            const char *name = space.matrix == YUVMatrix::BT601 ? "601 vídeo" : "709 completa";
+            char label[64];
+
+            std::snprintf(label, sizeof(label), "I420 %s", name);
+            report(label, frame, vcam::test::medianNsPerCall([&] { ConvertI420ToBGRA(frame.i420(), space, frame.dst()); }));
+            std::snprintf(label, sizeof(label), "I420 %s ref", name);
+            report(label, frame, vcam::test::medianNsPerCall(
+                                     [&] { reference::ConvertI420ToBGRA(frame.i420(), space, frame.dst()); }, 3, 1));
+            std::snprintf(label, sizeof(label), "NV12 %s", name);
+            report(label, frame, vcam::test::medianNsPerCall([&] { ConvertNV12ToBGRA(frame.nv12(), space, frame.dst()); }));
+            std::snprintf(label, sizeof(label), "NV12 %s ref", name);
+            report(label, frame, vcam::test::medianNsPerCall(
+                                     [&] { reference::ConvertNV12ToBGRA(frame.nv12(), space, frame.dst()); }, 3, 1));
+        }
+    }
+    SetParallelism(0);
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Gera os frames de data/timestamp_code: código de timestamp gravado como o
+// emissor grava (branco 235 / preto 16 depois da conversão RGB -> YUV de
+// vídeo), sobre uma cena com textura, e degradado como um stream H.264:
+// quantização da transformada 4x4 com zona morta de inter (QP 30 e 40),
+// camada de simulcast em meia resolução ampliada pelo receptor, ruído de
+// sensor e contraste reduzido. Os arquivos são PGM binários só com as linhas
+// da faixa; o cabeçalho guarda a altura do frame inteiro e o valor esperado.
+//
+//   make -C tests frames
+
+#include "TimestampCode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct Frame {
+    int width, height;
+    std::vector<uint8_t> luma;
+
+    Frame(int w, int h) : width(w), height(h), luma((size_t)w * h) {}
+
+    uint8_t &at(int x, int y) {
+        return luma[(size_t)y * width + x];
+    }
+};
+
+uint8_t clamp8(double v) {
+    return (uint8_t)std::min(std::max(std::lround(v), 0L), 255L);
+}
+
+// Cena de fundo: gradiente com textura, para a faixa não ser o único conteúdo dos blocos de borda
+void drawScene(Frame &frame, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> texture(-12, 12);
+    for (int y = 0; y < frame.height; y++) {
+        for (int x = 0; x < frame.width; x++) {
+            double base = 60 + 120.0 * x / frame.width + 40.0 * std::sin(y * 0.05);
+            frame.at(x, y) = clamp8(base + texture(rng));
+        }
+    }
+}
+
+// Quantização da transformada 4x4 do H.264: Qstep = 0,625 * 2^(QP/6), arredondamento de inter (1/6)
+void quantize4x4(Frame &frame, int qp) {
+    const double qstep = 0.625 * std::pow(2.0, qp / 6.0);
+    double basis[4][4];
+    for (int k = 0; k < 4; k++) {
+        for (int n = 0; n < 4; n++) {
+            basis[k][n] = (k == 0 ? 0.5 : std::sqrt(0.5)) * std::cos((2 * n + 1) * k * M_PI / 8);
+        }
+    }
+
+    for (int by = 0; by + 4 <= frame.height; by += 4) {
+        for (int bx = 0; bx + 4 <= frame.width; bx += 4) {
+            double block[4][4], coeff[4][4];
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    block[y][x] = frame.at(bx + x, by + y) - 128.0;
+                }
+            }
+            for (int v = 0; v < 4; v++) {
+                for (int u = 0; u < 4; u++) {
+                    double sum = 0;
+                    for (int y = 0; y < 4; y++) {
+                        for (int x = 0; x < 4; x++) {
+                            sum += basis[v][y] * basis[u][x] * block[y][x];
+                        }
+                    }
+                    double level = std::floor(std::fabs(sum) / qstep + 1.0 / 6.0);
+                    coeff[v][u] = std::copysign(level * qstep, sum);
+                }
+            }
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    double sum = 0;
+                    for (int v = 0; v < 4; v++) {
+                        for (int u = 0; u < 4; u++) {
+                            sum += basis[v][y] * basis[u][x] * coeff[v][u];
+                        }
+                    }
+                    frame.at(bx + x, by + y) = clamp8(sum + 128.0);
+                }
+            }
+        }
+    }
+}
+
+// Camada de meia resolução (média 2x2) ampliada de volta com bilinear
+void halfResolution(Frame &frame) {
+    int hw = frame.width / 2, hh = frame.height / 2;
+    std::vector<double> half((size_t)hw * hh);
+    for (int y = 0; y < hh; y++) {
+        for (int x = 0; x < hw; x++) {
+            half[(size_t)y * hw + x] = (frame.at(2 * x, 2 * y) + frame.at(2 * x + 1, 2 * y) +
+                                        frame.at(2 * x, 2 * y + 1) + frame.at(2 * x + 1, 2 * y + 1)) / 4.0;
+        }
+    }
+    for (int y = 0; y < frame.height; y++) {
+        double sy = std::min(std::max((y + 0.5) / 2 - 0.5, 0.0), hh - 1.0);
+        int y0 = (int)sy, y1 = std::min(y0 + 1, hh - 1);
+        double fy = sy - y0;
+        for (int x = 0; x < frame.width; x++) {
+            double sx = std::min(std::max((x + 0.5) / 2 - 0.5, 0.0), hw - 1.0);
+            int x0 = (int)sx, x1 = std::min(x0 + 1, hw - 1);
+            double fx = sx - x0;
+            double top = half[(size_t)y0 * hw + x0] * (1 - fx) + half[(size_t)y0 * hw + x1] * fx;
+            double bottom = half[(size_t)y1 * hw + x0] * (1 - fx) + half[(size_t)y1 * hw + x1] * fx;
+            frame.at(x, y) = clamp8(top * (1 - fy) + bottom * fy);
+        }
+    }
+}
+
+void addNoise(Frame &frame, std::mt19937 &rng, double sigma) {
+    std::normal_distribution<double> noise(0, sigma);
+    for (uint8_t &v : frame.luma) {
+        v = clamp8(v + noise(rng));
+    }
+}
+
+// Contraste reduzido em torno de 128 (exposição automática do emissor, tone mapping)
+void reduceContrast(Frame &frame, double gain) {
+    for (uint8_t &v : frame.luma) {
+        v = clamp8(128 + (v - 128) * gain);
+    }
+}
+
+bool writeStrip(const std::string &path, const Frame &frame, uint64_t timestampMs, bool expected,
+                const char *description) {
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "não foi possível criar %s\n", path.c_str());
+        return false;
+    }
+    int rows = std::min(TimestampCodeLayout::stripHeight(frame.height), frame.height);
+    std::fprintf(file, "P5\n# %s\n# frame-height %d\n# timestamp-ms %llu\n# expect %s\n%d %d\n255\n", description,
+                 frame.height, (unsigned long long)timestampMs, expected ? "valid" : "invalid", frame.width, rows);
+    std::fwrite(frame.luma.data(), 1, (size_t)frame.width * rows, file);
+    std::fclose(file);
+    std::printf("%s\n", path.c_str());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string dir = argc > 1 ? argv[1] : "data/timestamp_code";
+    const int sizes[][2] = { { 640, 360 }, { 1280, 720 }, { 1920, 1080 } };
+    uint64_t timestampMs = 1760000000123ULL;
+    bool ok = true;
+
+    for (const auto &size : sizes) {
+        int w = size[0], h = size[1];
+        struct Variant {
+            const char *name;
+            const char *description;
+        };
+        const Variant variants[] = {
+            { "qp30", "quantizacao 4x4 QP 30" },
+            { "qp40", "quantizacao 4x4 QP 40" },
+            { "half-noise", "meia resolucao ampliada, QP 34, ruido sigma 4, contraste 0.7" },
+        };
+        for (const Variant &variant : variants) {
+            std::mt19937 rng((unsigned)(w * 31 + timestampMs % 1000));
+            Frame frame(w, h);
+            drawScene(frame, rng);
+            WriteTimestampCode(frame.luma.data(), w, w, h, timestampMs);
+
+            std::string name = variant.name;
+            if (name == "qp30") {
+                quantize4x4(frame, 30);
+            } else if (name == "qp40") {
+                quantize4x4(frame, 40);
+            } else {
+                halfResolution(frame);
+                quantize4x4(frame, 34);
+                addNoise(frame, rng, 4);
+                reduceContrast(frame, 0.7);
+            }
+
+            char path[256];
+            std::snprintf(path, sizeof(path), "%s/%dp-%s.pgm", dir.c_str(), h, variant.name);
+            ok &= writeStrip(path, frame, timestampMs, true, variant.description);
+            timestampMs += 16667;
+        }
+    }
+
+    // Negativos: frame comum sem código e código com um bit de dado trocado (CRC não confere)
+    {
+        std::mt19937 rng(7);
+        Frame frame(1280, 720);
+        drawScene(frame, rng);
+        quantize4x4(frame, 30);
+        ok &= writeStrip(dir + "/720p-no-code.pgm", frame, 0, false, "cena sem codigo");
+    }
+    {
+        std::mt19937 rng(8);
+        Frame frame(1280, 720), flipped(1280, 720);
+        drawScene(frame, rng);
+        WriteTimestampCode(frame.luma.data(), 1280, 1280, 720, timestampMs);
+        WriteTimestampCode(flipped.luma.data(), 1280, 1280, 720, timestampMs ^ 1);
+        // Só a célula do último bit de dado vem do código trocado; o CRC continua o original
+        int cell = TimestampCodeLayout::kSyncCells + TimestampCodeLayout::kDataBits - 1;
+        int x0 = cell * 1280 / TimestampCodeLayout::kCellCount;
+        int x1 = (cell + 1) * 1280 / TimestampCodeLayout::kCellCount;
+        for (int y = 0; y < TimestampCodeLayout::stripHeight(720); y++) {
+            for (int x = x0; x < x1; x++) {
+                frame.at(x, y) = flipped.at(x, y);
+            }
+        }
+        quantize4x4(frame, 30);
+        ok &= writeStrip(dir + "/720p-bad-crc.pgm", frame, timestampMs, false, "ultimo bit de dado trocado, CRC original");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// Simulação determinística do CadenceMatcher: stream e câmera em 24/30/60 fps
+// em todas as combinações (stream mais lento, igual e mais rápido), com
+// jitter na chegada dos frames do stream, e um travamento do stream no meio.
+// Verifica a contabilidade, a ordem dos frames entregues, o tamanho das
+// sequências de repetição, que a câmera nunca fica sem frame e, com taxas
+// iguais, que a fase estimada mantém a cadência regular (sem repetição seguida
+// de descarte).
+
+#include "CadenceMatcher.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+const int64_t kSecondNs = 1000000000LL;
+
+struct Simulation {
+    int callbacks = 0;
+    int delivered = 0;
+    int repeated = 0;
+    int dropped = 0;          // chamadas com Drop depois do primeiro frame
+    int streamFrames = 0;
+    int maxRepeatRun = 0;
+    bool idsIncreasing = true;
+    uint64_t firstDeliveredId = 0;
+    uint64_t lastDeliveredId = 0;
+    int stalledCallbacks = 0;
+    bool deliveredAfterStall = false;
+    int steadyCallbacks = 0;  // depois do primeiro segundo (fase já estimada)
+    int irregular = 0;        // chamadas de regime sem exatamente o frame seguinte ao anterior
+};
+
+/**
+ * @param phaseNs Atraso do primeiro frame do stream em relação à primeira chamada da câmera
+ * @param stallStartNs/stallNs Intervalo sem frames novos (0 = sem travamento)
+ */
+Simulation simulate(CadenceMatcher &matcher, int streamFps, int cameraFps, int64_t durationNs, int64_t phaseNs,
+                    int64_t stallStartNs, int64_t stallNs, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int64_t> jitter(-4000000, 4000000);
+
+    // Instantes de publicação do stream (id = índice + 1), monotônicos apesar do jitter
+    std::vector<int64_t> publishNs;
+    int64_t streamIntervalNs = kSecondNs / streamFps;
+    int64_t last = 0;
+    for (int64_t t = phaseNs; t < durationNs; t += streamIntervalNs) {
+        if (stallNs > 0 && t >= stallStartNs && t < stallStartNs + stallNs) {
+            continue;
+        }
+        int64_t at = std::max(last + 1, t + jitter(rng));
+        publishNs.push_back(at);
+        last = at;
+    }
+
+    Simulation sim;
+    sim.streamFrames = (int)publishNs.size();
+    int64_t cameraIntervalNs = kSecondNs / cameraFps;
+    size_t published = 0;
+    int repeatRun = 0;
+    for (int64_t t = 0; t < durationNs; t += cameraIntervalNs) {
+        while (published < publishNs.size() && publishNs[published] <= t) {
+            published++;
+        }
+        // Mais recente publicado e o anterior, como o par guardado no FrameSlot; id 0 = nenhum
+        CadenceFrame latest = { published, published > 0 ? publishNs[published - 1] : 0 };
+        CadenceFrame previous = { published > 1 ? published - 1 : 0, published > 1 ? publishNs[published - 2] : 0 };
+        uint64_t before = matcher.frameId();
+        CadenceDecision decision = matcher.decide(latest, previous, t);
+        uint64_t frameId = matcher.frameId();
+        sim.callbacks++;
+        if (t >= kSecondNs) {
+            sim.steadyCallbacks++;
+            if (decision == CadenceDecision::Drop || frameId != before + 1) {
+                sim.irregular++;
+            }
+        }
+
+        switch (decision) {
+            case CadenceDecision::Deliver:
+                sim.delivered++;
+                if (frameId <= sim.lastDeliveredId) {
+                    sim.idsIncreasing = false;
+                }
+                if (sim.firstDeliveredId == 0) {
+                    sim.firstDeliveredId = frameId;
+                }
+                sim.lastDeliveredId = frameId;
+                repeatRun = 0;
+                if (stallNs > 0 && t >= stallStartNs + stallNs) {
+                    sim.deliveredAfterStall = true;
+                }
+                break;
+            case CadenceDecision::Repeat:
+                sim.repeated++;
+                repeatRun++;
+                // Sequências dentro do travamento são esperadas; fora dele, limitadas
+                if (!(stallNs > 0 && t >= stallStartNs && t < stallStartNs + stallNs + 2 * streamIntervalNs)) {
+                    sim.maxRepeatRun = std::max(sim.maxRepeatRun, repeatRun);
+                }
+                break;
+            case CadenceDecision::Drop:
+                if (latest.id != 0) {
+                    sim.dropped++;
+                }
+                break;
+        }
+        if (matcher.stalled()) {
+            sim.stalledCallbacks++;
+        }
+    }
+    return sim;
+}
+
+/**
+ * @param phaseNs Com fase perto de zero o jitter cruza os instantes das
+ *                chamadas, o pior caso para taxas iguais
+ */
+void checkCombination(int streamFps, int cameraFps, int64_t phaseNs) {
+    CadenceMatcher matcher;
+    const int64_t durationNs = 60 * kSecondNs;
+    Simulation sim = simulate(matcher, streamFps, cameraFps, durationNs, phaseNs, 0, 0,
+                              (unsigned)(streamFps * 100 + cameraFps));
+    CadenceStats stats = matcher.stats();
+
+    CHECK_MSG(sim.dropped == 0, "%d->%d: %d chamadas sem frame com stream ativo", streamFps, cameraFps, sim.dropped);
+    CHECK_MSG(sim.idsIncreasing, "%d->%d: frames entregues fora de ordem", streamFps, cameraFps);
+    CHECK(stats.delivered == (uint64_t)sim.delivered);
+    CHECK(stats.repeated == (uint64_t)sim.repeated);
+    CHECK(stats.stalledCallbacks == 0);
+    // Do primeiro entregue em diante, cada frame do stream é entregue uma vez ou contado como descartado
+    uint64_t span = sim.lastDeliveredId - sim.firstDeliveredId + 1;
+    CHECK_MSG(stats.delivered + stats.droppedFrames == span, "%d->%d: %llu entregues + %llu descartados != %llu",
+              streamFps, cameraFps, (unsigned long long)stats.delivered, (unsigned long long)stats.droppedFrames,
+              (unsigned long long)span);
+
+    // Entregas acompanham a taxa menor
+    double expected = std::min(streamFps, cameraFps) * (double)durationNs / kSecondNs;
+    if (streamFps != cameraFps) {
+        CHECK_MSG(std::fabs(sim.delivered - expected) <= std::max(expected * 0.03, 3.0),
+                  "%d->%d: %d entregues, esperado ~%.0f", streamFps, cameraFps, sim.delivered, expected);
+    } else {
+        // Taxas iguais com o jitter cruzando as chamadas: a fase estimada segura os
+        // frames publicados colados à chamada, e em regime cada chamada entrega
+        // exatamente o frame seguinte (sem repetição seguida de descarte)
+        CHECK_MSG(sim.irregular <= sim.steadyCallbacks / 200, "%d->%d: %d de %d chamadas fora de cadência",
+                  streamFps, cameraFps, sim.irregular, sim.steadyCallbacks);
+        // Fora do regime só as chamadas antes de a fase ser estimada
+        CHECK_MSG(stats.repeated + stats.droppedFrames <= (uint64_t)sim.callbacks / 100, "%d->%d: %llu repetidas, %llu descartados",
+                  streamFps, cameraFps, (unsigned long long)stats.repeated, (unsigned long long)stats.droppedFrames);
+        CHECK(sim.delivered + sim.repeated + 1 == sim.callbacks || sim.delivered + sim.repeated == sim.callbacks);
+    }
+
+    // Sequências de repetição: no máximo o necessário para cobrir um intervalo do stream, mais o jitter
+    int maxRun = (int)std::ceil((double)cameraFps / streamFps) + 1;
+    CHECK_MSG(sim.maxRepeatRun <= maxRun, "%d->%d: %d repetições seguidas (máx. %d)", streamFps, cameraFps,
+              sim.maxRepeatRun, maxRun);
+
+    double intervalError = std::fabs((double)matcher.cameraIntervalNs() - (double)kSecondNs / cameraFps);
+    CHECK_MSG(intervalError < kSecondNs / cameraFps * 0.02, "%d->%d: intervalo estimado %lld ns", streamFps, cameraFps,
+              (long long)matcher.cameraIntervalNs());
+
+    std::printf("fase %4.1f ms, stream %2d -> câmera %2d: %5d chamadas, %5d entregues, %5d repetidas (%3llu seguradas), "
+                "%5llu frames descartados, repetição máx. %d, fora de cadência %d\n",
+                phaseNs / 1e6, streamFps, cameraFps, sim.callbacks, sim.delivered, sim.repeated,
+                (unsigned long long)stats.held, (unsigned long long)stats.droppedFrames, sim.maxRepeatRun, sim.irregular);
+}
+
+// Stream congela 3 s: a câmera continua recebendo o último frame
+void checkStall(int streamFps, int cameraFps) {
+    CadenceMatcher matcher(500000000LL);
+    const int64_t stallStartNs = 5 * kSecondNs;
+    const int64_t stallNs = 3 * kSecondNs;
+    Simulation sim = simulate(matcher, streamFps, cameraFps, 12 * kSecondNs, kSecondNs / streamFps / 3,
+                              stallStartNs, stallNs, 99);
+
+    CHECK_MSG(sim.dropped == 0, "travamento %d->%d: %d chamadas sem frame", streamFps, cameraFps, sim.dropped);
+    CHECK_MSG(sim.deliveredAfterStall, "travamento %d->%d: nenhum frame novo depois da retomada", streamFps, cameraFps);
+    CHECK(!matcher.stalled());
+
+    // Repetições marcadas como travamento: do limite de 500 ms até a retomada (±2 intervalos de cada lado)
+    double expected = (double)(stallNs - 500000000LL) / kSecondNs * cameraFps;
+    double slack = 2.0 * cameraFps / streamFps + 2;
+    CHECK_MSG(std::fabs((double)matcher.stats().stalledCallbacks - expected) <= slack,
+              "travamento %d->%d: %llu chamadas paradas, esperado ~%.0f", streamFps, cameraFps,
+              (unsigned long long)matcher.stats().stalledCallbacks, expected);
+    CHECK(matcher.stats().stalledCallbacks == (uint64_t)sim.stalledCallbacks);
+}
+
+void checkNoFrameYet() {
+    CadenceMatcher matcher;
+    CHECK(matcher.decide(0, 0) == CadenceDecision::Drop);
+    CHECK(matcher.decide(0, 33333333) == CadenceDecision::Drop);
+    CHECK(matcher.stats().droppedCallbacks == 2);
+    CHECK(matcher.decide(1, 66666666) == CadenceDecision::Deliver);
+
+    // Id menor: stream reiniciado, entregue sem contar descartes
+    CHECK(matcher.decide(5, 100000000) == CadenceDecision::Deliver);
+    CHECK(matcher.stats().droppedFrames == 3);
+    CHECK(matcher.decide(1, 133333333) == CadenceDecision::Deliver);
+    CHECK(matcher.stats().droppedFrames == 3);
+}
+
+} // namespace
+
+int main() {
+    const int rates[] = { 24, 30, 60 };
+    for (int streamFps : rates) {
+        for (int cameraFps : rates) {
+            checkCombination(streamFps, cameraFps, kSecondNs / streamFps / 3);
+            checkCombination(streamFps, cameraFps, 1000000);
+            checkStall(streamFps, cameraFps);
+        }
+    }
+    checkNoFrameYet();
+    return vcam::test::finish("test_cadence_matcher");
+}
@@ -0,0 +1,211 @@
+// Reproduz um relógio de stream sintético com deriva, atraso de rede com
+// jitter e rajadas (frames retidos e entregues juntos), e verifica as
+// garantias do ClockBridge: PTS estritamente crescente, nunca depois da
+// chegada, erro limitado em relação à reta real e reinício do mapeamento
+// em descontinuidades.
+
+#include "ClockBridge.h"
+#include "TestSupport.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct Arrival {
+    int64_t streamNs;
+    int64_t hostNs;
+    int64_t idealHostNs;  // chegada sem jitter: base da avaliação de erro
+};
+
+/**
+ * Frames a `fps` no relógio do stream; o host anda a (1 + driftPpm) e cada
+ * frame chega com atraso base + jitter exponencial. A cada ~2 s uma rajada
+ * retém 3 frames e os entrega juntos.
+ */
+std::vector<Arrival> makeArrivals(std::mt19937 &rng, int frames, int fps, double driftPpm,
+                                  int64_t streamStartNs, int64_t hostStartNs) {
+    std::exponential_distribution<double> jitterMs(1.0 / 4.0);
+    std::vector<Arrival> arrivals;
+    const int64_t intervalNs = 1000000000LL / fps;
+    const int64_t baseLatencyNs = 40 * 1000000LL;
+    int64_t lastHostNs = 0;
+    int held = 0;
+    int64_t heldUntilNs = 0;
+
+    for (int i = 0; i < frames; i++) {
+        int64_t streamNs = streamStartNs + (int64_t)i * intervalNs;
+        int64_t ideal = hostStartNs + (int64_t)std::llround((double)(i * intervalNs) * (1.0 + driftPpm * 1e-6)) +
+                        baseLatencyNs;
+        int64_t host = ideal + (int64_t)(std::min(jitterMs(rng), 30.0) * 1e6);
+
+        if (held == 0 && i % (2 * fps) == fps) {
+            held = 3;
+            heldUntilNs = ideal + 3 * intervalNs + 5000000;
+        }
+        if (held > 0) {
+            host = std::max(host, heldUntilNs + (3 - held) * 100000);  // entregues com 0,1 ms entre si
+            held--;
+        }
+
+        // A chegada é serial: nenhum frame ultrapassa o anterior
+        host = std::max(host, lastHostNs);
+        lastHostNs = host;
+        arrivals.push_back({ streamNs, host, ideal });
+    }
+    return arrivals;
+}
+
+struct Result {
+    int64_t maxErrorNs = 0;       // |pts - ideal| depois do aquecimento
+    int64_t maxErrorFirstNs = 0;  // ... no primeiro minuto
+    int64_t maxErrorLastNs = 0;   // ... no último minuto
+    double meanDriftPpm = 0;      // média da estimativa depois do aquecimento
+    int violationsFuture = 0;
+    int violationsOrder = 0;
+};
+
+Result replay(ClockBridge &bridge, const std::vector<Arrival> &arrivals, int fps, int64_t &lastPts, bool &hasLast) {
+    const int warmupFrames = 4 * fps;
+    const int minuteFrames = 60 * fps;
+    Result result;
+    int driftSamples = 0;
+    for (size_t i = 0; i < arrivals.size(); i++) {
+        const Arrival &a = arrivals[i];
+        MappedTime mapped = bridge.map(a.streamNs, a.hostNs);
+
+        if (mapped.ptsNs > a.hostNs) {
+            result.violationsFuture++;
+        }
+        if (hasLast && (mapped.ptsNs <= lastPts || mapped.durationNs != mapped.ptsNs - lastPts)) {
+            result.violationsOrder++;
+        }
+        if ((int)i >= warmupFrames) {
+            int64_t error = std::llabs(mapped.ptsNs - a.idealHostNs);
+            result.maxErrorNs = std::max(result.maxErrorNs, error);
+            if ((int)i < minuteFrames) {
+                result.maxErrorFirstNs = std::max(result.maxErrorFirstNs, error);
+            }
+            if (i + minuteFrames >= arrivals.size()) {
+                result.maxErrorLastNs = std::max(result.maxErrorLastNs, error);
+            }
+            result.meanDriftPpm += bridge.driftPpm();
+            driftSamples++;
+        }
+        lastPts = mapped.ptsNs;
+        hasLast = true;
+    }
+    if (driftSamples > 0) {
+        result.meanDriftPpm /= driftSamples;
+    }
+    return result;
+}
+
+// Tolerâncias: jitter exponencial de média 4 ms (até 30 ms) e rajadas de 3
+// frames. A janela de 120 pares cobre 2-5 s, então a inclinação de um frame
+// isolado varia centenas de ppm; o que precisa ficar limitado é o erro do
+// PTS, que não pode crescer ao longo da sessão, e a média da estimativa.
+const int64_t kMaxErrorNs = 15 * 1000000LL;
+const int64_t kMaxGrowthNs = 3 * 1000000LL;
+const double kMaxMeanDriftErrorPpm = 100;
+
+void checkDrift(double driftPpm, int fps) {
+    std::mt19937 rng((unsigned)(1000 + fps + driftPpm));
+    // 10 minutos: erro que cresce com o tempo apareceria no fim da série
+    std::vector<Arrival> arrivals = makeArrivals(rng, 600 * fps, fps, driftPpm, 123456789LL, 5000000000LL);
+
+    ClockBridge bridge;
+    int64_t lastPts = 0;
+    bool hasLast = false;
+    Result result = replay(bridge, arrivals, fps, lastPts, hasLast);
+
+    CHECK_MSG(result.violationsFuture == 0, "deriva %.0f ppm: %d PTS depois da chegada", driftPpm, result.violationsFuture);
+    CHECK_MSG(result.violationsOrder == 0, "deriva %.0f ppm: %d PTS fora de ordem", driftPpm, result.violationsOrder);
+    CHECK_MSG(std::fabs(result.meanDriftPpm - driftPpm) < kMaxMeanDriftErrorPpm, "deriva média estimada %.1f ppm, real %.0f",
+              result.meanDriftPpm, driftPpm);
+    CHECK_MSG(result.maxErrorNs < kMaxErrorNs, "deriva %.0f ppm: erro máximo %.2f ms", driftPpm, result.maxErrorNs / 1e6);
+    CHECK_MSG(result.maxErrorLastNs <= result.maxErrorFirstNs + kMaxGrowthNs,
+              "deriva %.0f ppm: erro cresceu de %.2f ms para %.2f ms", driftPpm, result.maxErrorFirstNs / 1e6,
+              result.maxErrorLastNs / 1e6);
+    CHECK(bridge.discontinuityCount() == 0);
+    std::printf("%2d fps deriva %+5.0f ppm: média estimada %+7.1f ppm, erro máximo %.2f ms "
+                "(1º minuto %.2f, último %.2f)\n",
+                fps, driftPpm, result.meanDriftPpm, result.maxErrorNs / 1e6, result.maxErrorFirstNs / 1e6,
+                result.maxErrorLastNs / 1e6);
+}
+
+void checkDiscontinuity(int64_t jumpNs, const char *name) {
+    std::mt19937 rng(77);
+    const int fps = 30;
+    std::vector<Arrival> before = makeArrivals(rng, 20 * fps, fps, 150, 1000000000LL, 9000000000LL);
+    const Arrival &last = before.back();
+
+    // Mesmo host contínuo; o relógio do stream salta (encoder reiniciado, troca de SSRC)
+    int64_t hostResumeNs = last.idealHostNs + 1000000000LL / fps - 40 * 1000000LL;
+    std::vector<Arrival> after = makeArrivals(rng, 20 * fps, fps, -150, last.streamNs + jumpNs, hostResumeNs);
+
+    ClockBridge bridge;
+    int64_t lastPts = 0;
+    bool hasLast = false;
+    Result first = replay(bridge, before, fps, lastPts, hasLast);
+    CHECK(bridge.discontinuityCount() == 0);
+    Result second = replay(bridge, after, fps, lastPts, hasLast);
+
+    CHECK_MSG(bridge.discontinuityCount() == 1, "%s: %llu descontinuidades", name,
+              (unsigned long long)bridge.discontinuityCount());
+    CHECK_MSG(first.violationsFuture + second.violationsFuture == 0, "%s: PTS depois da chegada", name);
+    CHECK_MSG(first.violationsOrder + second.violationsOrder == 0, "%s: PTS fora de ordem", name);
+    // A janela antiga foi descartada: o mapeamento novo converge para a reta nova
+    CHECK_MSG(second.maxErrorNs < kMaxErrorNs, "%s: erro depois do salto %.2f ms", name, second.maxErrorNs / 1e6);
+    std::printf("salto %s: erro máximo depois do reinício %.2f ms\n", name, second.maxErrorNs / 1e6);
+}
+
+// Buffer de jitter esvaziado na conexão: vários frames chegam com 50 us entre si
+void checkStartupBurst() {
+    ClockBridge bridge;
+    int64_t lastPts = 0;
+    bool hasLast = false;
+    int future = 0;
+    int order = 0;
+    for (int i = 0; i < 40; i++) {
+        int64_t streamNs = 700000000LL + (int64_t)i * 33333333LL;
+        int64_t hostNs = i < 6 ? 3000000000LL + i * 50000LL : 3000000000LL + (int64_t)i * 33333333LL;
+        MappedTime mapped = bridge.map(streamNs, hostNs);
+        future += mapped.ptsNs > hostNs;
+        order += hasLast && mapped.ptsNs <= lastPts;
+        lastPts = mapped.ptsNs;
+        hasLast = true;
+    }
+    CHECK_MSG(future == 0, "rajada inicial: %d PTS depois da chegada", future);
+    CHECK_MSG(order == 0, "rajada inicial: %d PTS fora de ordem", order);
+}
+
+void checkReset() {
+    ClockBridge bridge;
+    MappedTime a = bridge.map(1000000000LL, 5000000000LL);
+    CHECK(a.durationNs == 0);
+    bridge.map(1033333333LL, 5033333333LL);
+    bridge.reset();
+    MappedTime b = bridge.map(1066666666LL, 5066666666LL);
+    CHECK(b.durationNs == 0);
+    CHECK(b.ptsNs <= 5066666666LL);
+}
+
+} // namespace
+
+int main() {
+    for (int fps : { 24, 30, 60 }) {
+        checkDrift(0, fps);
+        checkDrift(250, fps);
+        checkDrift(-400, fps);
+    }
+    checkDiscontinuity(3600LL * 1000000000LL, "para frente");
+    checkDiscontinuity(-500LL * 1000000000LL, "para trás");
+    checkStartupBurst();
+    checkReset();
+    return vcam::test::finish("test_clock_bridge");
+}
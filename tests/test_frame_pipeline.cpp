@@ -0,0 +1,288 @@
+// Estresse do FramePipeline a 4K60 com o mesmo arranjo do renderer: produtor
+// no ritmo do decoder, DropOldestQueue de capacidade 2, worker convertendo
+// NV12 -> BGRA em 4K e publicando num FrameSlot lido pela "câmera" a 30 fps.
+// Verifica que nada cresce sem limite (profundidade, frames vivos, espera na
+// fila) em ritmo nominal e com o worker mais lento que o stream, e imprime a
+// latência de cada estágio. Antes, a DropOldestQueue sozinha: o produtor
+// descartando pela cabeça enquanto o consumidor lê não pode perder nem
+// duplicar itens.
+
+#include "FramePipeline.h"
+#include "FrameSlot.h"
+#include "YUVToBGRA.h"
+#include "ParallelFor.h"
+#include "TestSupport.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+const int kWidth = 3840;
+const int kHeight = 2160;
+const size_t kCapacity = 2;  // kPipelineCapacity do WebRTCFrameRenderer
+
+// --- DropOldestQueue ---
+
+void checkQueueConcurrent() {
+    const uint64_t kItems = 1000000;
+    DropOldestQueue<uint64_t> queue(4);
+    std::atomic<bool> done(false);
+    uint64_t evicted = 0;
+
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= kItems; i++) {
+            evicted += queue.push(i) ? 1 : 0;
+            // Com um núcleo só, cede de vez em quando para as duas pontas se intercalarem
+            if (i % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t popped = 0, last = 0;
+    bool ordered = true;
+    for (;;) {
+        uint64_t value;
+        if (queue.pop(value)) {
+            ordered &= value > last;
+            last = value;
+            popped++;
+        } else if (done.load(std::memory_order_acquire)) {
+            break;
+        }
+    }
+    producer.join();
+    uint64_t remaining = 0, value;
+    while (queue.pop(value)) {
+        ordered &= value > last;
+        last = value;
+        remaining++;
+    }
+
+    CHECK_MSG(ordered, "fila: itens fora de ordem ou duplicados");
+    CHECK_MSG(popped + evicted + remaining == kItems, "fila: %llu lidos + %llu descartados + %llu restantes != %llu",
+              (unsigned long long)popped, (unsigned long long)evicted, (unsigned long long)remaining,
+              (unsigned long long)kItems);
+    CHECK(queue.depth() == 0);
+    std::printf("fila SPSC: %llu itens, %llu lidos, %llu descartados pelo produtor\n", (unsigned long long)kItems,
+                (unsigned long long)popped, (unsigned long long)evicted);
+}
+
+// --- Pipeline 4K60 ---
+
+// Conta payloads vivos: cada um segura um frame do decoder
+std::atomic<int> liveFrames(0);
+std::atomic<int> maxLiveFrames(0);
+
+struct DecodedFrame {
+    std::vector<uint8_t> y, uv;
+
+    DecodedFrame() : y((size_t)kWidth * kHeight), uv((size_t)kWidth * (kHeight / 2)) {
+        for (size_t i = 0; i < y.size(); i++) {
+            y[i] = (uint8_t)(16 + (i * 7) % 220);
+        }
+        for (size_t i = 0; i < uv.size(); i++) {
+            uv[i] = (uint8_t)(16 + (i * 3) % 225);
+        }
+    }
+};
+
+struct Payload {
+    std::shared_ptr<const DecodedFrame> frame;
+    uint64_t sequence = 0;
+    int64_t submitNs = 0;
+
+    Payload() = default;
+    Payload(std::shared_ptr<const DecodedFrame> f, uint64_t seq, int64_t ns) : frame(std::move(f)), sequence(seq), submitNs(ns) {
+        track(1);
+    }
+    Payload(const Payload &other) : frame(other.frame), sequence(other.sequence), submitNs(other.submitNs) {
+        track(frame ? 1 : 0);
+    }
+    Payload(Payload &&other) noexcept : frame(std::move(other.frame)), sequence(other.sequence), submitNs(other.submitNs) {
+    }
+    Payload &operator=(Payload other) noexcept {
+        release();
+        frame = std::move(other.frame);
+        sequence = other.sequence;
+        submitNs = other.submitNs;
+        return *this;
+    }
+    ~Payload() {
+        release();
+    }
+
+private:
+    void track(int delta) {
+        int live = liveFrames.fetch_add(delta) + delta;
+        int max = maxLiveFrames.load();
+        while (live > max && !maxLiveFrames.compare_exchange_weak(max, live)) {
+        }
+    }
+    void release() {
+        if (frame) {
+            frame.reset();
+            liveFrames.fetch_sub(1);
+        }
+    }
+};
+
+struct Converted {
+    std::vector<uint8_t> bgra;
+    uint64_t sequence = 0;
+    int64_t submitNs = 0;
+    int64_t publishedNs = 0;
+};
+
+struct StageSamples {
+    std::vector<int64_t> queueNs, convertNs, publishNs, endToEndNs;
+};
+
+void report(const char *stage, std::vector<int64_t> &samples) {
+    std::printf("  %-20s p50 %6.2f ms  p99 %6.2f ms  máx. %6.2f ms  (%zu amostras)\n", stage,
+                test::percentile(samples, 0.5) / 1e6, test::percentile(samples, 0.99) / 1e6,
+                test::percentile(samples, 1.0) / 1e6, samples.size());
+}
+
+/**
+ * @param extraWorkNs Atraso somado à conversão; acima de 16,7 ms o worker
+ *                    fica mais lento que o stream e a fila passa a descartar
+ */
+void runPipeline(const char *name, int seconds, int64_t extraWorkNs, double minProcessedRatio) {
+    liveFrames = 0;
+    maxLiveFrames = 0;
+
+    // Frames do decoder: alguns buffers reciclados, como o pool do VideoToolbox
+    std::vector<std::shared_ptr<const DecodedFrame>> decoded;
+    for (int i = 0; i < 4; i++) {
+        decoded.push_back(std::make_shared<const DecodedFrame>());
+    }
+    // Saídas: as do slot mais a que o worker escreve, como o pool do renderer
+    std::vector<std::shared_ptr<Converted>> outputs;
+    for (int i = 0; i < FrameSlot<int>::kSlotCount + 2; i++) {
+        outputs.push_back(std::make_shared<Converted>());
+        outputs.back()->bgra.resize((size_t)kWidth * kHeight * 4);
+    }
+
+    FrameSlot<std::shared_ptr<Converted>> slot;
+    StageSamples samples;
+    uint64_t lastSequence = 0;
+    bool ordered = true;
+    size_t nextOutput = 0;
+
+    FramePipeline<Payload> pipeline(kCapacity, [&](Payload &payload) {
+        int64_t startNs = test::nowNs();
+        samples.queueNs.push_back(startNs - payload.submitNs);
+        ordered &= payload.sequence > lastSequence;
+        lastSequence = payload.sequence;
+
+        // Saída livre: nenhuma outra referência além do vetor (slot e leitores já soltaram)
+        std::shared_ptr<Converted> out;
+        for (size_t i = 0; i < outputs.size() && !out; i++) {
+            size_t index = (nextOutput + i) % outputs.size();
+            if (outputs[index].use_count() == 1) {
+                out = outputs[index];
+                nextOutput = index + 1;
+            }
+        }
+        if (!out) {
+            return;  // pool esgotado: o renderer também descarta aqui
+        }
+
+        const DecodedFrame &frame = *payload.frame;
+        ConvertNV12ToBGRA({ frame.y.data(), frame.uv.data(), kWidth, kWidth, kWidth, kHeight },
+                          { YUVMatrix::BT709, YUVRange::Video }, { out->bgra.data(), kWidth * 4 });
+        if (extraWorkNs > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(extraWorkNs));
+        }
+        int64_t convertedNs = test::nowNs();
+        samples.convertNs.push_back(convertedNs - startNs);
+
+        out->sequence = payload.sequence;
+        out->submitNs = payload.submitNs;
+        out->publishedNs = test::nowNs();
+        slot.publish(std::move(out));
+        int64_t publishedNs = test::nowNs();
+        samples.publishNs.push_back(publishedNs - convertedNs);
+        samples.endToEndNs.push_back(publishedNs - payload.submitNs);
+    });
+    pipeline.start();
+
+    // Câmera a 30 fps lendo o slot
+    std::atomic<bool> running(true);
+    std::vector<int64_t> readAgeNs;
+    std::thread camera([&] {
+        auto next = std::chrono::steady_clock::now();
+        while (running.load()) {
+            next += std::chrono::nanoseconds(1000000000LL / 30);
+            std::this_thread::sleep_until(next);
+            std::shared_ptr<Converted> frame;
+            if (slot.read(frame)) {
+                readAgeNs.push_back(test::nowNs() - frame->publishedNs);
+            }
+        }
+    });
+
+    // Decoder a 60 fps
+    const int frames = seconds * 60;
+    size_t maxDepth = 0;
+    auto next = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        next += std::chrono::nanoseconds(1000000000LL / 60);
+        std::this_thread::sleep_until(next);
+        pipeline.submit(Payload(decoded[i % decoded.size()], (uint64_t)i + 1, test::nowNs()));
+        maxDepth = std::max(maxDepth, pipeline.depth());
+    }
+
+    running = false;
+    camera.join();
+    pipeline.stop();
+    FramePipelineStats stats = pipeline.stats();
+    slot.clear();
+
+    uint64_t discardedOnStop = stats.submitted - stats.processed - stats.dropped;
+    CHECK_MSG(stats.submitted == (uint64_t)frames, "%s: %llu submetidos", name, (unsigned long long)stats.submitted);
+    CHECK_MSG(discardedOnStop <= kCapacity, "%s: %llu itens sem destino", name, (unsigned long long)discardedOnStop);
+    CHECK_MSG(maxDepth <= kCapacity && stats.maxDepth <= kCapacity, "%s: profundidade %zu/%llu > %zu", name, maxDepth,
+              (unsigned long long)stats.maxDepth, kCapacity);
+    // Fila + item no worker + item sendo submetido + o descartado durante o push
+    CHECK_MSG(maxLiveFrames.load() <= (int)kCapacity + 3, "%s: %d frames vivos ao mesmo tempo", name,
+              maxLiveFrames.load());
+    CHECK_MSG(liveFrames.load() == 0, "%s: %d frames vivos depois do stop", name, liveFrames.load());
+    CHECK_MSG(ordered, "%s: worker recebeu frames fora de ordem", name);
+    CHECK_MSG(stats.processed >= (uint64_t)(frames * minProcessedRatio), "%s: só %llu de %d processados", name,
+              (unsigned long long)stats.processed, frames);
+    // Drop-oldest limita a espera: no pior caso a fila cheia na frente de um item
+    CHECK_MSG(stats.queueNsMax <= (kCapacity + 1) * stats.workNsMax + 20000000ULL, "%s: espera máx. %.2f ms, trabalho máx. %.2f ms",
+              name, stats.queueNsMax / 1e6, stats.workNsMax / 1e6);
+
+    std::printf("%s: %llu submetidos, %llu processados, %llu descartados, profundidade máx. %llu, frames vivos máx. %d\n",
+                name, (unsigned long long)stats.submitted, (unsigned long long)stats.processed,
+                (unsigned long long)stats.dropped, (unsigned long long)stats.maxDepth, maxLiveFrames.load());
+    report("fila", samples.queueNs);
+    report("conversão", samples.convertNs);
+    report("publicação", samples.publishNs);
+    report("submit -> slot", samples.endToEndNs);
+    report("idade na leitura", readAgeNs);
+}
+
+} // namespace
+
+int main() {
+    checkQueueConcurrent();
+
+    SetParallelism(1);
+    // Ritmo nominal: a conversão 4K cabe no intervalo de 16,7 ms
+    runPipeline("4K60 nominal", 4, 0, 0.9);
+    // Worker a ~25 fps: metade dos frames cai na fila, sem crescer memória nem espera
+    runPipeline("4K60 worker lento", 3, 30000000LL, 0.25);
+    SetParallelism(0);
+
+    return vcam::test::finish("test_frame_pipeline");
+}
@@ -0,0 +1,227 @@
+// PixelBufferPool com um PoolBackend falso que imita o CVPixelBufferPool:
+// buffers soltos voltam para a lista livre do bucket e o limite de buffers
+// vivos recusa o pedido. Verifica a contagem de hits/misses em regime
+// permanente (inclusive depois de varreduras e com o backend trocando
+// buffers), o esgotamento no highWaterMark, o descarte de buckets ociosos e
+// isSupported até o preset 4032x3024.
+
+#include "PixelBufferPool.h"
+#include "TestSupport.h"
+
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+struct FakeBuffer {
+    int id;
+};
+
+struct FakeBucket {
+    PoolKey key;
+    size_t maxBuffers;
+    size_t live = 0;
+    std::vector<FakeBuffer *> free;
+};
+
+class FakeBackend : public PoolBackend {
+public:
+    int bucketsCreated = 0;
+    int bucketsDestroyed = 0;
+    int allocations = 0;
+    FakeBucket *lastBucket = nullptr;
+
+    ~FakeBackend() override {
+        // Endereços nunca reaproveitados durante o teste: um buffer novo nunca parece reciclado
+        for (FakeBuffer *buffer : _all) {
+            delete buffer;
+        }
+    }
+
+    void *createBucket(const PoolKey &key, size_t maxBuffers) override {
+        bucketsCreated++;
+        lastBucket = new FakeBucket;
+        lastBucket->key = key;
+        lastBucket->maxBuffers = maxBuffers;
+        return lastBucket;
+    }
+
+    void *acquire(void *storage) override {
+        FakeBucket *bucket = static_cast<FakeBucket *>(storage);
+        if (bucket->live >= bucket->maxBuffers) {
+            return nullptr;  // kCVReturnWouldExceedAllocationThreshold
+        }
+        bucket->live++;
+        if (!bucket->free.empty()) {
+            FakeBuffer *buffer = bucket->free.back();
+            bucket->free.pop_back();
+            return buffer;
+        }
+        allocations++;
+        _all.push_back(new FakeBuffer{ allocations });
+        return _all.back();
+    }
+
+    void destroyBucket(void *storage) override {
+        bucketsDestroyed++;
+        if (storage == lastBucket) {
+            lastBucket = nullptr;
+        }
+        delete static_cast<FakeBucket *>(storage);
+    }
+
+    /** Último consumidor soltou o buffer (CVPixelBufferRelease). */
+    void release(FakeBucket *bucket, void *buffer) {
+        bucket->live--;
+        bucket->free.insert(bucket->free.begin(), static_cast<FakeBuffer *>(buffer));
+    }
+
+    /** Descarta os buffers ociosos, como kCVPixelBufferPoolFlushExcessBuffers. */
+    void flush(FakeBucket *bucket) {
+        bucket->free.clear();
+    }
+
+private:
+    std::vector<FakeBuffer *> _all;
+};
+
+struct Harness {
+    FakeBackend *backend;
+    std::unique_ptr<PixelBufferPool> pool;
+
+    Harness(size_t highWaterMark, std::chrono::milliseconds idleTimeout)
+        : backend(new FakeBackend),
+          pool(new PixelBufferPool(std::unique_ptr<PoolBackend>(backend), highWaterMark, idleTimeout)) {
+    }
+};
+
+const PoolKey k1080 = { kPoolFormat420f, 1920, 1080, 64 };
+
+/**
+ * Conversão contínua com `depth` buffers retidos pelos consumidores (slot,
+ * câmera, preview). Com `flushEvery` > 0 o backend descarta os ociosos de
+ * tempos em tempos e as alocações seguintes têm de contar como miss.
+ */
+void runSteadyState(const char *name, size_t depth, int flushEvery) {
+    const size_t highWaterMark = 6;
+    const int frames = 3000;
+    Harness h(highWaterMark, std::chrono::milliseconds(5000));
+    std::deque<void *> inFlight;
+
+    for (int i = 0; i < frames; i++) {
+        void *buffer = h.pool->acquire(k1080);
+        CHECK_MSG(buffer != nullptr, "%s: frame %d sem buffer", name, i);
+        inFlight.push_back(buffer);
+        if (inFlight.size() > depth) {
+            h.backend->release(h.backend->lastBucket, inFlight.front());
+            inFlight.pop_front();
+        }
+        // Varreduras não podem esquecer buffers em uso
+        if (i % 500 == 499) {
+            h.pool->trim();
+        }
+        if (flushEvery > 0 && i % flushEvery == flushEvery - 1) {
+            h.backend->flush(h.backend->lastBucket);
+        }
+    }
+
+    PoolStats stats = h.pool->stats();
+    CHECK_MSG(stats.misses == (uint64_t)h.backend->allocations, "%s: misses %llu != alocações %d", name,
+              (unsigned long long)stats.misses, h.backend->allocations);
+    CHECK(stats.hits + stats.misses == (uint64_t)frames);
+    CHECK(stats.exhausted == 0);
+    CHECK(stats.activeBuckets == 1);
+    CHECK(stats.distinctBuffers <= highWaterMark * 2);
+    std::printf("%s: %llu hits, %llu misses, %d alocações em %d frames\n", name, (unsigned long long)stats.hits,
+                (unsigned long long)stats.misses, h.backend->allocations, frames);
+}
+
+void checkSteadyState() {
+    // Sem troca de buffers: só os depth + 1 primeiros são alocações
+    runSteadyState("regime permanente", 3, 0);
+    runSteadyState("regime permanente no limite", 5, 0);
+    // Backend trocando buffers: identidades novas saem da janela sem virar hit
+    runSteadyState("backend descartando ociosos", 2, 97);
+}
+
+void checkExhaustion() {
+    const size_t highWaterMark = 4;
+    Harness h(highWaterMark, std::chrono::milliseconds(5000));
+    std::vector<void *> held;
+    for (size_t i = 0; i < highWaterMark; i++) {
+        held.push_back(h.pool->acquire(k1080));
+        CHECK(held.back() != nullptr);
+    }
+    CHECK(h.pool->acquire(k1080) == nullptr);
+    CHECK(h.pool->acquire(k1080) == nullptr);
+
+    // Um buffer solto volta a atender o pedido, como hit
+    h.backend->release(h.backend->lastBucket, held.back());
+    CHECK(h.pool->acquire(k1080) == held.back());
+
+    PoolStats stats = h.pool->stats();
+    CHECK(stats.exhausted == 2);
+    CHECK(stats.misses == highWaterMark);
+    CHECK(stats.hits == 1);
+}
+
+void checkIdleTrim() {
+    Harness h(6, std::chrono::milliseconds(40));
+    const PoolKey k720 = { kPoolFormatBGRA, 1280, 720, 64 };
+    void *a = h.pool->acquire(k1080);
+    h.backend->release(h.backend->lastBucket, a);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+    // Bucket novo usado agora; o de 1080p está ocioso há mais que o timeout
+    void *b = h.pool->acquire(k720);
+    CHECK(b != nullptr);
+    h.pool->trim();
+
+    PoolStats stats = h.pool->stats();
+    CHECK(stats.trimmedBuckets == 1);
+    CHECK(stats.activeBuckets == 1);
+    CHECK(h.backend->bucketsDestroyed == 1);
+
+    // A chave descartada recria o bucket e conta uma alocação nova
+    CHECK(h.pool->acquire(k1080) != nullptr);
+    CHECK(h.backend->bucketsCreated == 3);
+    CHECK(h.pool->stats().misses == 3);
+
+    h.pool->purge();
+    CHECK(h.pool->stats().activeBuckets == 0);
+    CHECK(h.backend->bucketsDestroyed == 3);
+}
+
+void checkSupport() {
+    CHECK((PoolKey{ kPoolFormat420f, 4032, 3024, 64 }).isSupported());
+    CHECK((PoolKey{ kPoolFormat420v, 3024, 4032, 64 }).isSupported());
+    CHECK((PoolKey{ kPoolFormatBGRA, 4032, 3024, 16 }).isSupported());
+    CHECK(!(PoolKey{ kPoolFormat420f, 4033, 3024, 64 }).isSupported());
+    CHECK(!(PoolKey{ kPoolFormat420f, 4032, 3025, 64 }).isSupported());
+    CHECK(!(PoolKey{ kPoolFormat420f, 3025, 4032, 64 }).isSupported());
+    CHECK(!(PoolKey{ 0x79343230, 1920, 1080, 64 }).isSupported());  // 'y420'
+    CHECK(!(PoolKey{ kPoolFormat420f, 0, 1080, 64 }).isSupported());
+    CHECK(!(PoolKey{ kPoolFormat420f, 1920, 1080, 48 }).isSupported());
+    CHECK(!(PoolKey{ kPoolFormat420f, 1920, 1080, 0 }).isSupported());
+
+    // Chave não suportada nem chega ao backend
+    Harness h(6, std::chrono::milliseconds(5000));
+    CHECK(h.pool->acquire({ kPoolFormat420f, 4096, 3072, 64 }) == nullptr);
+    CHECK(h.backend->bucketsCreated == 0);
+    CHECK(h.pool->acquire({ kPoolFormat420f, 4032, 3024, 64 }) != nullptr);
+    CHECK(h.backend->bucketsCreated == 1);
+}
+
+} // namespace
+
+int main() {
+    checkSteadyState();
+    checkExhaustion();
+    checkIdleTrim();
+    checkSupport();
+    return vcam::test::finish("test_pixel_buffer_pool");
+}
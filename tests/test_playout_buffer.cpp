@@ -0,0 +1,215 @@
+// Simulação do PlayoutBuffer como o WebRTCManager o usa: stream a 60 fps com
+// jitter de rede, liberação agendada em nextDueNs com um pouco de atraso do
+// despacho. Verifica que todos os atrasos até kMaxDelayNs entregam o stream
+// inteiro dentro da profundidade padrão, que uma fila pequena demais perde
+// frames sem congelar, o modo adaptativo, o estimador de jitter e a ordenação.
+
+#include "PlayoutBuffer.h"
+#include "TestSupport.h"
+
+#include <random>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+const int64_t kFrameNs = 1000000000LL / 60;
+const int64_t kMs = 1000000LL;
+
+struct PlayoutRun {
+    int delivered = 0;
+    uint64_t dropped = 0;
+    size_t maxDepth = 0;
+    int64_t maxGapNs = 0;       // maior intervalo entre liberações depois da primeira
+    int64_t minLagNs = INT64_MAX;  // liberação - PTS
+    int64_t maxLagNs = 0;
+    int64_t finalDelayNs = 0;
+};
+
+/**
+ * 10 s de stream: chegada = PTS + 5 ms + jitter uniforme em [0, jitterNs].
+ * A liberação acorda 0,5 ms depois do agendado, como um dispatch_after.
+ */
+PlayoutRun simulate(PlayoutBuffer<int> &buffer, int64_t jitterNs, unsigned seed) {
+    const int frames = 600;
+    const int64_t wakeLatencyNs = kMs / 2;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int64_t> jitter(0, jitterNs);
+
+    std::vector<int64_t> arrivals(frames);
+    for (int i = 0; i < frames; i++) {
+        arrivals[i] = i * kFrameNs + 5 * kMs + jitter(rng);
+    }
+    // A rede não reordena a ponto de o decoder entregar fora de ordem
+    for (int i = 1; i < frames; i++) {
+        arrivals[i] = std::max(arrivals[i], arrivals[i - 1]);
+    }
+
+    PlayoutRun run;
+    int64_t scheduledNs = 0;
+    int64_t lastReleaseNs = 0;
+    int next = 0;
+    while (next < frames || scheduledNs != 0) {
+        bool arrival = next < frames && (scheduledNs == 0 || arrivals[next] <= scheduledNs + wakeLatencyNs);
+        if (arrival) {
+            int64_t now = arrivals[next];
+            buffer.push(next, next * kFrameNs, now);
+            run.maxDepth = std::max(run.maxDepth, buffer.depth());
+            int64_t dueNs = buffer.nextDueNs();
+            if (scheduledNs == 0 || dueNs < scheduledNs) {
+                scheduledNs = dueNs;
+            }
+            next++;
+            continue;
+        }
+
+        int64_t now = scheduledNs + wakeLatencyNs;
+        int frame;
+        if (buffer.popDue(now, frame)) {
+            if (run.delivered > 0) {
+                run.maxGapNs = std::max(run.maxGapNs, now - lastReleaseNs);
+            }
+            int64_t lag = now - frame * kFrameNs;
+            run.minLagNs = std::min(run.minLagNs, lag);
+            run.maxLagNs = std::max(run.maxLagNs, lag);
+            lastReleaseNs = now;
+            run.delivered++;
+        }
+        scheduledNs = buffer.nextDueNs();
+    }
+    run.dropped = buffer.droppedCount();
+    run.finalDelayNs = buffer.currentDelayNs();
+    return run;
+}
+
+void checkFixedDelays() {
+    // Com a profundidade antiga (8), 140 e 150 ms descartavam quase todos os frames
+    for (int64_t delayMs : { 20, 100, 130, 134, 140, 150 }) {
+        PlayoutBuffer<int> buffer;
+        buffer.setTargetDelay(delayMs * kMs);
+        PlayoutRun run = simulate(buffer, 8 * kMs, (unsigned)delayMs);
+        std::printf("atraso %3lld ms: %d/600 entregues, %llu descartados, profundidade máx. %zu, "
+                    "atraso real %.1f-%.1f ms\n",
+                    (long long)delayMs, run.delivered, (unsigned long long)run.dropped, run.maxDepth,
+                    run.minLagNs / 1e6, run.maxLagNs / 1e6);
+
+        CHECK_MSG(run.delivered == 600, "atraso %lld ms: %d entregues", (long long)delayMs, run.delivered);
+        CHECK(run.dropped == 0);
+        CHECK(run.maxDepth <= PlayoutBuffer<int>::kDefaultMaxDepth);
+        // Cada frame sai em PTS + atraso, com o atraso do despacho
+        CHECK(run.minLagNs >= delayMs * kMs);
+        CHECK(run.maxLagNs <= delayMs * kMs + kMs);
+    }
+
+    // Acima do teto vale o teto
+    PlayoutBuffer<int> buffer;
+    buffer.setTargetDelay(400 * kMs);
+    CHECK(buffer.targetDelayNs() == PlayoutBuffer<int>::kMaxDelayNs);
+    CHECK(simulate(buffer, 8 * kMs, 1).delivered == 600);
+}
+
+void checkUndersizedQueue() {
+    // 150 ms a 60 fps com só 4 posições: perde frames, mas continua andando
+    PlayoutBuffer<int> buffer(4);
+    buffer.setTargetDelay(PlayoutBuffer<int>::kMaxDelayNs);
+    PlayoutRun run = simulate(buffer, 8 * kMs, 7);
+    std::printf("fila com 4 posições a 150 ms: %d/600 entregues, maior intervalo %.1f ms\n", run.delivered,
+                run.maxGapNs / 1e6);
+
+    CHECK(run.maxDepth <= 4);
+    CHECK(run.delivered >= 90);
+    CHECK(run.delivered + (int)run.dropped == 600);
+    CHECK(run.maxGapNs <= 2 * PlayoutBuffer<int>::kMaxDelayNs);
+    CHECK(run.minLagNs >= PlayoutBuffer<int>::kMaxDelayNs);
+}
+
+void checkAdaptive() {
+    // Rede estável: atraso bem abaixo do teto
+    PlayoutBuffer<int> calm;
+    calm.setTargetDelay(PlayoutBuffer<int>::kMaxDelayNs);
+    calm.setAdaptive(true);
+    PlayoutRun quiet = simulate(calm, kMs, 3);
+
+    // Rede instável: o atraso cresce com o jitter, limitado ao alvo
+    PlayoutBuffer<int> noisy;
+    noisy.setTargetDelay(PlayoutBuffer<int>::kMaxDelayNs);
+    noisy.setAdaptive(true);
+    PlayoutRun loud = simulate(noisy, 60 * kMs, 3);
+
+    PlayoutBuffer<int> capped;
+    capped.setTargetDelay(20 * kMs);
+    capped.setAdaptive(true);
+    PlayoutRun clamped = simulate(capped, 60 * kMs, 3);
+
+    std::printf("adaptativo: jitter 1 ms -> atraso %.1f ms (%d entregues), jitter 60 ms -> %.1f ms "
+                "(%d entregues), teto 20 ms -> %.1f ms\n",
+                quiet.finalDelayNs / 1e6, quiet.delivered, loud.finalDelayNs / 1e6, loud.delivered,
+                clamped.finalDelayNs / 1e6);
+
+    CHECK(quiet.finalDelayNs < 5 * kMs);
+    CHECK(quiet.delivered >= 590);
+    CHECK(loud.finalDelayNs > 30 * kMs);
+    CHECK(loud.finalDelayNs <= PlayoutBuffer<int>::kMaxDelayNs);
+    CHECK(loud.maxDepth <= PlayoutBuffer<int>::kDefaultMaxDepth);
+    CHECK(loud.delivered >= 540);
+    CHECK(clamped.finalDelayNs == 20 * kMs);
+}
+
+void checkJitterEstimator() {
+    // Trânsito constante: sem jitter
+    PlayoutBuffer<int> steady;
+    for (int i = 0; i < 100; i++) {
+        steady.push(i, i * kFrameNs, i * kFrameNs + 30 * kMs);
+        int frame;
+        steady.popDue(i * kFrameNs + 30 * kMs, frame);
+    }
+    CHECK(steady.jitterNs() == 0);
+
+    // Trânsito alternando 0 e 10 ms: |D| = 10 ms a cada frame, J converge para 10 ms
+    PlayoutBuffer<int> alternating;
+    for (int i = 0; i < 200; i++) {
+        int64_t transit = (i & 1) ? 10 * kMs : 0;
+        alternating.push(i, i * kFrameNs, i * kFrameNs + transit);
+        int frame;
+        alternating.popDue(i * kFrameNs + transit, frame);
+    }
+    CHECK_MSG(std::llabs(alternating.jitterNs() - 10 * kMs) < kMs / 2, "jitter %.2f ms",
+              alternating.jitterNs() / 1e6);
+
+    // clear zera o jitter e a chegada seguinte não vira amostra
+    alternating.clear();
+    CHECK(alternating.jitterNs() == 0);
+    alternating.push(0, 500 * kFrameNs, 900 * kFrameNs);
+    CHECK(alternating.jitterNs() == 0);
+}
+
+void checkOrdering() {
+    PlayoutBuffer<int> buffer;
+    buffer.setTargetDelay(10 * kMs);
+    buffer.push(3, 3 * kFrameNs, 3 * kFrameNs);
+    buffer.push(1, 1 * kFrameNs, 3 * kFrameNs);
+    buffer.push(2, 2 * kFrameNs, 3 * kFrameNs);
+    CHECK(buffer.depth() == 3);
+    CHECK(buffer.nextDueNs() == 1 * kFrameNs + 10 * kMs);
+
+    int frame = -1;
+    CHECK(!buffer.popDue(1 * kFrameNs + 10 * kMs - 1, frame));
+    CHECK(buffer.popDue(1 * kFrameNs + 10 * kMs, frame) && frame == 1);
+    // Dois vencidos: sai o mais recente, o outro conta como descartado
+    CHECK(buffer.popDue(3 * kFrameNs + 10 * kMs, frame) && frame == 3);
+    CHECK(buffer.droppedCount() == 1);
+    CHECK(buffer.depth() == 0);
+    CHECK(buffer.nextDueNs() == 0);
+}
+
+} // namespace
+
+int main() {
+    checkFixedDelays();
+    checkUndersizedQueue();
+    checkAdaptive();
+    checkJitterEstimator();
+    checkOrdering();
+    return vcam::test::finish("test_playout_buffer");
+}
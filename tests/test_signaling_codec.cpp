@@ -0,0 +1,394 @@
+// SignalingWriter/SignalingReader: ida e volta das mensagens reais de
+// data/signaling_messages.json e de valores aleatórios, tabelas iguais às do
+// server.js, e fuzz do leitor (o protocolo chega da rede): prefixos de
+// mensagens válidas são sempre rejeitados e entradas mutadas ou aleatórias
+// terminam sem ler fora do buffer nem aceitar contagens impossíveis.
+
+#include "SignalingCodec.h"
+#include "SignalingMessage.h"
+#include "TestSupport.h"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using namespace vcam;
+using vcam::test::Value;
+
+namespace {
+
+// --- Tabelas ---
+
+std::vector<std::string> serverTable(const std::string &source, const char *name) {
+    std::vector<std::string> names;
+    size_t start = source.find(std::string("const ") + name + " = [");
+    size_t end = start == std::string::npos ? start : source.find("];", start);
+    if (end == std::string::npos) {
+        return names;
+    }
+    for (size_t p = source.find('\'', start); p < end; p = source.find('\'', p)) {
+        size_t close = source.find('\'', p + 1);
+        names.push_back(source.substr(p + 1, close - p - 1));
+        p = close + 1;
+    }
+    return names;
+}
+
+void checkTablesMatchServer() {
+    std::ifstream file(VCAM_TEST_DATA_DIR "/../../server.js");
+    std::stringstream source;
+    source << file.rdbuf();
+    std::vector<std::string> keys = serverTable(source.str(), "SIGNALING_KEYS");
+    std::vector<std::string> types = serverTable(source.str(), "SIGNALING_TYPES");
+    CHECK_MSG(!keys.empty() && !types.empty(), "tabelas não encontradas no server.js");
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        const char *name = SignalingKeyName(i);
+        CHECK_MSG(name && keys[i] == name, "chave %zu: server.js '%s', C++ '%s'", i, keys[i].c_str(), name ? name : "-");
+    }
+    CHECK_MSG(SignalingKeyName(keys.size()) == nullptr, "C++ tem mais chaves que o server.js (%zu)", keys.size());
+    for (size_t i = 0; i < types.size(); i++) {
+        const char *name = SignalingTypeName(i);
+        CHECK_MSG(name && types[i] == name, "tipo %zu: server.js '%s', C++ '%s'", i, types[i].c_str(), name ? name : "-");
+    }
+    CHECK_MSG(SignalingTypeName(types.size()) == nullptr, "C++ tem mais tipos que o server.js (%zu)", types.size());
+}
+
+// --- Ida e volta ---
+
+bool roundTrip(const Value &message, std::vector<uint8_t> &bytes) {
+    Value decoded;
+    return test::encodeMessage(message, bytes) && test::decodeMessage(bytes.data(), bytes.size(), decoded) &&
+           test::sameValue(message, decoded);
+}
+
+// Todo prefixo estrito de uma mensagem válida é rejeitado
+int acceptedPrefixes(const std::vector<uint8_t> &bytes) {
+    int accepted = 0;
+    for (size_t length = 0; length < bytes.size(); length++) {
+        Value decoded;
+        accepted += test::decodeMessage(bytes.data(), length, decoded) ? 1 : 0;
+    }
+    return accepted;
+}
+
+void checkCorpus() {
+    auto corpus = test::loadSignalingCorpus();
+    CHECK_MSG(corpus.size() >= 8, "%zu mensagens em signaling_messages.json", corpus.size());
+    for (const auto &entry : corpus) {
+        std::vector<uint8_t> bytes;
+        CHECK_MSG(roundTrip(entry.second, bytes), "%s: ida e volta diverge", entry.first.c_str());
+        CHECK_MSG(acceptedPrefixes(bytes) == 0, "%s: prefixo truncado aceito", entry.first.c_str());
+        std::string json = test::toJSON(entry.second);
+        CHECK_MSG(bytes.size() < json.size(), "%s: binário com %zu bytes, JSON com %zu", entry.first.c_str(),
+                  bytes.size(), json.size());
+    }
+}
+
+void checkEdgeValues() {
+    Value message;
+    message.kind = Value::Map;
+    message.fields.emplace_back("type", Value::makeText("tipo-novo-fora-da-tabela"));
+
+    auto add = [&](const char *key, Value value) { message.fields.emplace_back(key, std::move(value)); };
+    Value v;
+    v.kind = Value::Int;
+    for (int64_t i : { (int64_t)0, (int64_t)23, (int64_t)24, (int64_t)255, (int64_t)256, (int64_t)65535, (int64_t)65536,
+                       (int64_t)-1, (int64_t)-24, (int64_t)-25, (int64_t)-256, (int64_t)-257, (int64_t)4294967295LL,
+                       (int64_t)4294967296LL, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min() }) {
+        v.integer = i;
+        add(("int" + std::to_string(i)).c_str(), v);
+    }
+    v = Value();
+    v.kind = Value::UInt;
+    v.unsignedInteger = std::numeric_limits<uint64_t>::max();
+    add("uintMax", v);
+    v = Value();
+    v.kind = Value::Double;
+    for (double d : { 0.5, -1.25, 1760000000123.456, 1e300, -1e-300, 3.0, std::nan(""), (double)INFINITY, -(double)INFINITY,
+                      9223372036854775808.0, -9223372036854775808.0 }) {
+        v.real = d;
+        add(("double" + std::to_string(message.fields.size())).c_str(), v);
+    }
+    add("texto", Value::makeText("ação ✓ \xF0\x9F\x93\xB7 \"aspas\" \\ \r\n"));
+    add("vazio", Value::makeText(""));
+    add("type-aninhado", Value::makeText("offer"));  // só o type do topo usa a tabela de tipos
+    v = Value();
+    add("nulo", v);
+    v.kind = Value::Bool;
+    v.boolean = true;
+    add("verdadeiro", v);
+
+    // Aninhamento no limite de profundidade
+    Value nested;
+    nested.kind = Value::Array;
+    for (int depth = 0; depth < test::kSignalingMaxDepth - 1; depth++) {
+        Value outer;
+        outer.kind = depth % 2 ? Value::Array : Value::Map;
+        if (outer.kind == Value::Array) {
+            outer.items.push_back(std::move(nested));
+        } else {
+            outer.fields.emplace_back("sdp", std::move(nested));
+        }
+        nested = std::move(outer);
+    }
+    add("fundo", nested);
+
+    std::vector<uint8_t> bytes;
+    CHECK_MSG(roundTrip(message, bytes), "valores de borda: ida e volta diverge");
+    CHECK(acceptedPrefixes(bytes) == 0);
+
+    // Um nível a mais é recusado na escrita (o emissor cai para JSON)
+    Value tooDeep;
+    tooDeep.kind = Value::Array;
+    tooDeep.items.push_back(std::move(nested));
+    Value deepMessage;
+    deepMessage.kind = Value::Map;
+    deepMessage.fields.emplace_back("config", std::move(tooDeep));
+    CHECK(!test::encodeMessage(deepMessage, bytes));
+}
+
+Value randomValue(std::mt19937 &rng, int depth) {
+    std::uniform_int_distribution<int> kind(0, depth < 5 ? 7 : 5);
+    std::uniform_int_distribution<int> small(0, 6);
+    Value v;
+    switch (kind(rng)) {
+        case 0: break;
+        case 1: v.kind = Value::Bool; v.boolean = rng() & 1; break;
+        case 2: v.kind = Value::Int; v.integer = (int64_t)(((uint64_t)rng() << 32) | rng()) >> (rng() % 64); break;
+        case 3: v.kind = Value::UInt; v.unsignedInteger = (((uint64_t)rng() << 32) | rng()) >> (rng() % 64); break;
+        case 4: {
+            v.kind = Value::Double;
+            uint64_t bits = ((uint64_t)rng() << 32) | rng();
+            std::memcpy(&v.real, &bits, sizeof(v.real));
+            if (rng() % 2) {
+                v.real = (float)((double)(int32_t)rng() / 1024.0);
+            }
+            break;
+        }
+        case 5: {
+            v.kind = Value::Text;
+            int length = (int)(rng() % 40);
+            for (int i = 0; i < length; i++) {
+                v.text += (char)(rng() % 256);
+            }
+            break;
+        }
+        case 6: {
+            v.kind = Value::Array;
+            int count = small(rng);
+            for (int i = 0; i < count; i++) {
+                v.items.push_back(randomValue(rng, depth + 1));
+            }
+            break;
+        }
+        case 7: {
+            v.kind = Value::Map;
+            int count = small(rng);
+            for (int i = 0; i < count; i++) {
+                // Metade das chaves da tabela, metade texto livre
+                std::string key = rng() % 2 ? SignalingKeyName(rng() % 28) : "k" + std::to_string(rng() % 1000);
+                v.fields.emplace_back(key, randomValue(rng, depth + 1));
+            }
+            break;
+        }
+    }
+    return v;
+}
+
+void checkRandomRoundTrips() {
+    std::mt19937 rng(2024);
+    int failures = 0;
+    for (int i = 0; i < 20000; i++) {
+        Value message;
+        message.kind = Value::Map;
+        message.fields.emplace_back("type", Value::makeText(rng() % 2 ? SignalingTypeName(rng() % 19) : "x-teste"));
+        int count = (int)(rng() % 6);
+        for (int f = 0; f < count; f++) {
+            message.fields.emplace_back(SignalingKeyName(1 + rng() % 27), randomValue(rng, 1));
+        }
+        std::vector<uint8_t> bytes;
+        if (!roundTrip(message, bytes) || acceptedPrefixes(bytes) != 0) {
+            failures++;
+        }
+    }
+    CHECK_MSG(failures == 0, "%d mensagens aleatórias divergem na ida e volta", failures);
+}
+
+// --- Fuzz do leitor ---
+
+// Percorre todos os itens sem montar valores, conferindo os limites de cada um
+bool walk(SignalingReader &reader, const uint8_t *begin, const uint8_t *end, int depth, bool &outOfBounds) {
+    SignalingItem item;
+    if (depth > test::kSignalingMaxDepth || !reader.read(item)) {
+        return false;
+    }
+    size_t remaining = 0;
+    switch (item.type) {
+        case SignalingItemType::Text:
+            if ((const uint8_t *)item.text < begin || (const uint8_t *)item.text + item.count > end) {
+                outOfBounds = true;
+            }
+            return true;
+        case SignalingItemType::Array:
+        case SignalingItemType::Map:
+            remaining = (size_t)(end - begin);
+            if (item.count > remaining) {
+                outOfBounds = true;
+                return false;
+            }
+            for (uint64_t i = 0; i < item.count * (item.type == SignalingItemType::Map ? 2 : 1); i++) {
+                if (!walk(reader, begin, end, depth + 1, outOfBounds)) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return true;
+    }
+}
+
+void fuzzOne(const std::vector<uint8_t> &input, int &outOfBounds, int &accepted, int &unstable) {
+    // Cópia exata no heap: leitura além do fim aparece com ASan
+    std::unique_ptr<uint8_t[]> copy(new uint8_t[input.size() + 1]);
+    std::memcpy(copy.get(), input.data(), input.size());
+    const uint8_t *begin = copy.get(), *end = copy.get() + input.size();
+
+    SignalingReader reader(begin, input.size());
+    bool bad = false;
+    if (reader.valid()) {
+        while (!reader.atEnd() && walk(reader, begin, end, 0, bad)) {
+        }
+    }
+    outOfBounds += bad ? 1 : 0;
+
+    Value decoded;
+    if (test::decodeMessage(begin, input.size(), decoded)) {
+        // Aceita: reescrever e reler tem de dar o mesmo valor
+        accepted++;
+        std::vector<uint8_t> bytes;
+        Value again;
+        if (!test::encodeMessage(decoded, bytes) || !test::decodeMessage(bytes.data(), bytes.size(), again) ||
+            !test::sameValue(decoded, again)) {
+            unstable++;
+        }
+    }
+}
+
+void checkFuzz() {
+    std::mt19937 rng(77);
+    auto corpus = test::loadSignalingCorpus();
+    std::vector<std::vector<uint8_t>> seeds;
+    for (const auto &entry : corpus) {
+        std::vector<uint8_t> bytes;
+        if (test::encodeMessage(entry.second, bytes)) {
+            seeds.push_back(bytes);
+        }
+    }
+    CHECK(!seeds.empty());
+    if (seeds.empty()) {
+        return;
+    }
+
+    int outOfBounds = 0, accepted = 0, unstable = 0, runs = 0;
+    for (int i = 0; i < 200000; i++) {
+        std::vector<uint8_t> input = seeds[rng() % seeds.size()];
+        int mutations = 1 + (int)(rng() % 4);
+        for (int m = 0; m < mutations && !input.empty(); m++) {
+            size_t at = rng() % input.size();
+            switch (rng() % 5) {
+                case 0: input[at] ^= (uint8_t)(1 << (rng() % 8)); break;
+                case 1: input[at] = (uint8_t)rng(); break;
+                case 2: input.insert(input.begin() + at, (uint8_t)rng()); break;
+                case 3: input.erase(input.begin() + at); break;
+                // Cabeçalhos de contagem grande (0x1B = uint64 a seguir) no meio da mensagem
+                case 4: input[at] = (uint8_t)(0x1B | ((rng() % 6) << 5)); break;
+            }
+        }
+        // Mantém o cabeçalho na maioria das vezes, senão o leitor recusa logo
+        if (input.size() >= 2 && rng() % 8) {
+            input[0] = kSignalingMagic;
+            input[1] = kSignalingProtocolVersion;
+        }
+        fuzzOne(input, outOfBounds, accepted, unstable);
+        runs++;
+    }
+    for (int i = 0; i < 50000; i++) {
+        std::vector<uint8_t> input(2 + rng() % 64);
+        for (uint8_t &b : input) {
+            b = (uint8_t)rng();
+        }
+        input[0] = kSignalingMagic;
+        input[1] = kSignalingProtocolVersion;
+        fuzzOne(input, outOfBounds, accepted, unstable);
+        runs++;
+    }
+    CHECK_MSG(outOfBounds == 0, "fuzz: %d entradas com item fora do buffer", outOfBounds);
+    CHECK_MSG(unstable == 0, "fuzz: %d mensagens aceitas mudam ao reescrever", unstable);
+    std::printf("fuzz: %d entradas, %d aceitas como mensagem\n", runs, accepted);
+}
+
+void checkHeaderAndCounts() {
+    SignalingItem item;
+    const uint8_t empty[] = { 0 };
+    CHECK(!SignalingReader(nullptr, 0).valid());
+    CHECK(!SignalingReader(empty, 0).valid());
+    const uint8_t headerOnly[] = { kSignalingMagic, kSignalingProtocolVersion };
+    CHECK(!SignalingReader(headerOnly, 2).valid());
+    const uint8_t otherVersion[] = { kSignalingMagic, kSignalingProtocolVersion + 1, 0xA0 };
+    SignalingReader future(otherVersion, sizeof(otherVersion));
+    CHECK(!future.valid() && !future.read(item));
+    const uint8_t json[] = { '{', '"', 't' };
+    CHECK(!SignalingReader(json, sizeof(json)).valid());
+
+    // Contagens maiores que os bytes restantes: recusadas antes de qualquer alocação
+    const uint8_t hugeMap[] = { kSignalingMagic, kSignalingProtocolVersion, 0xBB, 0, 0, 0, 1, 0, 0, 0, 0, 0x00, 0x00 };
+    SignalingReader map(hugeMap, sizeof(hugeMap));
+    CHECK(map.valid() && !map.read(item));
+    const uint8_t hugeText[] = { kSignalingMagic, kSignalingProtocolVersion, 0x7A, 0xFF, 0xFF, 0xFF, 0xFF, 'a' };
+    SignalingReader text(hugeText, sizeof(hugeText));
+    CHECK(text.valid() && !text.read(item));
+    const uint8_t oddMap[] = { kSignalingMagic, kSignalingProtocolVersion, 0xA2, 0x00, 0x01, 0x02 };
+    SignalingReader odd(oddMap, sizeof(oddMap));
+    CHECK(odd.valid() && !odd.read(item));
+
+    // Indefinido, tags, bytes e inteiro negativo fora de int64
+    for (uint8_t initial : { (uint8_t)0x9F, (uint8_t)0xBF, (uint8_t)0x7F, (uint8_t)0xC0, (uint8_t)0x41, (uint8_t)0xF7,
+                             (uint8_t)0xF8 }) {
+        const uint8_t data[] = { kSignalingMagic, kSignalingProtocolVersion, initial, 0x00 };
+        SignalingReader reader(data, sizeof(data));
+        CHECK_MSG(!reader.read(item), "byte inicial 0x%02X aceito", initial);
+    }
+    const uint8_t negative[] = { kSignalingMagic, kSignalingProtocolVersion, 0x3B, 0x80, 0, 0, 0, 0, 0, 0, 0 };
+    SignalingReader neg(negative, sizeof(negative));
+    CHECK(!neg.read(item));
+
+    // float16 (o JS não escreve, mas o leitor aceita)
+    const uint8_t half[] = { kSignalingMagic, kSignalingProtocolVersion, 0xF9, 0x3E, 0x00 };
+    SignalingReader halfReader(half, sizeof(half));
+    CHECK(halfReader.read(item) && item.type == SignalingItemType::Double && item.real == 1.5);
+
+    // Código de chave fora da tabela
+    const uint8_t unknownKey[] = { kSignalingMagic, kSignalingProtocolVersion, 0xA1, 0x18, 0xC8, 0x00 };
+    Value decoded;
+    CHECK(!test::decodeMessage(unknownKey, sizeof(unknownKey), decoded));
+    // Bytes sobrando depois do mapa
+    const uint8_t trailing[] = { kSignalingMagic, kSignalingProtocolVersion, 0xA0, 0x00 };
+    CHECK(!test::decodeMessage(trailing, sizeof(trailing), decoded));
+}
+
+} // namespace
+
+int main() {
+    checkTablesMatchServer();
+    checkCorpus();
+    checkEdgeValues();
+    checkRandomRoundTrips();
+    checkHeaderAndCounts();
+    checkFuzz();
+    return vcam::test::finish("test_signaling_codec");
+}
@@ -0,0 +1,62 @@
+// Leitura do código de timestamp nos frames de data/timestamp_code (faixas
+// degradadas como H.264, ver gen_timestamp_frames.cpp): o caminho SIMD e a
+// referência escalar precisam concordar entre si e com o valor esperado.
+// Também confere ida e volta em larguras que não são múltiplas do vetor.
+
+#include "TimestampCode.h"
+#include "TimestampFrames.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+void checkCheckedInFrames() {
+    std::vector<test::TimestampFrame> frames = test::loadTimestampFrames();
+    CHECK_MSG(frames.size() >= 10, "%zu frames em data/timestamp_code", frames.size());
+    for (const test::TimestampFrame &frame : frames) {
+        uint64_t fast = 0, slow = 0;
+        bool fastOk = ReadTimestampCode(frame.plane(), fast);
+        bool slowOk = reference::ReadTimestampCode(frame.plane(), slow);
+        CHECK_MSG(fastOk == slowOk && fast == slow, "%s: SIMD %d/%llu, referência %d/%llu", frame.name.c_str(), fastOk,
+                  (unsigned long long)fast, slowOk, (unsigned long long)slow);
+        CHECK_MSG(fastOk == frame.expectValid, "%s: leitura %s, esperado %s", frame.name.c_str(),
+                  fastOk ? "válida" : "inválida", frame.expectValid ? "válida" : "inválida");
+        if (frame.expectValid) {
+            CHECK_MSG(fast == frame.timestampMs, "%s: %llu, esperado %llu", frame.name.c_str(),
+                      (unsigned long long)fast, (unsigned long long)frame.timestampMs);
+        }
+    }
+}
+
+void checkRoundTrip() {
+    const int sizes[][2] = { { 116, 16 }, { 117, 30 }, { 641, 361 }, { 1279, 719 }, { 4032, 3024 } };
+    for (const auto &size : sizes) {
+        int w = size[0], h = size[1], stride = w + 13;
+        std::vector<uint8_t> luma((size_t)stride * h, 128);
+        uint64_t timestampMs = 0xABCDEF012345ULL ^ (uint64_t)w;
+        WriteTimestampCode(luma.data(), stride, w, h, timestampMs, 255, 0);
+        LumaPlane plane = { luma.data(), stride, w, h };
+        uint64_t fast = 0, slow = 0;
+        CHECK_MSG(ReadTimestampCode(plane, fast) && fast == timestampMs, "%dx%d: SIMD leu %llu", w, h,
+                  (unsigned long long)fast);
+        CHECK_MSG(reference::ReadTimestampCode(plane, slow) && slow == timestampMs, "%dx%d: referência leu %llu", w,
+                  h, (unsigned long long)slow);
+    }
+
+    // Abaixo da largura mínima não há leitura
+    std::vector<uint8_t> narrow(115 * 16, 128);
+    WriteTimestampCode(narrow.data(), 115, 115, 16, 1);
+    uint64_t value = 0;
+    CHECK(!ReadTimestampCode({ narrow.data(), 115, 115, 16 }, value));
+}
+
+} // namespace
+
+int main() {
+    checkCheckedInFrames();
+    checkRoundTrip();
+    return vcam::test::finish("test_timestamp_code");
+}
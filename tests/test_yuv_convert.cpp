@@ -0,0 +1,139 @@
+// Os kernels SIMD de I420 -> NV12 devem produzir exatamente os bytes de
+// reference::ConvertI420ToNV12, em todas as combinações de faixa, larguras
+// ímpares/sobras de vetor e strides com padding. Cada backend compilado e
+// suportado pelo host é testado (NEON só em host arm64).
+
+#include "YUVConvert.h"
+#include "TestSupport.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace vcam;
+
+namespace {
+
+const uint8_t kGuard = 0xA5;
+
+struct I420Frame {
+    int width, height, strideY, strideC;
+    std::vector<uint8_t> y, u, v;
+
+    I420Frame(int w, int h, std::mt19937 &rng) : width(w), height(h) {
+        strideY = w + 13;
+        strideC = (w + 1) / 2 + 7;
+        int chromaHeight = (h + 1) / 2;
+        y.resize((size_t)strideY * h);
+        u.resize((size_t)strideC * chromaHeight);
+        v.resize((size_t)strideC * chromaHeight);
+        // Metade aleatória, metade nos extremos para exercitar saturação
+        std::uniform_int_distribution<int> byte(0, 255);
+        auto fill = [&](std::vector<uint8_t> &plane) {
+            for (size_t i = 0; i < plane.size(); i++) {
+                int r = byte(rng);
+                plane[i] = (uint8_t)((r & 1) ? byte(rng) : (r & 2 ? 0 : 255));
+            }
+        };
+        fill(y);
+        fill(u);
+        fill(v);
+    }
+
+    I420Planes planes() const {
+        return { y.data(), u.data(), v.data(), strideY, strideC, strideC, width, height };
+    }
+};
+
+struct NV12Frame {
+    int strideY, strideUV, height;
+    std::vector<uint8_t> y, uv;
+
+    NV12Frame(int w, int h) : height(h) {
+        strideY = w + 9;
+        strideUV = ((w + 1) / 2) * 2 + 5;
+        y.assign((size_t)strideY * h, kGuard);
+        uv.assign((size_t)strideUV * ((h + 1) / 2), kGuard);
+    }
+
+    NV12Planes planes() {
+        return { y.data(), uv.data(), strideY, strideUV };
+    }
+};
+
+const YUVRange kRanges[] = { YUVRange::Video, YUVRange::Full };
+
+void checkFrame(const char *backend, int w, int h, std::mt19937 &rng) {
+    I420Frame src(w, h, rng);
+    for (YUVRange srcRange : kRanges) {
+        for (YUVRange dstRange : kRanges) {
+            NV12Frame expected(w, h);
+            NV12Frame actual(w, h);
+            reference::ConvertI420ToNV12(src.planes(), srcRange, expected.planes(), dstRange);
+            ConvertI420ToNV12(src.planes(), srcRange, actual.planes(), dstRange);
+            // Compara também o padding: nenhum kernel pode escrever além da largura
+            CHECK_MSG(expected.y == actual.y, "%s %dx%d luma %d->%d", backend, w, h, (int)srcRange, (int)dstRange);
+            CHECK_MSG(expected.uv == actual.uv, "%s %dx%d croma %d->%d", backend, w, h, (int)srcRange, (int)dstRange);
+        }
+    }
+}
+
+// Todos os 256 valores em várias posições de lane, com sobras de 0..63
+// amostras; a referência por linha é o backend escalar.
+void checkRowsExhaustive(const char *backend) {
+    std::vector<uint8_t> u(256 + 64), v(256 + 64);
+    for (size_t i = 0; i < u.size(); i++) {
+        u[i] = (uint8_t)i;
+        v[i] = (uint8_t)(255 - i * 7);
+    }
+    for (int width = 1; width <= (int)u.size(); width += (width < 70 ? 1 : 37)) {
+        for (YUVRange srcRange : kRanges) {
+            for (YUVRange dstRange : kRanges) {
+                std::vector<uint8_t> expectedY(width + 1, kGuard), actualY(width + 1, kGuard);
+                std::vector<uint8_t> expectedUV(2 * width + 1, kGuard), actualUV(2 * width + 1, kGuard);
+
+                SetYUVConvertBackend("scalar");
+                ConvertLumaRow(u.data(), expectedY.data(), width, srcRange, dstRange);
+                InterleaveChromaRow(u.data(), v.data(), expectedUV.data(), width, srcRange, dstRange);
+                SetYUVConvertBackend(backend);
+                ConvertLumaRow(u.data(), actualY.data(), width, srcRange, dstRange);
+                InterleaveChromaRow(u.data(), v.data(), actualUV.data(), width, srcRange, dstRange);
+
+                CHECK_MSG(expectedY == actualY, "%s linha de luma largura %d", backend, width);
+                CHECK_MSG(expectedUV == actualUV, "%s linha de croma largura %d", backend, width);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("backend automático: %s\n", YUVConvertBackendName());
+    CHECK(!SetYUVConvertBackend("inexistente"));
+
+    int tested = 0;
+    for (const char *backend : { "scalar", "sse2", "avx2", "neon" }) {
+        if (!SetYUVConvertBackend(backend)) {
+            std::printf("%s: indisponível neste host, ignorado\n", backend);
+            continue;
+        }
+        CHECK(std::strcmp(YUVConvertBackendName(), backend) == 0);
+        tested++;
+
+        std::mt19937 rng(1234);
+        const int sizes[][2] = {
+            { 2, 2 }, { 1, 1 }, { 3, 5 }, { 15, 3 }, { 17, 9 }, { 31, 7 }, { 33, 4 }, { 63, 11 },
+            { 65, 2 }, { 127, 3 }, { 320, 240 }, { 641, 361 }, { 1280, 720 }, { 1920, 1080 },
+        };
+        for (const auto &size : sizes) {
+            checkFrame(backend, size[0], size[1], rng);
+        }
+        checkRowsExhaustive(backend);
+        std::printf("%s: comparado com reference\n", backend);
+    }
+    CHECK(tested >= 2);
+
+    SetYUVConvertBackend(nullptr);
+    return vcam::test::finish("test_yuv_convert");
+}